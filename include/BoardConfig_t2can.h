@@ -20,6 +20,14 @@
 // CAN2 (source) - Second MCP2515 (connected to CAN2010 device)
 #define BOARD_CAN2_CS_PIN 14  // Chip Select for second MCP2515
 
+// MCP2515 interrupt outputs (active low, asserted while a frame waits in RXB0/RXB1)
+// -1: reception is polled from loop() (canBusService()). The T2CAN routing of INT is not
+// confirmed on the schematic; the GPIOs tried so far (3 and 46) are ESP32-S3 strapping pins,
+// and an idle-high INT on GPIO46 blocks download mode with the BOOT button.
+// Once the routing is known, set the GPIOs here, on non-strapping pins only.
+#define BOARD_CAN1_INT_PIN -1  // INT of first MCP2515
+#define BOARD_CAN2_INT_PIN -1  // INT of second MCP2515
+
 // I2C pins for RTC (DS1307/DS3231) - QWIIC interface on T2CAN
 #define BOARD_SDA_PIN 8   // I2C Data
 #define BOARD_SCL_PIN 9   // I2C Clock
@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @file alerts_journal.h
+ * @brief Table-driven decoding of the 0x120 alerts journal into popups
+ *
+ * The C5 (X7) cluster sits on CAN High Speed, so no notification reaches CAN
+ * Low Speed and popups are rebuilt from the journal. Bits 7-6 of byte 0
+ * select a block; bytes 1-7 carry its alert bits.
+ *
+ * The mapping journal bit → (alert, parameter bit) is a declarative table
+ * per block (alerts_journal.cpp). Each frame is XORed with the previous
+ * frame of the same block and only the bits that changed are visited, so
+ * a repeated journal frame costs one comparison. An alert fed by several
+ * bits (doors, lamps, tyres) is reported to the popup manager (popup.h)
+ * once per frame, with its parameter byte built from the raised bits.
+ * Alerts sharing a popup ID (brakes 106, tyres 13, ...) keep their own
+ * state: the popup stays open while any of them is raised and shows the
+ * most urgent one.
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+// Block selector (bits 7-6 of byte 0)
+#define JOURNAL_BLOCKS 4
+
+/**
+ * @brief Build the bit → alert lookup of every block
+ * Call from setup() before the first 0x120 frame.
+ */
+void journalBegin();
+
+/**
+ * @brief Decode one 0x120 frame and report changed alerts with popupSet()
+ * @param frame Journal frame received on CAN0
+ */
+void journalDecode(const struct can_frame& frame);
+
+/**
+ * @brief Print journal frames, unchanged frames, changed bits and alert updates on Serial
+ */
+void journalPrintStats();
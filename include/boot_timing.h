@@ -0,0 +1,83 @@
+#pragma once
+
+/**
+ * @file boot_timing.h
+ * @brief Boot-to-first-forwarded-frame timing
+ *
+ * After a key-on wake the NAC shows "no communication" until the adapter
+ * forwards car frames again, so the time from reset to the first forwarded
+ * frame is tracked with the milestones leading to it, in millis() since
+ * start:
+ *
+ * - CAN0 up / CAN1 up: controller in normal mode (can_bus.cpp)
+ * - setup done: loop() starts consuming frames
+ * - first RX: first received frame handled by a gateway path
+ * - first forward: first received frame that made the gateway send a frame
+ *   on the other bus (forwarded or converted)
+ *
+ * The first forward is printed once on Serial (debug output), or written as
+ * a CAPTURE_BOOT_ID record in the binary capture (see capture.h), and the
+ * milestones are part of the "stats" console command.
+ *
+ * BOOT_TIMING_SCOPE(bus, frame) at the top of processCANxFrame() detects the
+ * first forward; once it is seen, the scope costs one flag test.
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+// Boot milestones
+enum BootStage : byte {
+  BOOT_CAN0_UP = 0,
+  BOOT_CAN1_UP = 1,
+  BOOT_SETUP_DONE = 2,
+  BOOT_FIRST_RX = 3,
+  BOOT_FIRST_FORWARD = 4,
+  BOOT_STAGES = 5
+};
+
+// Set until the first forwarded frame is seen
+extern volatile bool bootForwardPending;
+
+/**
+ * @brief Record a milestone (only its first occurrence is kept)
+ */
+void bootTimingMark(BootStage stage);
+
+/**
+ * @brief millis() of a milestone, 0 if not reached yet
+ */
+unsigned long bootTimingAt(BootStage stage);
+
+/**
+ * @brief Start of the handling of a received frame while the first forward is pending
+ * @param bus Bus the frame was received on
+ * @return TX count of the other bus, compared by bootTimingLeave()
+ */
+unsigned long bootTimingEnter(byte bus);
+
+/**
+ * @brief End of the handling of a received frame while the first forward is pending
+ * @param bus Bus the frame was received on
+ * @param id Received CAN ID
+ * @param txBefore Value returned by bootTimingEnter()
+ */
+void bootTimingLeave(byte bus, canid_t id, unsigned long txBefore);
+
+/**
+ * @brief Print the boot milestones on Serial
+ */
+void bootTimingPrint();
+
+struct BootTimingScope {
+  BootTimingScope(byte bus, canid_t id) : bus(bus), id(id), txBefore(0) {
+    if (bootForwardPending) txBefore = bootTimingEnter(bus);
+  }
+  ~BootTimingScope() {
+    if (bootForwardPending) bootTimingLeave(bus, id, txBefore);
+  }
+  byte bus;
+  canid_t id;
+  unsigned long txBefore;
+};
+#define BOOT_TIMING_SCOPE(bus, frame) BootTimingScope bootTimingScope(bus, (frame).can_id)
@@ -0,0 +1,95 @@
+#pragma once
+
+/**
+ * @file buttons.h
+ * @brief Table-driven button state machine (debounce, long press, accelerating repeat)
+ *
+ * A button group is a set of raw inputs (one bit each: analog button pins,
+ * steering wheel bits of 0xA2) and a table of actions. The owner samples
+ * the inputs and calls buttonsUpdate() with one timestamp per tick; the
+ * engine debounces the inputs, picks the action of the accepted combination
+ * and calls its handler:
+ *
+ * - BUTTON_PRESS    once the combination has been stable for the debounce time
+ * - BUTTON_REPEAT   repeatDelayMs after the press, then every repeatMs, every
+ *                   fastRepeatMs once held for fastAfterMs (accelerating repeat)
+ * - BUTTON_LONG     once, when held for longPressMs
+ * - BUTTON_RELEASE  when the combination ends or another action takes over
+ *
+ * An action matches when (inputs & mask) == code; the first matching row
+ * wins, so rows are listed by priority (an exact chord such as VOL- + VOL+
+ * uses a full mask, a steering wheel button only its own bit). A tick with
+ * unchanged inputs is a few compares; a change walks the table once.
+ *
+ * Each action counts its presses, repeats and long presses and measures the
+ * press-to-frame latency: from the tick that first saw the inputs change to
+ * the return of the PRESS handler, which queues the frame (debounce
+ * included). Console: "buttons", "buttons reset".
+ */
+
+#include <Arduino.h>
+
+enum ButtonEvent : uint8_t {
+  BUTTON_PRESS,
+  BUTTON_REPEAT,
+  BUTTON_LONG,
+  BUTTON_RELEASE
+};
+
+struct ButtonAction;
+
+/**
+ * @brief Called on every event of an action
+ * @param action Table row of the action (name, arg)
+ * @param event What happened
+ */
+typedef void (*ButtonHandler)(const ButtonAction& action, ButtonEvent event);
+
+struct ButtonAction {
+  const char* name;        // Statistics and debug output
+  uint8_t mask;            // Inputs looked at
+  uint8_t code;            // Matches when (inputs & mask) == code
+  ButtonHandler handler;
+  uint8_t arg[3];          // Free for the handler (e.g. frame bytes)
+  uint16_t repeatDelayMs;  // Hold time before the first repeat, 0 = no repeat
+  uint16_t repeatMs;       // Repeat period
+  uint16_t fastAfterMs;    // Hold time from which fastRepeatMs applies, 0 = never
+  uint16_t fastRepeatMs;
+  uint16_t longPressMs;    // Hold time of BUTTON_LONG, 0 = no long press
+};
+
+/**
+ * @brief Declare a button group
+ * @param name Shown by the statistics
+ * @param actions Action table, by priority (must stay valid, usually static const)
+ * @param count Number of actions (at most BUTTON_MAX_ACTIONS)
+ * @param debounceMs Time the inputs must be stable before they are accepted (0 = on the first tick)
+ * @return Group number for buttonsUpdate(), -1 if BUTTON_MAX_GROUPS groups exist or the table is too long
+ * Call from setup().
+ */
+int8_t buttonsAddGroup(const char* name, const ButtonAction* actions, byte count, uint16_t debounceMs);
+
+/**
+ * @brief Feed one sample of the inputs and run the due events
+ * @param group Group number from buttonsAddGroup()
+ * @param inputs Raw inputs, one bit per button, 1 = pressed
+ * @param nowUs Timestamp of the sample (micros())
+ * Handlers run from this call. A group must always be updated from the same task.
+ */
+void buttonsUpdate(int8_t group, uint8_t inputs, unsigned long nowUs);
+
+/**
+ * @brief Whether an action of the group is pressed (between PRESS and RELEASE)
+ * @param group Group number from buttonsAddGroup()
+ */
+bool buttonsHeld(int8_t group);
+
+/**
+ * @brief Print the counters and press-to-frame latency of every action on Serial
+ */
+void buttonsPrintStats();
+
+/**
+ * @brief Clear the counters and latencies
+ */
+void buttonsResetStats();
@@ -0,0 +1,164 @@
+#pragma once
+
+/**
+ * @file can_bus.h
+ * @brief Interrupt-driven CAN reception and shared controller access
+ *
+ * Both MCP2515 controllers pull their INT line low while a frame waits in
+ * RXB0 or RXB1. A dedicated task wakes on that edge and drains both receive
+ * buffers of each controller into a fixed-size ring per bus, so a burst on one
+ * side cannot overrun the controller while loop() is busy in a long handler.
+ * loop() then consumes the rings in batches with canReceive().
+ *
+ * The drain task and loop() share the SPI bus, so every controller access goes
+ * through this module (canSend() for transmission) under a per-controller lock.
+ *
+ * canSend() does not wait for a free TX buffer: frames are queued per bus in
+ * arbitration ID order and loaded into TXB0-TXB2 as they complete, so several
+ * frames sent in a row from one handler are no longer lost to ERROR_ALLTXBUSY.
+ *
+ * Frame transfers use the MCP2515 quick instructions (mcp2515_spi.h), and the
+ * SPI time they take is counted per frame in both directions.
+ *
+ * canBusBegin() starts both controllers without waiting on either: a
+ * controller that does not enter normal mode at once is retried every
+ * CAN_BRINGUP_RETRY_MS by the RX task, and the gateway forwards on whichever
+ * bus is up meanwhile. Frames sent to a controller that is not up are dropped.
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+// Bus indexes
+#define BUS_CAN0 0   // Vehicle CAN2004 bus
+#define BUS_CAN1 1   // CAN2010 device(s)
+#define BUS_COUNT 2
+
+/**
+ * @brief Reception counters for one bus
+ */
+struct CanRxStats {
+  unsigned long received;     // Frames moved from the controller into the ring
+  unsigned long ringOverruns; // Frames dropped because the ring was full
+  unsigned long hwOverruns;   // RXB0/RXB1 overflows reported by the controller (EFLG RX0OVR/RX1OVR)
+  unsigned int highWater;     // Highest ring occupancy seen
+  unsigned long spiUs;        // Time spent on SPI draining the controller (per frame = spiUs / received)
+};
+
+/**
+ * @brief Transmission counters for one bus
+ */
+struct CanTxStats {
+  unsigned long queued;   // Frames accepted by canSend()
+  unsigned long sent;     // Frames loaded into a TX buffer
+  unsigned long aborted;  // Loaded frames aborted for a lower queued ID and requeued
+  unsigned long drops;    // Frames dropped because the queue was full
+  unsigned long offline;  // Frames dropped because the controller was not up yet
+  unsigned long delayUs;  // Total time spent queued by sent frames (average = delayUs / sent)
+  unsigned int highWater; // Highest queue depth seen
+  unsigned long spiUs;    // Time spent on SPI loading TX buffers (per frame = spiUs / sent)
+};
+
+/**
+ * @brief Error counters and flags of one controller
+ */
+struct CanErrorState {
+  uint8_t tec;   // Transmit error counter
+  uint8_t rec;   // Receive error counter
+  uint8_t eflg;  // EFLG register (MCP2515::EFLG_*)
+};
+
+/**
+ * @brief Start both controllers and interrupt-driven reception
+ * Call early in setup(), never blocks on a controller: one that is not in
+ * normal mode yet is retried in the background (see canBusReady()).
+ * Falls back to polled draining from canBusService() if an INT pin is
+ * not configured or the RX task cannot be created.
+ */
+void canBusBegin();
+
+/**
+ * @brief Drain the controllers and retry their bring-up when running without the RX task
+ * Call once per loop() pass, before consuming frames. No-op in interrupt mode.
+ */
+void canBusService();
+
+/**
+ * @brief Whether a controller is in normal mode
+ * @param bus BUS_CAN0 or BUS_CAN1
+ */
+bool canBusReady(byte bus);
+
+/**
+ * @brief Pop the oldest received frame of a bus
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param frame Destination frame
+ * @return true if a frame was available
+ */
+bool canReceive(byte bus, struct can_frame* frame);
+
+/**
+ * @brief Wake a task whenever frames of a bus are received
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param task Task notified with xTaskNotifyGive() (NULL to disable)
+ * Only effective in interrupt mode; in polled mode the consumer must poll.
+ */
+void canSetConsumer(byte bus, void* task);
+
+/**
+ * @brief Called when a controller enters normal mode
+ * @param bus BUS_CAN0 or BUS_CAN1
+ */
+typedef void (*CanBusUpHandler)(byte bus);
+
+/**
+ * @brief Run a handler each time a controller enters normal mode
+ * @param handler Handler (NULL to disable)
+ * Called at boot, when a late controller comes up and after canBusRecover(),
+ * from the task that brought it up, without the bus lock (canSend() is allowed).
+ * Set before canBusBegin() so the first bring-up is not missed.
+ */
+void canSetBusUpHandler(CanBusUpHandler handler);
+
+/**
+ * @brief Queue a frame for transmission on a bus
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param frame Frame to send (copied)
+ * @return ERROR_OK if queued, ERROR_ALLTXBUSY if the queue was full and the frame
+ *         had the lowest priority (otherwise the lowest-priority queued frame is dropped),
+ *         ERROR_FAILINIT if the controller is not up yet
+ */
+MCP2515::ERROR canSend(byte bus, const struct can_frame* frame);
+
+/**
+ * @brief Read TEC, REC and EFLG of a controller
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param state Destination
+ */
+void canReadErrorState(byte bus, CanErrorState* state);
+
+/**
+ * @brief Re-initialize a controller (reset, bitrate, normal mode)
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @return true if the controller is back in normal mode
+ * Clears TEC/REC; frames loaded in the TX buffers are lost, queued frames are kept.
+ * A controller left out of normal mode is retried like at boot.
+ */
+bool canBusRecover(byte bus);
+
+/**
+ * @brief Reception counters of a bus
+ * @param bus BUS_CAN0 or BUS_CAN1
+ */
+const CanRxStats& canRxStats(byte bus);
+
+/**
+ * @brief Transmission counters of a bus
+ * @param bus BUS_CAN0 or BUS_CAN1
+ */
+const CanTxStats& canTxStats(byte bus);
+
+/**
+ * @brief Print reception and transmission counters of both buses on Serial
+ */
+void canBusPrintStats();
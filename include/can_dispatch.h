@@ -0,0 +1,42 @@
+#pragma once
+
+/**
+ * @file can_dispatch.h
+ * @brief CAN-ID dispatch tables (one per bus)
+ *
+ * Each bus has a 2048-entry index over the 11-bit ID space pointing to the
+ * handler registered for that ID, so finding the handler of a frame costs one
+ * array access whatever the number of handled IDs. Handlers are registered
+ * once at boot: feature flags are checked at registration time and the
+ * accepted lengths are stored as a DLC bitmask. IDs without a handler, or with
+ * an unexpected length, return NULL and take the pass-through path.
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+// Accepted frame lengths (bit n set = DLC n accepted)
+#define DLC_ANY 0xFFFF
+#define DLC_EQ(n) ((uint16_t)(1u << (n)))             // Exactly n bytes
+#define DLC_BELOW(n) ((uint16_t)((1u << (n)) - 1))    // Less than n bytes
+#define DLC_FROM(n) ((uint16_t)(0xFFFFu << (n)))      // n bytes or more
+
+typedef void (*CanFrameHandler)();
+
+/**
+ * @brief Register the handler of a standard CAN ID
+ * @param bus BUS_CAN0 or BUS_CAN1 (bus the frame is received on)
+ * @param id 11-bit CAN ID
+ * @param dlcMask Accepted lengths (DLC_ANY, DLC_EQ(n), DLC_BELOW(n), DLC_FROM(n))
+ * @param handler Function processing the frame
+ * @return false if the ID already has a handler or the table is full (first registration wins)
+ */
+bool canDispatchAdd(byte bus, uint16_t id, uint16_t dlcMask, CanFrameHandler handler);
+
+/**
+ * @brief Handler of a received frame
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param frame Received frame
+ * @return Registered handler, or NULL to forward the frame unchanged
+ */
+CanFrameHandler canDispatchLookup(byte bus, const struct can_frame* frame);
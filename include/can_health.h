@@ -0,0 +1,84 @@
+#pragma once
+
+/**
+ * @file can_health.h
+ * @brief Controller health monitor: error counters, overflows and bus-off recovery
+ *
+ * A low-priority task samples TEC, REC and EFLG of both MCP2515 every
+ * CAN_HEALTH_POLL_MS and keeps, per controller, the error state and the
+ * count and time (millis()) of the last event of each kind:
+ *
+ * - overflow: frame lost in RXB0/RXB1 (EFLG RX0OVR/RX1OVR, counted by the drain)
+ * - error-passive: TEC or REC reached 128
+ * - bus-off: TEC reached 256, the controller stopped transmitting
+ * - recovery: controller re-initialized by the monitor
+ *
+ * The MCP2515 leaves bus-off by itself after 128 x 11 recessive bits. If it
+ * is still bus-off CAN_HEALTH_BACKOFF_MIN_MS later, the monitor
+ * re-initializes it (canBusRecover()). Every attempt doubles the delay
+ * before the next one, up to CAN_HEALTH_BACKOFF_MAX_MS, so a shorted or
+ * unterminated bus is not hammered with resets; the delay returns to the
+ * minimum once the controller has stayed out of bus-off for
+ * CAN_HEALTH_STABLE_MS.
+ *
+ * While binary capture is active, a health record (CAPTURE_HEALTH_ID, see
+ * capture.h) is written on every event and every CAN_HEALTH_CAPTURE_MS.
+ */
+
+#include <Arduino.h>
+#include <can_bus.h>
+
+// Error state, from EFLG
+enum CanHealthState : byte {
+  HEALTH_ERROR_ACTIVE = 0,
+  HEALTH_ERROR_WARNING = 1,  // TEC or REC >= 96
+  HEALTH_ERROR_PASSIVE = 2,  // TEC or REC >= 128
+  HEALTH_BUS_OFF = 3         // TEC > 255
+};
+
+/**
+ * @brief Occurrences of one kind of event
+ */
+struct CanHealthEvent {
+  unsigned long count;
+  unsigned long lastMs;  // millis() of the last occurrence
+};
+
+/**
+ * @brief Health of one controller
+ */
+struct CanHealthStats {
+  CanHealthState state;
+  CanErrorState errors;   // Last sample
+  uint8_t tecMax;
+  uint8_t recMax;
+  CanHealthEvent overflows;
+  CanHealthEvent errorPassive;
+  CanHealthEvent busOff;
+  CanHealthEvent recoveries;
+  unsigned long backoffMs; // Delay before the next recovery attempt
+};
+
+/**
+ * @brief Start the monitor task
+ * Call from setup() after canBusBegin(). Falls back to sampling from
+ * canHealthService() if the task cannot be created.
+ */
+void canHealthBegin();
+
+/**
+ * @brief Sample the controllers when running without the monitor task
+ * Call once per loop() pass. No-op when the task runs.
+ */
+void canHealthService();
+
+/**
+ * @brief Health of a controller
+ * @param bus BUS_CAN0 or BUS_CAN1
+ */
+const CanHealthStats& canHealthStats(byte bus);
+
+/**
+ * @brief Print the health of both controllers on Serial
+ */
+void canHealthPrintStats();
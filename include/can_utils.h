@@ -23,23 +23,14 @@
 byte checksumm_0E6(const byte* frame);
 
 /**
- * @brief Send or clear a popup notification on CAN2010 device
- * @param present True to show popup, false to clear
- * @param id Alert/notification ID
- * @param priority Priority level (0-14)
- * @param parameters Additional parameters for the notification
+ * @brief Calculate number of days since start of a year
+ * @param year Calendar year (4 digits)
+ * @param month Month (1-12)
+ * @param day Day of month (1-31)
+ * @return Day of year (1 for January 1st)
  */
-void sendPOPup(bool present, int id, byte priority, byte parameters);
-
-/**
- * @brief Calculate number of days since start of current year
- * @return Number of days since January 1st
- */
-int daysSinceYearStartFct();
+int daysSinceYearStartFct(int year, int month, int day);
 
 // External variables needed by these functions
 extern struct can_frame canMsgSnd;
-extern MCP2515 CAN1;
 extern bool SerialEnabled;
-extern int alertsCache[];
-extern byte alertsParametersCache[];
@@ -0,0 +1,84 @@
+#pragma once
+
+/**
+ * @file capture.h
+ * @brief Binary CAN capture stream on Serial (GVRET / SavvyCAN protocol)
+ *
+ * Replaces the ASCII "FRAME:ID=" output of debugCAN0/debugCAN1 when
+ * debugBinaryCapture is set. Each frame is encoded as a GVRET
+ * BUILD_CAN_FRAME record:
+ *
+ *   F1 00 | timestamp (4, µs, LSB first) | ID (4, LSB first, bit 31 = extended)
+ *         | DLC + (bus << 4) | data (DLC bytes) | 00
+ *
+ * Bus 0 = received on CAN0 (car), 1 = received on CAN1 (device),
+ * 2 / 3 = sent by the adapter on CAN0 / CAN1 (debugCaptureTx).
+ *
+ * Controller health (can_health.h) is logged as extended frames with ID
+ * CAPTURE_HEALTH_ID on the bus of the controller, on every event and
+ * every CAN_HEALTH_CAPTURE_MS:
+ *
+ *   state (0 active, 1 warning, 2 passive, 3 bus-off) | TEC | REC | EFLG
+ *   | overflows | error-passive | bus-off | recoveries (counts, saturated at 255)
+ *
+ * The boot timing (boot_timing.h) is logged once, when the first frame is
+ * forwarded, as an extended frame with ID CAPTURE_BOOT_ID on the bus it was
+ * received on (times in ms since start, little endian, saturated at 65535):
+ *
+ *   first forward | CAN0 up | CAN1 up | setup done   (2 bytes each)
+ *
+ * A flight recorder dump (flight_recorder.h) uses the same frame records,
+ * stamped with the time each frame was recorded, and starts with an
+ * extended frame with ID CAPTURE_RECORDER_ID stamped with the trigger time:
+ *
+ *   cause | bus (0xFF if none) | records dumped (4, LSB first)
+ *
+ * Records go into a byte ring buffer; a low-priority writer task empties it
+ * to Serial in large writes, so a slow USB-CDC host never stalls forwarding
+ * (when the ring is full, whole records are dropped). The GVRET host
+ * handshake (SavvyCAN "GVRET" connection) is answered by captureService().
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+#define CAPTURE_TX_BUS_OFFSET 2  // GVRET bus of frames sent by the adapter = bus + 2
+#define CAPTURE_HEALTH_ID (0x1FFFFF00UL | CAN_EFF_FLAG)  // Controller health record (not a bus frame)
+#define CAPTURE_BOOT_ID (0x1FFFFF01UL | CAN_EFF_FLAG)    // Boot timing record (not a bus frame)
+#define CAPTURE_RECORDER_ID (0x1FFFFF02UL | CAN_EFF_FLAG) // Flight recorder trigger record (not a bus frame)
+#define CAPTURE_RECORD_MAX (12 + CAN_MAX_DLEN + 1)        // Longest GVRET frame record
+
+/**
+ * @brief Start the writer task (or polled flushing from captureService())
+ */
+void captureBegin();
+
+/**
+ * @brief Whether frames are captured in binary (debugBinaryCapture with debugCAN0 or debugCAN1)
+ */
+bool captureActive();
+
+/**
+ * @brief Queue one frame record, never blocks
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param frame Frame received or sent
+ * @param tx true for a frame sent by the adapter
+ */
+void captureFrame(byte bus, const struct can_frame* frame, bool tx);
+
+/**
+ * @brief Encode one GVRET frame record with a given timestamp
+ * @param record Destination, CAPTURE_RECORD_MAX bytes
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param frame Frame received or sent
+ * @param tx true for a frame sent by the adapter
+ * @param us Timestamp (micros())
+ * @return Record length
+ */
+unsigned int captureEncode(byte* record, byte bus, const struct can_frame* frame, bool tx, unsigned long us);
+
+/**
+ * @brief Answer GVRET host commands and flush when no writer task runs
+ * Call from loop() instead of consoleService() while capture is active.
+ */
+void captureService();
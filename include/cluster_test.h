@@ -3,17 +3,30 @@
 /**
  * @file cluster_test.h
  * @brief Instrument Cluster Test Mode for CAN2010
- * 
+ *
  * This module provides testing functionality for CAN2010 instrument cluster
  * without requiring a connected car or BSI. It simulates CAN2004 messages
  * and sends them to the CAN2010 cluster.
- * 
- * Based on existing cluster test implementation.
+ *
+ * Each simulated BSI frame is a scheduled frame (see scheduler.h) with its
+ * own period, so frame rates do not depend on loop() timing and the
+ * measured send jitter is reported by the scheduler statistics.
+ *
+ * Speed, RPM and fuel follow a scenario: a timeline of keyframes, each held
+ * or linearly ramped to the next one. The timeline is evaluated when a frame
+ * is built (every 50 ms with 0xB6), at CLUSTER_TEST_SAMPLE_MS resolution.
  */
 
 #include <Arduino.h>
 #include <mcp2515.h>
 
+// Scenarios (testScenario)
+// 0-15: fixed gauge levels (0 km/h ... 657 km/h)
+#define CLUSTER_SCENARIO_STEPS 16  // Cycle through levels 0-15, 6 s each
+#define CLUSTER_SCENARIO_SWEEP 17  // Ramp every gauge 0 → max → 0 (needle calibration)
+#define CLUSTER_SCENARIO_CITY 18   // Stop-and-go drive with gear changes
+#define CLUSTER_SCENARIO_COUNT 19
+
 // ============================================================================
 // CONFIGURATION VARIABLES (set in main.cpp)
 // ============================================================================
@@ -21,29 +34,39 @@
 // and defined in cluster_test.cpp
 
 extern bool testClusterMode;              // Enable/disable test mode
-extern unsigned long testClusterCounter;  // Internal counter for timing
-extern int testSpeed;                     // Vehicle speed (km/h)
-extern int testRPM;                       // Engine RPM
-extern int testFuel;                      // Fuel level (0-100%)
+extern int testSpeed;                     // Vehicle speed (km/h), driven by the scenario
+extern int testRPM;                       // Engine RPM, driven by the scenario
+extern int testFuel;                      // Fuel level (0-100%), driven by the scenario
 extern unsigned long testOdometer;        // Odometer (km)
 extern bool testIgnition;                 // Ignition state
-extern byte testScenario;                 // Test scenario (0-15)
-extern bool testAutoIncrement;           // Auto-cycle scenarios
+extern byte testScenario;                 // Test scenario (see CLUSTER_SCENARIO_*)
+extern bool testAutoIncrement;           // Run CLUSTER_SCENARIO_STEPS whatever testScenario
 extern int testOilTemp;                   // Oil temperature
 
+/**
+ * @brief One point of a scenario timeline
+ */
+struct ClusterKeyframe {
+  unsigned int durationMs; // Time until the next keyframe (0 = hold forever)
+  bool ramp;               // true: interpolate to the next keyframe, false: hold the values
+  int speed;               // km/h
+  int rpm;
+  byte fuel;               // %
+};
+
 // ============================================================================
 // FUNCTION DECLARATIONS
 // ============================================================================
 
 /**
  * @brief Initialize cluster test mode
- * Call this in setup() if testClusterMode is enabled
+ * Call this in setup() if testClusterMode is enabled, before schedulerBegin()
  */
 void clusterTestInit();
 
 /**
- * @brief Main cluster test loop
- * Call this in loop() before main CAN processing
+ * @brief Periodic report of the scenario values and send jitter
+ * Call this in loop(); frames are sent by the scheduler
  */
 void clusterTestLoop();
 
@@ -71,12 +94,3 @@ void encodeSpeed(int speed, byte* high, byte* low);
  * @param byte2 Pointer to store third byte (10s and 1s)
  */
 void encodeOdometerBCD(unsigned long odo, byte* byte0, byte* byte1, byte* byte2);
-
-/**
- * @brief Set test values based on scenario (matches original switch cases)
- * @param scenario Scenario number (0-15)
- * @param speed Pointer to store speed value
- * @param rpm Pointer to store RPM value
- * @param fuel Pointer to store fuel level
- */
-void setTestScenario(byte scenario, int* speed, int* rpm, int* fuel);
@@ -20,6 +20,8 @@
 // CAN1: Connected to CAN2010 device like NAC/SMEG (source)
 #define CS_PIN_CAN0 BOARD_CAN1_CS_PIN  // CAN0 chip select pin
 #define CS_PIN_CAN1 BOARD_CAN2_CS_PIN  // CAN1 chip select pin
+#define INT_PIN_CAN0 BOARD_CAN1_INT_PIN  // CAN0 interrupt pin (-1 = polled)
+#define INT_PIN_CAN1 BOARD_CAN2_INT_PIN  // CAN1 interrupt pin (-1 = polled)
 
 // Serial Communication
 #define SERIAL_SPEED 115200  // Baud rate for Serial monitor
@@ -28,3 +30,126 @@
 #define CAN_SPEED CAN_125KBPS  // Entertainment CAN bus speed (125 kbps)
 #define CAN_FREQ MCP_16MHZ     // MCP2515 oscillator frequency (16 MHz)
                               // Change to MCP_8MHZ if using 8 MHz module
+
+// MCP2515 SPI access (see mcp2515_spi.h)
+#define CAN_SPI_CLOCK 10000000  // SPI clock of both controllers in Hz (MCP2515 maximum: 10 MHz)
+#define CAN_SPI_FAST_PATH 1     // 1 = READ RX BUFFER / LOAD TX BUFFER instructions, 0 = generic driver calls
+
+// CAN Reception (see can_bus.h)
+#define CAN_RX_RING_SIZE 64  // Frames buffered per bus between the RX task and loop() (power of two)
+#define CAN_RX_BATCH 16      // Max frames consumed per bus on each loop() pass
+#define CAN_RX_TASK_CORE 0   // Core running the RX drain task (loop() runs on ARDUINO_RUNNING_CORE)
+#define CAN_RX_TASK_PRIORITY 5
+#define CAN_RX_POLL_MS 5     // Safety poll interval in case an INT edge is missed
+#define CAN_BRINGUP_RETRY_MS 100 // Retry period of a controller not yet in normal mode at boot
+
+// CAN Transmission (see can_bus.h)
+#define CAN_TX_QUEUE_SIZE 32 // Frames waiting for a free MCP2515 TX buffer, per bus
+
+// Controller health monitor (see can_health.h)
+#define CAN_HEALTH_POLL_MS 100          // TEC/REC/EFLG sampling period
+#define CAN_HEALTH_BACKOFF_MIN_MS 100   // Bus-off time before the first re-initialization
+#define CAN_HEALTH_BACKOFF_MAX_MS 5000  // Upper bound of the doubling delay between re-initializations
+#define CAN_HEALTH_STABLE_MS 10000      // Out of bus-off for this long: backoff back to the minimum
+#define CAN_HEALTH_CAPTURE_MS 1000      // Health record period in the binary capture
+#define CAN_HEALTH_TASK_CORE 0
+#define CAN_HEALTH_TASK_PRIORITY 1      // Below every CAN task
+
+// Echo suppression (see echo_filter.h)
+#define ECHO_TTL_MS 20        // A frame coming back on the other bus within this time is an echo
+#define ECHO_TABLE_SIZE 64    // Records per bus (power of two)
+
+// Flight recorder (see flight_recorder.h)
+#define FLIGHT_RECORDER_RECORDS 131072     // Records in PSRAM (power of two, 24 bytes each: 3 MiB, ~90 s at 1500 frames/s)
+#define FLIGHT_RECORDER_HEAP_RECORDS 1024  // Records in internal RAM when no PSRAM is found (power of two)
+#define FLIGHT_RECORDER_POST_MS 2000       // Keep recording this long after a trigger, then freeze
+#define FLIGHT_RECORDER_TRIGGERS (FLIGHT_TRIGGER_BUS_OFF | FLIGHT_TRIGGER_TX_DROP)  // Armed at boot
+#define FLIGHT_RECORDER_DUMP_CHUNK 32      // Records encoded per Serial write of a dump
+#define FLIGHT_RECORDER_TASK_CORE 0
+#define FLIGHT_RECORDER_TASK_PRIORITY 1    // Dump writer, below every CAN task
+
+// Drive log (see drive_log.h)
+#define DRIVE_LOG_BLOCK_SIZE 16384      // Bytes per compressed block (power of two, 256 to 32768)
+#define DRIVE_LOG_QUEUE_SIZE 1024       // Frames waiting for the encoder (power of two, ~0.7 s at 1500 frames/s)
+#define DRIVE_LOG_RAM_BLOCKS 128        // Closed blocks held in PSRAM until the buses are quiet (2 MiB, ~9 min at 1000 frames/s)
+#define DRIVE_LOG_HEAP_BLOCKS 2         // Blocks in internal RAM when no PSRAM is found
+#define DRIVE_LOG_WRITE_CHUNK 1024      // Bytes per flash write and pass while the buses are busy (ring over half full)
+#define DRIVE_LOG_FILE_BLOCKS 16        // Blocks per file; the oldest file is deleted when the partition is full
+#define DRIVE_LOG_PARTITION "spiffs"    // LittleFS partition label (default.csv)
+#define DRIVE_LOG_DIR "/log"
+#define DRIVE_LOG_PERIOD_MS 50          // Encoder wake-up period
+#define DRIVE_LOG_DUMP_CHUNK 512        // Bytes per Serial write of "log dump"
+#define DRIVE_LOG_TASK_CORE 0
+#define DRIVE_LOG_TASK_PRIORITY 1       // Encoder and flash writer, below every CAN task
+
+// Dual-core gateway (see gateway.h)
+#define GATEWAY_DEVICE_TASK_CORE 0      // Core running the CAN1 → CAN0 path when dualCoreGateway is enabled
+#define GATEWAY_DEVICE_TASK_PRIORITY 3  // Below the RX task
+#define GATEWAY_DEVICE_IDLE_MS 2        // Max wait for CAN1 frames before applying posted state anyway
+#define GATEWAY_MAILBOX_SIZE 32         // Pending cross-direction state updates per path (power of two)
+#define GATEWAY_PENDING_MAX 8           // Posts kept while a mailbox is full (one per variable)
+
+// Binary capture (see capture.h)
+#define CAPTURE_BUFFER_SIZE 16384  // Bytes buffered between the gateway and Serial (power of two, ~20 bytes per frame)
+#define CAPTURE_FLUSH_MS 2         // Writer task period
+#define CAPTURE_TASK_CORE 0
+#define CAPTURE_TASK_PRIORITY 1    // Below every CAN task
+
+// Settings persistence (see persist.h)
+#define PERSIST_QUIET_MS 2000        // Commit once settings have not changed for this long
+#define PERSIST_MAX_DELAY_MS 30000   // Commit at the latest this long after the first pending change
+#define PERSIST_POLL_MS 250          // Flush task check interval
+#define PERSIST_TASK_CORE 0
+#define PERSIST_TASK_PRIORITY 1      // Below every CAN task
+
+// Time service (see time_service.h)
+#define CLOCK_RTC_SYNC_S 600      // Re-read the RTC module this often
+#define CLOCK_TASK_CORE 0
+#define CLOCK_TASK_PRIORITY 1     // Below every CAN task
+
+// Periodic frame scheduler (see scheduler.h)
+#define SCHEDULER_TICK_MS 5           // Timer wheel resolution
+#define SCHEDULER_WHEEL_SLOTS 64      // Slots per wheel turn (64 x 5 ms = 320 ms)
+#define SCHEDULER_MAX_FRAMES 16       // Max scheduled frames
+#define SCHEDULER_BUS_TIMEOUT_MS 1000 // A bus without received frames for this long is considered asleep
+#define SCHEDULER_TASK_CORE 0
+#define SCHEDULER_TASK_PRIORITY 4     // Above the device path, below the RX task
+
+// Popup notifications (see popup.h)
+#define POPUP_MAX_ID 256           // Alert IDs tracked by the bitsets (multiple of 32)
+#define POPUP_MAX_ACTIVE 8         // Popups shown at once on the device
+#define POPUP_TX_INTERVAL_MS 100   // At most one 0x1A1 frame per interval
+#define POPUP_TX_PHASE_MS 50       // Scheduler phase of 0x1A1
+
+// Translation memo (see translation_memo.h)
+#define TRANSLATION_MEMO_MAX 16    // Memos listed by the statistics
+
+// Instrument cluster test mode (see cluster_test.h)
+#define CLUSTER_TEST_SAMPLE_MS 10     // Scenario time resolution; evaluated when a frame is built (0xB6: every 50 ms)
+#define CLUSTER_TEST_REPORT_MS 5000   // Values and send jitter printed with debugGeneral
+
+// Buttons (see buttons.h)
+#define BUTTON_MAX_GROUPS 4           // Analog buttons, steering wheel
+#define BUTTON_MAX_ACTIONS 8          // Actions per group
+#define BUTTON_DEBOUNCE_MS 100        // Analog buttons: stable time before a press is accepted
+#define BUTTON_REPEAT_DELAY_MS 800    // Held volume/menu button: first repeat
+#define BUTTON_REPEAT_MS 600          // Then one repeat per period
+#define BUTTON_FAST_AFTER_MS 2000     // Held this long: faster repeat
+#define BUTTON_FAST_REPEAT_MS 350
+
+// Gateway latency histograms (see latency.h)
+//#define GATEWAY_LATENCY     // Uncomment to compile in per-ID RX → TX latency histograms (console: latency)
+#define LATENCY_MAX_IDS 48    // Tracked received IDs per direction
+
+// CAN-ID dispatch (see can_dispatch.h)
+#define CAN_DISPATCH_MAX_ROUTES 32  // Max handled IDs per bus
+
+// Gateway rules (see gateway_rules.h)
+#define GATEWAY_RULES_MAX 32          // Compiled rules
+#define GATEWAY_RULES_MAX_MAPS 256    // Byte maps (copy, lut, scale) of all rules, 3 bytes each
+#define GATEWAY_RULES_MAX_TABLES 16   // 256-byte lut / scale tables, identical ones shared
+#define GATEWAY_RULES_TEXT_SIZE 2048  // Bytes of rule text (stored in NVS)
+#define GATEWAY_RULES_LINE_SIZE 240   // Max length of one rule
+
+// Serial console (see console.h)
+#define CONSOLE_LINE_SIZE 256  // Longest command, "rules add" + a rule
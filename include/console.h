@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * @file console.h
+ * @brief Line-based command console on Serial
+ *
+ * Commands (terminated by a newline):
+ * - help:            list commands
+ * - stats:           CAN reception/transmission counters and gateway load
+ * - health:          controller error state and events
+ * - settings, set <name> <value>, save, defaults: feature flags (settings.h)
+ * - recorder ...:    flight recorder status, freeze, resume, dump, triggers (flight_recorder.h)
+ * - log ...:         drive log status, list, dump, flush, erase (drive_log.h)
+ * - rules ...:       frame rewrite rules list, add, del, save, defaults (gateway_rules.h)
+ * - buttons [reset]: button presses and press-to-frame latency (buttons.h)
+ * - latency:         latency histograms (GATEWAY_LATENCY builds)
+ * - latency reset:   clear the histograms
+ * - latency on|off:  start/stop recording
+ */
+
+#include <Arduino.h>
+
+/**
+ * @brief Read pending Serial input and run complete commands
+ * Call from loop(); never blocks.
+ */
+void consoleService();
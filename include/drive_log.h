@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ * @file drive_log.h
+ * @brief Compressed log of both buses on a LittleFS partition
+ *
+ * With the driveLog setting, every frame read from a controller and every
+ * frame loaded into a TX buffer is queued (one spinlock-protected copy, as
+ * the binary capture) for a low-priority task that encodes it into fixed
+ * DRIVE_LOG_BLOCK_SIZE blocks (log_codec.h: delta timestamps, per-block ID
+ * dictionary, only the bytes changed since the last frame of the same ID)
+ * and appends full blocks to /log/NNNNN.clg on the DRIVE_LOG_PARTITION
+ * LittleFS partition. A file holds DRIVE_LOG_FILE_BLOCKS blocks; when the
+ * partition is full the oldest file is deleted, so the log always covers
+ * the last drives.
+ *
+ * A flash write stalls both cores (cache disabled), so full blocks are kept
+ * in a ring of DRIVE_LOG_RAM_BLOCKS in PSRAM and written once both buses
+ * are quiet or at ignition off, with the partial block. While the buses are
+ * busy and the ring is over half full, DRIVE_LOG_WRITE_CHUNK bytes are
+ * written per pass; the statistics show the longest write and the
+ * controller overruns that followed writes.
+ *
+ * The partition is mounted by the task, so setup() never waits on flash.
+ * Frames arriving while the queue is full are counted and skipped.
+ *
+ * Console: "log" (status), "log list", "log dump <n>" (raw file on Serial,
+ * decoded on a PC by native/tools/log_decode.cpp into candump format),
+ * "log flush" (write the RAM blocks and the partial block), "log erase".
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+extern volatile bool driveLogActive;
+
+/**
+ * @brief Start the log task when the driveLog setting is enabled
+ * Call from setup(), before canBusBegin().
+ */
+void driveLogBegin();
+
+/**
+ * @brief Queue a frame for the encoder (RX task and TX pump)
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param frame Frame read from or loaded into the controller
+ * @param tx true for a frame sent by the adapter
+ * @param us micros() when read or loaded
+ */
+void driveLogFrame(byte bus, const struct can_frame* frame, bool tx, unsigned long us);
+
+static inline void driveLog(byte bus, const struct can_frame* frame, bool tx, unsigned long us) {
+  if (driveLogActive) {
+    driveLogFrame(bus, frame, tx, us);
+  }
+}
+
+/**
+ * @brief Write the blocks held in RAM and the partial block at the next task pass (ignition off, console)
+ */
+void driveLogFlush();
+
+/**
+ * @brief Write a log file on Serial, raw, from the log task
+ * @param number File number (see driveLogList())
+ * @return false if the log is not running, the file does not exist or a dump is running
+ */
+bool driveLogDump(unsigned long number);
+
+/**
+ * @brief Delete every log file at the next task pass
+ */
+void driveLogErase();
+
+/**
+ * @brief Print the log files and their size on Serial
+ */
+void driveLogList();
+
+/**
+ * @brief Encode, write and dump when running without the log task
+ * Call once per loop() pass. No-op when the task runs.
+ */
+void driveLogService();
+
+/**
+ * @brief Print state, frames logged, compression and partition use on Serial
+ */
+void driveLogPrintStats();
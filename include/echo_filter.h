@@ -0,0 +1,44 @@
+#pragma once
+
+/**
+ * @file echo_filter.h
+ * @brief Suppression of frames the adapter emitted coming back on the other bus
+ *
+ * When something else bridges the two networks (a second gateway, a
+ * diagnostic tool, Send_CAN2010_ForgedMessages writing CAN2010 frames onto
+ * the car bus), a frame the adapter sent on one bus can come back on the
+ * other one and be converted and sent again, until both buses saturate.
+ *
+ * canSend() records every frame the adapter generates or converts: ID and
+ * payload hash, per destination bus, for ECHO_TTL_MS. A frame received on
+ * the other bus that matches a live record is an echo and is dropped before
+ * dispatch (each record absorbs one echo).
+ *
+ * Frames forwarded unchanged are not recorded: they are identical to the
+ * next periodic frame of their source, which must not be dropped. The fixed
+ * drops of converted IDs (0x15B on CAN0, 0x260/0x361 on CAN1) stay in the
+ * dispatch table.
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+/**
+ * @brief Record a frame sent by the adapter (called by canSend())
+ * @param bus Bus the frame is sent on
+ * @param frame Frame sent
+ */
+void echoRecord(byte bus, const struct can_frame* frame);
+
+/**
+ * @brief Check a received frame against the frames sent on the other bus
+ * @param bus Bus the frame was received on
+ * @param frame Received frame, also remembered to recognize unchanged forwards
+ * @return true if the frame is an echo and must be dropped
+ */
+bool echoSuppress(byte bus, const struct can_frame* frame);
+
+/**
+ * @brief Print recorded frames, suppressed echoes and table evictions on Serial
+ */
+void echoPrintStats();
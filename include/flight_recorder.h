@@ -0,0 +1,120 @@
+#pragma once
+
+/**
+ * @file flight_recorder.h
+ * @brief Rolling record of both buses in PSRAM, frozen by a trigger
+ *
+ * Every frame read from a controller (RX task) and loaded into a TX buffer
+ * (TX pump) is appended to a ring of FLIGHT_RECORDER_RECORDS fixed-size
+ * records in PSRAM: micros() timestamp, bus, direction, ID, DLC and data.
+ * Writers reserve a record with one atomic increment and never wait, so the
+ * RX task and the TX pumps of both buses record concurrently; recording is
+ * a reservation plus a 24-byte copy per frame, with no lock on the
+ * forwarding path. Without PSRAM a small ring of FLIGHT_RECORDER_HEAP_RECORDS
+ * is allocated in internal RAM.
+ *
+ * Triggers (bits of FlightTrigger, armed at boot by FLIGHT_RECORDER_TRIGGERS):
+ * - MATCH: a recorded frame with a given ID whose data matches a nibble pattern
+ * - BUS_OFF: a controller went bus-off (can_health.cpp)
+ * - TX_DROP: a frame was dropped because a TX queue was full (can_bus.cpp)
+ * - MANUAL: console "recorder freeze"
+ *
+ * After a trigger the recorder keeps recording for FLIGHT_RECORDER_POST_MS,
+ * then freezes: the ring then holds the minutes before the glitch. "recorder
+ * dump" writes the frozen ring on Serial as GVRET frame records (capture.h),
+ * oldest first, from a low-priority task; "recorder resume" clears it and
+ * re-arms the triggers.
+ *
+ * Console: "recorder" (status), "recorder freeze", "recorder resume",
+ * "recorder dump", "recorder match <id> [pattern]" (pattern: hex nibbles
+ * of the data bytes, x = any, e.g. "xx3F" for data[1] = 0x3F),
+ * "recorder match off", "recorder busoff|txdrop on|off".
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+#include <atomic>
+
+// Trigger causes (also a bitmask of armed triggers)
+enum FlightTrigger : byte {
+  FLIGHT_TRIGGER_MANUAL = 0x01,
+  FLIGHT_TRIGGER_MATCH = 0x02,
+  FLIGHT_TRIGGER_BUS_OFF = 0x04,
+  FLIGHT_TRIGGER_TX_DROP = 0x08
+};
+
+// Recorder state
+enum FlightState : byte {
+  FLIGHT_RECORDING = 0,
+  FLIGHT_TRIGGERED = 1,  // Recording the post-trigger window
+  FLIGHT_FROZEN = 2,
+  FLIGHT_DUMPING = 3
+};
+
+extern std::atomic<byte> flightState;
+
+/**
+ * @brief Allocate the ring (PSRAM if available) and arm the default triggers
+ * Call from setup() before canBusBegin().
+ */
+void flightRecorderBegin();
+
+/**
+ * @brief Append a frame (RX task and TX pump)
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param frame Frame read from or loaded into the controller
+ * @param tx true for a frame sent by the adapter
+ * @param us micros() when read or loaded
+ */
+void flightRecordFrame(byte bus, const struct can_frame* frame, bool tx, unsigned long us);
+
+static inline void flightRecord(byte bus, const struct can_frame* frame, bool tx, unsigned long us) {
+  if (flightState.load(std::memory_order_relaxed) <= FLIGHT_TRIGGERED) {
+    flightRecordFrame(bus, frame, tx, us);
+  }
+}
+
+/**
+ * @brief Report an event; freezes the recorder if its trigger is armed
+ * @param cause Trigger cause
+ * @param bus Bus concerned, 0xFF if none
+ * Never blocks, callable with a bus lock held.
+ */
+void flightRecorderTrigger(FlightTrigger cause, byte bus);
+
+/**
+ * @brief Arm or disarm triggers
+ * @param triggers FlightTrigger bits
+ * @param enable true to arm
+ */
+void flightRecorderArm(byte triggers, bool enable);
+
+/**
+ * @brief Arm the ID / data pattern trigger
+ * @param id CAN ID (with CAN_EFF_FLAG for an extended ID)
+ * @param mask Data bits compared (8 bytes)
+ * @param value Expected data bits (8 bytes)
+ */
+void flightRecorderSetMatch(canid_t id, const uint8_t* mask, const uint8_t* value);
+
+/**
+ * @brief Clear the ring and start recording again
+ */
+void flightRecorderResume();
+
+/**
+ * @brief Freeze if needed, then write the ring on Serial as GVRET records
+ * @return false if no ring is allocated or a dump is already running
+ */
+bool flightRecorderDump();
+
+/**
+ * @brief Report a freeze on Serial and dump when running without the dump task
+ * Call once per loop() pass.
+ */
+void flightRecorderService();
+
+/**
+ * @brief Print state, recorded span, triggers and last trigger on Serial
+ */
+void flightRecorderPrintStats();
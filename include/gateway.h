@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * @file gateway.h
+ * @brief Dual-core gateway: one task per direction and cross-direction state
+ *
+ * The adapter has two processing paths:
+ * - PATH_CAR:    frames from the car (CAN0 → CAN1), processCAN0Frame()
+ * - PATH_DEVICE: frames from the CAN2010 device(s) (CAN1 → CAN0), processCAN1Frame()
+ *
+ * With dualCoreGateway disabled both paths run one after the other in loop().
+ * When enabled, the device path runs in its own task pinned to
+ * GATEWAY_DEVICE_TASK_CORE while loop() keeps the car path on
+ * ARDUINO_RUNNING_CORE, so a slow CAN1 handler can never hold up
+ * the BSI → NAC direction.
+ *
+ * State written by one path and read by the other is not written directly:
+ * the writer posts the new value with gatewayPost() into a lock-free SPSC
+ * mailbox, and the reading path applies it with gatewayApply() before its
+ * next batch. Posting never blocks. Single-byte flags with one writer (Ignition, EngineRunning) are
+ * read directly.
+ */
+
+#include <Arduino.h>
+
+// Processing paths
+#define PATH_CAR 0     // CAN0 → CAN1 (runs in loop())
+#define PATH_DEVICE 1  // CAN1 → CAN0 (own task in dual-core mode)
+#define PATH_COUNT 2
+
+/**
+ * @brief Start the device path task if dualCoreGateway is enabled
+ * @param deviceBatch Function consuming one batch of CAN1 frames
+ * Falls back to running the device path from loop() if the task cannot be created.
+ */
+void gatewayBegin(void (*deviceBatch)());
+
+/**
+ * @brief Whether the device path runs in its own task
+ */
+bool gatewayDualCore();
+
+/**
+ * @brief Publish a value owned by the other path
+ * @param path Path owning (reading) the value: PATH_CAR or PATH_DEVICE
+ * @param dst Variable to update
+ * @param value New value
+ * @param len Size in bytes (max 8)
+ * In single-loop mode the value is written immediately. Never waits: with
+ * the mailbox full the value is kept and posted later (a newer value of the
+ * same variable replaces it). Post on change, not on every frame.
+ */
+void gatewayPost(byte path, void* dst, const void* value, byte len);
+
+/**
+ * @brief Apply values posted to a path
+ * Call from the owning path before processing a batch of frames.
+ */
+void gatewayApply(byte path);
+
+/**
+ * @brief Account time spent processing frames
+ * @param path PATH_CAR or PATH_DEVICE
+ * @param us Microseconds spent
+ */
+void gatewayAddBusy(byte path, unsigned long us);
+
+/**
+ * @brief Print per-path CPU utilisation since the previous call on Serial
+ */
+void gatewayPrintStats();
@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+ * @file gateway_rules.h
+ * @brief Frame rewrite rules loaded from NVS and compiled at boot
+ *
+ * Simple byte rewrites are written as text rules instead of C++ handlers, so
+ * a new car variant only needs a console session, not a reflash. One rule per
+ * line:
+ *
+ *   can1 1E5 dlc=7: lut 6 5 00=40 08=44 *=40, scale 2 2 1/4+49, set 3 3F
+ *
+ * Match part (before ':'), all conditions must hold:
+ * - can0|can1      bus the frame is received on
+ * - ID             11-bit ID, hexadecimal
+ * - dlc=N, dlc<N, dlc>=N   accepted lengths (any length without it)
+ * - bN&MM=VV, bN=VV        received byte N masked with MM (FF without it) equals VV
+ *
+ * Actions (after ':', separated by ','), on a copy of the received frame.
+ * Sources always read the received bytes, so actions never see each other's
+ * output; when two actions write the same byte the last one wins:
+ * - id HHH          output ID
+ * - len N           output length, new bytes are zero
+ * - set D VV        byte D = VV
+ * - copy D S        byte D = received byte S
+ * - scale D S M/Q+O byte D = received byte S * M / Q + O, clamped to 0-255 (M, Q, O decimal; "/Q" and "+O" optional)
+ * - lut D S K=V ... [*=V]   byte D = V for received byte S = K; other values: *=V, else copied
+ * - sum D e6        byte D = 0xE6 checksum/counter of output bytes 0-6 (checksumm_0E6()), computed last
+ * - send can0|can1  send the output frame to that bus (both may be given)
+ * - drop            send nothing
+ * Without send or drop the output frame goes to the other bus.
+ * IDs, masks and byte values are hexadecimal; byte numbers, lengths and
+ * scale factors decimal.
+ *
+ * At boot each rule is compiled to a few 64-bit masks and a short list of
+ * byte maps: byte conditions are one masked compare, kept, constant and
+ * zero-filled bytes one AND/OR, and every copy, lut and scale one lookup in
+ * a 256-byte table (identical tables are shared). Each ID gets one
+ * dispatcher route (can_dispatch.h) registered before the C++ handlers, so a
+ * rule takes an ID over from a built-in handler. Several rules may share an
+ * ID: the first matching rule runs, frames matching none are forwarded
+ * unchanged.
+ *
+ * Rules are stored as text (Preferences namespace SETTINGS_NAMESPACE, key
+ * GATEWAY_RULES_KEY). Without a saved record the built-in defaults are used
+ * (0xE6 length fix, 0x321 DrumVlado extension, 0x1E5 audio settings).
+ * Console: "rules", "rules add <rule>", "rules del <n>", "rules save",
+ * "rules defaults"; saved rules apply at the next start.
+ */
+
+#include <Arduino.h>
+
+#define GATEWAY_RULES_KEY "rules"
+#define GATEWAY_RULES_VERSION 1  // First byte of the stored record, followed by the rule lines
+
+/**
+ * @brief Load and compile the rules, then register their IDs with the dispatcher
+ * Call from registerFrameHandlers(), before the C++ handlers. Invalid rules
+ * are skipped and reported on Serial.
+ */
+void gatewayRulesBegin();
+
+/**
+ * @brief Append a rule to the edited list (checked, not applied until restart)
+ * @param text Rule text
+ * @param error Set to the reason when the rule is rejected
+ * @return false if the rule does not compile or the list is full
+ */
+bool gatewayRulesAdd(const char* text, const char** error);
+
+/**
+ * @brief Remove a rule from the edited list
+ * @param number Rule number, from 1 (see gatewayRulesPrint())
+ * @return false if there is no such rule
+ */
+bool gatewayRulesDelete(byte number);
+
+/**
+ * @brief Replace the edited list with the built-in rules (not saved)
+ */
+void gatewayRulesDefaults();
+
+/**
+ * @brief Store the edited list in NVS
+ * @return false if NVS could not be written
+ */
+bool gatewayRulesSave();
+
+/**
+ * @brief Print the rules, with the frames handled by each while unedited, on Serial
+ */
+void gatewayRulesPrint();
+
+/**
+ * @brief Print compiled rules, ops, tables and frames handled on Serial
+ */
+void gatewayRulesPrintStats();
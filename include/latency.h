@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * @file latency.h
+ * @brief Per-CAN-ID end-to-end gateway latency histograms
+ *
+ * Compiled in with GATEWAY_LATENCY (config.h). Frames are timestamped with
+ * micros() when the RX task reads them from the controller; every frame sent
+ * while one of them is being handled inherits that timestamp, and the
+ * latency is recorded when the pump loads it into an MCP2515 TX buffer.
+ * Latencies go into log2 microsecond buckets per received ID and direction
+ * (CAN0 → CAN1, CAN1 → CAN0, and forged frames sent back on the same bus).
+ *
+ * Recording is switched on and off at run time (console "latency on|off");
+ * when off, each hook costs one flag test. Without GATEWAY_LATENCY the hooks
+ * compile to nothing.
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h> // Before config.h, which redefines CAN_SPEED
+#include <config.h>
+
+#define LATENCY_BUCKETS 16  // Bucket n: [2^n, 2^(n+1)) us, last bucket open-ended
+
+#ifdef GATEWAY_LATENCY
+
+/**
+ * @brief Received frame a transmission originates from
+ */
+struct LatencyOrigin {
+  unsigned long rxUs;  // micros() when read from the controller
+  uint16_t id;         // Received CAN ID
+  byte bus;            // Bus the frame was received on
+  bool valid;          // false for frames not caused by a received frame (buttons, timers)
+};
+
+extern volatile bool latencyEnabled;
+
+/**
+ * @brief Remember the RX timestamp of the frame just popped by canReceive()
+ */
+void latencyNoteRx(byte bus, uint16_t id, unsigned long rxUs);
+
+/**
+ * @brief Mark the frame of a bus as being handled on the calling core
+ * Use through LATENCY_SCOPE(bus) at the top of processCANxFrame().
+ */
+void latencyEnter(byte bus);
+
+/**
+ * @brief End of the frame handled on the calling core
+ */
+void latencyLeave();
+
+/**
+ * @brief Origin of the frame handled on the calling core (called by canSend())
+ */
+LatencyOrigin latencyCurrent();
+
+/**
+ * @brief Record the latency of a frame loaded into a TX buffer
+ * @param origin Origin captured by canSend()
+ * @param txBus Bus the frame is sent on
+ * @param txUs micros() when loaded
+ * Called with the txBus controller lock held.
+ */
+void latencyRecord(const LatencyOrigin& origin, byte txBus, unsigned long txUs);
+
+/**
+ * @brief Print all non-empty histograms on Serial
+ */
+void latencyPrint();
+
+/**
+ * @brief Clear all histograms
+ */
+void latencyReset();
+
+struct LatencyScope {
+  explicit LatencyScope(byte bus) { if (latencyEnabled) latencyEnter(bus); }
+  ~LatencyScope() { latencyLeave(); }
+};
+
+#define LATENCY_SCOPE(bus) LatencyScope latencyScope(bus)
+
+#else
+
+#define LATENCY_SCOPE(bus)
+
+#endif
@@ -0,0 +1,130 @@
+#pragma once
+
+/**
+ * @file log_codec.h
+ * @brief Compressed drive log block format (encoder and decoder)
+ *
+ * Shared by the firmware (drive_log.cpp) and the host decoder
+ * (native/tools/log_decode.cpp), so it only depends on the C library.
+ *
+ * A log is a sequence of fixed-size blocks. Each block starts with a
+ * LOG_HEADER_SIZE byte header (little endian):
+ *
+ *   magic "CLOG" (4) | version (1) | flags (1) | log2(block size) (1) | 0 (1)
+ *   | used bytes (2) | frames (2) | sequence (4) | epoch seconds (4) | base µs (4)
+ *   | CRC-32 (4, of the used bytes with this field zero)
+ *
+ * followed by the frame records, then zero padding up to the block size.
+ * A block is decoded on its own: the ID dictionary and the last payload of
+ * each ID start empty in every block, so a damaged block only loses its own
+ * frames and decoding can start at any block.
+ *
+ * Frame record (varint = LEB128, 7 bits per byte, least significant first):
+ *
+ *   varint zigzag(µs since the previous frame of the block, or since base µs)
+ *   varint (dictionary index << 1) | DLC changed
+ *   index == entries so far (new entry):
+ *     key (1: bus, bit 1 = sent by the adapter) | varint ID | DLC (1) | data (DLC bytes)
+ *   known entry:
+ *     [DLC (1) if changed] | changed-byte mask (1, bit i = data[i]) | changed bytes
+ *
+ * The ID varint is (11 or 29-bit ID << 2) | extended << 1 | remote. An
+ * entry is one bus, direction and ID; a frame repeating the last payload of
+ * its entry typically costs 3 to 5 bytes instead of the 16 of a raw record.
+ *
+ * Time of a frame: epoch seconds + (frame µs - base µs) / 1e6, where epoch
+ * seconds is the wall clock when the block was opened (flag LOG_FLAG_EPOCH,
+ * otherwise seconds since start) and base µs the micros() of its first frame.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOG_MAGIC 0x474F4C43UL  // "CLOG"
+#define LOG_VERSION 1
+#define LOG_HEADER_SIZE 28
+#define LOG_RECORD_MAX 24       // Longest frame record
+#define LOG_DICTIONARY_SIZE 256 // Entries per block; a block is closed when full
+#define LOG_FLAG_EPOCH 0x01     // Epoch seconds are wall clock time
+
+// One frame of the log
+struct LoggedFrame {
+  uint32_t us;        // micros() when read from / loaded into the controller
+  uint32_t id;        // can_id, CAN_EFF_FLAG / CAN_RTR_FLAG included
+  uint8_t bus;        // 0 = CAN0, 1 = CAN1
+  uint8_t tx;         // 1 = sent by the adapter
+  uint8_t dlc;
+  uint8_t data[8];
+};
+
+struct LogBlockHeader {
+  uint8_t version;
+  uint8_t flags;
+  uint32_t blockSize;
+  uint16_t used;      // Header and records
+  uint16_t frames;
+  uint32_t sequence;  // Block number, increasing across files
+  uint32_t epoch;
+  uint32_t baseUs;
+  uint32_t crc;
+};
+
+// Dictionary entry: last payload of a bus, direction and ID
+struct LogEntry {
+  uint32_t id;        // ID varint value
+  uint8_t key;        // bus | tx << 1
+  uint8_t dlc;
+  uint8_t data[8];
+};
+
+// Encoder state of the block being filled
+struct LogEncoder {
+  uint8_t* block;
+  uint32_t blockSize;
+  uint32_t used;
+  uint16_t frames;
+  uint32_t prevUs;
+  uint16_t entries;
+  int16_t slots[2 * LOG_DICTIONARY_SIZE];  // Hash of ID and key -> entry, -1 if free
+  LogEntry dictionary[LOG_DICTIONARY_SIZE];
+};
+
+/**
+ * @brief Start a block
+ * @param encoder Encoder state
+ * @param block Buffer of blockSize bytes
+ * @param blockSize Power of two, 256 to 32768
+ * @param sequence Block number
+ * @param epoch Wall clock seconds (or seconds since start)
+ * @param epochValid Whether epoch is wall clock time
+ * @param baseUs micros() of the first frame
+ */
+void logEncoderOpen(LogEncoder* encoder, uint8_t* block, uint32_t blockSize, uint32_t sequence, uint32_t epoch, bool epochValid, uint32_t baseUs);
+
+/**
+ * @brief Append a frame to the block
+ * @return false if the block is full (the frame goes into the next block)
+ */
+bool logEncodeFrame(LogEncoder* encoder, const LoggedFrame* frame);
+
+/**
+ * @brief Write the header counts and pad the block with zeros
+ */
+void logEncoderClose(LogEncoder* encoder);
+
+/**
+ * @brief Parse and check a block header
+ * @param data At least LOG_HEADER_SIZE bytes
+ * @return false if it is not a valid block header
+ */
+bool logParseHeader(const uint8_t* data, LogBlockHeader* header);
+
+typedef void (*LogFrameCallback)(const LogBlockHeader* header, const LoggedFrame* frame, void* context);
+
+/**
+ * @brief Decode the frames of a block
+ * @param block header.blockSize bytes starting with a valid header
+ * @param callback Called for each frame, oldest first
+ * @return Frames decoded, or -1 if the block is damaged (bad CRC or records)
+ */
+int logDecodeBlock(const uint8_t* block, LogFrameCallback callback, void* context);
@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file mcp2515_spi.h
+ * @brief Frame transfers with the MCP2515 quick SPI instructions
+ *
+ * Both controllers share one SPI bus. The generic driver spends four to five
+ * register transactions per received frame (READ STATUS, header, control,
+ * data, CANINTF clear) and three per sent frame (TXBnCTRL check, registers,
+ * TXREQ set). With CAN_SPI_FAST_PATH enabled, a frame costs one transaction:
+ *
+ * - READ RX BUFFER (0x90/0x94) clocks out SIDH..D7 and clears RXnIF when
+ *   chip select is released. One READ STATUS serves both receive buffers.
+ * - LOAD TX BUFFER (0x40/0x42/0x44) writes SIDH..D7 in one burst, followed
+ *   by the one-byte RTS instruction.
+ *
+ * Each transaction is a single SPI.transferBytes()/writeBytes() call: a frame
+ * is at most 14 bytes and fits the SPI FIFO. The native build, and
+ * CAN_SPI_FAST_PATH 0, go through the generic driver instead.
+ *
+ * Only can_bus.cpp calls these functions, with the bus lock held.
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+// Frames returned at most by one mcpReadMessages() call (RXB0 and RXB1)
+#define MCP_RX_BUFFERS 2
+
+/**
+ * @brief READ STATUS: RX0IF/RX1IF on bits 0/1, TXREQ of TXB0/1/2 on bits 2/4/6
+ * @param bus BUS_CAN0 or BUS_CAN1
+ */
+uint8_t mcpReadStatus(byte bus);
+
+/**
+ * @brief Read every frame waiting in RXB0 and RXB1, oldest first
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param frames Destination, MCP_RX_BUFFERS entries
+ * @return Number of frames read (0 when both buffers are empty)
+ */
+byte mcpReadMessages(byte bus, struct can_frame* frames);
+
+/**
+ * @brief Load a frame into a free TX buffer and request its transmission
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param txb TX buffer (0-2), TXREQ must be clear
+ * @param frame Frame to send
+ */
+void mcpLoadTx(byte bus, byte txb, const struct can_frame* frame);
+
+/**
+ * @brief BIT MODIFY on a register the generic driver keeps private
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param reg Register address
+ * @param mask Bits to change
+ * @param data New value of those bits
+ */
+void mcpModifyRegister(byte bus, uint8_t reg, uint8_t mask, uint8_t data);
+
+/**
+ * @brief READ of a register the generic driver keeps private
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param reg Register address
+ * @return Register value
+ */
+uint8_t mcpReadRegister(byte bus, uint8_t reg);
@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * @file persist.h
+ * @brief Write-behind storage of the settings kept in EEPROM
+ *
+ * On ESP32 the EEPROM library only edits a RAM copy; nothing reaches flash
+ * until EEPROM.commit(), which erases and rewrites a flash page and can take
+ * several milliseconds. Handlers must not do that from the frame path.
+ *
+ * Handlers read and write a RAM shadow of the layout below. Every changed
+ * byte is marked dirty, and a low-priority task writes all dirty bytes in a
+ * single commit once no setting has changed for PERSIST_QUIET_MS (or
+ * PERSIST_MAX_DELAY_MS after the first pending change, whichever is first).
+ * Ignition off forces a commit right away so nothing is lost at power down.
+ *
+ * Flash commits are counted per drive (reset at ignition on) to check wear.
+ */
+
+#include <Arduino.h>
+
+// EEPROM layout
+#define PERSIST_LANGUAGE_UNIT 0     // CAN2010 language and unit byte (>= 128)
+#define PERSIST_LANGUAGE_CAN2004 1  // CAN2004 matrix language ID
+#define PERSIST_LANGUAGE 2          // CAN2010 language ID
+#define PERSIST_TEMPERATURE_F 3     // 1 = Fahrenheit
+#define PERSIST_MPG_MI 4            // 1 = mpg / miles
+#define PERSIST_TIME_DAY 5
+#define PERSIST_TIME_MONTH 6
+#define PERSIST_TIME_YEAR 7         // uint16_t, 2 bytes (7-8)
+#define PERSIST_PERSONALIZATION 10  // 7 bytes of personalization settings (0x15B data[1..7])
+#define PERSIST_SIZE 32             // Bytes of EEPROM used
+
+/**
+ * @brief Load the shadow from EEPROM and start the flush task
+ * Call first in setup(), before reading any setting.
+ * Falls back to flushing from persistService() if the task cannot be created.
+ */
+void persistBegin();
+
+/**
+ * @brief Flush pending settings when running without the flush task
+ * Call once per loop() pass. No-op when the task runs.
+ */
+void persistService();
+
+/**
+ * @brief Read one byte of the shadow
+ * @param address Offset in the layout
+ */
+byte persistRead(int address);
+
+/**
+ * @brief Write one byte of the shadow, marks it dirty only if the value changed
+ * @param address Offset in the layout
+ * @param value New value
+ * Safe from both gateway paths; never touches flash.
+ */
+void persistWrite(int address, byte value);
+
+/**
+ * @brief Read a multi-byte value of the shadow
+ */
+template <typename T> T& persistGet(int address, T& value) {
+  byte* bytes = (byte*) & value;
+  for (unsigned int i = 0; i < sizeof(T); i++) {
+    bytes[i] = persistRead(address + i);
+  }
+  return value;
+}
+
+/**
+ * @brief Write a multi-byte value of the shadow
+ */
+template <typename T> void persistPut(int address, const T& value) {
+  const byte* bytes = (const byte*) & value;
+  for (unsigned int i = 0; i < sizeof(T); i++) {
+    persistWrite(address + i, bytes[i]);
+  }
+}
+
+/**
+ * @brief Report ignition changes
+ * @param ignition New ignition state
+ * Ignition on starts a new drive for the commit counter; ignition off
+ * asks the flush task to commit pending settings without waiting.
+ */
+void persistIgnition(bool ignition);
+
+/**
+ * @brief Print commit counters on Serial
+ */
+void persistPrintStats();
@@ -0,0 +1,42 @@
+#pragma once
+
+/**
+ * @file popup.h
+ * @brief Popup notifications (0x1A1) rebuilt from the alerts journal for CAN2010 devices
+ *
+ * sendPOPup() used to scan an 8-entry cache on every call and send 0x1A1
+ * inline, and the 0x120 handler calls it for every journal bit it knows.
+ * The alert state is now kept in bitsets indexed by alert ID: popupSet()
+ * only compares and sets a few bits, and marks the ID pending when its
+ * state changed.
+ *
+ * The 0x1A1 frames are a scheduled frame (see scheduler.h) sent at most once
+ * every POPUP_TX_INTERVAL_MS: closes first, then the most urgent pending
+ * alert while fewer than POPUP_MAX_ACTIVE popups are shown. Active popups
+ * are kept ordered by priority (0 = most urgent).
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+/**
+ * @brief Declare the 0x1A1 frame to the scheduler
+ * Call from setup(), before schedulerBegin().
+ */
+void popupBegin();
+
+/**
+ * @brief Report the state of an alert
+ * @param present True if the alert is active, false to clear it
+ * @param id Alert/notification ID (below POPUP_MAX_ID)
+ * @param priority Priority level (0-14, 0 = most urgent)
+ * @param parameters Additional parameters for the notification
+ * Cheap enough to call for every journal bit: only a change is queued.
+ * A change of parameters or priority closes the popup and shows it again.
+ */
+void popupSet(bool present, int id, byte priority, byte parameters);
+
+/**
+ * @brief Print popup counters and the active popups on Serial
+ */
+void popupPrintStats();
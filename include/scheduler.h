@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * @file scheduler.h
+ * @brief Time-triggered transmission of the frames generated by the adapter
+ *
+ * Frames that exist only because the adapter synthesises them (EMF time
+ * 0x3F6, clock 0x228, CVM 0x268) used to be sent from the handler of some
+ * unrelated received frame, so their rate followed the BSI or the NAC.
+ * They are now declared once with a period and a phase offset, and a
+ * scheduler task sends them on time whatever the RX traffic.
+ *
+ * The scheduler is a timer wheel of SCHEDULER_WHEEL_SLOTS slots of
+ * SCHEDULER_TICK_MS each: every tick only the frames due in the current
+ * slot are visited. Phase offsets put frames in different slots so they
+ * never reach the TX queue in one burst.
+ *
+ * The builder of a frame fills its data just before sending and may skip
+ * the period (e.g. while the source of the data is silent).
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+/**
+ * @brief Fills a scheduled frame before it is sent
+ * @param frame Frame to fill (can_id is already set, data and can_dlc are not)
+ * @return false to skip this period
+ */
+typedef bool (*ScheduledFrameBuilder)(struct can_frame* frame);
+
+/**
+ * @brief Declare a periodic frame
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param id Arbitration ID
+ * @param periodMs Period (rounded to SCHEDULER_TICK_MS)
+ * @param phaseMs Offset of the first send from the scheduler start
+ * @param builder Fills the frame before each send
+ * @return false if SCHEDULER_MAX_FRAMES frames are already declared
+ * Call from setup(), before schedulerBegin().
+ */
+bool schedulerAdd(byte bus, uint16_t id, unsigned int periodMs, unsigned int phaseMs, ScheduledFrameBuilder builder);
+
+/**
+ * @brief Start the scheduler task
+ * Falls back to running the scheduler from schedulerService() if the task cannot be created.
+ */
+void schedulerBegin();
+
+/**
+ * @brief Run due ticks when running without the scheduler task
+ * Call once per loop() pass. No-op when the task runs.
+ */
+void schedulerService();
+
+/**
+ * @brief Send a scheduled frame at the next tick in addition to its period
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * @param id Arbitration ID
+ * Use when the data changed and should not wait for the period (e.g. clock set by the NAC).
+ */
+void schedulerKick(byte bus, uint16_t id);
+
+/**
+ * @brief Whether frames were received on a bus within SCHEDULER_BUS_TIMEOUT_MS
+ * @param bus BUS_CAN0 or BUS_CAN1
+ * Lets builders stay quiet while the bus sleeps.
+ */
+bool schedulerBusAwake(byte bus);
+
+/**
+ * @brief Print period and jitter statistics of every scheduled frame on Serial
+ */
+void schedulerPrintStats();
+
+/**
+ * @brief Clear the period and jitter statistics
+ */
+void schedulerResetStats();
@@ -0,0 +1,100 @@
+#pragma once
+
+/**
+ * @file settings.h
+ * @brief Feature flags in one versioned, CRC-checked record in NVS
+ *
+ * The behaviour switches used to be compile-time globals of main.cpp. They
+ * now live in one Settings struct: the defaults below are compiled in, and
+ * settingsBegin() overlays the record saved in NVS with a single
+ * Preferences read. Handlers read the decoded struct directly
+ * (settings.CVM_Emul, ...), so nothing is parsed on the frame path.
+ *
+ * Record layout (Preferences namespace SETTINGS_NAMESPACE, key SETTINGS_KEY):
+ *
+ *   magic (2) | version (1) | size of Settings (2) | Settings | CRC-32 (4)
+ *
+ * A record with a bad magic or CRC, a version newer than SETTINGS_VERSION
+ * or a size that does not match its version is ignored (defaults are used).
+ * Fields are only ever appended to Settings, bumping SETTINGS_VERSION and
+ * adding the new size to recordSizes (settings.cpp): a record from an older
+ * firmware is migrated by applying it over the defaults, and the fields it
+ * lacks keep their default value.
+ *
+ * From the serial console: "settings" lists every setting, "set <name>
+ * <value>" changes one in RAM, "save" writes the record, "defaults"
+ * restores the compiled-in values. Settings marked "restart" select frame
+ * handlers or hardware at boot and take effect at the next start once saved.
+ */
+
+#include <Arduino.h>
+
+#define SETTINGS_NAMESPACE "psa2010"
+#define SETTINGS_KEY "settings"
+#define SETTINGS_MAGIC 0x5347  // "SG"
+#define SETTINGS_VERSION 2
+
+struct Settings {
+  // Debug (see main.cpp)
+  bool debugGeneral;
+  bool debugCAN0;
+  bool debugCAN1;
+  bool debugBinaryCapture;
+  bool debugCaptureTx;
+  bool dualCoreGateway;
+
+  // Features
+  bool EconomyModeEnabled;
+  bool Send_CAN2010_ForgedMessages;
+  bool kmL;
+  bool fixedBrightness;
+  bool noFMUX;
+  byte steeringWheelCommands_Type;
+  bool listenCAN2004Language;
+  bool CVM_Emul;
+  bool generatePOPups;
+  bool emulateVIN;
+  char vinNumber[18];
+
+  // Analog buttons
+  bool hasAnalogicButtons;
+  byte menuButton;
+  byte volDownButton;
+  byte volUpButton;
+
+  // Logging (version 2)
+  bool driveLog;
+};
+
+extern Settings settings;
+
+/**
+ * @brief Load the saved record over the compiled-in defaults
+ * Call first in setup(), before any setting is read.
+ * @return true if a valid record was found
+ */
+bool settingsBegin();
+
+/**
+ * @brief Change one setting in RAM
+ * @param name Setting name (same as the Settings field)
+ * @param value Value: 0/1 for flags, a number, or the VIN (17 characters)
+ * @return true if the name and value were valid
+ */
+bool settingsSet(const char* name, const char* value);
+
+/**
+ * @brief Write the current settings to NVS
+ * @return true if the record was written
+ */
+bool settingsSave();
+
+/**
+ * @brief Restore the compiled-in defaults in RAM (not saved)
+ */
+void settingsDefaults();
+
+/**
+ * @brief Print every setting, its value and when a change applies, on Serial
+ */
+void settingsPrint();
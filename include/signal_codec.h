@@ -0,0 +1,181 @@
+#pragma once
+
+/**
+ * @file signal_codec.h
+ * @brief Compile-time CAN signal descriptors and frame translations
+ *
+ * A signal is described like a DBC entry: start byte and bit, length, byte
+ * order and scale, all as template parameters. Every mask and shift is a
+ * constant, so reading or writing a signal compiles to a load, a mask and a
+ * shift, instead of one bitRead()/bitWrite() pair per bit.
+ *
+ * A translation is a list of rules applied to a received frame:
+ *
+ *   typedef Translation<
+ *     Copy<Signal<6, 7, 8>, Signal<1, 7, 8>>, // Gearbox report: byte 6 -> byte 1
+ *     Copy<Signal<7, 1>, Signal<2, 5>>,       // One bit
+ *     Const<Signal<4, 3>, 0>                  // Fixed value
+ *   > Example;
+ *   Example::apply(canMsgRcv.data, canMsgSnd.data);
+ *
+ * The source frame is read once and the output bytes are built in locals,
+ * then stored: rules never reload the source because of a possible alias.
+ * Output bits not covered by any rule keep their previous value.
+ *
+ * Written for C++11 (the ESP32 Arduino core default): rule lists are
+ * expanded by recursion rather than fold expressions.
+ */
+
+#include <Arduino.h>
+
+enum SignalByteOrder {
+  SIGNAL_MOTOROLA, // Big endian: MSB at (Byte, Bit), continues to bit 0 then bit 7 of the next byte (PSA frames)
+  SIGNAL_INTEL     // Little endian: LSB at (Byte, Bit), continues to bit 7 then bit 0 of the next byte
+};
+
+/**
+ * @brief Signal descriptor
+ * @tparam Byte Byte of the start bit (0-7)
+ * @tparam Bit Start bit in that byte (7 = MSB): the MSB of a Motorola signal, the LSB of an Intel one
+ * @tparam Length Length in bits (1-32)
+ * @tparam Order SIGNAL_MOTOROLA or SIGNAL_INTEL
+ * @tparam Factor, Offset Scale: physical = raw * Factor + Offset
+ */
+template <byte Byte, byte Bit, byte Length = 1, SignalByteOrder Order = SIGNAL_MOTOROLA, long Factor = 1, long Offset = 0>
+struct Signal {
+  static_assert(Byte < 8 && Bit < 8, "Start bit outside of the frame");
+  static_assert(Length >= 1 && Length <= 32, "Signal length must be 1-32 bits");
+
+  // Bytes spanned and position of the LSB in the last (Motorola) or first (Intel) byte
+  enum : unsigned {
+    MotorolaEnd = Byte * 8 + (7 - Bit) + Length - 1, // MSB-first bit index of the LSB
+    IntelEnd = Byte * 8 + Bit + Length - 1,          // LSB-first bit index of the MSB
+    FirstByte = Byte,
+    LastByte = (Order == SIGNAL_MOTOROLA) ? MotorolaEnd / 8 : IntelEnd / 8,
+    Shift = (Order == SIGNAL_MOTOROLA) ? 7 - MotorolaEnd % 8 : Bit
+  };
+  static_assert(LastByte < 8, "Signal extends past byte 7");
+
+  static constexpr uint32_t mask() {
+    return Length == 32 ? 0xFFFFFFFFUL : (1UL << Length) - 1;
+  }
+
+  /**
+   * @brief Raw value of the signal
+   */
+  static inline uint32_t get(const byte* data) {
+    uint64_t word = 0;
+    if (Order == SIGNAL_MOTOROLA) {
+      for (unsigned i = FirstByte; i <= LastByte; i++) {
+        word = (word << 8) | data[i];
+      }
+    } else {
+      for (unsigned i = LastByte + 1; i-- > FirstByte;) {
+        word = (word << 8) | data[i];
+      }
+    }
+    return (uint32_t) (word >> Shift) & mask();
+  }
+
+  /**
+   * @brief Write a raw value (truncated to Length bits), other bits unchanged
+   */
+  static inline void set(byte* data, uint32_t raw) {
+    uint64_t value = (uint64_t) (raw & mask()) << Shift;
+    uint64_t bits = (uint64_t) mask() << Shift;
+    if (Order == SIGNAL_MOTOROLA) {
+      for (unsigned i = LastByte + 1; i-- > FirstByte;) {
+        data[i] = (data[i] & ~(byte) bits) | (byte) value;
+        value >>= 8;
+        bits >>= 8;
+      }
+    } else {
+      for (unsigned i = FirstByte; i <= LastByte; i++) {
+        data[i] = (data[i] & ~(byte) bits) | (byte) value;
+        value >>= 8;
+        bits >>= 8;
+      }
+    }
+  }
+
+  /**
+   * @brief Physical value (raw * Factor + Offset)
+   */
+  static inline long decode(const byte* data) {
+    return (long) get(data) * Factor + Offset;
+  }
+
+  /**
+   * @brief Write a physical value
+   */
+  static inline void encode(byte* data, long value) {
+    set(data, (uint32_t) ((value - Offset) / Factor));
+  }
+};
+
+// ============================================================================
+// TRANSLATION RULES
+// ============================================================================
+
+/**
+ * @brief Copy the raw value of a source signal to an output signal
+ */
+template <class From, class To>
+struct Copy {
+  static inline void apply(const byte* src, byte* dst) {
+    To::set(dst, From::get(src));
+  }
+};
+
+/**
+ * @brief Copy a source bit inverted
+ */
+template <class From, class To>
+struct Invert {
+  static inline void apply(const byte* src, byte* dst) {
+    To::set(dst, ~From::get(src));
+  }
+};
+
+/**
+ * @brief Write a constant raw value
+ */
+template <class To, uint32_t Value>
+struct Const {
+  static inline void apply(const byte*, byte* dst) {
+    To::set(dst, Value);
+  }
+};
+
+/**
+ * @brief Ordered list of rules, applied from a received frame to an output frame
+ */
+template <class... Rules>
+struct Translation;
+
+template <>
+struct Translation<> {
+  static inline void run(const byte*, byte*) {}
+};
+
+template <class Rule, class... Rules>
+struct Translation<Rule, Rules...> {
+  static inline void run(const byte* src, byte* dst) {
+    Rule::apply(src, dst);
+    Translation<Rules...>::run(src, dst);
+  }
+
+  /**
+   * @brief Apply every rule
+   * @param src Received data (8 bytes)
+   * @param dst Output data (8 bytes), may be the same buffer as src
+   */
+  static inline void apply(const byte* src, byte* dst) {
+    byte in[8];
+    byte out[8];
+    memcpy(in, src, 8);
+    memcpy(out, dst, 8);
+    run(in, out);
+    memcpy(dst, out, 8);
+  }
+};
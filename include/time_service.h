@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file time_service.h
+ * @brief Cached system clock, the RTC module is only accessed by a background task
+ *
+ * TimeLib's now() reads the DS1307/DS3231 over I2C whenever its sync interval
+ * has elapsed, and RTC.set() blocks on the Wire bus, so both used to stall
+ * whichever CAN handler touched the clock (0x221, 0x260, 0x39B).
+ *
+ * The clock is now kept as an epoch value plus the millis() at which it was
+ * valid. Handlers read it with clockNow()/clockRead(), which never touch I2C.
+ * A low-priority task owns the Wire bus: it re-reads the RTC every
+ * CLOCK_RTC_SYNC_S seconds and writes the time set by the NAC (clockSet()).
+ */
+
+#include <Arduino.h>
+#include <TimeLib.h>
+
+/**
+ * @brief Start the RTC task, which reads the RTC first
+ * Call in setup(), after setting the fallback time with clockSet(); setup()
+ * never waits on I2C, the time read from the RTC replaces the fallback.
+ * Falls back to servicing the RTC from clockService() if the task cannot be created.
+ */
+void clockBegin();
+
+/**
+ * @brief Service the RTC when running without the RTC task
+ * Call once per loop() pass. No-op when the task runs.
+ */
+void clockService();
+
+/**
+ * @brief Whether the clock has been set (by the RTC, the NAC or a default)
+ */
+bool clockIsSet();
+
+/**
+ * @brief Current time in seconds since 1970
+ */
+time_t clockNow();
+
+/**
+ * @brief Current time broken down into date and time fields
+ * @param tm Destination (Year is an offset from 1970, see tmYearToCalendar())
+ */
+void clockRead(tmElements_t& tm);
+
+/**
+ * @brief Set the clock
+ * @param year Calendar year (e.g. 2024)
+ * @param month 1-12
+ * @param day 1-31
+ * @param hour 0-23
+ * @param minute 0-59
+ * @param writeRtc Also write the time to the RTC module (done by the RTC task)
+ */
+void clockSet(int year, byte month, byte day, byte hour, byte minute, bool writeRtc);
+
+/**
+ * @brief Print RTC access counters and I2C durations on Serial
+ */
+void clockPrintStats();
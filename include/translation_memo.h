@@ -0,0 +1,83 @@
+#pragma once
+
+/**
+ * @file translation_memo.h
+ * @brief Per-ID memo of the last translation: unchanged input → cached output frame
+ *
+ * Most CAN2004 status frames (0x128, 0x168, 0x361, 0x3A7, 0x1D0) repeat with
+ * the same payload for long stretches. Each translating handler keeps the
+ * last input payload, the state it depends on and the frame it produced.
+ * When both match, the cached frame is sent without running the
+ * translation again.
+ *
+ * Usage in a handler:
+ *
+ *   static TranslationMemo memo_128 = TRANSLATION_MEMO(0x128);
+ *
+ *   const struct can_frame* out = memoLookup(memo_128, canMsgRcv, state);
+ *   if (out == NULL) {
+ *     ... build canMsgSnd ...
+ *     out = memoStore(memo_128, canMsgSnd);
+ *   }
+ *   canSend(BUS_CAN1, out);
+ *
+ * state packs whatever else the output depends on (flags, settings); use 0
+ * when the output only depends on the payload. Side effects of the handler
+ * (globals it sets) must be the same for the same input and state.
+ * A memo is only used from one gateway path.
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+
+struct TranslationMemo {
+  uint16_t id;          // Received ID, for statistics
+  bool valid;
+  bool listed;          // Registered for memoPrintStats()
+  byte inDlc;
+  byte in[8];
+  uint32_t state;
+  struct can_frame out;
+  unsigned long hits;
+  unsigned long misses;
+};
+
+#define TRANSLATION_MEMO(id) {id, false, false, 0, {0}, 0, {}, 0, 0}
+
+/**
+ * @brief Cached output for this input and state, or NULL
+ * @param memo Memo of the handler
+ * @param in Received frame
+ * @param state Other inputs of the translation
+ * On a miss, the input and state are remembered for memoStore().
+ */
+const struct can_frame* memoLookup(TranslationMemo& memo, const struct can_frame& in, uint32_t state);
+
+/**
+ * @brief Cache the frame built after a miss
+ * @param memo Memo of the handler
+ * @param out Output frame
+ * @return The cached copy, to be sent
+ */
+const struct can_frame* memoStore(TranslationMemo& memo, const struct can_frame& out);
+
+/**
+ * @brief Forget the cached output of one handler
+ * Use when a global the translation reads is changed elsewhere.
+ */
+void memoInvalidate(TranslationMemo& memo);
+
+/**
+ * @brief Forget every cached output (e.g. after a settings change not covered by state)
+ */
+void memoInvalidateAll();
+
+/**
+ * @brief Print hits and misses per translated ID on Serial
+ */
+void memoPrintStats();
+
+/**
+ * @brief Clear the hit/miss counters
+ */
+void memoResetStats();
@@ -0,0 +1,11 @@
+#pragma once
+#include <TimeLib.h>
+class DS1307RTC {
+public:
+  static time_t get();
+  static bool set(time_t t);
+  static bool read(tmElements_t& tm);
+  static bool write(tmElements_t& tm);
+  static bool chipPresent() { return true; }
+};
+extern DS1307RTC RTC;
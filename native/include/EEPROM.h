@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+class EEPROMClass {
+public:
+  EEPROMClass() { memset(data, 0xFF, sizeof(data)); } // Erased flash
+  bool begin(size_t size);
+  uint8_t read(int address);
+  void write(int address, uint8_t value);
+  bool commit();
+  template <typename T> T& get(int address, T& t) { memcpy(&t, data + address, sizeof(T)); return t; }
+  template <typename T> const T& put(int address, const T& t) { memcpy(data + address, &t, sizeof(T)); return t; }
+  uint8_t data[4096];
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+// LittleFS on a host directory (created in the working directory), capacity NATIVE_LITTLEFS_SIZE
+#ifndef NATIVE_LITTLEFS_DIR
+#define NATIVE_LITTLEFS_DIR "littlefs"
+#endif
+#ifndef NATIVE_LITTLEFS_SIZE
+#define NATIVE_LITTLEFS_SIZE 1441792UL  // "spiffs" partition of default.csv
+#endif
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+class File {
+public:
+  File() {}
+  File(const std::string& path, const char* mode) : path(path) {
+    if (std::filesystem::is_directory(path)) {
+      entries = std::make_shared<std::vector<std::string>>();
+      for (const auto& entry : std::filesystem::directory_iterator(path)) entries->push_back(entry.path().string());
+      std::sort(entries->begin(), entries->end());
+    } else {
+      FILE* f = fopen(path.c_str(), strcmp(mode, "r") == 0 ? "rb" : (strcmp(mode, "a") == 0 ? "ab" : "wb"));
+      if (f) file = std::shared_ptr<FILE>(f, fclose);
+    }
+    base = path.substr(path.find_last_of('/') + 1);
+  }
+  operator bool() const { return file != nullptr || entries != nullptr; }
+  size_t write(const uint8_t* buf, size_t size) { return file ? fwrite(buf, 1, size, file.get()) : 0; }
+  size_t read(uint8_t* buf, size_t size) { return file ? fread(buf, 1, size, file.get()) : 0; }
+  size_t size() { if (!file) return 0; fflush(file.get()); return std::filesystem::file_size(path); }
+  size_t position() { return file ? ftell(file.get()) : 0; }
+  bool seek(uint32_t pos) { return file && fseek(file.get(), pos, SEEK_SET) == 0; }
+  void flush() { if (file) fflush(file.get()); }
+  void close() { file.reset(); entries.reset(); }
+  const char* name() const { return base.c_str(); }
+  bool isDirectory() const { return entries != nullptr; }
+  File openNextFile() { return entries && next < entries->size() ? File((*entries)[next++], FILE_READ) : File(); }
+private:
+  std::string path, base;
+  std::shared_ptr<FILE> file;
+  std::shared_ptr<std::vector<std::string>> entries;
+  size_t next = 0;
+};
+class LittleFSFS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs") {
+    (void) formatOnFail; (void) basePath; (void) maxOpenFiles; (void) partitionLabel;
+    std::error_code error;
+    std::filesystem::create_directories(NATIVE_LITTLEFS_DIR, error);
+    return !error;
+  }
+  void end() {}
+  File open(const char* path, const char* mode = FILE_READ) {
+    if (strcmp(mode, "r") == 0 && !exists(path)) return File();
+    return File(host(path), mode);
+  }
+  bool exists(const char* path) { return std::filesystem::exists(host(path)); }
+  bool remove(const char* path) { std::error_code error; return std::filesystem::remove(host(path), error); }
+  bool mkdir(const char* path) { std::error_code error; std::filesystem::create_directory(host(path), error); return !error; }
+  size_t totalBytes() { return NATIVE_LITTLEFS_SIZE; }
+  size_t usedBytes() {
+    size_t used = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(NATIVE_LITTLEFS_DIR)) {
+      if (entry.is_regular_file()) used += entry.file_size();
+    }
+    return used;
+  }
+private:
+  static std::string host(const char* path) { return std::string(NATIVE_LITTLEFS_DIR) + path; }
+};
+inline LittleFSFS LittleFS;
@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+// NVS in RAM, shared by every Preferences instance (lost at exit)
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false) { ns = name; ro = readOnly; return true; }
+  void end() {}
+  size_t getBytesLength(const char* key) { auto it = store().find(ns + "/" + key); return it == store().end() ? 0 : it->second.size(); }
+  size_t getBytes(const char* key, void* buf, size_t maxLen) {
+    auto it = store().find(ns + "/" + key);
+    if (it == store().end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+  size_t putBytes(const char* key, const void* value, size_t len) {
+    if (ro) return 0;
+    store()[ns + "/" + key].assign((const uint8_t*) value, (const uint8_t*) value + len);
+    return len;
+  }
+  bool remove(const char* key) { return !ro && store().erase(ns + "/" + key) > 0; }
+private:
+  static std::map<std::string, std::vector<uint8_t>>& store() { static std::map<std::string, std::vector<uint8_t>> s; return s; }
+  std::string ns;
+  bool ro = false;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <Arduino.h>
+#include <ctime>
+typedef enum { timeNotSet, timeNeedsSync, timeSet } timeStatus_t;
+typedef time_t (*getExternalTime)();
+typedef struct { uint8_t Second, Minute, Hour, Wday, Day, Month, Year; } tmElements_t;
+time_t now();
+void setTime(time_t t);
+void setTime(int hr, int min, int sec, int day, int month, int yr);
+timeStatus_t timeStatus();
+void setSyncProvider(getExternalTime getTimeFunction);
+int hour(); int hour(time_t t);
+int minute(); int minute(time_t t);
+int second(); int second(time_t t);
+int day(); int day(time_t t);
+int month(); int month(time_t t);
+int year(); int year(time_t t);
+time_t makeTime(const tmElements_t& tm);
+void breakTime(time_t time, tmElements_t& tm);
+#define CalendarYrToTm(Y) ((Y) - 1970)
+#define tmYearToCalendar(Y) ((Y) + 1970)
@@ -0,0 +1,5 @@
+#pragma once
+#include <freertos/FreeRTOS.h>
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s);
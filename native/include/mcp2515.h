@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * @file mcp2515.h
+ * @brief Mock of the autowp MCP2515 library for the native build
+ *
+ * Same public API as the real driver. Received frames come from a scripted
+ * queue (pushRx) and transmitted frames are captured (sent). TX buffers
+ * complete instantly, so getStatus() never reports a pending TXREQ.
+ */
+
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+typedef uint32_t canid_t;
+#define CAN_EFF_FLAG 0x80000000UL
+#define CAN_RTR_FLAG 0x40000000UL
+#define CAN_ERR_FLAG 0x20000000UL
+#define CAN_SFF_MASK 0x000007FFUL
+#define CAN_EFF_MASK 0x1FFFFFFFUL
+#define CAN_MAX_DLEN 8
+struct can_frame { canid_t can_id; uint8_t can_dlc; uint8_t data[CAN_MAX_DLEN] __attribute__((aligned(8))); };
+enum CAN_CLOCK { MCP_20MHZ, MCP_16MHZ, MCP_8MHZ };
+enum CAN_SPEED { CAN_5KBPS, CAN_10KBPS, CAN_20KBPS, CAN_31K25BPS, CAN_33KBPS, CAN_40KBPS, CAN_50KBPS, CAN_80KBPS, CAN_83K3BPS, CAN_95KBPS, CAN_100KBPS, CAN_125KBPS, CAN_200KBPS, CAN_250KBPS, CAN_500KBPS, CAN_1000KBPS };
+class SPIClass;
+class MCP2515 {
+public:
+  enum ERROR { ERROR_OK = 0, ERROR_FAIL = 1, ERROR_ALLTXBUSY = 2, ERROR_FAILINIT = 3, ERROR_FAILTX = 4, ERROR_NOMSG = 5 };
+  enum RXBn { RXB0 = 0, RXB1 = 1 };
+  enum TXBn { TXB0 = 0, TXB1 = 1, TXB2 = 2 };
+  enum CANINTF : uint8_t { CANINTF_RX0IF = 0x01, CANINTF_RX1IF = 0x02, CANINTF_TX0IF = 0x04, CANINTF_TX1IF = 0x08, CANINTF_TX2IF = 0x10, CANINTF_ERRIF = 0x20, CANINTF_WAKIF = 0x40, CANINTF_MERRF = 0x80 };
+  enum EFLG : uint8_t { EFLG_RX1OVR = (1 << 7), EFLG_RX0OVR = (1 << 6), EFLG_TXBO = (1 << 5), EFLG_TXEP = (1 << 4), EFLG_RXEP = (1 << 3), EFLG_TXWAR = (1 << 2), EFLG_RXWAR = (1 << 1), EFLG_EWARN = (1 << 0) };
+  MCP2515(const uint8_t cs, const uint32_t spiClock = 10000000, SPIClass* spi = nullptr);
+  ERROR reset();
+  ERROR setConfigMode();
+  ERROR setListenOnlyMode();
+  ERROR setSleepMode();
+  ERROR setLoopbackMode();
+  ERROR setNormalMode();
+  ERROR setBitrate(const CAN_SPEED canSpeed, const CAN_CLOCK canClock);
+  ERROR sendMessage(const TXBn txbn, const struct can_frame* frame);
+  ERROR sendMessage(const struct can_frame* frame);
+  ERROR readMessage(const RXBn rxbn, struct can_frame* frame);
+  ERROR readMessage(struct can_frame* frame);
+  bool checkReceive();
+  bool checkError();
+  uint8_t getErrorFlags();
+  void clearRXnOVRFlags();
+  uint8_t getInterrupts();
+  uint8_t getInterruptMask();
+  void clearInterrupts();
+  void clearTXInterrupts();
+  uint8_t getStatus();
+  void clearRXnOVR();
+  void clearMERR();
+  void clearERRIF();
+  uint8_t errorCountRX();
+  uint8_t errorCountTX();
+
+  // Native build only
+  void pushRx(const struct can_frame& frame) { rx.push_back(frame); }
+  size_t rxPending() const { return rx.size(); }
+  const std::vector<struct can_frame>& sent() const { return tx; }
+  void clearSent() { tx.clear(); }
+  void setCaptureTx(bool enabled) { captureTx = enabled; }
+  unsigned long sentCount() const { return txCount; }
+  void setErrorState(uint8_t flags, uint8_t tec, uint8_t rec) { eflg = flags; txErrors = tec; rxErrors = rec; }
+  void failNormalMode(unsigned int attempts) { normalModeFailures = attempts; }
+
+private:
+  std::deque<struct can_frame> rx;
+  std::vector<struct can_frame> tx;
+  bool captureTx = true;
+  unsigned long txCount = 0;
+  uint8_t eflg = 0;
+  uint8_t txErrors = 0;
+  uint8_t rxErrors = 0;
+  unsigned int normalModeFailures = 0;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+/**
+ * @file native.h
+ * @brief Hooks of the native (host) build, not available on the ESP32
+ */
+
+#include <Arduino.h>
+
+extern bool nativeSerialMuted; // Discard Serial output (benchmarks)
+
+/**
+ * @brief Switch millis()/micros() to a virtual clock and set it
+ * @param us New value of micros(); delay() then advances it instead of sleeping
+ */
+void nativeSetMicros(unsigned long us);
+
+// Entry points of src/main.cpp
+void setup();
+void loop();
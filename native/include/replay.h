@@ -0,0 +1,28 @@
+#pragma once
+
+/**
+ * @file replay.h
+ * @brief Log replay through the translation handlers (native build)
+ *
+ * Reads a candump (-L "(ts) can0 123#1122" or -ta "(ts) can0 123 [2] 11 22")
+ * or Vector ASC log, feeds each frame to the mock controller of its bus at
+ * its log timestamp on the virtual clock, runs loop(), and writes every frame
+ * the adapter transmits as a candump -L log (can0 = sent to the car,
+ * can1 = sent to the device), timestamped on the input time base.
+ */
+
+#include <Arduino.h>
+
+struct ReplayOptions {
+  const char* input;        // Log to replay
+  const char* output;       // Translated log (NULL = none)
+  const char* carIface;     // Interface/channel of the car side (CAN0), NULL = "can0" or ASC channel "1"
+  const char* deviceIface;  // Interface/channel of the device side (CAN1), NULL = "can1" or ASC channel "2"
+  bool realtime;            // Honour the original timing instead of running as fast as possible
+};
+
+/**
+ * @brief Replay a log, print a throughput summary on stdout
+ * @return 0 on success, 1 if a file cannot be opened
+ */
+int replayLog(const ReplayOptions& options);
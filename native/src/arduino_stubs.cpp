@@ -0,0 +1,119 @@
+/*
+ * @file arduino_stubs.cpp
+ * @brief Arduino core, EEPROM, SPI/Wire and FreeRTOS stubs for the native build
+ *
+ * Time comes from the host monotonic clock, or from a virtual clock driven by
+ * the caller (log replay) once nativeSetMicros() is used. FreeRTOS tasks are never created
+ * (xTaskCreatePinnedToCore fails), so every module runs its single-loop or
+ * polled fallback from loop().
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <native.h>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+
+HardwareSerial Serial;
+SPIClass SPI;
+TwoWire Wire;
+EEPROMClass EEPROM;
+
+bool nativeSerialMuted = false;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static bool virtualClock = false;
+static unsigned long virtualMicros = 0;
+
+// ============================================================================
+// ARDUINO CORE
+// ============================================================================
+
+unsigned long micros() {
+  if (virtualClock) {
+    return virtualMicros;
+  }
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void nativeSetMicros(unsigned long us) {
+  virtualClock = true;
+  virtualMicros = us;
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+  if (virtualClock) {
+    virtualMicros += ms * 1000;
+  } else {
+    usleep(ms * 1000);
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (virtualClock) {
+    virtualMicros += us;
+  } else {
+    usleep(us);
+  }
+}
+
+int digitalRead(uint8_t) { return HIGH; } // Buttons released, INT lines idle
+void digitalWrite(uint8_t, uint8_t) {}
+void pinMode(uint8_t, uint8_t) {}
+void attachInterrupt(uint8_t, void (*)(void), int) {}
+
+void* ps_malloc(size_t size) { return malloc(size); }
+bool psramFound() { return false; }
+
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t len) {
+  if (!nativeSerialMuted) {
+    fwrite(buf, 1, len, stdout);
+  }
+  return len;
+}
+
+// ============================================================================
+// EEPROM
+// ============================================================================
+
+bool EEPROMClass::begin(size_t) { return true; }
+uint8_t EEPROMClass::read(int address) { return data[address]; }
+void EEPROMClass::write(int address, uint8_t value) { data[address] = value; }
+bool EEPROMClass::commit() { return true; }
+
+// ============================================================================
+// FREERTOS
+// ============================================================================
+
+static int mutexDummy;
+
+BaseType_t xPortGetCoreID() { return ARDUINO_RUNNING_CORE; }
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*, BaseType_t) { return pdFAIL; }
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+void xTaskNotifyGive(TaskHandle_t) {}
+void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*) {}
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+void vTaskDelete(TaskHandle_t) {}
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment) { *previousWakeTime += increment; }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return NULL; }
+TickType_t xTaskGetTickCount() { return millis(); }
+SemaphoreHandle_t xSemaphoreCreateMutex() { return &mutexDummy; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
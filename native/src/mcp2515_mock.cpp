@@ -0,0 +1,65 @@
+/*
+ * @file mcp2515_mock.cpp
+ * @brief Mock MCP2515 for the native build: scripted RX, captured TX
+ */
+
+#include <mcp2515.h>
+
+MCP2515::MCP2515(const uint8_t, const uint32_t, SPIClass*) {}
+
+MCP2515::ERROR MCP2515::reset() { rx.clear(); tx.clear(); eflg = 0; txErrors = 0; rxErrors = 0; return ERROR_OK; }
+MCP2515::ERROR MCP2515::setConfigMode() { return ERROR_OK; }
+MCP2515::ERROR MCP2515::setListenOnlyMode() { return ERROR_OK; }
+MCP2515::ERROR MCP2515::setSleepMode() { return ERROR_OK; }
+MCP2515::ERROR MCP2515::setLoopbackMode() { return ERROR_OK; }
+MCP2515::ERROR MCP2515::setNormalMode() {
+  if (normalModeFailures > 0) {
+    normalModeFailures--;
+    return ERROR_FAILINIT;
+  }
+  return ERROR_OK;
+}
+MCP2515::ERROR MCP2515::setBitrate(const CAN_SPEED, const CAN_CLOCK) { return ERROR_OK; }
+
+MCP2515::ERROR MCP2515::sendMessage(const TXBn, const struct can_frame* frame) {
+  return sendMessage(frame);
+}
+
+MCP2515::ERROR MCP2515::sendMessage(const struct can_frame* frame) {
+  if (frame->can_dlc > CAN_MAX_DLEN) {
+    return ERROR_FAILTX;
+  }
+  txCount++;
+  if (captureTx) {
+    tx.push_back(*frame);
+  }
+  return ERROR_OK;
+}
+
+MCP2515::ERROR MCP2515::readMessage(const RXBn, struct can_frame* frame) {
+  return readMessage(frame);
+}
+
+MCP2515::ERROR MCP2515::readMessage(struct can_frame* frame) {
+  if (rx.empty()) {
+    return ERROR_NOMSG;
+  }
+  *frame = rx.front();
+  rx.pop_front();
+  return ERROR_OK;
+}
+
+bool MCP2515::checkReceive() { return !rx.empty(); }
+bool MCP2515::checkError() { return false; }
+uint8_t MCP2515::getErrorFlags() { return eflg; }
+void MCP2515::clearRXnOVRFlags() {}
+uint8_t MCP2515::getInterrupts() { return 0; }
+uint8_t MCP2515::getInterruptMask() { return 0; }
+void MCP2515::clearInterrupts() {}
+void MCP2515::clearTXInterrupts() {}
+uint8_t MCP2515::getStatus() { return 0; } // No TXREQ pending: transmission is instant
+void MCP2515::clearRXnOVR() {}
+void MCP2515::clearMERR() {}
+void MCP2515::clearERRIF() {}
+uint8_t MCP2515::errorCountRX() { return rxErrors; }
+uint8_t MCP2515::errorCountTX() { return txErrors; }
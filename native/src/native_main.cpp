@@ -0,0 +1,171 @@
+/*
+ * @file native_main.cpp
+ * @brief Entry point of the native build: runs setup()/loop() on the host
+ *
+ * Benchmark mode feeds every ID with a registered handler (and one unhandled
+ * ID per bus for the pass-through path) through the mock controllers and
+ * loop(), and reports ns per frame and frames per second for each. Frame
+ * payloads come from a fixed-seed generator, so runs are repeatable.
+ *
+ * Replay mode runs a candump/ASC log through the same loop() instead, see
+ * replay.h.
+ *
+ * Usage: program [--frames N]
+ *        program --replay LOG [--out LOG] [--realtime] [--car IFACE] [--device IFACE]
+ */
+
+#include <Arduino.h>
+#include <mcp2515.h>
+#include <can_bus.h>
+#include <can_dispatch.h>
+#include <config.h>
+#include <native.h>
+#include <replay.h>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+// External variables from main.cpp
+extern MCP2515 CAN0;
+extern MCP2515 CAN1;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+struct BenchTarget {
+  byte bus;
+  uint16_t id;
+  byte dlc;
+  bool passThrough;
+};
+
+static unsigned long benchFrames = 20000;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static MCP2515& mockController(byte bus) {
+  return (bus == BUS_CAN0) ? CAN0 : CAN1;
+}
+
+// Every ID with a handler, at the longest accepted DLC, then one unhandled ID per bus
+static std::vector<BenchTarget> collectTargets() {
+  std::vector<BenchTarget> targets;
+  struct can_frame frame = {};
+
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    uint16_t unhandled = 0;
+    for (uint16_t id = 0x7FF; id > 0; id--) {
+      frame.can_id = id;
+      bool found = false;
+      for (int dlc = CAN_MAX_DLEN; dlc >= 0 && !found; dlc--) {
+        frame.can_dlc = dlc;
+        if (canDispatchLookup(bus, &frame) != NULL) {
+          targets.push_back({bus, id, (byte)dlc, false});
+          found = true;
+        }
+      }
+      if (!found && unhandled == 0) {
+        unhandled = id;
+      }
+    }
+    targets.push_back({bus, unhandled, CAN_MAX_DLEN, true});
+  }
+  return targets;
+}
+
+static double runTarget(const BenchTarget& target, unsigned long* txFrames) {
+  MCP2515& can = mockController(target.bus);
+  uint32_t seed = target.id * 2654435761u + target.bus;
+  unsigned long sentBefore = CAN0.sentCount() + CAN1.sentCount();
+  struct can_frame frame = {};
+  frame.can_id = target.id;
+  frame.can_dlc = target.dlc;
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long done = 0; done < benchFrames;) {
+    for (byte n = 0; n < CAN_RX_BATCH && done < benchFrames; n++, done++) {
+      for (byte i = 0; i < target.dlc; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        frame.data[i] = seed >> 24;
+      }
+      can.pushRx(frame);
+    }
+    loop();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  *txFrames = CAN0.sentCount() + CAN1.sentCount() - sentBefore;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / benchFrames;
+}
+
+static void runBench() {
+  std::vector<BenchTarget> targets = collectTargets();
+
+  CAN0.setCaptureTx(false);
+  CAN1.setCaptureTx(false);
+
+  printf("\n%-6s %-6s %-4s %12s %12s %10s\n", "bus", "id", "dlc", "ns/frame", "frames/s", "tx/frame");
+  for (const BenchTarget& target : targets) {
+    unsigned long txFrames;
+    nativeSerialMuted = true;
+    runTarget(target, &txFrames); // Warm-up: caches, first-time state changes
+    double ns = runTarget(target, &txFrames);
+    nativeSerialMuted = false;
+
+    char id[16];
+    snprintf(id, sizeof id, "0x%03X", target.id);
+    printf("CAN%-3u %-6s %-4u %12.1f %12.0f %10.2f%s\n", target.bus, id, target.dlc, ns, 1e9 / ns, (double)txFrames / benchFrames, target.passThrough ? "  (pass-through)" : "");
+  }
+
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    if (canRxStats(bus).ringOverruns != 0 || canTxStats(bus).drops != 0) {
+      printf("WARNING: CAN%u lost frames during the benchmark\n", bus);
+    }
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+static int usage(const char* program) {
+  printf("Usage: %s [--frames N]\n", program);
+  printf("       %s --replay LOG [--out LOG] [--realtime] [--car IFACE] [--device IFACE]\n", program);
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  ReplayOptions replay = {NULL, NULL, NULL, NULL, false};
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = (i + 1 < argc);
+    if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+      benchFrames = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--replay") == 0 && hasValue) {
+      replay.input = argv[++i];
+    } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+      replay.output = argv[++i];
+    } else if (strcmp(argv[i], "--car") == 0 && hasValue) {
+      replay.carIface = argv[++i];
+    } else if (strcmp(argv[i], "--device") == 0 && hasValue) {
+      replay.deviceIface = argv[++i];
+    } else if (strcmp(argv[i], "--realtime") == 0) {
+      replay.realtime = true;
+    } else {
+      return usage(argv[0]);
+    }
+  }
+
+  if (replay.input != NULL) {
+    nativeSetMicros(0); // Boot on the virtual clock, the log drives it from there
+    setup();
+    return replayLog(replay);
+  }
+
+  setup();
+  runBench();
+  return 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * @file replay.cpp
+ * @brief Log replay through the translation handlers (native build)
+ */
+
+#include <replay.h>
+#include <native.h>
+#include <mcp2515.h>
+#include <can_bus.h>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+// External variables from main.cpp
+extern MCP2515 CAN0;
+extern MCP2515 CAN1;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define REPLAY_BOOT_US 1000000UL  // First frame arrives 1 s after setup()
+
+struct LogFrame {
+  double timestamp;  // Seconds, as written in the log
+  char iface[16];
+  struct can_frame frame;
+};
+
+static bool ascDecimalIds = false;  // ASC "base dec" header
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static MCP2515& mockController(byte bus) {
+  return (bus == BUS_CAN0) ? CAN0 : CAN1;
+}
+
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// "123" (standard) or "12345678" (extended)
+static bool parseId(const char* text, size_t len, canid_t* id) {
+  if (len == 0 || len > 8) {
+    return false;
+  }
+  canid_t value = 0;
+  for (size_t i = 0; i < len; i++) {
+    int digit = hexDigit(text[i]);
+    if (digit < 0) {
+      return false;
+    }
+    value = (value << 4) | digit;
+  }
+  *id = (len > 3) ? (value | CAN_EFF_FLAG) : value;
+  return true;
+}
+
+// candump -L: "(1436509052.249713) can0 123#11223344" / -ta: "(0.000000) can0 123 [4] 11 22 33 44"
+static bool parseCandump(const char* line, LogFrame* out) {
+  char rest[96];
+  if (sscanf(line, " (%lf) %15s %95[^\n]", &out->timestamp, out->iface, rest) != 3) {
+    return false;
+  }
+
+  struct can_frame& frame = out->frame;
+  memset(&frame, 0, sizeof(frame));
+  char* hash = strchr(rest, '#');
+
+  if (hash != NULL) {
+    if (!parseId(rest, hash - rest, &frame.can_id) || hash[1] == '#') {
+      return false; // CAN FD frames are not supported by the MCP2515
+    }
+    const char* data = hash + 1;
+    if (*data == 'R' || *data == 'r') {
+      frame.can_id |= CAN_RTR_FLAG;
+      return true;
+    }
+    while (frame.can_dlc < CAN_MAX_DLEN && hexDigit(data[0]) >= 0 && hexDigit(data[1]) >= 0) {
+      frame.data[frame.can_dlc++] = (hexDigit(data[0]) << 4) | hexDigit(data[1]);
+      data += 2;
+      if (*data == '.') data++;
+    }
+    return true;
+  }
+
+  char id[16];
+  int dlc, consumed;
+  if (sscanf(rest, "%15s [%d]%n", id, &dlc, &consumed) != 2 || dlc < 0 || dlc > CAN_MAX_DLEN || !parseId(id, strlen(id), &frame.can_id)) {
+    return false;
+  }
+  frame.can_dlc = dlc;
+  const char* data = rest + consumed;
+  for (int i = 0; i < dlc; i++) {
+    unsigned int value;
+    int n;
+    if (sscanf(data, "%x%n", &value, &n) != 1) {
+      return false;
+    }
+    frame.data[i] = value;
+    data += n;
+  }
+  return true;
+}
+
+// Vector ASC: "   0.010000 1  123             Rx   d 8 11 22 33 44 55 66 77 88"
+static bool parseAsc(const char* line, LogFrame* out) {
+  char id[16], dir[4], type;
+  int dlc, consumed;
+  if (sscanf(line, " %lf %15s %15s %3s %c %d%n", &out->timestamp, out->iface, id, dir, &type, &dlc, &consumed) != 6) {
+    return false;
+  }
+  // Only received data frames: Tx lines were sent by the logging tool itself
+  if (strcmp(dir, "Rx") != 0 || (type != 'd' && type != 'r') || dlc < 0 || dlc > CAN_MAX_DLEN) {
+    return false;
+  }
+
+  struct can_frame& frame = out->frame;
+  memset(&frame, 0, sizeof(frame));
+  size_t idLen = strlen(id);
+  bool extended = (id[idLen - 1] == 'x');
+  if (extended) {
+    id[--idLen] = '\0';
+  }
+  if (ascDecimalIds) {
+    frame.can_id = strtoul(id, NULL, 10);
+  } else if (!parseId(id, idLen, &frame.can_id)) {
+    return false;
+  }
+  frame.can_id &= CAN_EFF_MASK;
+  if (extended) {
+    frame.can_id |= CAN_EFF_FLAG;
+  }
+  frame.can_dlc = dlc;
+
+  if (type == 'r') {
+    frame.can_id |= CAN_RTR_FLAG;
+    return true;
+  }
+  const char* data = line + consumed;
+  for (int i = 0; i < dlc; i++) {
+    unsigned int value;
+    int n;
+    if (sscanf(data, "%x%n", &value, &n) != 1) {
+      return false;
+    }
+    frame.data[i] = value;
+    data += n;
+  }
+  return true;
+}
+
+// Explicit interface name, or the candump/ASC default of the bus
+static bool matchIface(const char* iface, const char* wanted, const char* candumpDefault, const char* ascDefault) {
+  if (wanted != NULL) {
+    return strcmp(iface, wanted) == 0;
+  }
+  return strcmp(iface, candumpDefault) == 0 || strcmp(iface, ascDefault) == 0;
+}
+
+static void writeFrame(FILE* out, double timestamp, byte bus, const struct can_frame& frame) {
+  fprintf(out, "(%.6f) can%u ", timestamp, bus);
+  if (frame.can_id & CAN_EFF_FLAG) {
+    fprintf(out, "%08X#", (unsigned int)(frame.can_id & CAN_EFF_MASK));
+  } else {
+    fprintf(out, "%03X#", (unsigned int)(frame.can_id & CAN_SFF_MASK));
+  }
+  for (byte i = 0; i < frame.can_dlc; i++) {
+    fprintf(out, "%02X", frame.data[i]);
+  }
+  fputc('\n', out);
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+int replayLog(const ReplayOptions& options) {
+  FILE* in = fopen(options.input, "r");
+  if (in == NULL) {
+    fprintf(stderr, "Cannot open %s\n", options.input);
+    return 1;
+  }
+  FILE* out = NULL;
+  if (options.output != NULL) {
+    out = fopen(options.output, "w");
+    if (out == NULL) {
+      fprintf(stderr, "Cannot create %s\n", options.output);
+      fclose(in);
+      return 1;
+    }
+  }
+
+  char line[256];
+  LogFrame entry;
+  double firstTimestamp = -1, lastTimestamp = 0;
+  unsigned long now = micros();
+  unsigned long framesIn[BUS_COUNT] = {0, 0};
+  unsigned long framesOut[BUS_COUNT] = {0, 0};
+  unsigned long skipped = 0;
+  auto wallStart = std::chrono::steady_clock::now();
+
+  nativeSerialMuted = true;
+  while (fgets(line, sizeof line, in) != NULL) {
+    if (strncmp(line, "base dec", 8) == 0) {
+      ascDecimalIds = true;
+    }
+
+    const char* start = line + strspn(line, " \t");
+    bool isAsc = (*start != '(');
+    if (!(isAsc ? parseAsc(line, &entry) : parseCandump(line, &entry))) {
+      continue;
+    }
+
+    byte bus;
+    if (matchIface(entry.iface, options.carIface, "can0", "1")) {
+      bus = BUS_CAN0;
+    } else if (matchIface(entry.iface, options.deviceIface, "can1", "2")) {
+      bus = BUS_CAN1;
+    } else {
+      skipped++;
+      continue;
+    }
+
+    if (firstTimestamp < 0) {
+      firstTimestamp = entry.timestamp;
+    }
+    lastTimestamp = entry.timestamp;
+
+    // Virtual time follows the log, never backwards
+    unsigned long frameTime = REPLAY_BOOT_US + (unsigned long)((entry.timestamp - firstTimestamp) * 1e6);
+    if (frameTime > now) {
+      now = frameTime;
+    }
+    nativeSetMicros(now);
+
+    if (options.realtime) {
+      std::this_thread::sleep_until(wallStart + std::chrono::microseconds(now - REPLAY_BOOT_US));
+    }
+
+    mockController(bus).pushRx(entry.frame);
+    framesIn[bus]++;
+    loop();
+    now = micros(); // delay() inside handlers advances the virtual clock
+
+    for (byte b = 0; b < BUS_COUNT; b++) {
+      MCP2515& can = mockController(b);
+      for (const struct can_frame& frame : can.sent()) {
+        if (out != NULL) {
+          writeFrame(out, firstTimestamp + (now - REPLAY_BOOT_US) / 1e6, b, frame);
+        }
+        framesOut[b]++;
+      }
+      can.clearSent();
+    }
+  }
+  nativeSerialMuted = false;
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double duration = (firstTimestamp < 0) ? 0 : lastTimestamp - firstTimestamp;
+  unsigned long total = framesIn[BUS_CAN0] + framesIn[BUS_CAN1];
+
+  printf("Replayed %s: %.1f s of traffic in %.3f s (x%.0f)\n", options.input, duration, wall, wall > 0 ? duration / wall : 0);
+  printf("  CAN0 (car) in=%lu out=%lu, CAN1 (device) in=%lu out=%lu, other interfaces skipped=%lu\n", framesIn[BUS_CAN0], framesOut[BUS_CAN0], framesIn[BUS_CAN1], framesOut[BUS_CAN1], skipped);
+  printf("  %.0f frames/s, %.1f ns/frame\n", wall > 0 ? total / wall : 0, total > 0 ? wall * 1e9 / total : 0);
+
+  fclose(in);
+  if (out != NULL) {
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * @file timelib_stubs.cpp
+ * @brief TimeLib and DS1307RTC stubs for the native build
+ *
+ * The system clock is set with setTime() and advances with millis(). The RTC
+ * has no chip, like a board without the module: RTC.get() returns 0.
+ */
+
+#include <TimeLib.h>
+#include <DS1307RTC.h>
+
+DS1307RTC RTC;
+
+static time_t sysTime = 0;
+static unsigned long syncMillis = 0;
+static timeStatus_t status = timeNotSet;
+static getExternalTime syncProvider = NULL;
+
+time_t now() {
+  return sysTime + (millis() - syncMillis) / 1000;
+}
+
+void setTime(time_t t) {
+  sysTime = t;
+  syncMillis = millis();
+  status = timeSet;
+}
+
+void setTime(int hr, int min, int sec, int dy, int mnth, int yr) {
+  tmElements_t tm;
+  tm.Year = (yr > 99) ? CalendarYrToTm(yr) : yr + 30;
+  tm.Month = mnth;
+  tm.Day = dy;
+  tm.Hour = hr;
+  tm.Minute = min;
+  tm.Second = sec;
+  setTime(makeTime(tm));
+}
+
+timeStatus_t timeStatus() {
+  return status;
+}
+
+void setSyncProvider(getExternalTime getTimeFunction) {
+  syncProvider = getTimeFunction;
+  time_t t = syncProvider();
+  if (t != 0) {
+    setTime(t);
+  }
+}
+
+static struct tm brokenDown(time_t t) {
+  struct tm result;
+  gmtime_r(&t, &result);
+  return result;
+}
+
+int hour(time_t t) { return brokenDown(t).tm_hour; }
+int minute(time_t t) { return brokenDown(t).tm_min; }
+int second(time_t t) { return brokenDown(t).tm_sec; }
+int day(time_t t) { return brokenDown(t).tm_mday; }
+int month(time_t t) { return brokenDown(t).tm_mon + 1; }
+int year(time_t t) { return brokenDown(t).tm_year + 1900; }
+int hour() { return hour(now()); }
+int minute() { return minute(now()); }
+int second() { return second(now()); }
+int day() { return day(now()); }
+int month() { return month(now()); }
+int year() { return year(now()); }
+
+time_t makeTime(const tmElements_t& tm) {
+  struct tm t = {};
+  t.tm_year = tmYearToCalendar(tm.Year) - 1900;
+  t.tm_mon = tm.Month - 1;
+  t.tm_mday = tm.Day;
+  t.tm_hour = tm.Hour;
+  t.tm_min = tm.Minute;
+  t.tm_sec = tm.Second;
+  return timegm(&t);
+}
+
+void breakTime(time_t time, tmElements_t& tm) {
+  struct tm t = brokenDown(time);
+  tm.Year = CalendarYrToTm(t.tm_year + 1900);
+  tm.Month = t.tm_mon + 1;
+  tm.Day = t.tm_mday;
+  tm.Wday = t.tm_wday + 1;
+  tm.Hour = t.tm_hour;
+  tm.Minute = t.tm_min;
+  tm.Second = t.tm_sec;
+}
+
+time_t DS1307RTC::get() { return 0; }
+bool DS1307RTC::set(time_t) { return false; }
+bool DS1307RTC::read(tmElements_t&) { return false; }
+bool DS1307RTC::write(tmElements_t&) { return false; }
@@ -0,0 +1,270 @@
+/*
+ * @file gateway_rules_test.cpp
+ * @brief Default gateway rules against the C++ handlers they replaced (host program)
+ *
+ * 0xE6, 0x321 and 0x1E5 used to be C++ handlers of main.cpp; they are now
+ * the built-in rules of gateway_rules.cpp. This program runs setup() with no
+ * saved rules, feeds fixed-seed frames of every accepted length (and every
+ * key of the 0x1E5 lookup tables) through the mock controllers and loop(),
+ * and compares each frame sent with the output of the former handler,
+ * kept below as it was. Lengths the rules do not accept must still be
+ * forwarded unchanged, as before.
+ *
+ * Bytes past the received length: the former handlers read whatever the
+ * previous frame left in canMsgRcv, the rules use zeros. The frames fed
+ * here carry garbage there, the former handlers are given zeros.
+ *
+ * Built with the whole firmware and the native stubs by run_tests.sh.
+ */
+
+#include "test_check.h"
+#include <Arduino.h>
+#include <mcp2515.h>
+#include <can_bus.h>
+#include <config.h>
+#include <native.h>
+#include <cstdio>
+#include <vector>
+
+// External variables from main.cpp
+extern MCP2515 CAN0;
+extern MCP2515 CAN1;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define TEST_FRAMES_PER_DLC 200
+
+typedef void (*BaselineHandler)(const struct can_frame* in, struct can_frame* out);
+
+// ============================================================================
+// FORMER HANDLERS (main.cpp before the rules), on a copy of the received frame
+// ============================================================================
+
+// checksumm_0E6() of can_utils.cpp, with its own counter: only the 0xE6 rule calls the firmware one
+static byte baselineChecksum_0E6(const byte* frame) {
+  static byte iter = 0;
+  byte cursumm = 0;
+  for (byte i = 0; i < 7; i++) {
+    cursumm += (frame[i] >> 4) + (frame[i] & 0x0F);
+  }
+  cursumm += iter;
+  cursumm = ((cursumm ^ 0xFF) - 3) & 0x0F;
+  cursumm ^= iter << 4;
+  iter++;
+  if (iter >= 16) iter = 0;
+  return cursumm;
+}
+
+// ABS status frame, increase length (CAN0, dlc < 8)
+static void baseline_0E6(const struct can_frame* in, struct can_frame* out) {
+  for (byte i = 0; i < 7; i++) {
+    out->data[i] = in->data[i];
+  }
+  out->data[7] = baselineChecksum_0E6(out->data);
+  out->can_id = 0xE6;
+  out->can_dlc = 8;
+}
+
+// Intercept 0x321 and reconstruct it with 5 bytes DrumVlado (CAN0, dlc < 5)
+static void baseline_321(const struct can_frame* in, struct can_frame* out) {
+  out->can_id = 0x321;
+  out->can_dlc = 5;
+  for (int i = 0; i < 4; i++) {
+    out->data[i] = in->data[i];
+  }
+  out->data[4] = 0x00;
+}
+
+// Audio settings (CAN1, dlc == 7), converted in place
+static void baseline_1E5(const struct can_frame* in, struct can_frame* out) {
+  int tmpVal;
+
+  *out = *in;
+
+  // Ambience mapping
+  tmpVal = out->data[5];
+  if (tmpVal == 0x00) { // User
+    out->data[6] = 0x40;
+  } else if (tmpVal == 0x08) { // Classical
+    out->data[6] = 0x44;
+  } else if (tmpVal == 0x10) { // Jazz
+    out->data[6] = 0x48;
+  } else if (tmpVal == 0x18) { // Pop-Rock
+    out->data[6] = 0x4C;
+  } else if (tmpVal == 0x28) { // Techno
+    out->data[6] = 0x54;
+  } else if (tmpVal == 0x20) { // Vocal
+    out->data[6] = 0x50;
+  } else { // Default : User
+    out->data[6] = 0x40;
+  }
+
+  // Loudness / Volume linked to speed
+  tmpVal = out->data[4];
+  if (tmpVal == 0x10) { // Loudness / not linked to speed
+    out->data[5] = 0x40;
+  } else if (tmpVal == 0x14) { // Loudness / Volume linked to speed
+    out->data[5] = 0x47;
+  } else if (tmpVal == 0x04) { // No Loudness / Volume linked to speed
+    out->data[5] = 0x07;
+  } else if (tmpVal == 0x00) { // No Loudness / not linked to speed
+    out->data[5] = 0x00;
+  } else { // Default : No Loudness / not linked to speed
+    out->data[5] = 0x00;
+  }
+
+  // Bass, treble (on position 4), balance left / right and front / back
+  tmpVal = out->data[2];
+  out->data[2] = ((tmpVal - 32) >> 2) + 57;
+  tmpVal = out->data[3];
+  out->data[4] = ((tmpVal - 32) >> 2) + 57;
+  tmpVal = out->data[1];
+  out->data[1] = ((tmpVal - 32) >> 2) + 57;
+  tmpVal = out->data[0];
+  out->data[0] = ((tmpVal - 32) >> 2) + 57;
+
+  // Mediums ?
+  out->data[3] = 63;
+}
+
+// Not handled: forwarded unchanged to the other bus
+static void baselineForward(const struct can_frame* in, struct can_frame* out) {
+  *out = *in;
+}
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static MCP2515& mockController(byte bus) {
+  return (bus == BUS_CAN0) ? CAN0 : CAN1;
+}
+
+// Run one frame through loop() and compare what is sent with the former handler
+static void runFrame(byte bus, const struct can_frame& in, BaselineHandler baseline) {
+  struct can_frame received = in;
+  struct can_frame expected = {};
+  byte outBus = (bus == BUS_CAN0) ? BUS_CAN1 : BUS_CAN0;
+
+  for (byte i = in.can_dlc; i < CAN_MAX_DLEN; i++) {
+    received.data[i] = 0; // See the file comment
+  }
+  baseline(&received, &expected);
+
+  CAN0.clearSent();
+  CAN1.clearSent();
+  mockController(bus).pushRx(in);
+  loop();
+
+  const struct can_frame* sent = NULL;
+  unsigned int count = 0;
+  for (const struct can_frame& frame : mockController(outBus).sent()) {
+    if (frame.can_id == expected.can_id) {
+      sent = &frame;
+      count++;
+    }
+  }
+  if (!CHECK(count == 1)) {
+    fprintf(stderr, "  CAN%u 0x%03lX dlc %u: %u frames sent\n", bus, (unsigned long) in.can_id, in.can_dlc, count);
+    return;
+  }
+
+  bool same = (sent->can_dlc == expected.can_dlc);
+  for (byte i = 0; same && i < expected.can_dlc; i++) {
+    same = (sent->data[i] == expected.data[i]);
+  }
+  if (!CHECK(same)) {
+    fprintf(stderr, "  CAN%u 0x%03lX in:", bus, (unsigned long) in.can_id);
+    for (byte i = 0; i < in.can_dlc; i++) {
+      fprintf(stderr, " %02X", in.data[i]);
+    }
+    fprintf(stderr, "\n  sent:    ");
+    for (byte i = 0; i < sent->can_dlc; i++) {
+      fprintf(stderr, " %02X", sent->data[i]);
+    }
+    fprintf(stderr, "\n  expected:");
+    for (byte i = 0; i < expected.can_dlc; i++) {
+      fprintf(stderr, " %02X", expected.data[i]);
+    }
+    fprintf(stderr, "\n");
+  }
+}
+
+// Fixed-seed payloads of one length, garbage past it
+static void runRandom(byte bus, uint16_t id, byte dlc, BaselineHandler baseline) {
+  struct can_frame frame;
+  frame.can_id = id;
+  frame.can_dlc = dlc;
+  for (int n = 0; n < TEST_FRAMES_PER_DLC; n++) {
+    for (byte i = 0; i < CAN_MAX_DLEN; i++) {
+      frame.data[i] = testRandomByte();
+    }
+    runFrame(bus, frame, baseline);
+  }
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static void test_0E6() {
+  for (byte dlc = 0; dlc < 8; dlc++) {
+    runRandom(BUS_CAN0, 0xE6, dlc, baseline_0E6);
+  }
+  runRandom(BUS_CAN0, 0xE6, 8, baselineForward);
+}
+
+static void test_321() {
+  for (byte dlc = 0; dlc < 5; dlc++) {
+    runRandom(BUS_CAN0, 0x321, dlc, baseline_321);
+  }
+  for (byte dlc = 5; dlc <= 8; dlc++) {
+    runRandom(BUS_CAN0, 0x321, dlc, baselineForward);
+  }
+}
+
+static void test_1E5() {
+  runRandom(BUS_CAN1, 0x1E5, 7, baseline_1E5);
+
+  // Every value of each source byte (lookup keys and defaults, scale ends)
+  struct can_frame frame;
+  frame.can_id = 0x1E5;
+  frame.can_dlc = 7;
+  for (int value = 0; value < 256; value++) {
+    for (byte i = 0; i < CAN_MAX_DLEN; i++) {
+      frame.data[i] = testRandomByte();
+    }
+    for (byte i = 0; i < 7; i++) {
+      frame.data[i] = value;
+      runFrame(BUS_CAN1, frame, baseline_1E5);
+    }
+  }
+
+  for (byte dlc = 0; dlc <= 8; dlc++) {
+    if (dlc != 7) {
+      runRandom(BUS_CAN1, 0x1E5, dlc, baselineForward);
+    }
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+int main() {
+  testSeed(2024);
+  nativeSerialMuted = true;
+  nativeSetMicros(0); // Virtual clock standing still: no scheduled frame in the way
+  setup();
+  CAN0.setCaptureTx(true);
+  CAN1.setCaptureTx(true);
+
+  test_0E6();
+  test_321();
+  test_1E5();
+
+  nativeSerialMuted = false;
+  return testSummary();
+}
@@ -0,0 +1,296 @@
+/*
+ * @file log_codec_test.cpp
+ * @brief Drive log codec tests (host program): encode, decode, damaged blocks
+ *
+ * Encodes a fixed-seed stream of frames (both buses and directions,
+ * standard, extended and remote IDs, every DLC, repeated and changing
+ * payloads, time going backwards a few µs, long gaps) into blocks, decodes
+ * them back and compares every field. A damaged block must be rejected by
+ * its CRC without losing the blocks around it, and a scan of a dump with
+ * text between the blocks must find them all, as log_decode does.
+ *
+ * Built and run by run_tests.sh.
+ */
+
+#include "test_check.h"
+#include <log_codec.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define TEST_BLOCK_SIZE 1024  // Small blocks, so the stream spans many of them
+#define TEST_FRAMES 20000
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+// Fixed-seed traffic: a few IDs that repeat with small changes, like a car bus
+static std::vector<LoggedFrame> makeFrames(size_t count) {
+  static const uint32_t ids[] = {0x0F6, 0x036, 0x0B6, 0x1A8, 0x221, 0x3A7, 0x7FF, 0x000,
+                                 0x80000000UL | 0x18DAF110UL, 0x80000000UL | 0x1FFFFFFFUL, 0x40000000UL | 0x2B6};
+  std::vector<LoggedFrame> frames;
+  LoggedFrame last[sizeof(ids) / sizeof(ids[0])][4];
+  uint32_t us = 0xFFF00000UL; // micros() wraps inside the stream
+
+  memset(last, 0, sizeof(last));
+  for (size_t n = 0; n < count; n++) {
+    uint32_t r = testRandom();
+    size_t idIndex = r % (sizeof(ids) / sizeof(ids[0]));
+    uint8_t key = (r >> 4) & 0x03;
+    LoggedFrame frame = last[idIndex][key];
+
+    frame.id = ids[idIndex];
+    frame.bus = key & 0x01;
+    frame.tx = key >> 1;
+    if (frame.dlc == 0 || (r >> 6) % 50 == 0) {
+      frame.dlc = (r >> 12) % 9; // DLC changes now and then
+    }
+    for (uint8_t i = 0; i < 8; i++) {
+      if ((testRandom() & 0x07) == 0) {
+        frame.data[i] = (uint8_t) testRandom();
+      }
+    }
+    for (uint8_t i = frame.dlc; i < 8; i++) {
+      frame.data[i] = 0; // The decoder returns zeros beyond the DLC
+    }
+    last[idIndex][key] = frame;
+
+    switch ((r >> 16) % 100) {
+    case 0:
+      us += 2000000UL; // Long gap (4-byte varint)
+      break;
+    case 1:
+      us -= 7;         // Queued a few µs out of order
+      break;
+    default:
+      us += 100 + (r >> 20) % 900;
+      break;
+    }
+    frame.us = us;
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+// Encode the frames into as many blocks as needed, sequence numbers from 0
+static std::vector<uint8_t> encodeBlocks(const std::vector<LoggedFrame>& frames) {
+  std::vector<uint8_t> blocks;
+  static LogEncoder encoder;
+  uint8_t block[TEST_BLOCK_SIZE];
+  uint32_t sequence = 0;
+  bool open = false;
+
+  for (const LoggedFrame& frame : frames) {
+    if (!open) {
+      logEncoderOpen(&encoder, block, TEST_BLOCK_SIZE, sequence++, 1436509052UL, true, frame.us);
+      open = true;
+    }
+    if (!logEncodeFrame(&encoder, &frame)) {
+      logEncoderClose(&encoder);
+      blocks.insert(blocks.end(), block, block + TEST_BLOCK_SIZE);
+      logEncoderOpen(&encoder, block, TEST_BLOCK_SIZE, sequence++, 1436509052UL, true, frame.us);
+      CHECK(logEncodeFrame(&encoder, &frame));
+    }
+  }
+  if (open) {
+    logEncoderClose(&encoder);
+    blocks.insert(blocks.end(), block, block + TEST_BLOCK_SIZE);
+  }
+  return blocks;
+}
+
+static void collectFrame(const LogBlockHeader*, const LoggedFrame* frame, void* context) {
+  ((std::vector<LoggedFrame>*) context)->push_back(*frame);
+}
+
+// Decode what a scan finds, as log_decode does: a header anywhere, damaged blocks skipped
+static std::vector<LoggedFrame> scanBlocks(const std::vector<uint8_t>& input, unsigned long* decoded, unsigned long* damaged) {
+  std::vector<LoggedFrame> frames;
+  size_t pos = 0;
+
+  *decoded = 0;
+  *damaged = 0;
+  while (pos + LOG_HEADER_SIZE <= input.size()) {
+    LogBlockHeader header;
+    if (!logParseHeader(&input[pos], &header) || pos + header.blockSize > input.size()) {
+      pos++;
+      continue;
+    }
+
+    std::vector<LoggedFrame> block;
+    if (logDecodeBlock(&input[pos], collectFrame, &block) < 0) {
+      (*damaged)++;
+    } else {
+      (*decoded)++;
+      frames.insert(frames.end(), block.begin(), block.end());
+    }
+    pos += header.blockSize;
+  }
+  return frames;
+}
+
+static bool sameFrame(const LoggedFrame& a, const LoggedFrame& b) {
+  return a.us == b.us && a.id == b.id && a.bus == b.bus && a.tx == b.tx && a.dlc == b.dlc && memcmp(a.data, b.data, 8) == 0;
+}
+
+static bool sameFrames(const std::vector<LoggedFrame>& a, const std::vector<LoggedFrame>& b, size_t from, size_t count) {
+  if (!CHECK(a.size() == count)) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (!sameFrame(a[i], b[from + i])) {
+      fprintf(stderr, "frame %zu differs\n", from + i);
+      return CHECK(false);
+    }
+  }
+  return true;
+}
+
+// Frames of the first blocks of an encoded stream
+static size_t framesBefore(const std::vector<uint8_t>& blocks, size_t blockCount) {
+  size_t frames = 0;
+  for (size_t b = 0; b < blockCount; b++) {
+    LogBlockHeader header;
+    CHECK(logParseHeader(&blocks[b * TEST_BLOCK_SIZE], &header));
+    frames += header.frames;
+  }
+  return frames;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static void testRoundTrip() {
+  std::vector<LoggedFrame> frames = makeFrames(TEST_FRAMES);
+  std::vector<uint8_t> blocks = encodeBlocks(frames);
+  size_t blockCount = blocks.size() / TEST_BLOCK_SIZE;
+  unsigned long decoded, damaged;
+
+  CHECK(blockCount > 10);
+  std::vector<LoggedFrame> out = scanBlocks(blocks, &decoded, &damaged);
+  CHECK(decoded == blockCount);
+  CHECK(damaged == 0);
+  sameFrames(out, frames, 0, frames.size());
+
+  // Headers: sequence numbers, size, frame counts and the epoch of each block
+  size_t total = 0;
+  for (size_t b = 0; b < blockCount; b++) {
+    LogBlockHeader header;
+    CHECK(logParseHeader(&blocks[b * TEST_BLOCK_SIZE], &header));
+    CHECK(header.sequence == b);
+    CHECK(header.blockSize == TEST_BLOCK_SIZE);
+    CHECK(header.flags == LOG_FLAG_EPOCH);
+    CHECK(header.epoch == 1436509052UL);
+    CHECK(header.used <= TEST_BLOCK_SIZE);
+    total += header.frames;
+  }
+  CHECK(total == frames.size());
+}
+
+static void testDictionaryFull() {
+  static LogEncoder encoder;
+  static uint8_t block[32768];
+  LoggedFrame frame;
+
+  memset(&frame, 0, sizeof(frame));
+  logEncoderOpen(&encoder, block, sizeof(block), 0, 0, false, 0);
+  for (uint32_t id = 0; id < LOG_DICTIONARY_SIZE; id++) {
+    frame.id = id;
+    frame.us = id;
+    CHECK(logEncodeFrame(&encoder, &frame));
+  }
+  frame.id = LOG_DICTIONARY_SIZE;
+  CHECK(!logEncodeFrame(&encoder, &frame)); // A new ID needs a new block
+  frame.id = 0;
+  CHECK(logEncodeFrame(&encoder, &frame));  // A known one still fits
+  logEncoderClose(&encoder);
+
+  std::vector<LoggedFrame> out;
+  CHECK(logDecodeBlock(block, collectFrame, &out) == LOG_DICTIONARY_SIZE + 1);
+}
+
+static void testDamagedBlock() {
+  testSeed(777);
+  std::vector<LoggedFrame> frames = makeFrames(TEST_FRAMES / 4);
+  std::vector<uint8_t> blocks = encodeBlocks(frames);
+  size_t blockCount = blocks.size() / TEST_BLOCK_SIZE;
+  unsigned long decoded, damaged;
+
+  CHECK(blockCount >= 4);
+
+  // One bit of the records of block 1: rejected by the CRC, blocks 0 and 2.. intact
+  std::vector<uint8_t> flipped = blocks;
+  flipped[TEST_BLOCK_SIZE + LOG_HEADER_SIZE + 40] ^= 0x10;
+  std::vector<LoggedFrame> out = scanBlocks(flipped, &decoded, &damaged);
+  CHECK(decoded == blockCount - 1);
+  CHECK(damaged == 1);
+  size_t first = framesBefore(blocks, 1);
+  size_t second = framesBefore(blocks, 2);
+  std::vector<LoggedFrame> expected(frames.begin(), frames.begin() + first);
+  expected.insert(expected.end(), frames.begin() + second, frames.end());
+  sameFrames(out, expected, 0, expected.size());
+
+  // Damaged CRC field itself
+  std::vector<uint8_t> badCrc = blocks;
+  badCrc[2 * TEST_BLOCK_SIZE + 24] ^= 0x01;
+  std::vector<LoggedFrame> unused;
+  CHECK(logDecodeBlock(&badCrc[2 * TEST_BLOCK_SIZE], collectFrame, &unused) == -1);
+  CHECK(unused.empty());
+
+  // Used bytes past the block size: not a header
+  LogBlockHeader header;
+  std::vector<uint8_t> badUsed = blocks;
+  badUsed[8] = 0xFF;
+  badUsed[9] = 0xFF;
+  CHECK(!logParseHeader(&badUsed[0], &header));
+
+  // Block cut short (power lost during a write): the blocks before it decode
+  std::vector<uint8_t> cut(blocks.begin(), blocks.begin() + 3 * TEST_BLOCK_SIZE + TEST_BLOCK_SIZE / 2);
+  out = scanBlocks(cut, &decoded, &damaged);
+  CHECK(decoded == 3);
+  sameFrames(out, frames, 0, framesBefore(blocks, 3));
+}
+
+static void testResync() {
+  testSeed(4242);
+  std::vector<LoggedFrame> frames = makeFrames(TEST_FRAMES / 4);
+  std::vector<uint8_t> blocks = encodeBlocks(frames);
+  size_t blockCount = blocks.size() / TEST_BLOCK_SIZE;
+  unsigned long decoded, damaged;
+
+  // A "log dump" capture: console text before, between and after the blocks, a stray "CLOG"
+  static const char text[] = "> log dump 12\r\nCLOG\r\n";
+  std::vector<uint8_t> dump(text, text + sizeof(text) - 1);
+  for (size_t b = 0; b < blockCount; b++) {
+    dump.insert(dump.end(), blocks.begin() + b * TEST_BLOCK_SIZE, blocks.begin() + (b + 1) * TEST_BLOCK_SIZE);
+    if (b == 1) {
+      dump.insert(dump.end(), text, text + sizeof(text) - 1);
+    }
+  }
+  dump.insert(dump.end(), text, text + sizeof(text) - 1);
+
+  std::vector<LoggedFrame> out = scanBlocks(dump, &decoded, &damaged);
+  CHECK(decoded == blockCount);
+  CHECK(damaged == 0);
+  sameFrames(out, frames, 0, frames.size());
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+int main() {
+  testSeed(12345);
+  testRoundTrip();
+  testDictionaryFull();
+  testDamagedBlock();
+  testResync();
+
+  return testSummary();
+}
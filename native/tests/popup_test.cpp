@@ -0,0 +1,212 @@
+/*
+ * @file popup_test.cpp
+ * @brief Popup manager and alerts journal tests (host program)
+ *
+ * Feeds 0x120 journal frames to journalDecode() and reads the 0x1A1 frames
+ * the popup builder sends, one per call as on the scheduler. Covers a popup
+ * shared by two alerts of different priorities (106: braking STOP at P1,
+ * ABS WARNING at P2), a change of parameters, repeats that must not send
+ * anything, and the POPUP_MAX_ACTIVE limit.
+ *
+ * Built with alerts_journal.cpp, popup.cpp and the Arduino stubs by run_tests.sh.
+ */
+
+#include "test_check.h"
+#include <alerts_journal.h>
+#include <popup.h>
+#include <scheduler.h>
+#include <can_bus.h>
+#include <config.h>
+#include <cstdio>
+
+// Variables of main.cpp used by the modules under test
+bool isBVMP = false;
+bool SerialEnabled = false;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define POPUP_CLOSE 0x7FFF
+
+struct PopupFrame {
+  bool sent;
+  uint16_t id;     // POPUP_CLOSE for a close
+  bool isNew;      // Bit 7 of byte 0
+  byte priority;
+  byte parameters;
+};
+
+static ScheduledFrameBuilder popupBuilder = NULL;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+// popupBegin() declares its builder here; the test calls it directly
+bool schedulerAdd(byte bus, uint16_t id, unsigned int periodMs, unsigned int phaseMs, ScheduledFrameBuilder builder) {
+  (void) periodMs;
+  (void) phaseMs;
+  CHECK(bus == BUS_CAN1);
+  CHECK(id == 0x1A1);
+  popupBuilder = builder;
+  return true;
+}
+
+// One scheduler slot of 0x1A1
+static PopupFrame nextPopup() {
+  PopupFrame popup = {};
+  struct can_frame frame = {};
+
+  popup.sent = popupBuilder(&frame);
+  if (popup.sent) {
+    CHECK(frame.can_dlc == 8);
+    popup.isNew = frame.data[0] & 0x80;
+    popup.id = ((frame.data[0] & 0x7F) << 8) | frame.data[1];
+    popup.priority = frame.data[2] & 0x3F;
+    popup.parameters = frame.data[3];
+  }
+  return popup;
+}
+
+static void checkShown(const PopupFrame& popup, uint16_t id, byte priority, byte parameters, int line) {
+  if (!testCheck(popup.sent && popup.id == id && popup.isNew && popup.priority == priority && popup.parameters == parameters,
+                 "popup shown", __FILE__, line)) {
+    fprintf(stderr, "  expected %u/P%u/%02X, got %s %u/P%u/%02X\n", id, priority, parameters,
+            popup.sent ? "frame" : "no frame", popup.id, popup.priority, popup.parameters);
+  }
+}
+
+static void checkClosed(const PopupFrame& popup, byte priority, int line) {
+  if (!testCheck(popup.sent && popup.id == POPUP_CLOSE && popup.priority == priority, "popup closed", __FILE__, line)) {
+    fprintf(stderr, "  expected close P%u, got %s %04X/P%u\n", priority, popup.sent ? "frame" : "no frame", popup.id, popup.priority);
+  }
+}
+
+static void checkIdle(int line) {
+  PopupFrame popup = nextPopup();
+  if (!testCheck(!popup.sent, "no popup frame", __FILE__, line)) {
+    fprintf(stderr, "  got %04X/P%u\n", popup.id, popup.priority);
+  }
+}
+
+#define CHECK_SHOWN(id, priority, parameters) checkShown(nextPopup(), (id), (priority), (parameters), __LINE__)
+#define CHECK_CLOSED(priority) checkClosed(nextPopup(), (priority), __LINE__)
+#define CHECK_IDLE() checkIdle(__LINE__)
+
+// Bloc 1 of the journal (0x120, byte 0 = 01xxxxxx), other bytes clear
+static void journalBloc1(byte byte1, byte byte4) {
+  struct can_frame frame = {};
+  frame.can_id = 0x120;
+  frame.can_dlc = 8;
+  frame.data[0] = 0x40;
+  frame.data[1] = byte1;
+  frame.data[4] = byte4;
+  journalDecode(frame);
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+#define BLOC1_BRAKING_STOP 0x10  // Byte 1 bit 4, popup 106 at P1
+#define BLOC1_ABS 0x20           // Byte 4 bit 5, popup 106 at P2
+
+// Braking and ABS share popup 106: clearing the more urgent one re-shows it at the other's priority
+static void testSharedPopupPriority() {
+  journalBloc1(BLOC1_BRAKING_STOP, BLOC1_ABS);
+  CHECK_SHOWN(106, 1, 0x00);
+  CHECK_IDLE();
+
+  journalBloc1(0x00, BLOC1_ABS);
+  CHECK_CLOSED(1);
+  CHECK_SHOWN(106, 2, 0x00);
+  CHECK_IDLE();
+
+  // Braking again: back to P1
+  journalBloc1(BLOC1_BRAKING_STOP, BLOC1_ABS);
+  CHECK_CLOSED(2);
+  CHECK_SHOWN(106, 1, 0x00);
+  CHECK_IDLE();
+
+  // ABS clears under braking: same priority, nothing to send
+  journalBloc1(BLOC1_BRAKING_STOP, 0x00);
+  CHECK_IDLE();
+
+  journalBloc1(0x00, 0x00);
+  CHECK_CLOSED(1);
+  CHECK_IDLE();
+}
+
+// Same state reported again: no frame. New parameters: close and show again
+static void testRepeatsAndParameters() {
+  popupSet(true, 8, 8, 0x80);
+  popupSet(true, 8, 8, 0x80);
+  CHECK_SHOWN(8, 8, 0x80);
+  CHECK_IDLE();
+  popupSet(true, 8, 8, 0x80);
+  CHECK_IDLE();
+
+  popupSet(true, 8, 8, 0xC0);
+  CHECK_CLOSED(8);
+  CHECK_SHOWN(8, 8, 0xC0);
+
+  // Priority up and back down before the builder runs: nothing changes on the device
+  popupSet(true, 8, 3, 0xC0);
+  popupSet(true, 8, 8, 0xC0);
+  CHECK_IDLE();
+
+  popupSet(false, 8, 8, 0x00);
+  popupSet(false, 8, 8, 0x00);
+  CHECK_CLOSED(8);
+  CHECK_IDLE();
+
+  // Raised and cleared between two frames: never shown
+  popupSet(true, 224, 10, 0x00);
+  popupSet(false, 224, 10, 0x00);
+  CHECK_IDLE();
+}
+
+// At most POPUP_MAX_ACTIVE shown, most urgent first; a waiting one is shown when a slot frees
+static void testActiveLimit() {
+  for (int n = 0; n <= POPUP_MAX_ACTIVE; n++) {
+    popupSet(true, 200 + n, 14 - n, 0x00);
+  }
+  for (int n = POPUP_MAX_ACTIVE; n > 0; n--) {
+    CHECK_SHOWN(200 + n, 14 - n, 0x00);
+  }
+  CHECK_IDLE();
+
+  popupSet(false, 203, 11, 0x00);
+  CHECK_CLOSED(11);
+  CHECK_SHOWN(200, 14, 0x00);
+
+  // Closed in the order they are kept: most urgent first
+  static const byte closing[] = {6, 7, 8, 9, 10, 12, 13, 14};
+  static_assert(sizeof(closing) == POPUP_MAX_ACTIVE, "One close per active popup");
+  for (int n = 0; n <= POPUP_MAX_ACTIVE; n++) {
+    popupSet(false, 200 + n, 14 - n, 0x00);
+  }
+  for (byte priority : closing) {
+    CHECK_CLOSED(priority);
+  }
+  CHECK_IDLE();
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+int main() {
+  journalBegin();
+  popupBegin();
+  if (!CHECK(popupBuilder != NULL)) {
+    return testSummary();
+  }
+
+  testSharedPopupPriority();
+  testRepeatsAndParameters();
+  testActiveLimit();
+
+  return testSummary();
+}
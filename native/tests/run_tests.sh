@@ -0,0 +1,66 @@
+#!/bin/sh
+#
+# Build and run the host tests of native/tests/ (g++ only, no PlatformIO needed).
+#
+# Usage: native/tests/run_tests.sh [TEST...]   (all tests without TEST, e.g. log_codec_test)
+# Exit status 0 when every test builds and passes. Binaries go to $TEST_BUILD_DIR
+# (a temporary directory, removed afterwards, if not set).
+
+cd "$(dirname "$0")/../.." || exit 1
+
+CXX="${CXX:-g++}"
+CXXFLAGS="-std=gnu++17 -O2 -Wall -I include -I native/include"
+FIRMWARE_FLAGS="-D HW_LILYGO2CAN -D NATIVE_BUILD"
+
+if [ -n "$TEST_BUILD_DIR" ]; then
+  BUILD_DIR="$TEST_BUILD_DIR"
+  mkdir -p "$BUILD_DIR" || exit 1
+else
+  BUILD_DIR="$(mktemp -d)" || exit 1
+  trap 'rm -rf "$BUILD_DIR"' EXIT
+fi
+
+# Sources linked with each test, besides its own file
+sources() {
+  case "$1" in
+    log_codec_test) echo "src/log_codec.cpp" ;;
+    gateway_rules_test) echo "$(find src native/src -name '*.cpp' ! -name native_main.cpp | sort)" ;;
+    popup_test) echo "src/alerts_journal.cpp src/popup.cpp native/src/arduino_stubs.cpp" ;;
+    *) return 1 ;;
+  esac
+}
+
+flags() {
+  case "$1" in
+    log_codec_test) ;;
+    *) echo "$FIRMWARE_FLAGS" ;;
+  esac
+}
+
+TESTS="${*:-log_codec_test gateway_rules_test popup_test}"
+failed=""
+
+for test in $TESTS; do
+  if ! src="$(sources "$test")"; then
+    echo "$test: unknown test"
+    failed="$failed $test"
+    continue
+  fi
+
+  echo "== $test"
+  # shellcheck disable=SC2046,SC2086 # Word splitting of the flag and source lists is intended
+  if ! "$CXX" $CXXFLAGS $(flags "$test") "native/tests/$test.cpp" $src -o "$BUILD_DIR/$test"; then
+    failed="$failed $test"
+    continue
+  fi
+  # Run from the build directory: the LittleFS stub of the firmware tests writes littlefs/ there
+  if ! (cd "$BUILD_DIR" && "./$test"); then
+    failed="$failed $test"
+  fi
+done
+
+if [ -n "$failed" ]; then
+  echo "FAILED:$failed"
+  exit 1
+fi
+echo "All tests passed"
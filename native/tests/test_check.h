@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * @file test_check.h
+ * @brief Checks and fixed-seed random numbers shared by the host tests
+ *
+ * Each test is one program that includes this header once: CHECK() counts
+ * and reports, testSummary() prints the totals and gives the exit status
+ * (0 when every check passes). Build and run them all with run_tests.sh.
+ */
+
+#include <cstdint>
+#include <cstdio>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define CHECK(condition) testCheck((condition), #condition, __FILE__, __LINE__)
+
+static unsigned long testChecks = 0;
+static unsigned long testFailures = 0;
+static uint32_t testSeedValue = 1;
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Count a check, print file, line and condition if it failed
+ * @return condition, so a failed check can print more details
+ */
+static inline bool testCheck(bool condition, const char* text, const char* file, int line) {
+  testChecks++;
+  if (!condition) {
+    testFailures++;
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+  }
+  return condition;
+}
+
+/**
+ * @brief Restart the random sequence, so each run sees the same data
+ */
+static inline void testSeed(uint32_t seed) {
+  testSeedValue = seed;
+}
+
+/**
+ * @brief Next fixed-seed random number (LCG, upper 24 bits)
+ */
+static inline uint32_t testRandom() {
+  testSeedValue = testSeedValue * 1103515245UL + 12345UL;
+  return testSeedValue >> 8;
+}
+
+/**
+ * @brief Next fixed-seed random byte (top bits of testRandom())
+ */
+static inline uint8_t testRandomByte() {
+  return testRandom() >> 16;
+}
+
+/**
+ * @brief Print "<n> checks, <m> failed"
+ * @return Exit status of the test: 0 when every check passed
+ */
+static inline int testSummary() {
+  printf("%lu checks, %lu failed\n", testChecks, testFailures);
+  return testFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/*
+ * @file log_decode.cpp
+ * @brief Drive log decoder (host tool): compressed blocks to candump -L
+ *
+ * Reads log files pulled from the adapter ("log dump <n>" saved to a file,
+ * see drive_log.h) and prints one candump log line per frame:
+ *
+ *   (1436509052.249713) can0 1A9#0102030405060708
+ *
+ * Blocks are found by their header anywhere in the input, so a dump
+ * captured with console text around it decodes as is; damaged blocks are
+ * skipped and counted. Frames are sorted by time inside each block.
+ *
+ * Build: g++ -std=gnu++17 -O2 -I include native/tools/log_decode.cpp src/log_codec.cpp -o log_decode
+ * Usage: log_decode [--tx] [--car IFACE] [--device IFACE] [FILE...]   (stdin without FILE)
+ */
+
+#include <log_codec.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+struct Options {
+  bool tx = false;                // Also print the frames sent by the adapter
+  const char* iface[4] = {"can0", "can1", NULL, NULL};  // CAN0, CAN1, then their TX names
+};
+
+struct BlockFrames {
+  const Options* options;
+  std::vector<LoggedFrame> frames;
+};
+
+static unsigned long blocksDecoded = 0;
+static unsigned long blocksDamaged = 0;
+static unsigned long framesPrinted = 0;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static void collectFrame(const LogBlockHeader*, const LoggedFrame* frame, void* context) {
+  BlockFrames* block = (BlockFrames*) context;
+  if (!frame->tx || block->options->tx) {
+    block->frames.push_back(*frame);
+  }
+}
+
+static void printFrame(const Options& options, const LogBlockHeader& header, const LoggedFrame& frame) {
+  long long us = (long long) header.epoch * 1000000LL + (int32_t) (frame.us - header.baseUs);
+  if (us < 0) {
+    us = 0;
+  }
+
+  printf("(%lld.%06lld) %s ", us / 1000000LL, us % 1000000LL, options.iface[frame.bus + (frame.tx ? 2 : 0)]);
+  if (frame.id & 0x80000000UL) {
+    printf("%08lX#", (unsigned long) (frame.id & 0x1FFFFFFFUL));
+  } else {
+    printf("%03lX#", (unsigned long) (frame.id & 0x7FF));
+  }
+  if (frame.id & 0x40000000UL) {
+    printf("R\n");
+  } else {
+    for (uint8_t i = 0; i < frame.dlc; i++) {
+      printf("%02X", frame.data[i]);
+    }
+    printf("\n");
+  }
+  framesPrinted++;
+}
+
+static void decodeBuffer(const Options& options, const std::vector<uint8_t>& input) {
+  size_t pos = 0;
+
+  while (pos + LOG_HEADER_SIZE <= input.size()) {
+    LogBlockHeader header;
+    if (!logParseHeader(&input[pos], &header) || pos + header.blockSize > input.size()) {
+      pos++; // Not a block start (console text, damaged block)
+      continue;
+    }
+
+    BlockFrames block;
+    block.options = &options;
+    if (logDecodeBlock(&input[pos], collectFrame, &block) < 0) {
+      blocksDamaged++;
+    } else {
+      blocksDecoded++;
+    }
+
+    // RX and TX frames are queued a few µs out of order
+    std::stable_sort(block.frames.begin(), block.frames.end(), [&header](const LoggedFrame& a, const LoggedFrame& b) {
+      return (int32_t) (a.us - header.baseUs) < (int32_t) (b.us - header.baseUs);
+    });
+    for (const LoggedFrame& frame : block.frames) {
+      printFrame(options, header, frame);
+    }
+    pos += header.blockSize;
+  }
+}
+
+static bool readFile(FILE* file, std::vector<uint8_t>& input) {
+  uint8_t buffer[65536];
+  size_t length;
+
+  input.clear();
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    input.insert(input.end(), buffer, buffer + length);
+  }
+  return !ferror(file);
+}
+
+static int usage(const char* program) {
+  fprintf(stderr, "Usage: %s [--tx] [--car IFACE] [--device IFACE] [FILE...]\n", program);
+  fprintf(stderr, "  --tx            also print the frames sent by the adapter (IFACE + \"tx\")\n");
+  fprintf(stderr, "  --car IFACE     interface name of CAN0 (default can0)\n");
+  fprintf(stderr, "  --device IFACE  interface name of CAN1 (default can1)\n");
+  return 2;
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+int main(int argc, char** argv) {
+  Options options;
+  static char txIface[2][64];
+  std::vector<const char*> files;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = (i + 1 < argc);
+    if (strcmp(argv[i], "--tx") == 0) {
+      options.tx = true;
+    } else if (strcmp(argv[i], "--car") == 0 && hasValue) {
+      options.iface[0] = argv[++i];
+    } else if (strcmp(argv[i], "--device") == 0 && hasValue) {
+      options.iface[1] = argv[++i];
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      return usage(argv[0]);
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+  for (int bus = 0; bus < 2; bus++) {
+    snprintf(txIface[bus], sizeof(txIface[bus]), "%stx", options.iface[bus]);
+    options.iface[bus + 2] = txIface[bus];
+  }
+
+  std::vector<uint8_t> input;
+  if (files.empty()) {
+    if (!readFile(stdin, input)) {
+      perror("stdin");
+      return 1;
+    }
+    decodeBuffer(options, input);
+  }
+  for (const char* name : files) {
+    FILE* file = fopen(name, "rb");
+    if (file == NULL || !readFile(file, input)) {
+      perror(name);
+      return 1;
+    }
+    fclose(file);
+    decodeBuffer(options, input);
+  }
+
+  fprintf(stderr, "%lu blocks, %lu damaged, %lu frames\n", blocksDecoded, blocksDamaged, framesPrinted);
+  return blocksDecoded > 0 ? 0 : 1;
+}
@@ -0,0 +1,406 @@
+/*
+ * @file alerts_journal.cpp
+ * @brief Table-driven decoding of the 0x120 alerts journal into popups
+ *
+ * Only called from the CAN0 path. To map a new journal bit, add an alert
+ * to JournalAlertIndex/journalAlerts and a row to the table of its block.
+ */
+
+#include <alerts_journal.h>
+#include <popup.h>
+
+// External variables from main.cpp
+extern bool isBVMP;
+
+// ============================================================================
+// TABLES
+// ============================================================================
+
+#define JOURNAL_BIT(byteIndex, bitIndex) ((byteIndex) * 8 + (bitIndex)) // Bytes 1-7
+#define JOURNAL_NO_PARAM 0xFF
+#define JOURNAL_NO_SIGNAL 0xFF
+
+struct JournalAlert {
+  uint16_t id;
+  uint16_t idBVMP; // ID used with a manual gearbox (isBVMP), 0 = same as id
+  byte priority;
+};
+
+struct JournalSignal {
+  byte bit;   // JOURNAL_BIT()
+  byte alert; // JournalAlertIndex
+  byte param; // Parameter bit set while the signal is raised, or JOURNAL_NO_PARAM
+};
+
+struct JournalBlock {
+  const JournalSignal* signals;
+  byte count;
+};
+
+enum JournalAlertIndex {
+  // Bloc 1
+  ALERT_OIL_PRESSURE,
+  ALERT_ENGINE_TEMPERATURE,
+  ALERT_CHARGING,
+  ALERT_BRAKING_STOP,
+  ALERT_POWER_STEERING_STOP,
+  ALERT_COOLANT_LEVEL,
+  ALERT_OIL_LEVEL,
+  ALERT_OPENINGS_WARNING,
+  ALERT_ESP_ASR,
+  ALERT_WATER_IN_DIESEL,
+  ALERT_BRAKE_PADS,
+  ALERT_FUEL_LOW,
+  ALERT_AIRBAG,
+  ALERT_ABS,
+  ALERT_PARTICLE_FILTER_FULL,
+  ALERT_PARTICLE_FILTER_ADDITIVE,
+  ALERT_SUSPENSION_REPAIR,
+  ALERT_IMMOBILISER,
+  ALERT_SCREENWASH,
+  ALERT_REMOTE_BATTERY,
+  // Bloc 2
+  ALERT_PUNCTURE,
+  ALERT_SIDELAMPS,
+  ALERT_DIPPED_BEAM,
+  ALERT_MAIN_BEAM,
+  ALERT_BRAKE_LAMPS,
+  ALERT_FOGLAMPS,
+  ALERT_DIRECTION_INDICATORS,
+  ALERT_REVERSING_LAMPS,
+  ALERT_PARKING_ASSISTANCE,
+  ALERT_TYRE_PRESSURE,
+  ALERT_EMISSIONS,
+  ALERT_EMISSIONS_START,
+  ALERT_P,
+  ALERT_ICE,
+  ALERT_OPENINGS, // Also fed by bloc 3
+  // Bloc 3
+  ALERT_PARKING_BRAKE,
+  ALERT_GEARBOX,
+  ALERT_SUSPENSION_90,
+  ALERT_TYRE_SENSOR,
+  ALERT_SUSPENSION_REPAIR_2,
+  ALERT_POWER_STEERING_REPAIR,
+  ALERT_UNDERINFLATED,
+  ALERT_ADBLUE_WARNING,
+  ALERT_ADBLUE_INFO,
+  ALERT_ADBLUE_START,
+  ALERT_COUNT
+};
+
+static_assert(ALERT_COUNT <= 64, "Dirty alerts are tracked in a 64-bit mask");
+
+static const JournalAlert journalAlerts[ALERT_COUNT] = {
+  {5, 0, 1},     // Engine oil pressure fault: stop the vehicle (STOP)
+  {1, 0, 1},     // Engine temperature fault: stop the vehicle (STOP)
+  {138, 0, 6},   // Charging system fault: repair needed (WARNING)
+  {106, 0, 1},   // Braking system fault: stop the vehicle (STOP)
+  {109, 0, 2},   // Power steering fault: stop the vehicle (STOP)
+  {3, 0, 4},     // Top up coolant level (WARNING)
+  {4, 0, 4},     // Top up engine oil level (WARNING)
+  {8, 0, 8},     // Door / boot / rear screen opened (WARNING)
+  {107, 0, 2},   // ESP/ASR system fault, repair the vehicle (WARNING)
+  {125, 0, 6},   // Water in diesel fuel filter (WARNING)
+  {103, 0, 6},   // Have brake pads replaced (WARNING)
+  {224, 0, 10},  // Fuel level low (INFO)
+  {120, 0, 6},   // Airbag(s) or seatbelt(s) pretensioner fault(s) (WARNING)
+  {106, 0, 2},   // ABS braking system fault, repair the vehicle (WARNING)
+  {15, 0, 4},    // Particle filter is full, please drive 20min to clean it (WARNING)
+  {129, 0, 6},   // Particle filter additive level low (WARNING)
+  {17, 0, 4},    // Suspension fault, repair the vehicle (WARNING)
+  {131, 0, 6},   // Electronic immobiliser fault (WARNING)
+  {223, 0, 10},  // Top Up screenwash fluid level (INFO)
+  {227, 0, 14},  // Replace remote control battery (INFO)
+  {13, 0, 6},    // Puncture: Replace or repair the wheel (STOP)
+  {160, 0, 6},   // Check sidelamps (WARNING)
+  {154, 0, 6},   // Check the dipped beam headlamps (WARNING)
+  {155, 0, 6},   // Check the main beam headlamps (WARNING)
+  {156, 0, 6},   // Check the RH brake lamp (WARNING) || Check the LH brake lamp (WARNING)
+  {157, 0, 6},   // Check the front / rear foglamps (WARNING)
+  {159, 0, 6},   // Check the direction indicators (WARNING)
+  {159, 0, 6},   // Check the reversing lamp(s) (WARNING)
+  {136, 0, 8},   // Parking assistance system fault (WARNING)
+  {13, 0, 8},    // Adjust tyre pressures (WARNING)
+  {190, 0, 8},   // Emissions fault (WARNING)
+  {192, 0, 8},   // Emissions fault: Starting Prevented (WARNING)
+  {215, 0, 10},  // "P" (INFO)
+  {216, 0, 10},  // Ice warning (INFO)
+  {222, 0, 8},   // Door / boot / rear screen opened (INFO)
+  {100, 0, 6},   // Parking brake fault (WARNING)
+  {110, 122, 4}, // Gearbox fault (WARNING)
+  {17, 0, 3},    // Suspension fault: limit your speed to 90km/h (WARNING)
+  {229, 0, 10},  // Sensor fault: tyre pressure not monitored (INFO)
+  {18, 0, 4},    // Suspension fault: repair the vehicle (WARNING)
+  {109, 0, 4},   // Power steering fault: repair the vehicle (WARNING)
+  {183, 0, 8},   // Underinflated wheel, ajust pressure and reset (INFO)
+  {188, 0, 6},   // Refill AdBlue (WARNING)
+  {187, 0, 10},  // Refill AdBlue (INFO)
+  {189, 0, 4},   // Impossible engine start, refill AdBlue (WARNING)
+};
+
+// Bloc 1 (byte 0 = 01xxxxxx)
+static const JournalSignal bloc1Signals[] = {
+  {JOURNAL_BIT(1, 7), ALERT_OIL_PRESSURE, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(1, 6), ALERT_ENGINE_TEMPERATURE, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(1, 5), ALERT_CHARGING, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(1, 4), ALERT_BRAKING_STOP, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(1, 2), ALERT_POWER_STEERING_STOP, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(1, 1), ALERT_COOLANT_LEVEL, JOURNAL_NO_PARAM},
+  // (1, 0): Fault with LKA (WARNING)
+  {JOURNAL_BIT(2, 7), ALERT_OIL_LEVEL, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(2, 5), ALERT_OPENINGS_WARNING, 7}, // Front right door
+  {JOURNAL_BIT(2, 4), ALERT_OPENINGS_WARNING, 6}, // Front left door
+  {JOURNAL_BIT(2, 3), ALERT_OPENINGS_WARNING, 5}, // Rear right door
+  {JOURNAL_BIT(2, 2), ALERT_OPENINGS_WARNING, 4}, // Rear left door
+  {JOURNAL_BIT(2, 0), ALERT_OPENINGS_WARNING, 3}, // Boot open
+  {JOURNAL_BIT(3, 7), ALERT_OPENINGS_WARNING, 1}, // Rear Screen open
+  // Parameter bits 2 (Hood open) and 0 (Fuel door open): source unknown
+  {JOURNAL_BIT(3, 6), ALERT_ESP_ASR, JOURNAL_NO_PARAM},
+  // (3, 5): Battery charge fault, stop the vehicle (WARNING)
+  {JOURNAL_BIT(3, 3), ALERT_WATER_IN_DIESEL, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(3, 2), ALERT_BRAKE_PADS, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(3, 1), ALERT_FUEL_LOW, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(3, 0), ALERT_AIRBAG, JOURNAL_NO_PARAM},
+  // (4, 6): Engine fault, repair the vehicle (WARNING)
+  {JOURNAL_BIT(4, 5), ALERT_ABS, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(4, 4), ALERT_PARTICLE_FILTER_FULL, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(4, 2), ALERT_PARTICLE_FILTER_ADDITIVE, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(4, 0), ALERT_SUSPENSION_REPAIR, JOURNAL_NO_PARAM},
+  // (5, 7): Preheating deactivated, battery charge too low (INFO)
+  // (5, 6): Preheating deactivated, fuel level too low (INFO)
+  // (5, 5): Check the centre brake lamp (WARNING)
+  // (5, 4): Retractable roof mechanism fault (WARNING)
+  // (5, 3): Steering lock fault, repair the vehicle (WARNING), priority 8, ID unknown
+  {JOURNAL_BIT(5, 2), ALERT_IMMOBILISER, JOURNAL_NO_PARAM},
+  // (5, 0): Roof operation not possible, system temperature too high (WARNING)
+  // (6, 7): Roof operation not possible, start the engine (WARNING)
+  // (6, 6): Roof operation not possible, apply parking brake (WARNING)
+  // (6, 5): Hybrid system fault (STOP)
+  // (6, 4): Automatic headlamp adjustment fault (WARNING)
+  // (6, 3): Hybrid system fault (WARNING)
+  // (6, 2): Hybrid system fault: speed restricted (WARNING)
+  {JOURNAL_BIT(6, 1), ALERT_SCREENWASH, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(6, 0), ALERT_REMOTE_BATTERY, JOURNAL_NO_PARAM},
+  // (7, 6): Preheating deactivated, set the clock (INFO)
+  // (7, 5): Trailer connection fault (WARNING)
+  // (7, 3): Tyre under-inflation (WARNING)
+  // (7, 2): Driving aid camera limited visibility (INFO)
+};
+
+// Bloc 2 (byte 0 = 10xxxxxx)
+static const JournalSignal bloc2Signals[] = {
+  // (1, 6): Electric mode not available : Particle filter regenerating (INFO)
+  {JOURNAL_BIT(1, 4), ALERT_PUNCTURE, 7}, // Front left tyre
+  {JOURNAL_BIT(1, 3), ALERT_PUNCTURE, 6}, // Front right tyre
+  {JOURNAL_BIT(1, 2), ALERT_PUNCTURE, 5}, // Rear right tyre
+  {JOURNAL_BIT(1, 1), ALERT_PUNCTURE, 4}, // Rear left tyre
+  {JOURNAL_BIT(1, 0), ALERT_SIDELAMPS, 7}, // Front right sidelamp
+  {JOURNAL_BIT(2, 7), ALERT_SIDELAMPS, 6}, // Front left sidelamp
+  {JOURNAL_BIT(2, 6), ALERT_SIDELAMPS, 5}, // Rear right sidelamp
+  {JOURNAL_BIT(2, 5), ALERT_SIDELAMPS, 4}, // Rear left sidelamp
+  {JOURNAL_BIT(2, 4), ALERT_DIPPED_BEAM, 7}, // Right dipped beam headlamp
+  {JOURNAL_BIT(2, 3), ALERT_DIPPED_BEAM, 6}, // Left dipped beam headlamp
+  {JOURNAL_BIT(2, 2), ALERT_MAIN_BEAM, 7}, // Right main beam headlamp
+  {JOURNAL_BIT(2, 1), ALERT_MAIN_BEAM, 6}, // Left main beam headlamp
+  {JOURNAL_BIT(2, 0), ALERT_BRAKE_LAMPS, 7}, // Right brake lamp
+  {JOURNAL_BIT(3, 7), ALERT_BRAKE_LAMPS, 6}, // Left brake lamp
+  {JOURNAL_BIT(3, 6), ALERT_FOGLAMPS, 7}, // Front right foglamp
+  {JOURNAL_BIT(3, 5), ALERT_FOGLAMPS, 6}, // Front left foglamp
+  {JOURNAL_BIT(3, 4), ALERT_FOGLAMPS, 5}, // Rear right foglamp
+  {JOURNAL_BIT(3, 3), ALERT_FOGLAMPS, 4}, // Rear left foglamp
+  {JOURNAL_BIT(3, 2), ALERT_DIRECTION_INDICATORS, 7}, // Front right direction indicator
+  {JOURNAL_BIT(3, 1), ALERT_DIRECTION_INDICATORS, 6}, // Front left direction indicator
+  {JOURNAL_BIT(3, 0), ALERT_DIRECTION_INDICATORS, 5}, // Rear right direction indicator
+  {JOURNAL_BIT(4, 7), ALERT_DIRECTION_INDICATORS, 4}, // Rear left direction indicator
+  {JOURNAL_BIT(4, 6), ALERT_REVERSING_LAMPS, 7}, // Right reversing lamp
+  {JOURNAL_BIT(4, 5), ALERT_REVERSING_LAMPS, 6}, // Left reversing lamp
+  {JOURNAL_BIT(5, 4), ALERT_PARKING_ASSISTANCE, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(5, 1), ALERT_TYRE_PRESSURE, 7}, // Front left tyre
+  {JOURNAL_BIT(5, 0), ALERT_TYRE_PRESSURE, 6}, // Front right tyre
+  {JOURNAL_BIT(6, 7), ALERT_TYRE_PRESSURE, 5}, // Rear right tyre
+  {JOURNAL_BIT(6, 5), ALERT_TYRE_PRESSURE, 4}, // Rear left tyre
+  // (6, 5): also Switch off lighting (INFO)
+  {JOURNAL_BIT(6, 3), ALERT_EMISSIONS, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(6, 1), ALERT_EMISSIONS, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(6, 2), ALERT_EMISSIONS_START, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(7, 5), ALERT_P, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(7, 4), ALERT_ICE, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(7, 3), ALERT_OPENINGS, 7}, // Front right door
+  {JOURNAL_BIT(7, 2), ALERT_OPENINGS, 6}, // Front left door
+  {JOURNAL_BIT(7, 1), ALERT_OPENINGS, 5}, // Rear right door
+  {JOURNAL_BIT(7, 0), ALERT_OPENINGS, 4}, // Rear left door
+};
+
+// Bloc 3 (byte 0 = 11xxxxxx)
+static const JournalSignal bloc3Signals[] = {
+  {JOURNAL_BIT(1, 7), ALERT_OPENINGS, 3}, // Boot open
+  {JOURNAL_BIT(1, 5), ALERT_OPENINGS, 1}, // Rear Screen open
+  // Parameter bits 2 (Hood open) and 0 (Fuel door open): source unknown
+  // (1, 6): Collision detection risk system fault (INFO)
+  {JOURNAL_BIT(2, 4), ALERT_PARKING_BRAKE, JOURNAL_NO_PARAM},
+  // (2, 3): Active spoiler fault: speed restricted (WARNING)
+  // (2, 2): Automatic braking system fault (INFO)
+  // (2, 1): Directional headlamps fault (WARNING)
+  {JOURNAL_BIT(3, 2), ALERT_GEARBOX, JOURNAL_NO_PARAM},
+  // (4, 2): Engine fault (WARNING)
+  {JOURNAL_BIT(4, 1), ALERT_SUSPENSION_90, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(5, 3), ALERT_TYRE_SENSOR, 7}, // Front left tyre
+  {JOURNAL_BIT(5, 2), ALERT_TYRE_SENSOR, 6}, // Front right tyre
+  {JOURNAL_BIT(5, 1), ALERT_TYRE_SENSOR, 5}, // Rear right tyre
+  {JOURNAL_BIT(5, 0), ALERT_TYRE_SENSOR, 4}, // Rear left tyre
+  {JOURNAL_BIT(6, 7), ALERT_SUSPENSION_REPAIR_2, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(6, 6), ALERT_POWER_STEERING_REPAIR, JOURNAL_NO_PARAM},
+  // (6, 3): Inter-vehicle time measurement fault (WARNING)
+  // (6, 2): Engine fault, stop the vehicle (STOP)
+  // (6, 1): Fault with LKA (INFO)
+  // (6, 0): Tyre under-inflation detection system fault (WARNING)
+  {JOURNAL_BIT(7, 7), ALERT_UNDERINFLATED, 7}, // Front left tyre
+  {JOURNAL_BIT(7, 6), ALERT_UNDERINFLATED, 6}, // Front right tyre
+  {JOURNAL_BIT(7, 5), ALERT_UNDERINFLATED, 5}, // Rear right tyre
+  // Parameter bit 4 (Rear left tyre): source unknown
+  // (7, 4): Spare wheel fitted: driving aids deactivated (INFO)
+  // (7, 3): Automatic braking disabled (INFO)
+  {JOURNAL_BIT(7, 2), ALERT_ADBLUE_WARNING, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(7, 1), ALERT_ADBLUE_INFO, JOURNAL_NO_PARAM},
+  {JOURNAL_BIT(7, 0), ALERT_ADBLUE_START, JOURNAL_NO_PARAM},
+};
+
+// Indexed by the block selector
+static const JournalBlock journalBlocks[JOURNAL_BLOCKS] = {
+  {NULL, 0}, // 00: not decoded
+  {bloc1Signals, sizeof(bloc1Signals) / sizeof(bloc1Signals[0])},
+  {bloc2Signals, sizeof(bloc2Signals) / sizeof(bloc2Signals[0])},
+  {bloc3Signals, sizeof(bloc3Signals) / sizeof(bloc3Signals[0])},
+};
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+// Built by journalBegin()
+static byte signalOfBit[JOURNAL_BLOCKS][64]; // Row of the block table, or JOURNAL_NO_SIGNAL
+static byte sourceOfBit[JOURNAL_BLOCKS][64]; // Bit of the signal in its alert's raised mask
+static uint64_t blockMask[JOURNAL_BLOCKS];   // Mapped bits
+
+static uint64_t lastPayload[JOURNAL_BLOCKS];
+static bool blockSeen[JOURNAL_BLOCKS];
+
+// Alert state, across blocks
+static byte alertRaised[ALERT_COUNT];     // One bit per signal
+static byte alertParameters[ALERT_COUNT];
+static uint64_t raisedAlerts = 0;         // Alerts with a raised signal
+static uint64_t sharedPopup[ALERT_COUNT]; // Alerts with the same popup ID (itself included), built by journalBegin()
+
+// Statistics
+static unsigned long journalFrames = 0;
+static unsigned long unchangedFrames = 0;
+static unsigned long changedBits = 0;
+static unsigned long alertUpdates = 0;
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void journalBegin() {
+  byte sources[ALERT_COUNT] = {0};
+
+  // Several alerts show the same popup (106, 109, 13, 17, 159): it stays open while any of them is raised.
+  // idBVMP IDs are not shared
+  for (byte a = 0; a < ALERT_COUNT; a++) {
+    sharedPopup[a] = 0;
+    for (byte b = 0; b < ALERT_COUNT; b++) {
+      if (journalAlerts[b].id == journalAlerts[a].id) {
+        sharedPopup[a] |= 1ULL << b;
+      }
+    }
+  }
+
+  memset(signalOfBit, JOURNAL_NO_SIGNAL, sizeof(signalOfBit));
+  for (byte block = 0; block < JOURNAL_BLOCKS; block++) {
+    blockMask[block] = 0;
+    for (byte row = 0; row < journalBlocks[block].count; row++) {
+      const JournalSignal& signal = journalBlocks[block].signals[row];
+      signalOfBit[block][signal.bit] = row;
+      sourceOfBit[block][signal.bit] = sources[signal.alert]++;
+      blockMask[block] |= 1ULL << signal.bit;
+    }
+  }
+}
+
+void journalDecode(const struct can_frame& frame) {
+  byte block = frame.data[0] >> 6;
+  uint64_t payload = 0;
+  uint64_t changed;
+  uint64_t dirty = 0;
+
+  for (byte i = 1; i < 8; i++) {
+    payload |= (uint64_t) frame.data[i] << (8 * i);
+  }
+
+  journalFrames++;
+  changed = payload ^ lastPayload[block];
+  if (!blockSeen[block]) {
+    changed = ~0ULL; // First frame of the block: report every alert once
+    blockSeen[block] = true;
+  }
+  lastPayload[block] = payload;
+  changed &= blockMask[block];
+
+  if (changed == 0) {
+    unchangedFrames++;
+    return;
+  }
+
+  while (changed) {
+    byte bit = __builtin_ctzll(changed);
+    changed &= changed - 1;
+    changedBits++;
+
+    const JournalSignal& signal = journalBlocks[block].signals[signalOfBit[block][bit]];
+    bool raised = (payload >> bit) & 1;
+    bitWrite(alertRaised[signal.alert], sourceOfBit[block][bit], raised);
+    if (signal.param != JOURNAL_NO_PARAM) {
+      bitWrite(alertParameters[signal.alert], signal.param, raised);
+    }
+    if (alertRaised[signal.alert] != 0) {
+      raisedAlerts |= 1ULL << signal.alert;
+    } else {
+      raisedAlerts &= ~(1ULL << signal.alert);
+    }
+    dirty |= 1ULL << signal.alert;
+  }
+
+  while (dirty) {
+    byte index = __builtin_ctzll(dirty);
+    uint64_t raised = sharedPopup[index] & raisedAlerts;
+    dirty &= ~sharedPopup[index]; // One report per popup
+    alertUpdates++;
+
+    // The most urgent raised alert of the popup gives priority and parameters
+    byte shown = index;
+    while (raised) {
+      byte other = __builtin_ctzll(raised);
+      raised &= raised - 1;
+      if (!((raisedAlerts >> shown) & 1) || journalAlerts[other].priority < journalAlerts[shown].priority) {
+        shown = other;
+      }
+    }
+
+    const JournalAlert& alert = journalAlerts[shown];
+    uint16_t id = (isBVMP && alert.idBVMP != 0) ? alert.idBVMP : alert.id;
+    popupSet(((raisedAlerts >> shown) & 1), id, alert.priority, alertParameters[shown]);
+  }
+}
+
+void journalPrintStats() {
+  Serial.print("Alerts journal: ");
+  Serial.print(journalFrames);
+  Serial.print(" frames, ");
+  Serial.print(unchangedFrames);
+  Serial.print(" unchanged, ");
+  Serial.print(changedBits);
+  Serial.print(" changed bits, ");
+  Serial.print(alertUpdates);
+  Serial.println(" alert updates");
+}
@@ -0,0 +1,131 @@
+/*
+ * @file boot_timing.cpp
+ * @brief Boot-to-first-forwarded-frame timing
+ *
+ * Milestones come from setup(), the RX task (controller up) and both gateway
+ * paths, so they are recorded under a spinlock. A frame counts as forwarded
+ * when handling it queued at least one frame on the other bus.
+ */
+
+#include <boot_timing.h>
+#include <can_bus.h>
+#include <capture.h>
+#include <freertos/FreeRTOS.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+volatile bool bootForwardPending = true;
+
+static const char* const stageNames[BOOT_STAGES] = {"CAN0 up", "CAN1 up", "setup done", "first RX", "first forward"};
+
+static unsigned long stageAt[BOOT_STAGES];
+static bool stageSeen[BOOT_STAGES];
+static byte forwardBus = 0;     // Bus the first forwarded frame was received on
+static canid_t forwardId = 0;
+static portMUX_TYPE bootMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static void putTime(byte* data, BootStage stage) {
+  unsigned long ms = stageSeen[stage] ? stageAt[stage] : 0;
+  if (ms > 0xFFFF) {
+    ms = 0xFFFF;
+  }
+  data[0] = ms & 0xFF;
+  data[1] = ms >> 8;
+}
+
+// Boot record in the capture stream (layout in capture.h)
+static void captureBoot() {
+  struct can_frame record;
+
+  record.can_id = CAPTURE_BOOT_ID;
+  record.can_dlc = 8;
+  putTime(record.data, BOOT_FIRST_FORWARD);
+  putTime(record.data + 2, BOOT_CAN0_UP);
+  putTime(record.data + 4, BOOT_CAN1_UP);
+  putTime(record.data + 6, BOOT_SETUP_DONE);
+  captureFrame(forwardBus, &record, false);
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void bootTimingMark(BootStage stage) {
+  unsigned long now = millis();
+
+  portENTER_CRITICAL(&bootMux);
+  if (!stageSeen[stage]) {
+    stageAt[stage] = now;
+    stageSeen[stage] = true;
+  }
+  portEXIT_CRITICAL(&bootMux);
+}
+
+unsigned long bootTimingAt(BootStage stage) {
+  return stageSeen[stage] ? stageAt[stage] : 0;
+}
+
+unsigned long bootTimingEnter(byte bus) {
+  if (!stageSeen[BOOT_FIRST_RX]) {
+    bootTimingMark(BOOT_FIRST_RX);
+  }
+  return canTxStats(bus ^ 1).queued;
+}
+
+void bootTimingLeave(byte bus, canid_t id, unsigned long txBefore) {
+  if (canTxStats(bus ^ 1).queued == txBefore) {
+    return; // Dropped or only answered on the same bus
+  }
+
+  unsigned long now = millis();
+  bool first;
+  portENTER_CRITICAL(&bootMux);
+  first = bootForwardPending;
+  if (first) {
+    bootForwardPending = false;
+    stageAt[BOOT_FIRST_FORWARD] = now;
+    stageSeen[BOOT_FIRST_FORWARD] = true;
+    forwardBus = bus;
+    forwardId = id;
+  }
+  portEXIT_CRITICAL(&bootMux);
+
+  if (!first) {
+    return;
+  }
+  if (captureActive()) {
+    captureBoot();
+  } else if (SerialEnabled) {
+    bootTimingPrint();
+  }
+}
+
+void bootTimingPrint() {
+  Serial.print("Boot:");
+  for (byte stage = 0; stage < BOOT_STAGES; stage++) {
+    Serial.print(stage == 0 ? " " : ", ");
+    Serial.print(stageNames[stage]);
+    Serial.print("=");
+    if (stageSeen[stage]) {
+      Serial.print(stageAt[stage]);
+      Serial.print(" ms");
+    } else {
+      Serial.print("-");
+    }
+  }
+  if (stageSeen[BOOT_FIRST_FORWARD]) {
+    Serial.print(" (0x");
+    Serial.print((unsigned long) forwardId, HEX);
+    Serial.print(forwardBus == BUS_CAN0 ? " CAN0 > CAN1)" : " CAN1 > CAN0)");
+  }
+  Serial.println();
+}
@@ -0,0 +1,192 @@
+/*
+ * @file buttons.cpp
+ * @brief Table-driven button state machine (debounce, long press, accelerating repeat)
+ *
+ * Groups are declared in setup(), then each one is only touched by the task
+ * that updates it. All times are kept in µs from the caller's timestamps;
+ * the tables are in ms.
+ */
+
+#include <buttons.h>
+#include <config.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define NO_ACTION -1
+
+struct ActionStats {
+  unsigned long presses;
+  unsigned long repeats;
+  unsigned long longPresses;
+  unsigned long minLatencyUs;
+  unsigned long maxLatencyUs;
+  uint64_t latencySumUs;
+};
+
+struct ButtonGroup {
+  const char* name;
+  const ButtonAction* actions;
+  byte count;
+  unsigned long debounceUs;
+
+  uint8_t raw;               // Last sample
+  uint8_t accepted;          // Debounced inputs
+  unsigned long rawSinceUs;  // Tick at which raw last changed
+  int8_t active;             // Pressed action, NO_ACTION when none
+  unsigned long pressUs;     // Start of the press (change of the inputs)
+  unsigned long nextRepeatUs;
+  bool longPending;
+
+  ActionStats stats[BUTTON_MAX_ACTIONS];
+};
+
+static ButtonGroup groups[BUTTON_MAX_GROUPS];
+static byte groupCount = 0;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static int8_t findAction(const ButtonGroup& group, uint8_t inputs) {
+  for (byte i = 0; i < group.count; i++) {
+    if ((inputs & group.actions[i].mask) == group.actions[i].code) {
+      return i;
+    }
+  }
+  return NO_ACTION;
+}
+
+static void pressAction(ButtonGroup& group, int8_t index) {
+  const ButtonAction& action = group.actions[index];
+  ActionStats& stats = group.stats[index];
+
+  group.active = index;
+  group.pressUs = group.rawSinceUs;
+  group.nextRepeatUs = group.pressUs + action.repeatDelayMs * 1000UL;
+  group.longPending = (action.longPressMs != 0);
+
+  action.handler(action, BUTTON_PRESS);
+
+  unsigned long latencyUs = micros() - group.pressUs;
+  if (stats.presses == 0 || latencyUs < stats.minLatencyUs) {
+    stats.minLatencyUs = latencyUs;
+  }
+  if (latencyUs > stats.maxLatencyUs) {
+    stats.maxLatencyUs = latencyUs;
+  }
+  stats.latencySumUs += latencyUs;
+  stats.presses++;
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+int8_t buttonsAddGroup(const char* name, const ButtonAction* actions, byte count, uint16_t debounceMs) {
+  if (groupCount >= BUTTON_MAX_GROUPS || count > BUTTON_MAX_ACTIONS) {
+    return -1;
+  }
+
+  ButtonGroup& group = groups[groupCount];
+  group.name = name;
+  group.actions = actions;
+  group.count = count;
+  group.debounceUs = debounceMs * 1000UL;
+  group.raw = 0;
+  group.accepted = 0;
+  group.rawSinceUs = 0;
+  group.active = NO_ACTION;
+  memset(group.stats, 0, sizeof(group.stats));
+  return groupCount++;
+}
+
+void buttonsUpdate(int8_t index, uint8_t inputs, unsigned long nowUs) {
+  ButtonGroup& group = groups[index];
+
+  if (inputs != group.raw) {
+    group.raw = inputs;
+    group.rawSinceUs = nowUs;
+  }
+
+  if (group.raw != group.accepted && nowUs - group.rawSinceUs >= group.debounceUs) {
+    group.accepted = group.raw;
+    int8_t action = findAction(group, group.accepted);
+    if (action != group.active) {
+      if (group.active != NO_ACTION) {
+        const ButtonAction& released = group.actions[group.active];
+        group.active = NO_ACTION;
+        released.handler(released, BUTTON_RELEASE);
+      }
+      if (action != NO_ACTION) {
+        pressAction(group, action);
+      }
+    }
+    return;
+  }
+
+  if (group.active == NO_ACTION) {
+    return;
+  }
+
+  const ButtonAction& action = group.actions[group.active];
+  ActionStats& stats = group.stats[group.active];
+  unsigned long heldUs = nowUs - group.pressUs;
+
+  if (group.longPending && heldUs >= action.longPressMs * 1000UL) {
+    group.longPending = false;
+    stats.longPresses++;
+    action.handler(action, BUTTON_LONG);
+  }
+  if (action.repeatDelayMs != 0 && (long) (nowUs - group.nextRepeatUs) >= 0) {
+    bool fast = (action.fastAfterMs != 0 && heldUs >= action.fastAfterMs * 1000UL);
+    group.nextRepeatUs = nowUs + (fast ? action.fastRepeatMs : action.repeatMs) * 1000UL;
+    stats.repeats++;
+    action.handler(action, BUTTON_REPEAT);
+  }
+}
+
+bool buttonsHeld(int8_t index) {
+  return groups[index].active != NO_ACTION;
+}
+
+void buttonsPrintStats() {
+  if (groupCount == 0) {
+    return;
+  }
+  Serial.println("Buttons: group/action | presses, repeats, long | press to frame min/avg/max (us)");
+
+  for (byte g = 0; g < groupCount; g++) {
+    const ButtonGroup& group = groups[g];
+    for (byte i = 0; i < group.count; i++) {
+      const ActionStats& stats = group.stats[i];
+      Serial.print("  ");
+      Serial.print(group.name);
+      Serial.print("/");
+      Serial.print(group.actions[i].name);
+      Serial.print(" | ");
+      Serial.print(stats.presses);
+      Serial.print(", ");
+      Serial.print(stats.repeats);
+      Serial.print(", ");
+      Serial.print(stats.longPresses);
+      Serial.print(" | ");
+      if (stats.presses == 0) {
+        Serial.println("-");
+        continue;
+      }
+      Serial.print(stats.minLatencyUs);
+      Serial.print("/");
+      Serial.print((unsigned long) (stats.latencySumUs / stats.presses));
+      Serial.print("/");
+      Serial.println(stats.maxLatencyUs);
+    }
+  }
+}
+
+void buttonsResetStats() {
+  for (byte g = 0; g < groupCount; g++) {
+    memset(groups[g].stats, 0, sizeof(groups[g].stats));
+  }
+}
@@ -0,0 +1,614 @@
+/*
+ * @file can_bus.cpp
+ * @brief Interrupt-driven CAN reception and shared controller access
+ *
+ * The RX task is woken by the MCP2515 INT lines and drains RXB0/RXB1 of both
+ * controllers into one single-producer/single-consumer ring per bus. Each ring
+ * has one consumer: loop() for CAN0, loop() or the gateway device task for
+ * CAN1. When no INT pin is configured the same drain runs from
+ * canBusService() at the top of every loop() pass.
+ *
+ * canSend() never waits for the controller: frames go into a per-bus queue
+ * kept sorted by arbitration ID, and the pump loads the three TX buffers from
+ * its head. TXP priorities of the loaded buffers follow their IDs, so the
+ * controller also sends the lowest ID first. The pump runs from canSend() and
+ * again on every TX-complete interrupt (or canBusService() pass).
+ */
+
+#include <can_bus.h>
+#include <mcp2515_spi.h>
+#include <echo_filter.h>
+#include <config.h>
+#include <settings.h>
+#include <latency.h>
+#include <capture.h>
+#include <boot_timing.h>
+#include <flight_recorder.h>
+#include <drive_log.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+// External variables from main.cpp
+extern MCP2515 CAN0;
+extern MCP2515 CAN1;
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+// MCP2515 registers not exposed by the library
+#define MCP_CANINTE 0x2B
+#define MCP_TXB_ABTF 0x40      // TXBnCTRL: message aborted
+#define MCP_TXB_TXREQ 0x08     // TXBnCTRL: transmission requested
+#define MCP_TXB_TXP_MASK 0x03
+#define TX_BUFFER_COUNT 3
+#define TX_BUFFER_FREE 0xFFFFFFFF
+#define TX_BUFFER_NONE -1
+
+static const uint8_t txCtrlRegs[TX_BUFFER_COUNT] = {0x30, 0x40, 0x50};  // TXB0CTRL..TXB2CTRL
+
+static_assert((CAN_RX_RING_SIZE & (CAN_RX_RING_SIZE - 1)) == 0, "CAN_RX_RING_SIZE must be a power of two");
+
+struct CanRxRing {
+  struct can_frame frames[CAN_RX_RING_SIZE];
+#ifdef GATEWAY_LATENCY
+  unsigned long rxUs[CAN_RX_RING_SIZE];
+#endif
+  std::atomic<unsigned int> head;  // Written by the producer (RX task)
+  std::atomic<unsigned int> tail;  // Written by the consumer (loop)
+};
+
+struct CanTxEntry {
+  struct can_frame frame;
+  unsigned long queuedAt;  // micros() when canSend() was called
+#ifdef GATEWAY_LATENCY
+  LatencyOrigin origin;
+#endif
+};
+
+// Pending frames sorted by arbitration ID, FIFO among equal IDs
+struct CanTxQueue {
+  CanTxEntry entries[CAN_TX_QUEUE_SIZE];
+  unsigned int count;
+  canid_t loadedId[TX_BUFFER_COUNT];    // ID in each TX buffer, TX_BUFFER_FREE if empty
+  unsigned long loadedSeq[TX_BUFFER_COUNT];
+  uint8_t loadedPrio[TX_BUFFER_COUNT];  // TXP currently written to the controller
+  CanTxEntry loaded[TX_BUFFER_COUNT];   // Copy of each loaded frame, requeued if its abort succeeds
+  unsigned long loadedAt[TX_BUFFER_COUNT];
+  int8_t aborting;                      // Buffer whose TXREQ was cleared, TX_BUFFER_NONE if none
+  unsigned long seq;
+};
+
+static CanRxRing rxRing[BUS_COUNT];
+static CanRxStats rxStats[BUS_COUNT];
+static CanTxQueue txQueue[BUS_COUNT];
+static CanTxStats txStats[BUS_COUNT];
+static SemaphoreHandle_t canLock[BUS_COUNT] = {NULL, NULL};
+static TaskHandle_t rxTaskHandle = NULL;
+static TaskHandle_t rxConsumer[BUS_COUNT] = {NULL, NULL};
+static const int intPins[BUS_COUNT] = {INT_PIN_CAN0, INT_PIN_CAN1};
+static volatile bool busUp[BUS_COUNT] = {false, false}; // Controller in normal mode
+static unsigned long lastBringUp = 0;
+static CanBusUpHandler busUpHandler = NULL;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static MCP2515& controller(byte bus) {
+  return (bus == BUS_CAN0) ? CAN0 : CAN1;
+}
+
+static void lockBus(byte bus) {
+  if (canLock[bus] != NULL) {
+    xSemaphoreTake(canLock[bus], portMAX_DELAY);
+  }
+}
+
+static void unlockBus(byte bus) {
+  if (canLock[bus] != NULL) {
+    xSemaphoreGive(canLock[bus]);
+  }
+}
+
+// Give the lowest loaded ID the highest TXP (3), oldest first among equal IDs
+static void assignTxPriorities(byte bus) {
+  CanTxQueue& queue = txQueue[bus];
+
+  for (byte b = 0; b < TX_BUFFER_COUNT; b++) {
+    if (queue.loadedId[b] == TX_BUFFER_FREE) {
+      continue;
+    }
+
+    uint8_t prio = 3;
+    for (byte o = 0; o < TX_BUFFER_COUNT; o++) {
+      if (o == b || queue.loadedId[o] == TX_BUFFER_FREE) {
+        continue;
+      }
+      if (queue.loadedId[o] < queue.loadedId[b] || (queue.loadedId[o] == queue.loadedId[b] && queue.loadedSeq[o] < queue.loadedSeq[b])) {
+        prio--;
+      }
+    }
+
+    if (prio != queue.loadedPrio[b]) {
+      mcpModifyRegister(bus, txCtrlRegs[b], MCP_TXB_TXP_MASK, prio);
+      queue.loadedPrio[b] = prio;
+    }
+  }
+}
+
+// Insert an entry by arbitration ID, dropping the lowest-priority frame if full.
+// FIFO among equal IDs, except for a frame taken back from a TX buffer: it goes ahead of them
+static bool insertTx(byte bus, const CanTxEntry& entry, bool ahead) {
+  CanTxQueue& queue = txQueue[bus];
+  CanTxStats& stats = txStats[bus];
+  canid_t id = entry.frame.can_id;
+
+  if (queue.count >= CAN_TX_QUEUE_SIZE) {
+    stats.drops++;
+    flightRecorderTrigger(FLIGHT_TRIGGER_TX_DROP, bus);
+    canid_t last = queue.entries[CAN_TX_QUEUE_SIZE - 1].frame.can_id;
+    if (ahead ? id > last : id >= last) {
+      return false;
+    }
+    queue.count--;
+  }
+
+  unsigned int pos = queue.count;
+  while (pos > 0 && (queue.entries[pos - 1].frame.can_id > id || (ahead && queue.entries[pos - 1].frame.can_id == id))) {
+    queue.entries[pos] = queue.entries[pos - 1];
+    pos--;
+  }
+  queue.entries[pos] = entry;
+  queue.count++;
+
+  if (queue.count > stats.highWater) {
+    stats.highWater = queue.count;
+  }
+  return true;
+}
+
+// Insert a frame from canSend()
+static bool enqueueTx(byte bus, const struct can_frame* frame) {
+  CanTxEntry entry;
+  entry.frame = *frame;
+  entry.queuedAt = micros();
+#ifdef GATEWAY_LATENCY
+  entry.origin = latencyEnabled ? latencyCurrent() : LatencyOrigin();
+#endif
+
+  if (!insertTx(bus, entry, false)) {
+    return false;
+  }
+  txStats[bus].queued++;
+  return true;
+}
+
+// Put an aborted frame back in the queue; it is counted as sent again when reloaded
+static void requeueTx(byte bus, byte b) {
+  CanTxQueue& queue = txQueue[bus];
+  CanTxStats& stats = txStats[bus];
+  CanTxEntry entry = queue.loaded[b];
+
+  stats.aborted++;
+  stats.sent--;
+  stats.delayUs -= queue.loadedAt[b] - entry.queuedAt;
+#ifdef GATEWAY_LATENCY
+  entry.origin.valid = false; // Recorded when first loaded
+#endif
+  insertTx(bus, entry, true);
+}
+
+// Free the buffers whose TXREQ is clear. A buffer being aborted has either been
+// sent meanwhile or aborted (ABTF set); an aborted frame is requeued
+static void releaseTxBuffers(byte bus) {
+  CanTxQueue& queue = txQueue[bus];
+
+  // READ STATUS: TXREQ of TXB0/1/2 on bits 2/4/6
+  uint8_t status = mcpReadStatus(bus);
+  for (byte b = 0; b < TX_BUFFER_COUNT; b++) {
+    if (queue.loadedId[b] == TX_BUFFER_FREE || (status & (0x04 << (2 * b)))) {
+      continue;
+    }
+    if (queue.aborting == b) {
+      if (mcpReadRegister(bus, txCtrlRegs[b]) & MCP_TXB_ABTF) {
+        requeueTx(bus, b); // ABTF is cleared by the next TXREQ
+      }
+      queue.aborting = TX_BUFFER_NONE;
+    }
+    queue.loadedId[b] = TX_BUFFER_FREE;
+  }
+}
+
+// Clear TXREQ of the highest-ID buffer when every buffer is loaded and the head of
+// the queue has a lower ID. Returns true if an abort was requested
+static bool abortTxBuffer(byte bus) {
+  CanTxQueue& queue = txQueue[bus];
+  int8_t last = TX_BUFFER_NONE;
+
+  if (queue.count == 0 || queue.aborting != TX_BUFFER_NONE) {
+    return false;
+  }
+  for (byte b = 0; b < TX_BUFFER_COUNT; b++) {
+    if (queue.loadedId[b] == TX_BUFFER_FREE) {
+      return false;
+    }
+    if (last == TX_BUFFER_NONE || queue.loadedId[b] > queue.loadedId[last] || (queue.loadedId[b] == queue.loadedId[last] && queue.loadedSeq[b] > queue.loadedSeq[last])) {
+      last = b;
+    }
+  }
+  if (queue.entries[0].frame.can_id >= queue.loadedId[last]) {
+    return false;
+  }
+
+  mcpModifyRegister(bus, txCtrlRegs[last], MCP_TXB_TXREQ, 0);
+  queue.aborting = last;
+  return true;
+}
+
+// Load free TX buffers from the head of the queue (caller holds the bus lock).
+// A lower ID waiting behind three loaded frames aborts the highest one. A frame not
+// started yet is aborted at once and its buffer refilled in the same pass; one on
+// the bus finishes or loses arbitration, and the next pass frees the buffer
+static void pumpTx(byte bus) {
+  CanTxQueue& queue = txQueue[bus];
+  CanTxStats& stats = txStats[bus];
+  unsigned long spiStart = micros();
+
+  for (byte pass = 0; pass < 2; pass++) {
+    releaseTxBuffers(bus);
+
+    for (byte b = 0; b < TX_BUFFER_COUNT && queue.count > 0; b++) {
+      if (queue.loadedId[b] != TX_BUFFER_FREE) {
+        continue;
+      }
+
+      const CanTxEntry& entry = queue.entries[0];
+      queue.loadedId[b] = entry.frame.can_id;
+      queue.loadedSeq[b] = queue.seq++;
+      assignTxPriorities(bus); // TXP is set before TXREQ so the frame never competes with a stale priority
+
+      mcpLoadTx(bus, b, &entry.frame);
+      unsigned long loadedAt = micros();
+      stats.spiUs += loadedAt - spiStart;
+      if (settings.debugCaptureTx && captureActive()) {
+        captureFrame(bus, &entry.frame, true);
+      }
+      flightRecord(bus, &entry.frame, true, loadedAt);
+      driveLog(bus, &entry.frame, true, loadedAt);
+      stats.sent++;
+      stats.delayUs += loadedAt - entry.queuedAt;
+#ifdef GATEWAY_LATENCY
+      if (entry.origin.valid) {
+        latencyRecord(entry.origin, bus, loadedAt);
+      }
+#endif
+      queue.loaded[b] = entry;
+      queue.loadedAt[b] = loadedAt;
+
+      queue.count--;
+      memmove(&queue.entries[0], &queue.entries[1], queue.count * sizeof(CanTxEntry));
+      spiStart = micros();
+    }
+
+    if (pass > 0 || !abortTxBuffer(bus)) {
+      break;
+    }
+  }
+  stats.spiUs += micros() - spiStart;
+}
+
+// Move every pending frame of one controller into its ring and refill its TX buffers
+static void drainController(byte bus) {
+  MCP2515& can = controller(bus);
+  CanRxRing& ring = rxRing[bus];
+  CanRxStats& stats = rxStats[bus];
+  struct can_frame frames[MCP_RX_BUFFERS];
+  unsigned long received = stats.received;
+  byte count;
+
+  if (!busUp[bus]) {
+    return; // Still in configuration mode, retried by bringUpPending()
+  }
+
+  lockBus(bus);
+  unsigned long spiStart = micros();
+  while ((count = mcpReadMessages(bus, frames)) > 0) {
+    unsigned long readAt = micros();
+    for (byte i = 0; i < count; i++) {
+      flightRecord(bus, &frames[i], false, readAt);
+      driveLog(bus, &frames[i], false, readAt);
+
+      unsigned int head = ring.head.load(std::memory_order_relaxed);
+      unsigned int used = head - ring.tail.load(std::memory_order_acquire);
+
+      if (used >= CAN_RX_RING_SIZE) {
+        stats.ringOverruns++; // Keep the oldest frames, loop() is behind
+        continue;
+      }
+
+      ring.frames[head & (CAN_RX_RING_SIZE - 1)] = frames[i];
+#ifdef GATEWAY_LATENCY
+      ring.rxUs[head & (CAN_RX_RING_SIZE - 1)] = latencyEnabled ? micros() : 0;
+#endif
+      ring.head.store(head + 1, std::memory_order_release);
+
+      stats.received++;
+      if (used + 1 > stats.highWater) {
+        stats.highWater = used + 1;
+      }
+    }
+  }
+
+  // RX0OVR/RX1OVR raise ERRIF and keep INT asserted until cleared
+  uint8_t irq = can.getInterrupts();
+  if (irq & (MCP2515::CANINTF_ERRIF | MCP2515::CANINTF_MERRF)) {
+    uint8_t eflg = can.getErrorFlags();
+    if (eflg & MCP2515::EFLG_RX0OVR) stats.hwOverruns++;
+    if (eflg & MCP2515::EFLG_RX1OVR) stats.hwOverruns++;
+    if (eflg & (MCP2515::EFLG_RX0OVR | MCP2515::EFLG_RX1OVR)) {
+      can.clearRXnOVRFlags();
+    }
+    can.clearERRIF();
+    can.clearMERR();
+  }
+  if (irq & (MCP2515::CANINTF_TX0IF | MCP2515::CANINTF_TX1IF | MCP2515::CANINTF_TX2IF)) {
+    can.clearTXInterrupts();
+  }
+  stats.spiUs += micros() - spiStart;
+  pumpTx(bus);
+  unlockBus(bus);
+
+  if (rxConsumer[bus] != NULL && stats.received != received) {
+    xTaskNotifyGive(rxConsumer[bus]);
+  }
+}
+
+// Retry the controllers that are not in normal mode yet
+static void bringUpPending() {
+  if ((busUp[BUS_CAN0] && busUp[BUS_CAN1]) || millis() - lastBringUp < CAN_BRINGUP_RETRY_MS) {
+    return;
+  }
+
+  lastBringUp = millis();
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    if (!busUp[bus]) {
+      canBusRecover(bus);
+    }
+  }
+}
+
+static bool interruptPending() {
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    if (intPins[bus] >= 0 && digitalRead(intPins[bus]) == LOW) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void IRAM_ATTR canIntISR() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(rxTaskHandle, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+static void canRxTask(void*) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAN_RX_POLL_MS));
+
+    // INT is level triggered: keep draining while a controller still holds it low
+    byte rounds = 0;
+    do {
+      drainController(BUS_CAN0);
+      drainController(BUS_CAN1);
+    } while (interruptPending() && ++rounds < 4);
+
+    bringUpPending();
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void canBusBegin() {
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    canLock[bus] = xSemaphoreCreateMutex();
+    for (byte b = 0; b < TX_BUFFER_COUNT; b++) {
+      txQueue[bus].loadedId[b] = TX_BUFFER_FREE;
+    }
+    txQueue[bus].aborting = TX_BUFFER_NONE;
+  }
+
+  // One attempt each, back to back: neither controller waits for the other
+  lastBringUp = millis();
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    if (!canBusRecover(bus) && SerialEnabled) {
+      Serial.print("CAN");
+      Serial.print(bus);
+      Serial.println(": not in normal mode yet, retrying in the background");
+    }
+  }
+
+  if (intPins[BUS_CAN0] < 0 || intPins[BUS_CAN1] < 0) {
+    if (SerialEnabled) {
+      Serial.println("CAN RX: polled mode (no INT pin configured)");
+    }
+    return;
+  }
+
+  if (xTaskCreatePinnedToCore(canRxTask, "canRx", 4096, NULL, CAN_RX_TASK_PRIORITY, &rxTaskHandle, CAN_RX_TASK_CORE) != pdPASS) {
+    rxTaskHandle = NULL;
+    if (SerialEnabled) {
+      Serial.println("CAN RX: unable to start RX task, polled mode");
+    }
+    return;
+  }
+
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    // reset() enables RX and error interrupts only, add TX complete to refill the TX buffers
+    lockBus(bus);
+    mcpModifyRegister(bus, MCP_CANINTE, MCP2515::CANINTF_TX0IF | MCP2515::CANINTF_TX1IF | MCP2515::CANINTF_TX2IF, 0xFF);
+    unlockBus(bus);
+
+    pinMode(intPins[bus], INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(intPins[bus]), canIntISR, FALLING);
+  }
+  xTaskNotifyGive(rxTaskHandle); // Frames may already be waiting
+
+  if (SerialEnabled) {
+    Serial.println("CAN RX: interrupt mode");
+  }
+}
+
+void canBusService() {
+  if (rxTaskHandle == NULL) {
+    drainController(BUS_CAN0);
+    drainController(BUS_CAN1);
+    bringUpPending();
+  }
+}
+
+bool canBusReady(byte bus) {
+  return busUp[bus];
+}
+
+bool canReceive(byte bus, struct can_frame* frame) {
+  CanRxRing& ring = rxRing[bus];
+  unsigned int tail = ring.tail.load(std::memory_order_relaxed);
+
+  if (tail == ring.head.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  *frame = ring.frames[tail & (CAN_RX_RING_SIZE - 1)];
+#ifdef GATEWAY_LATENCY
+  if (latencyEnabled) {
+    latencyNoteRx(bus, frame->can_id, ring.rxUs[tail & (CAN_RX_RING_SIZE - 1)]);
+  }
+#endif
+  ring.tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+void canSetConsumer(byte bus, void* task) {
+  rxConsumer[bus] = (TaskHandle_t)task;
+}
+
+void canSetBusUpHandler(CanBusUpHandler handler) {
+  busUpHandler = handler;
+}
+
+MCP2515::ERROR canSend(byte bus, const struct can_frame* frame) {
+  if (!busUp[bus]) {
+    lockBus(bus);
+    txStats[bus].offline++;
+    unlockBus(bus);
+    return MCP2515::ERROR_FAILINIT;
+  }
+
+  echoRecord(bus, frame);
+
+  lockBus(bus);
+  bool queued = enqueueTx(bus, frame);
+  pumpTx(bus);
+  unlockBus(bus);
+  return queued ? MCP2515::ERROR_OK : MCP2515::ERROR_ALLTXBUSY;
+}
+
+void canReadErrorState(byte bus, CanErrorState* state) {
+  MCP2515& can = controller(bus);
+
+  lockBus(bus);
+  state->tec = can.errorCountTX();
+  state->rec = can.errorCountRX();
+  state->eflg = can.getErrorFlags();
+  unlockBus(bus);
+}
+
+bool canBusRecover(byte bus) {
+  MCP2515& can = controller(bus);
+
+  lockBus(bus);
+  can.reset();
+  can.setBitrate(CAN_SPEED, CAN_FREQ);
+  bool normal = can.setNormalMode() == MCP2515::ERROR_OK;
+  if (rxTaskHandle != NULL) {
+    mcpModifyRegister(bus, MCP_CANINTE, MCP2515::CANINTF_TX0IF | MCP2515::CANINTF_TX1IF | MCP2515::CANINTF_TX2IF, 0xFF);
+  }
+
+  // reset() aborted the loaded frames and cleared the TXP bits
+  CanTxQueue& queue = txQueue[bus];
+  for (byte b = 0; b < TX_BUFFER_COUNT; b++) {
+    queue.loadedId[b] = TX_BUFFER_FREE;
+    queue.loadedPrio[b] = 0;
+  }
+  queue.aborting = TX_BUFFER_NONE;
+  if (normal) {
+    pumpTx(bus);
+  }
+  busUp[bus] = normal;
+  unlockBus(bus);
+
+  if (normal) {
+    bootTimingMark(bus == BUS_CAN0 ? BOOT_CAN0_UP : BOOT_CAN1_UP);
+    if (busUpHandler != NULL) {
+      busUpHandler(bus);
+    }
+  }
+  return normal;
+}
+
+const CanRxStats& canRxStats(byte bus) {
+  return rxStats[bus];
+}
+
+const CanTxStats& canTxStats(byte bus) {
+  return txStats[bus];
+}
+
+void canBusPrintStats() {
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    const CanRxStats& stats = rxStats[bus];
+    Serial.print("CAN");
+    Serial.print(bus);
+    Serial.print(" RX: received=");
+    Serial.print(stats.received);
+    Serial.print(", ring overruns=");
+    Serial.print(stats.ringOverruns);
+    Serial.print(", controller overruns=");
+    Serial.print(stats.hwOverruns);
+    Serial.print(", high-water=");
+    Serial.print(stats.highWater);
+    Serial.print("/");
+    Serial.print(CAN_RX_RING_SIZE);
+    Serial.print(", SPI=");
+    Serial.print(stats.received > 0 ? (float) stats.spiUs / stats.received : 0.0f, 1);
+    Serial.println(" us/frame");
+
+    const CanTxStats& tx = txStats[bus];
+    Serial.print("CAN");
+    Serial.print(bus);
+    Serial.print(" TX: sent=");
+    Serial.print(tx.sent);
+    Serial.print(", aborted=");
+    Serial.print(tx.aborted);
+    Serial.print(", drops=");
+    Serial.print(tx.drops);
+    Serial.print(", offline=");
+    Serial.print(tx.offline);
+    Serial.print(", queue high-water=");
+    Serial.print(tx.highWater);
+    Serial.print("/");
+    Serial.print(CAN_TX_QUEUE_SIZE);
+    Serial.print(", avg queueing delay=");
+    Serial.print(tx.sent > 0 ? tx.delayUs / tx.sent : 0);
+    Serial.print(" us, SPI=");
+    Serial.print(tx.sent > 0 ? (float) tx.spiUs / tx.sent : 0.0f, 1);
+    Serial.println(" us/frame");
+  }
+}
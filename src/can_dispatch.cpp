@@ -0,0 +1,63 @@
+/*
+ * @file can_dispatch.cpp
+ * @brief CAN-ID dispatch tables (one per bus)
+ */
+
+#include <can_dispatch.h>
+#include <can_bus.h>
+#include <config.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert(CAN_DISPATCH_MAX_ROUTES < 256, "Route indexes are stored on one byte");
+
+struct CanRoute {
+  uint16_t dlcMask;
+  CanFrameHandler handler;
+};
+
+// Route 0 is "no handler", so a zero-initialised index means pass-through
+static CanRoute routes[BUS_COUNT][CAN_DISPATCH_MAX_ROUTES + 1];
+static byte routeCount[BUS_COUNT] = {0, 0};
+static byte routeIndex[BUS_COUNT][0x800];
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+bool canDispatchAdd(byte bus, uint16_t id, uint16_t dlcMask, CanFrameHandler handler) {
+  if (bus >= BUS_COUNT || id > 0x7FF || routeIndex[bus][id] != 0) {
+    return false;
+  }
+
+  if (routeCount[bus] >= CAN_DISPATCH_MAX_ROUTES) {
+    if (SerialEnabled) {
+      Serial.println("CAN dispatch: too many handlers, increase CAN_DISPATCH_MAX_ROUTES");
+    }
+    return false;
+  }
+
+  byte index = ++routeCount[bus];
+  routes[bus][index].dlcMask = dlcMask;
+  routes[bus][index].handler = handler;
+  routeIndex[bus][id] = index;
+  return true;
+}
+
+CanFrameHandler canDispatchLookup(byte bus, const struct can_frame* frame) {
+  // Extended, RTR and error frames carry flags above bit 10: never dispatched
+  if (frame->can_id > 0x7FF || frame->can_dlc > 15) {
+    return NULL;
+  }
+
+  const CanRoute& route = routes[bus][routeIndex[bus][frame->can_id]];
+  if (!((route.dlcMask >> frame->can_dlc) & 1)) {
+    return NULL;
+  }
+  return route.handler;
+}
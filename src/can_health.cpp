@@ -0,0 +1,217 @@
+/*
+ * @file can_health.cpp
+ * @brief Controller health monitor: error counters, overflows and bus-off recovery
+ *
+ * Only the monitor task (or canHealthService()) writes the statistics;
+ * readers on other tasks may see a sample being updated, which is harmless
+ * for counters printed on the console.
+ */
+
+#include <can_health.h>
+#include <capture.h>
+#include <flight_recorder.h>
+#include <config.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert(CAN_HEALTH_BACKOFF_MIN_MS <= CAN_HEALTH_BACKOFF_MAX_MS, "CAN_HEALTH_BACKOFF_MIN_MS must not exceed CAN_HEALTH_BACKOFF_MAX_MS");
+
+static const char* const stateNames[] = {"error-active", "error-warning", "error-passive", "bus-off"};
+
+static CanHealthStats health[BUS_COUNT];
+static unsigned long lastHwOverruns[BUS_COUNT] = {0, 0};
+static unsigned long recoverAt[BUS_COUNT] = {0, 0};  // millis() of the next recovery attempt while bus-off
+static unsigned long stableSince[BUS_COUNT] = {0, 0}; // millis() when the controller left bus-off
+static unsigned long lastSample = 0;
+static unsigned long lastCapture = 0;
+static TaskHandle_t healthTaskHandle = NULL;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static CanHealthState stateFromFlags(uint8_t eflg) {
+  if (eflg & MCP2515::EFLG_TXBO) {
+    return HEALTH_BUS_OFF;
+  }
+  if (eflg & (MCP2515::EFLG_TXEP | MCP2515::EFLG_RXEP)) {
+    return HEALTH_ERROR_PASSIVE;
+  }
+  if (eflg & MCP2515::EFLG_EWARN) {
+    return HEALTH_ERROR_WARNING;
+  }
+  return HEALTH_ERROR_ACTIVE;
+}
+
+static void noteEvent(CanHealthEvent& event, unsigned long count, unsigned long now) {
+  event.count += count;
+  event.lastMs = now;
+}
+
+static byte saturate(unsigned long count) {
+  return count > 0xFF ? 0xFF : (byte) count;
+}
+
+// Health record in the capture stream (layout in capture.h)
+static void captureHealth(byte bus) {
+  const CanHealthStats& h = health[bus];
+  struct can_frame record;
+
+  record.can_id = CAPTURE_HEALTH_ID;
+  record.can_dlc = 8;
+  record.data[0] = h.state;
+  record.data[1] = h.errors.tec;
+  record.data[2] = h.errors.rec;
+  record.data[3] = h.errors.eflg;
+  record.data[4] = saturate(h.overflows.count);
+  record.data[5] = saturate(h.errorPassive.count);
+  record.data[6] = saturate(h.busOff.count);
+  record.data[7] = saturate(h.recoveries.count);
+  captureFrame(bus, &record, false);
+}
+
+// One sample of one controller, returns true if something happened
+static bool sampleBus(byte bus, unsigned long now) {
+  CanHealthStats& h = health[bus];
+  bool changed = false;
+
+  canReadErrorState(bus, &h.errors);
+  if (h.errors.tec > h.tecMax) h.tecMax = h.errors.tec;
+  if (h.errors.rec > h.recMax) h.recMax = h.errors.rec;
+
+  // RX0OVR/RX1OVR are cleared by the drain, which counts them
+  unsigned long hwOverruns = canRxStats(bus).hwOverruns;
+  if (hwOverruns != lastHwOverruns[bus]) {
+    noteEvent(h.overflows, hwOverruns - lastHwOverruns[bus], now);
+    lastHwOverruns[bus] = hwOverruns;
+    changed = true;
+  }
+
+  CanHealthState state = stateFromFlags(h.errors.eflg);
+  if (state != h.state) {
+    if (state == HEALTH_BUS_OFF) {
+      noteEvent(h.busOff, 1, now);
+      flightRecorderTrigger(FLIGHT_TRIGGER_BUS_OFF, bus);
+      if (h.recoveries.count == 0 || now - stableSince[bus] >= CAN_HEALTH_STABLE_MS) {
+        h.backoffMs = CAN_HEALTH_BACKOFF_MIN_MS; // Otherwise keep the backoff of the last recovery
+      }
+      recoverAt[bus] = now + h.backoffMs;
+    } else if (state == HEALTH_ERROR_PASSIVE && h.state < HEALTH_ERROR_PASSIVE) {
+      noteEvent(h.errorPassive, 1, now);
+    }
+    if (h.state == HEALTH_BUS_OFF) {
+      stableSince[bus] = now;
+    }
+    h.state = state;
+    changed = true;
+  }
+
+  // Still bus-off once the backoff has elapsed: re-initialize the controller
+  if (h.state == HEALTH_BUS_OFF && (long) (now - recoverAt[bus]) >= 0) {
+    noteEvent(h.recoveries, 1, now);
+    canBusRecover(bus);
+    h.backoffMs = (h.backoffMs * 2 > CAN_HEALTH_BACKOFF_MAX_MS) ? CAN_HEALTH_BACKOFF_MAX_MS : h.backoffMs * 2;
+    recoverAt[bus] = now + h.backoffMs;
+    changed = true;
+  }
+
+  return changed;
+}
+
+static void sampleAll() {
+  unsigned long now = millis();
+  bool log = now - lastCapture >= CAN_HEALTH_CAPTURE_MS;
+
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    if (sampleBus(bus, now) || log) {
+      if (captureActive()) {
+        captureHealth(bus);
+      }
+    }
+  }
+  if (log) {
+    lastCapture = now;
+  }
+}
+
+static void healthTask(void*) {
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(CAN_HEALTH_POLL_MS));
+    sampleAll();
+  }
+}
+
+static void printEvent(const char* name, const CanHealthEvent& event) {
+  Serial.print(name);
+  Serial.print("=");
+  Serial.print(event.count);
+  if (event.count > 0) {
+    Serial.print(" (last at ");
+    Serial.print(event.lastMs);
+    Serial.print(" ms)");
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void canHealthBegin() {
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    health[bus].backoffMs = CAN_HEALTH_BACKOFF_MIN_MS;
+    lastHwOverruns[bus] = canRxStats(bus).hwOverruns;
+  }
+
+  if (xTaskCreatePinnedToCore(healthTask, "canHealth", 3072, NULL, CAN_HEALTH_TASK_PRIORITY, &healthTaskHandle, CAN_HEALTH_TASK_CORE) != pdPASS) {
+    healthTaskHandle = NULL; // Sampled from canHealthService()
+  }
+}
+
+void canHealthService() {
+  if (healthTaskHandle != NULL) {
+    return;
+  }
+
+  if (millis() - lastSample >= CAN_HEALTH_POLL_MS) {
+    lastSample = millis();
+    sampleAll();
+  }
+}
+
+const CanHealthStats& canHealthStats(byte bus) {
+  return health[bus];
+}
+
+void canHealthPrintStats() {
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    const CanHealthStats& h = health[bus];
+    Serial.print("CAN");
+    Serial.print(bus);
+    Serial.print(" health: ");
+    Serial.print(stateNames[h.state]);
+    Serial.print(", TEC=");
+    Serial.print(h.errors.tec);
+    Serial.print(" (max ");
+    Serial.print(h.tecMax);
+    Serial.print("), REC=");
+    Serial.print(h.errors.rec);
+    Serial.print(" (max ");
+    Serial.print(h.recMax);
+    Serial.print("), EFLG=0x");
+    Serial.println(h.errors.eflg, HEX);
+
+    Serial.print("  ");
+    printEvent("overflows", h.overflows);
+    Serial.print(", ");
+    printEvent("error-passive", h.errorPassive);
+    Serial.print(", ");
+    printEvent("bus-off", h.busOff);
+    Serial.print(", ");
+    printEvent("recoveries", h.recoveries);
+    Serial.println();
+  }
+}
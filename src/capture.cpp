@@ -0,0 +1,230 @@
+/*
+ * @file capture.cpp
+ * @brief Binary CAN capture stream on Serial (GVRET / SavvyCAN protocol)
+ *
+ * Producers (loop(), gateway device task, TX pump) append whole records to
+ * the ring under a spinlock; the writer task is the only consumer.
+ */
+
+#include <capture.h>
+#include <can_bus.h>
+#include <config.h>
+#include <settings.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert((CAPTURE_BUFFER_SIZE & (CAPTURE_BUFFER_SIZE - 1)) == 0, "CAPTURE_BUFFER_SIZE must be a power of two");
+
+// GVRET protocol
+#define GVRET_START 0xF1
+#define GVRET_BINARY_MODE 0xE7
+#define GVRET_BUILD_CAN_FRAME 0x00
+#define GVRET_TIME_SYNC 0x01
+#define GVRET_SETUP_CANBUS 0x05
+#define GVRET_GET_CANBUS_PARAMS 0x06
+#define GVRET_GET_DEV_INFO 0x07
+#define GVRET_SET_SW_MODE 0x08
+#define GVRET_KEEPALIVE 0x09
+#define GVRET_SET_SYSTYPE 0x0A
+#define GVRET_GET_NUMBUSES 0x0C
+
+static byte ring[CAPTURE_BUFFER_SIZE];
+static std::atomic<unsigned int> ringHead(0);  // Advanced by producers, under ringMux
+static std::atomic<unsigned int> ringTail(0);  // Advanced by the writer
+static portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t writerTaskHandle = NULL;
+
+// Host command parser: bytes still to skip for commands carrying a payload
+static byte hostState = 0;   // 0 = idle, 1 = after F1, 2 = skipping payload
+static byte hostSkip = 0;
+static byte hostFrameHeader = 0;  // BUILD_CAN_FRAME: bytes of ID/bus/length read so far
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+// Append one record atomically, or drop it whole
+static void ringWrite(const byte* data, unsigned int len) {
+  portENTER_CRITICAL(&ringMux);
+  unsigned int head = ringHead.load(std::memory_order_relaxed);
+  if (CAPTURE_BUFFER_SIZE - (head - ringTail.load(std::memory_order_acquire)) >= len) {
+    for (unsigned int i = 0; i < len; i++) {
+      ring[(head + i) & (CAPTURE_BUFFER_SIZE - 1)] = data[i];
+    }
+    ringHead.store(head + len, std::memory_order_release);
+  }
+  portEXIT_CRITICAL(&ringMux);
+}
+
+static void ringFlush() {
+  unsigned int tail = ringTail.load(std::memory_order_relaxed);
+  unsigned int head = ringHead.load(std::memory_order_acquire);
+
+  while (tail != head) {
+    unsigned int offset = tail & (CAPTURE_BUFFER_SIZE - 1);
+    unsigned int chunk = head - tail;
+    if (chunk > CAPTURE_BUFFER_SIZE - offset) {
+      chunk = CAPTURE_BUFFER_SIZE - offset;
+    }
+    int room = Serial.availableForWrite();
+    if (room <= 0) {
+      break;
+    }
+    if (chunk > (unsigned int)room) {
+      chunk = room;
+    }
+    Serial.write(&ring[offset], chunk);
+    tail += chunk;
+    ringTail.store(tail, std::memory_order_release);
+  }
+}
+
+static void writerTask(void*) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAPTURE_FLUSH_MS));
+    ringFlush();
+  }
+}
+
+static void putLong(byte* buffer, unsigned long value) {
+  buffer[0] = value;
+  buffer[1] = value >> 8;
+  buffer[2] = value >> 16;
+  buffer[3] = value >> 24;
+}
+
+static void replyHost(byte command) {
+  byte reply[12] = {GVRET_START, command};
+  byte len = 2;
+
+  switch (command) {
+  case GVRET_TIME_SYNC:
+    putLong(&reply[2], micros());
+    len = 6;
+    break;
+  case GVRET_GET_CANBUS_PARAMS:
+    reply[2] = 0x01;  // CAN0 enabled, not listen-only
+    putLong(&reply[3], 125000);
+    reply[7] = 0x01;  // CAN1 enabled
+    putLong(&reply[8], 125000);
+    len = 12;
+    break;
+  case GVRET_GET_DEV_INFO:
+    reply[2] = 1;     // Build number (LSB, MSB)
+    reply[3] = 0;
+    reply[4] = 0x20;  // EEPROM version
+    reply[5] = 0;     // File output type
+    reply[6] = 0;     // Auto start logging
+    reply[7] = 0;     // Single wire mode
+    len = 8;
+    break;
+  case GVRET_KEEPALIVE:
+    reply[2] = 0xDE;
+    reply[3] = 0xAD;
+    len = 4;
+    break;
+  case GVRET_GET_NUMBUSES:
+    reply[2] = BUS_COUNT + CAPTURE_TX_BUS_OFFSET;
+    len = 3;
+    break;
+  default:
+    return;
+  }
+  ringWrite(reply, len);
+}
+
+// SavvyCAN connection handshake and polling; frames sent by the host are ignored
+static void parseHostByte(byte c) {
+  switch (hostState) {
+  case 0:
+    if (c == GVRET_START) {
+      hostState = 1;
+    } // GVRET_BINARY_MODE (E7 E7) needs no answer: the stream is always binary
+    break;
+  case 1:
+    hostState = 0;
+    if (c == GVRET_BUILD_CAN_FRAME) {
+      hostState = 3;  // ID (4), bus (1), length (1) then data
+      hostFrameHeader = 0;
+    } else if (c == GVRET_SETUP_CANBUS) {
+      hostState = 2;
+      hostSkip = 8;
+    } else if (c == GVRET_SET_SW_MODE || c == GVRET_SET_SYSTYPE) {
+      hostState = 2;
+      hostSkip = 1;
+    } else {
+      replyHost(c);
+    }
+    break;
+  case 2:
+    if (--hostSkip == 0) {
+      hostState = 0;
+    }
+    break;
+  case 3:
+    if (++hostFrameHeader == 6) {
+      hostSkip = c & 0x0F;
+      hostState = (hostSkip > 0) ? 2 : 0;
+    }
+    break;
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void captureBegin() {
+  if (!captureActive()) {
+    return;
+  }
+
+  if (xTaskCreatePinnedToCore(writerTask, "capture", 3072, NULL, CAPTURE_TASK_PRIORITY, &writerTaskHandle, CAPTURE_TASK_CORE) != pdPASS) {
+    writerTaskHandle = NULL; // Flushed from captureService()
+  }
+}
+
+bool captureActive() {
+  return settings.debugBinaryCapture && (settings.debugCAN0 || settings.debugCAN1);
+}
+
+unsigned int captureEncode(byte* record, byte bus, const struct can_frame* frame, bool tx, unsigned long us) {
+  byte len = (frame->can_dlc > CAN_MAX_DLEN) ? CAN_MAX_DLEN : frame->can_dlc;
+  unsigned long id;
+
+  if (frame->can_id & CAN_EFF_FLAG) {
+    id = (frame->can_id & CAN_EFF_MASK) | 0x80000000UL;
+  } else {
+    id = frame->can_id & CAN_SFF_MASK;
+  }
+
+  record[0] = GVRET_START;
+  record[1] = GVRET_BUILD_CAN_FRAME;
+  putLong(&record[2], us);
+  putLong(&record[6], id);
+  record[10] = len | ((bus + (tx ? CAPTURE_TX_BUS_OFFSET : 0)) << 4);
+  memcpy(&record[11], frame->data, len);
+  record[11 + len] = 0;
+  return 12 + len;
+}
+
+void captureFrame(byte bus, const struct can_frame* frame, bool tx) {
+  byte record[CAPTURE_RECORD_MAX];
+
+  ringWrite(record, captureEncode(record, bus, frame, tx, micros()));
+}
+
+void captureService() {
+  while (Serial.available() > 0) {
+    parseHostByte(Serial.read());
+  }
+
+  if (writerTaskHandle == NULL) {
+    ringFlush();
+  }
+}
@@ -4,6 +4,12 @@
  * 
  * This module simulates CAN2004 messages for testing CAN2010 instrument cluster.
  * Based on existing cluster test implementation.
+ *
+ * Frames are built by scheduler callbacks. There is no sampling of its own:
+ * the first builder run in a CLUSTER_TEST_SAMPLE_MS slot evaluates the
+ * timeline at the start of that slot for all frames of the slot. Values
+ * therefore change at the rate of the fastest frame (0xB6, 50 ms).
+ * CLUSTER_TEST_SAMPLE_MS is the time resolution.
  * 
  * IMPORTANT: Messages are in CAN2004 format (simulating car messages) but are
  * sent to CAN1 (CAN2010 cluster). This mimics the normal adapter behavior where
@@ -13,19 +19,72 @@
 #include <cluster_test.h>
 #include <config.h>
 #include <can_utils.h>
+#include <can_bus.h>
+#include <scheduler.h>
+#include <settings.h>
 
 // External variables from main.cpp
-extern struct can_frame canMsgSnd;
-extern MCP2515 CAN1;
 extern bool SerialEnabled;
-extern bool debugGeneral;
 
 // ============================================================================
 // INTERNAL VARIABLES
 // ============================================================================
 
-static unsigned long testClusterLastUpdate = 0;
-static const unsigned long testClusterUpdateInterval = 10;  // 10ms = 100Hz base
+struct ClusterScenario {
+  const char* name;
+  const ClusterKeyframe* keyframes;
+  byte count;
+  bool loop;  // Restart after the last keyframe, otherwise hold it
+};
+
+// Fixed gauge levels (scenarios 0-15), held 6 s each in CLUSTER_SCENARIO_STEPS
+static const ClusterKeyframe levels[16] = {
+  {6000, false, 0, 0, 0},        // 0x02 - All zeros
+  {6000, false, 10, 0, 0},       // 0x12 - 10 km/h
+  {6000, false, 30, 500, 0},     // 0x22 - 30 km/h, 500 RPM
+  {6000, false, 50, 1000, 25},   // 0x32 - 50 km/h, 1000 RPM, 1/4 fuel
+  {6000, false, 70, 1500, 13},   // 0x42 - 70 km/h, 1500 RPM, 1/4 fuel
+  {6000, false, 90, 2000, 26},   // 0x52 - 90 km/h, 2000 RPM, 1/4 fuel
+  {6000, false, 110, 2500, 38},  // 0x62 - 110 km/h, 2500 RPM, 1/2 fuel
+  {6000, false, 130, 3000, 50},  // 0x72 - 130 km/h, 3000 RPM, 1/2 fuel
+  {6000, false, 150, 3500, 63},  // 0x82 - 150 km/h, 3500 RPM, 1/2 fuel
+  {6000, false, 170, 4000, 74},  // 0x92 - 170 km/h, 4000 RPM, 3/4 fuel
+  {6000, false, 190, 4500, 87},  // 0xA2 - 190 km/h, 4500 RPM, 3/4 fuel
+  {6000, false, 210, 5000, 100}, // 0xB2 - 210 km/h, 5000 RPM, Full fuel
+  {6000, false, 230, 5500, 100}, // 0xC2 - 230 km/h, 5500 RPM, Full fuel
+  {6000, false, 250, 6000, 100}, // 0xD2 - 250 km/h, 6000 RPM, Full fuel
+  {6000, false, 260, 6000, 100}, // 0xE2 - 260 km/h, 6000 RPM, Full fuel
+  {6000, false, 657, 6000, 100}, // 0xF2 - 657 km/h (max), 6000 RPM, Full fuel
+};
+
+static const ClusterKeyframe sweep[] = {
+  {5000, true, 0, 0, 0},
+  {2000, false, 260, 6000, 100},
+  {5000, true, 260, 6000, 100},
+  {2000, false, 0, 0, 0},
+};
+
+static const ClusterKeyframe city[] = {
+  {3000, false, 0, 800, 60},   // Idle
+  {4000, true, 0, 800, 60},    // 1st gear
+  {400, true, 20, 2800, 60},   // Shift
+  {5000, true, 20, 1500, 60},  // 2nd gear
+  {400, true, 45, 2600, 60},   // Shift
+  {6000, false, 45, 1800, 60}, // Cruise
+  {5000, true, 45, 1800, 60},  // Brake to a stop
+};
+
+static const ClusterScenario timelines[] = {
+  {"steps", levels, 16, true},
+  {"sweep", sweep, sizeof(sweep) / sizeof(sweep[0]), true},
+  {"city", city, sizeof(city) / sizeof(city[0]), true},
+};
+
+static unsigned long scenarioStart = 0;
+static unsigned long lastSample = 0;     // Sample index (millis() / CLUSTER_TEST_SAMPLE_MS) of the current values
+static bool sampled = false;
+static unsigned long distanceMm = 0;     // Driven since the last odometer km, in mm
+static unsigned long lastReport = 0;
 
 // ============================================================================
 // HELPER FUNCTIONS
@@ -58,93 +117,172 @@ void encodeOdometerBCD(unsigned long odo, byte* byte0, byte* byte1, byte* byte2)
   *byte2 = (digit2 << 4) | digit1;
 }
 
-void setTestScenario(byte scenario, int* speed, int* rpm, int* fuel) {
-  switch (scenario) {
-    case 0:  // 0x02 - All zeros
-      *speed = 0;
-      *rpm = 0;
-      *fuel = 0;
-      break;
-    case 1:  // 0x12 - 10 km/h
-      *speed = 10;
-      *rpm = 0;
-      *fuel = 0;
-      break;
-    case 2:  // 0x22 - 30 km/h, 500 RPM
-      *speed = 30;
-      *rpm = 500;
-      *fuel = 0;
-      break;
-    case 3:  // 0x32 - 50 km/h, 1000 RPM, 1/4 fuel
-      *speed = 50;
-      *rpm = 1000;
-      *fuel = 25;
-      break;
-    case 4:  // 0x42 - 70 km/h, 1500 RPM, 1/4 fuel
-      *speed = 70;
-      *rpm = 1500;
-      *fuel = 13;
-      break;
-    case 5:  // 0x52 - 90 km/h, 2000 RPM, 1/4 fuel
-      *speed = 90;
-      *rpm = 2000;
-      *fuel = 26;
-      break;
-    case 6:  // 0x62 - 110 km/h, 2500 RPM, 1/2 fuel
-      *speed = 110;
-      *rpm = 2500;
-      *fuel = 38;
-      break;
-    case 7:  // 0x72 - 130 km/h, 3000 RPM, 1/2 fuel
-      *speed = 130;
-      *rpm = 3000;
-      *fuel = 50;
-      break;
-    case 8:  // 0x82 - 150 km/h, 3500 RPM, 1/2 fuel
-      *speed = 150;
-      *rpm = 3500;
-      *fuel = 63;
-      break;
-    case 9:  // 0x92 - 170 km/h, 4000 RPM, 3/4 fuel
-      *speed = 170;
-      *rpm = 4000;
-      *fuel = 74;
-      break;
-    case 10: // 0xA2 - 190 km/h, 4500 RPM, 3/4 fuel
-      *speed = 190;
-      *rpm = 4500;
-      *fuel = 87;
-      break;
-    case 11: // 0xB2 - 210 km/h, 5000 RPM, Full fuel
-      *speed = 210;
-      *rpm = 5000;
-      *fuel = 100;
-      break;
-    case 12: // 0xC2 - 230 km/h, 5500 RPM, Full fuel
-      *speed = 230;
-      *rpm = 5500;
-      *fuel = 100;
-      break;
-    case 13: // 0xD2 - 250 km/h, 6000 RPM, Full fuel
-      *speed = 250;
-      *rpm = 6000;
-      *fuel = 100;
-      break;
-    case 14: // 0xE2 - 260 km/h, 6000 RPM, Full fuel
-      *speed = 260;
-      *rpm = 6000;
-      *fuel = 100;
-      break;
-    case 15: // 0xF2 - 657 km/h (max), 6000 RPM, Full fuel
-      *speed = 657;
-      *rpm = 6000;
-      *fuel = 100;
-      break;
-    default:
-      *speed = 0;
-      *rpm = 0;
-      *fuel = 0;
+static ClusterScenario scenarioFor(byte scenario) {
+  if (scenario < CLUSTER_SCENARIO_STEPS) {
+    return {"level", &levels[scenario], 1, false};
+  }
+  return timelines[scenario - CLUSTER_SCENARIO_STEPS];
+}
+
+static int interpolate(int from, int to, unsigned long t, unsigned long duration) {
+  return from + (long) (to - from) * (long) t / (long) duration;
+}
+
+// Values of a scenario t ms after its start
+static void scenarioValues(const ClusterScenario& scenario, unsigned long t, int* speed, int* rpm, int* fuel) {
+  if (scenario.loop) {
+    unsigned long total = 0;
+    for (byte i = 0; i < scenario.count; i++) {
+      total += scenario.keyframes[i].durationMs;
+    }
+    if (total > 0) {
+      t %= total;
+    }
+  }
+
+  for (byte i = 0; i < scenario.count; i++) {
+    const ClusterKeyframe& key = scenario.keyframes[i];
+    bool last = (i + 1 == scenario.count);
+
+    if (key.durationMs == 0 || t < key.durationMs || (last && !scenario.loop)) {
+      *speed = key.speed;
+      *rpm = key.rpm;
+      *fuel = key.fuel;
+
+      if (key.ramp && key.durationMs > 0 && t < key.durationMs && (!last || scenario.loop)) {
+        const ClusterKeyframe& next = scenario.keyframes[last ? 0 : i + 1];
+        *speed = interpolate(key.speed, next.speed, t, key.durationMs);
+        *rpm = interpolate(key.rpm, next.rpm, t, key.durationMs);
+        *fuel = interpolate(key.fuel, next.fuel, t, key.durationMs);
+      }
+      return;
+    }
+    t -= key.durationMs;
+  }
+}
+
+// Evaluate the scenario at the start of the current CLUSTER_TEST_SAMPLE_MS slot, once per slot (called by the builders)
+static void sample() {
+  unsigned long now = millis();
+  unsigned long index = now / CLUSTER_TEST_SAMPLE_MS;
+
+  if (sampled && index == lastSample) {
+    return;
+  }
+
+  unsigned long elapsedMs = sampled ? (index - lastSample) * CLUSTER_TEST_SAMPLE_MS : 0;
+  lastSample = index;
+  sampled = true;
+
+  // Drive the odometer with the speed of the previous sample (km/h x ms = mm / 3.6)
+  if (testIgnition) {
+    distanceMm += (unsigned long) testSpeed * elapsedMs * 10 / 36;
+    while (distanceMm >= 1000000UL) {
+      distanceMm -= 1000000UL;
+      testOdometer++;
+      if (testOdometer > 999999) testOdometer = 0;
+    }
   }
+
+  scenarioValues(scenarioFor(testScenario), index * CLUSTER_TEST_SAMPLE_MS - scenarioStart, &testSpeed, &testRPM, &testFuel);
+}
+
+// NOTE: Messages are in CAN2004 format (simulating car messages) but sent to CAN1 (CAN2010 cluster)
+
+// RPM + Speed
+static bool buildFrame_B6(struct can_frame* frame) {
+  byte rpm1, rpm2, speed1, speed2;
+
+  sample();
+  encodeRPM(testRPM, &rpm1, &rpm2);
+  encodeSpeed(testSpeed, &speed1, &speed2);
+
+  frame->can_dlc = 8;
+  frame->data[0] = rpm1;
+  frame->data[1] = rpm2;
+  frame->data[2] = speed1;
+  frame->data[3] = speed2;
+  frame->data[4] = 0x00;
+  frame->data[5] = 0x00;
+  frame->data[6] = 0x00;
+  frame->data[7] = 0xD0;
+  return true;
+}
+
+// Odometer display + Ignition
+static bool buildFrame_F6(struct can_frame* frame) {
+  byte odo1, odo2, odo3;
+
+  sample();
+  encodeOdometerBCD(testOdometer, &odo1, &odo2, &odo3);
+
+  frame->can_dlc = 8;
+  frame->data[0] = testIgnition ? 0x8E : 0x0E;  // Ignition bit
+  frame->data[1] = 0x80;
+  frame->data[2] = odo1;  // Odometer byte 0
+  frame->data[3] = odo2;  // Odometer byte 1
+  frame->data[4] = odo3;  // Odometer byte 2
+  frame->data[5] = 0xB6;
+  frame->data[6] = 0xFF;
+  frame->data[7] = 0x10;
+  return true;
+}
+
+// Oil temp + Fuel gauge
+static bool buildFrame_161(struct can_frame* frame) {
+  sample();
+
+  frame->can_dlc = 7;
+  frame->data[0] = 0x00;
+  frame->data[1] = 0x00;
+  frame->data[2] = testOilTemp;  // Oil temperature
+  frame->data[3] = testFuel;     // Fuel gauge (0x00-0x64 = 0-100%)
+  frame->data[4] = 0x00;
+  frame->data[5] = 0x00;
+  frame->data[6] = 0xFF;
+  return true;
+}
+
+// Ignition + Brightness
+static bool buildFrame_36(struct can_frame* frame) {
+  frame->can_dlc = 8;
+  frame->data[0] = 0x0E;
+  frame->data[1] = 0x00;
+  frame->data[2] = 0x00;
+  frame->data[3] = 0x3F;  // Brightness (can be adjusted)
+  frame->data[4] = 0x01;
+  frame->data[5] = 0x00;
+  frame->data[6] = 0x00;
+  frame->data[7] = 0xA0;
+  return true;
+}
+
+// Dash lights 1
+static bool buildFrame_128(struct can_frame* frame) {
+  frame->can_dlc = 8;
+  frame->data[0] = 0xFF;  // All lights on (for testing)
+  frame->data[1] = 0xFF;
+  frame->data[2] = 0x00;
+  frame->data[3] = 0x00;
+  frame->data[4] = 0xFE;
+  frame->data[5] = 0x11;
+  frame->data[6] = 0x38;
+  frame->data[7] = 0x00;
+  return true;
+}
+
+// Dash lights 2
+static bool buildFrame_168(struct can_frame* frame) {
+  frame->can_dlc = 8;
+  frame->data[0] = 0xFF;  // All lights on (for testing)
+  frame->data[1] = 0x00;
+  frame->data[2] = 0x00;
+  frame->data[3] = 0xF3;
+  frame->data[4] = 0x03;
+  frame->data[5] = 0x00;
+  frame->data[6] = 0xF0;
+  frame->data[7] = 0x00;
+  return true;
 }
 
 // ============================================================================
@@ -152,179 +290,68 @@ void setTestScenario(byte scenario, int* speed, int* rpm, int* fuel) {
 // ============================================================================
 
 void clusterTestInit() {
+  if (testAutoIncrement) {
+    testScenario = CLUSTER_SCENARIO_STEPS;
+  }
+  if (testScenario >= CLUSTER_SCENARIO_COUNT) {
+    testScenario = 0;
+  }
+  scenarioStart = (millis() / CLUSTER_TEST_SAMPLE_MS) * CLUSTER_TEST_SAMPLE_MS;
+
+  // Periods and phases of the simulated BSI frames
+  schedulerAdd(BUS_CAN1, 0xB6, 50, 0, buildFrame_B6);
+  schedulerAdd(BUS_CAN1, 0x36, 100, 10, buildFrame_36);
+  schedulerAdd(BUS_CAN1, 0x128, 200, 20, buildFrame_128);
+  schedulerAdd(BUS_CAN1, 0x168, 300, 30, buildFrame_168);
+  schedulerAdd(BUS_CAN1, 0xF6, 500, 40, buildFrame_F6);
+  schedulerAdd(BUS_CAN1, 0x161, 500, 45, buildFrame_161);
+
   if (SerialEnabled) {
     Serial.println("========================================");
     Serial.println("INSTRUMENT CLUSTER TEST MODE ENABLED");
     Serial.println("========================================");
     Serial.println("Simulating CAN2004 messages for CAN2010 cluster");
-    Serial.println("Based on existing cluster test implementation");
-    Serial.print("Update rate: ");
-    Serial.print(1000 / testClusterUpdateInterval);
-    Serial.println(" Hz base frequency");
-    Serial.println("========================================");
-    Serial.print("Initial values:");
-    Serial.print(" Scenario=");
+    Serial.print("Scenario: ");
     Serial.print(testScenario);
-    Serial.print(", Speed=");
-    Serial.print(testSpeed);
-    Serial.print(" km/h, RPM=");
-    Serial.print(testRPM);
-    Serial.print(", Fuel=");
-    Serial.print(testFuel);
-    Serial.print("%, Odometer=");
+    Serial.print(" (");
+    Serial.print(scenarioFor(testScenario).name);
+    Serial.print("), evaluated on a ");
+    Serial.print(CLUSTER_TEST_SAMPLE_MS);
+    Serial.println(" ms grid when a frame is built");
+    Serial.print("Initial values: Odometer=");
     Serial.print(testOdometer);
     Serial.print(" km");
     Serial.println();
     Serial.println("========================================");
     Serial.println("Messages sent:");
-    Serial.println("  0xB6 (RPM+Speed) - every 500ms");
-    Serial.println("  0xF6 (Odometer) - every 500ms");
-    Serial.println("  0x161 (Oil+Fuel) - every 500ms");
+    Serial.println("  0xB6 (RPM+Speed) - every 50ms");
     Serial.println("  0x36 (Ign+Bright) - every 100ms");
     Serial.println("  0x128 (Lights1) - every 200ms");
     Serial.println("  0x168 (Lights2) - every 300ms");
+    Serial.println("  0xF6 (Odometer) - every 500ms");
+    Serial.println("  0x161 (Oil+Fuel) - every 500ms");
+    Serial.println("Send jitter: console command 'scheduler'");
     Serial.println("========================================");
   }
 }
 
 void clusterTestLoop() {
-  unsigned long currentTime = millis();
-  
-  if (currentTime - testClusterLastUpdate >= testClusterUpdateInterval) {
-    testClusterLastUpdate = currentTime;
-    testClusterCounter++;
-    
-    // Reset counter at 600 (like original liczarka)
-    if (testClusterCounter > 600) {
-      testClusterCounter = 0;
-    }
-    
-    // Auto-increment scenario if enabled
-    if (testAutoIncrement && testClusterCounter == 0) {
-      testScenario++;
-      if (testScenario > 15) testScenario = 0;
-      setTestScenario(testScenario, &testSpeed, &testRPM, &testFuel);
-    }
-    
-    // Encode RPM and Speed
-    byte rpm1, rpm2, speed1, speed2;
-    encodeRPM(testRPM, &rpm1, &rpm2);
-    encodeSpeed(testSpeed, &speed1, &speed2);
-    
-    // Encode odometer
-    byte odo1, odo2, odo3;
-    encodeOdometerBCD(testOdometer, &odo1, &odo2, &odo3);
-    
-    // Send 0xB6 - RPM + Speed (frequently, like original at liczarka == 500)
-    // NOTE: Messages are in CAN2004 format (simulating car messages) but sent to CAN1 (CAN2010 cluster)
-    if (testClusterCounter == 500) {
-      canMsgSnd.can_id = 0xB6;
-      canMsgSnd.can_dlc = 8;
-      canMsgSnd.data[0] = rpm1;
-      canMsgSnd.data[1] = rpm2;
-      canMsgSnd.data[2] = speed1;
-      canMsgSnd.data[3] = speed2;
-      canMsgSnd.data[4] = 0x00;
-      canMsgSnd.data[5] = 0x00;
-      canMsgSnd.data[6] = 0x00;
-      canMsgSnd.data[7] = 0xD0;
-      CAN1.sendMessage(&canMsgSnd);
-    }
-    
-    // Send 0xF6 - Odometer display + Ignition (frequently, like original at liczarka == 500)
-    if (testClusterCounter == 500) {
-      canMsgSnd.can_id = 0xF6;
-      canMsgSnd.can_dlc = 8;
-      canMsgSnd.data[0] = testIgnition ? 0x8E : 0x0E;  // Ignition bit
-      canMsgSnd.data[1] = 0x80;
-      canMsgSnd.data[2] = odo1;  // Odometer byte 0
-      canMsgSnd.data[3] = odo2;  // Odometer byte 1
-      canMsgSnd.data[4] = odo3;  // Odometer byte 2
-      canMsgSnd.data[5] = 0xB6;
-      canMsgSnd.data[6] = 0xFF;
-      canMsgSnd.data[7] = 0x10;
-      CAN1.sendMessage(&canMsgSnd);
-    }
-    
-    // Send 0x161 - Oil temp + Fuel gauge (frequently, like original at liczarka == 500)
-    if (testClusterCounter == 500) {
-      canMsgSnd.can_id = 0x161;
-      canMsgSnd.can_dlc = 7;
-      canMsgSnd.data[0] = 0x00;
-      canMsgSnd.data[1] = 0x00;
-      canMsgSnd.data[2] = testOilTemp;  // Oil temperature
-      canMsgSnd.data[3] = testFuel;    // Fuel gauge (0x00-0x64 = 0-100%)
-      canMsgSnd.data[4] = 0x00;
-      canMsgSnd.data[5] = 0x00;
-      canMsgSnd.data[6] = 0xFF;
-      CAN1.sendMessage(&canMsgSnd);
-    }
-    
-    // Send 0x36 - Ignition + Brightness (less frequently, like original at liczarka == 100)
-    if (testClusterCounter == 100) {
-      canMsgSnd.can_id = 0x36;
-      canMsgSnd.can_dlc = 8;
-      canMsgSnd.data[0] = 0x0E;
-      canMsgSnd.data[1] = 0x00;
-      canMsgSnd.data[2] = 0x00;
-      canMsgSnd.data[3] = 0x3F;  // Brightness (can be adjusted)
-      canMsgSnd.data[4] = 0x01;
-      canMsgSnd.data[5] = 0x00;
-      canMsgSnd.data[6] = 0x00;
-      canMsgSnd.data[7] = 0xA0;
-      CAN1.sendMessage(&canMsgSnd);
-    }
-    
-    // Send 0x128 - Dash lights 1 (less frequently, like original at liczarka == 200)
-    if (testClusterCounter == 200) {
-      canMsgSnd.can_id = 0x128;
-      canMsgSnd.can_dlc = 8;
-      canMsgSnd.data[0] = 0xFF;  // All lights on (for testing)
-      canMsgSnd.data[1] = 0xFF;
-      canMsgSnd.data[2] = 0x00;
-      canMsgSnd.data[3] = 0x00;
-      canMsgSnd.data[4] = 0xFE;
-      canMsgSnd.data[5] = 0x11;
-      canMsgSnd.data[6] = 0x38;
-      canMsgSnd.data[7] = 0x00;
-      CAN1.sendMessage(&canMsgSnd);
-    }
-    
-    // Send 0x168 - Dash lights 2 (less frequently, like original at liczarka == 300)
-    if (testClusterCounter == 300) {
-      canMsgSnd.can_id = 0x168;
-      canMsgSnd.can_dlc = 8;
-      canMsgSnd.data[0] = 0xFF;  // All lights on (for testing)
-      canMsgSnd.data[1] = 0x00;
-      canMsgSnd.data[2] = 0x00;
-      canMsgSnd.data[3] = 0xF3;
-      canMsgSnd.data[4] = 0x03;
-      canMsgSnd.data[5] = 0x00;
-      canMsgSnd.data[6] = 0xF0;
-      canMsgSnd.data[7] = 0x00;
-      CAN1.sendMessage(&canMsgSnd);
-    }
-    
-    // Auto-increment odometer if engine running (simulate driving)
-    if (testIgnition && testClusterCounter == 500 && testSpeed > 0) {
-      // Increment by 0.01 km (at 10Hz update, this simulates driving)
-      testOdometer += 1;
-      if (testOdometer > 999999) testOdometer = 0;
-    }
-    
-    // Debug output (only if SerialEnabled and debugGeneral)
-    if (SerialEnabled && debugGeneral && testClusterCounter == 0) {
-      Serial.print("Cluster Test - Scenario: ");
-      Serial.print(testScenario);
-      Serial.print(", Speed: ");
-      Serial.print(testSpeed);
-      Serial.print(" km/h, RPM: ");
-      Serial.print(testRPM);
-      Serial.print(", Fuel: ");
-      Serial.print(testFuel);
-      Serial.print("%, Odo: ");
-      Serial.print(testOdometer);
-      Serial.println(" km");
-    }
+  // Debug output (only if SerialEnabled and debugGeneral)
+  if (!SerialEnabled || !settings.debugGeneral || millis() - lastReport < CLUSTER_TEST_REPORT_MS) {
+    return;
   }
+  lastReport = millis();
+
+  Serial.print("Cluster Test - Scenario: ");
+  Serial.print(testScenario);
+  Serial.print(", Speed: ");
+  Serial.print(testSpeed);
+  Serial.print(" km/h, RPM: ");
+  Serial.print(testRPM);
+  Serial.print(", Fuel: ");
+  Serial.print(testFuel);
+  Serial.print("%, Odo: ");
+  Serial.print(testOdometer);
+  Serial.println(" km");
+  schedulerPrintStats();
 }
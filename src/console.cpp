@@ -0,0 +1,280 @@
+/*
+ * @file console.cpp
+ * @brief Line-based command console on Serial
+ */
+
+#include <console.h>
+#include <can_bus.h>
+#include <can_health.h>
+#include <echo_filter.h>
+#include <boot_timing.h>
+#include <flight_recorder.h>
+#include <drive_log.h>
+#include <gateway_rules.h>
+#include <buttons.h>
+#include <capture.h>
+#include <gateway.h>
+#include <latency.h>
+#include <persist.h>
+#include <time_service.h>
+#include <scheduler.h>
+#include <popup.h>
+#include <alerts_journal.h>
+#include <translation_memo.h>
+#include <settings.h>
+#include <config.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static char line[CONSOLE_LINE_SIZE];
+static byte lineLength = 0;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static void printHelp() {
+  Serial.println("Commands: help, stats, health, scheduler, scheduler reset, buttons, buttons reset, memo reset");
+  Serial.println("          settings, set <name> <value>, save, defaults");
+  Serial.println("          recorder, recorder freeze|resume|dump, recorder match <id> [pattern]|off,");
+  Serial.println("          recorder busoff|txdrop on|off");
+  Serial.println("          log, log list, log dump <n>, log flush, log erase");
+  Serial.println("          rules, rules add <rule>, rules del <n>, rules save, rules defaults");
+#ifdef GATEWAY_LATENCY
+  Serial.println("          latency, latency reset, latency on, latency off");
+#endif
+}
+
+// "set <name> <value>"
+static void runSet(const char* arguments) {
+  char name[32];
+  const char* value = strchr(arguments, ' ');
+  size_t length = value ? (size_t) (value - arguments) : 0;
+
+  if (length == 0 || length >= sizeof(name)) {
+    Serial.println("Usage: set <name> <value>");
+    return;
+  }
+  memcpy(name, arguments, length);
+  name[length] = '\0';
+
+  if (settingsSet(name, value + 1)) {
+    Serial.print(name);
+    Serial.println(" changed, \"save\" to keep it");
+  } else {
+    Serial.print("Invalid setting or value: ");
+    Serial.println(arguments);
+  }
+}
+
+// "recorder match <id> [pattern]": hexadecimal ID, data nibbles with x as wildcard
+static bool runRecorderMatch(const char* arguments) {
+  uint8_t mask[CAN_MAX_DLEN] = {0};
+  uint8_t value[CAN_MAX_DLEN] = {0};
+  char* end;
+
+  unsigned long id = strtoul(arguments, &end, 16);
+  if (end == arguments || id > CAN_EFF_MASK) {
+    return false;
+  }
+  if (id > CAN_SFF_MASK) {
+    id |= CAN_EFF_FLAG;
+  }
+
+  const char* pattern = end;
+  while (*pattern == ' ') {
+    pattern++;
+  }
+  for (byte nibble = 0; pattern[nibble] != '\0'; nibble++) {
+    char c = pattern[nibble];
+    byte shift = (nibble % 2) ? 0 : 4;
+    if (nibble >= 2 * CAN_MAX_DLEN) {
+      return false;
+    }
+    if (c == 'x' || c == 'X') {
+      continue;
+    }
+    if (!isxdigit(c)) {
+      return false;
+    }
+    mask[nibble / 2] |= 0x0F << shift;
+    value[nibble / 2] |= (isdigit(c) ? c - '0' : (toupper(c) - 'A' + 10)) << shift;
+  }
+
+  flightRecorderSetMatch(id, mask, value);
+  return true;
+}
+
+// "recorder [...]"
+static void runRecorder(const char* arguments) {
+  if (*arguments == '\0') {
+    flightRecorderPrintStats();
+  } else if (strcmp(arguments, "freeze") == 0) {
+    flightRecorderTrigger(FLIGHT_TRIGGER_MANUAL, 0xFF);
+    Serial.println("Flight recorder triggered");
+  } else if (strcmp(arguments, "resume") == 0) {
+    flightRecorderResume();
+    Serial.println("Flight recorder cleared and armed");
+  } else if (strcmp(arguments, "dump") == 0) {
+    if (captureActive() || !flightRecorderDump()) {
+      Serial.println("Unable to dump (no ring, dump running or binary capture active)");
+    }
+  } else if (strcmp(arguments, "match off") == 0) {
+    flightRecorderArm(FLIGHT_TRIGGER_MATCH, false);
+    Serial.println("Match trigger off");
+  } else if (strncmp(arguments, "match ", 6) == 0) {
+    Serial.println(runRecorderMatch(arguments + 6) ? "Match trigger armed" : "Usage: recorder match <hex id> [hex nibbles, x = any]");
+  } else if (strcmp(arguments, "busoff on") == 0 || strcmp(arguments, "busoff off") == 0) {
+    flightRecorderArm(FLIGHT_TRIGGER_BUS_OFF, arguments[8] == 'n');
+    Serial.println(arguments[8] == 'n' ? "Bus-off trigger on" : "Bus-off trigger off");
+  } else if (strcmp(arguments, "txdrop on") == 0 || strcmp(arguments, "txdrop off") == 0) {
+    flightRecorderArm(FLIGHT_TRIGGER_TX_DROP, arguments[8] == 'n');
+    Serial.println(arguments[8] == 'n' ? "TX drop trigger on" : "TX drop trigger off");
+  } else {
+    Serial.print("Unknown recorder command: ");
+    Serial.println(arguments);
+  }
+}
+
+// "log [...]"
+static void runLog(const char* arguments) {
+  if (*arguments == '\0') {
+    driveLogPrintStats();
+  } else if (strcmp(arguments, "list") == 0) {
+    driveLogList();
+  } else if (strncmp(arguments, "dump ", 5) == 0) {
+    if (captureActive() || !driveLogDump(strtoul(arguments + 5, NULL, 10))) {
+      Serial.println("Unable to dump (log not running, no such file, dump running or binary capture active)");
+    }
+  } else if (strcmp(arguments, "flush") == 0) {
+    driveLogFlush();
+    Serial.println("Partial block written");
+  } else if (strcmp(arguments, "erase") == 0) {
+    driveLogErase();
+    Serial.println("Drive log erased");
+  } else {
+    Serial.print("Unknown log command: ");
+    Serial.println(arguments);
+  }
+}
+
+// "rules [...]"
+static void runRules(const char* arguments) {
+  const char* error;
+
+  if (*arguments == '\0') {
+    gatewayRulesPrint();
+  } else if (strncmp(arguments, "add ", 4) == 0) {
+    if (gatewayRulesAdd(arguments + 4, &error)) {
+      Serial.println("Rule added, \"rules save\" then restart to apply");
+    } else {
+      Serial.print("Invalid rule: ");
+      Serial.println(error);
+    }
+  } else if (strncmp(arguments, "del ", 4) == 0) {
+    if (gatewayRulesDelete(strtoul(arguments + 4, NULL, 10))) {
+      Serial.println("Rule deleted, \"rules save\" then restart to apply");
+    } else {
+      Serial.println("No such rule");
+    }
+  } else if (strcmp(arguments, "save") == 0) {
+    Serial.println(gatewayRulesSave() ? "Rules saved, applied at the next start" : "Unable to save the rules");
+  } else if (strcmp(arguments, "defaults") == 0) {
+    gatewayRulesDefaults();
+    Serial.println("Default rules restored (not saved)");
+  } else {
+    Serial.print("Unknown rules command: ");
+    Serial.println(arguments);
+  }
+}
+
+static void runCommand(const char* command) {
+  if (strcmp(command, "help") == 0) {
+    printHelp();
+  } else if (strcmp(command, "stats") == 0) {
+    bootTimingPrint();
+    canBusPrintStats();
+    canHealthPrintStats();
+    echoPrintStats();
+    flightRecorderPrintStats();
+    driveLogPrintStats();
+    gatewayRulesPrintStats();
+    buttonsPrintStats();
+    gatewayPrintStats();
+    persistPrintStats();
+    clockPrintStats();
+    journalPrintStats();
+    popupPrintStats();
+    memoPrintStats();
+  } else if (strcmp(command, "settings") == 0) {
+    settingsPrint();
+  } else if (strncmp(command, "set ", 4) == 0) {
+    runSet(command + 4);
+  } else if (strcmp(command, "save") == 0) {
+    Serial.println(settingsSave() ? "Settings saved" : "Unable to save the settings");
+  } else if (strcmp(command, "defaults") == 0) {
+    settingsDefaults();
+    Serial.println("Default settings restored (not saved)");
+  } else if (strcmp(command, "recorder") == 0) {
+    runRecorder("");
+  } else if (strncmp(command, "recorder ", 9) == 0) {
+    runRecorder(command + 9);
+  } else if (strcmp(command, "log") == 0) {
+    runLog("");
+  } else if (strncmp(command, "log ", 4) == 0) {
+    runLog(command + 4);
+  } else if (strcmp(command, "rules") == 0) {
+    runRules("");
+  } else if (strncmp(command, "rules ", 6) == 0) {
+    runRules(command + 6);
+  } else if (strcmp(command, "health") == 0) {
+    canHealthPrintStats();
+  } else if (strcmp(command, "scheduler") == 0) {
+    schedulerPrintStats();
+  } else if (strcmp(command, "scheduler reset") == 0) {
+    schedulerResetStats();
+    Serial.println("Scheduler statistics cleared");
+  } else if (strcmp(command, "buttons") == 0) {
+    buttonsPrintStats();
+  } else if (strcmp(command, "buttons reset") == 0) {
+    buttonsResetStats();
+    Serial.println("Button statistics cleared");
+  } else if (strcmp(command, "memo reset") == 0) {
+    memoResetStats();
+    Serial.println("Translation memo statistics cleared");
+#ifdef GATEWAY_LATENCY
+  } else if (strcmp(command, "latency") == 0) {
+    latencyPrint();
+  } else if (strcmp(command, "latency reset") == 0) {
+    latencyReset();
+    Serial.println("Latency histograms cleared");
+  } else if (strcmp(command, "latency on") == 0 || strcmp(command, "latency off") == 0) {
+    latencyEnabled = (command[9] == 'n');
+    Serial.println(latencyEnabled ? "Latency recording on" : "Latency recording off");
+#endif
+  } else if (command[0] != '\0') {
+    Serial.print("Unknown command: ");
+    Serial.println(command);
+    printHelp();
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void consoleService() {
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+
+    if (c == '\r' || c == '\n') {
+      line[lineLength] = '\0';
+      runCommand(line);
+      lineLength = 0;
+    } else if (lineLength < sizeof(line) - 1) {
+      line[lineLength++] = c;
+    }
+  }
+}
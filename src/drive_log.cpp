@@ -0,0 +1,563 @@
+/*
+ * @file drive_log.cpp
+ * @brief Compressed log of both buses on a LittleFS partition
+ *
+ * Producers (RX task, TX pumps) copy frames into the queue under a spinlock;
+ * the log task is the only consumer and the only user of LittleFS apart from
+ * "log list". Frame times are kept as µs since a clock anchor in 64 bits, as
+ * micros() wraps every 71 minutes; the anchor moves when the clock is set.
+ *
+ * Blocks are encoded straight into a ring of RAM blocks (PSRAM if found).
+ * A flash write disables the cache of both cores, so the ring is written out
+ * while the buses are quiet or at ignition off; while they are busy it is
+ * only written DRIVE_LOG_WRITE_CHUNK bytes per pass, once half full.
+ */
+
+#include <drive_log.h>
+#include <log_codec.h>
+#include <can_bus.h>
+#include <config.h>
+#include <scheduler.h>
+#include <settings.h>
+#include <time_service.h>
+#include <LittleFS.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert((DRIVE_LOG_QUEUE_SIZE & (DRIVE_LOG_QUEUE_SIZE - 1)) == 0, "DRIVE_LOG_QUEUE_SIZE must be a power of two");
+static_assert((DRIVE_LOG_BLOCK_SIZE & (DRIVE_LOG_BLOCK_SIZE - 1)) == 0 && DRIVE_LOG_BLOCK_SIZE >= 256 && DRIVE_LOG_BLOCK_SIZE <= 32768, "DRIVE_LOG_BLOCK_SIZE must be a power of two from 256 to 32768");
+
+#define QUEUED_TX 0x20  // info: frame sent by the adapter
+#define LOG_PATH_SIZE 32
+
+struct QueuedFrame {
+  uint32_t us;
+  uint32_t id;       // can_id, EFF/RTR flags included
+  uint8_t info;      // DLC (bits 0-3), bus (bit 4), QUEUED_TX
+  uint8_t data[CAN_MAX_DLEN];
+};
+
+enum LogState : byte {
+  LOG_OFF = 0,
+  LOG_MOUNTING = 1,
+  LOG_RUNNING = 2,
+  LOG_FAILED = 3
+};
+
+volatile bool driveLogActive = false;
+
+static QueuedFrame* queue = NULL;
+static std::atomic<uint32_t> queueHead(0);  // Advanced by producers, under queueMux
+static std::atomic<uint32_t> queueTail(0);  // Advanced by the log task
+static portMUX_TYPE queueMux = portMUX_INITIALIZER_UNLOCKED;
+static unsigned long dropped = 0;
+static volatile byte logState = LOG_OFF;
+static TaskHandle_t logTaskHandle = NULL;
+
+// Log task only
+static LogEncoder* encoder = NULL;
+static uint8_t* blocks = NULL;           // Ring of ramBlocks blocks, the open one is blocks[ramHead]
+static unsigned int ramBlocks = 0;
+static bool inPsram = false;
+static uint16_t blockFrames[DRIVE_LOG_RAM_BLOCKS];
+static uint16_t blockUsed[DRIVE_LOG_RAM_BLOCKS];
+static unsigned long ramHead = 0;        // Blocks closed
+static unsigned long ramTail = 0;        // Blocks written (or dropped on a write error)
+static size_t writeOffset = 0;           // Bytes of the oldest closed block already written
+static bool blockOpen = false;
+static File logFile;
+static File dumpFile;
+static volatile bool dumping = false;
+static unsigned long fileNumber = 0;     // Current file, 0 before the first block
+static unsigned int fileBlocks = 0;
+static uint32_t sequence = 0;
+
+// Clock anchor
+static uint32_t anchorEpoch = 0;         // Wall clock (or 0 = start) at elapsedUs = 0
+static bool anchorValid = false;
+static uint32_t lastUs = 0;
+static uint64_t elapsedUs = 0;           // Time of the last frame since the anchor
+
+// Requests from the console
+static std::atomic<bool> flushRequested(false);
+static std::atomic<bool> eraseRequested(false);
+static std::atomic<unsigned long> dumpRequested(0);  // File number, 0 = none
+
+// Statistics
+static unsigned long framesLogged = 0;
+static unsigned long blocksWritten = 0;
+static unsigned long framesWritten = 0;  // Frames of the written blocks
+static unsigned long long bytesEncoded = 0;  // Used bytes of the written blocks
+static unsigned long writeErrors = 0;
+static unsigned long filesDeleted = 0;
+static unsigned long busyWrites = 0;     // Chunks written while the buses were busy
+static unsigned long forcedWrites = 0;   // Blocks written at once because the ring was full
+static unsigned long maxWriteUs = 0;
+static unsigned long writeOverruns = 0;  // Controller overruns from a write to the next pass
+static unsigned long overrunsAtWrite = 0;
+static bool writeMarked = false;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static void filePath(char* path, unsigned long number) {
+  snprintf(path, LOG_PATH_SIZE, DRIVE_LOG_DIR "/%05lu.clg", number);
+}
+
+// Number of a log file name, 0 if not a log file
+static unsigned long fileNumberOf(const char* name) {
+  char* end;
+  unsigned long number = strtoul(name, &end, 10);
+  return (end != name && strcmp(end, ".clg") == 0) ? number : 0;
+}
+
+// Highest file number, and lowest one other than skip (0 if none)
+static unsigned long scanFiles(unsigned long* lowest, unsigned long skip) {
+  unsigned long highest = 0;
+  File dir = LittleFS.open(DRIVE_LOG_DIR);
+
+  *lowest = 0;
+  if (!dir || !dir.isDirectory()) {
+    return 0;
+  }
+  for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    unsigned long number = fileNumberOf(file.name());
+    if (number > highest) {
+      highest = number;
+    }
+    if (number != 0 && number != skip && (*lowest == 0 || number < *lowest)) {
+      *lowest = number;
+    }
+  }
+  return highest;
+}
+
+static bool mount() {
+  unsigned long lowest;
+
+  if (!LittleFS.begin(true, "/littlefs", 4, DRIVE_LOG_PARTITION)) {
+    return false;
+  }
+  if (!LittleFS.exists(DRIVE_LOG_DIR)) {
+    LittleFS.mkdir(DRIVE_LOG_DIR);
+  }
+  fileNumber = scanFiles(&lowest, 0); // The first block goes into a new file
+  fileBlocks = DRIVE_LOG_FILE_BLOCKS;
+  return true;
+}
+
+// Delete the oldest files until two blocks fit
+static bool makeRoom() {
+  while (LittleFS.totalBytes() - LittleFS.usedBytes() < 2 * DRIVE_LOG_BLOCK_SIZE) {
+    unsigned long lowest;
+    char path[LOG_PATH_SIZE];
+
+    scanFiles(&lowest, fileNumber);
+    if (lowest == 0) {
+      return false;
+    }
+    filePath(path, lowest);
+    if (!LittleFS.remove(path)) {
+      return false;
+    }
+    filesDeleted++;
+  }
+  return true;
+}
+
+static void advanceClock(uint32_t us) {
+  elapsedUs += (int32_t) (us - lastUs); // Queued frames may be a few µs out of order
+  lastUs = us;
+}
+
+static uint8_t* ramBlock(unsigned long number) {
+  return blocks + (size_t) (number % ramBlocks) * DRIVE_LOG_BLOCK_SIZE;
+}
+
+static unsigned long controllerOverruns() {
+  return canRxStats(BUS_CAN0).hwOverruns + canRxStats(BUS_CAN1).hwOverruns;
+}
+
+// Overruns counted since the last write: the cache was off, the drain could not run
+static void countWriteOverruns() {
+  if (writeMarked) {
+    writeOverruns += controllerOverruns() - overrunsAtWrite;
+    writeMarked = false;
+  }
+}
+
+// Write up to max bytes of the oldest closed block, dropped on a write error
+static void writeChunk(size_t max) {
+  if (ramTail == ramHead) {
+    return;
+  }
+
+  if (writeOffset == 0) {
+    if (fileBlocks >= DRIVE_LOG_FILE_BLOCKS || !logFile) {
+      char path[LOG_PATH_SIZE];
+      logFile.close();
+      filePath(path, ++fileNumber);
+      logFile = LittleFS.open(path, FILE_APPEND);
+      fileBlocks = 0;
+    }
+    if (!makeRoom() || !logFile) {
+      writeErrors++;
+      ramTail++;
+      return;
+    }
+  }
+
+  if (!writeMarked) {
+    overrunsAtWrite = controllerOverruns();
+    writeMarked = true;
+  }
+  size_t length = DRIVE_LOG_BLOCK_SIZE - writeOffset;
+  if (length > max) {
+    length = max;
+  }
+  unsigned long start = micros();
+  bool ok = logFile.write(ramBlock(ramTail) + writeOffset, length) == length;
+  writeOffset += length;
+  if (ok && writeOffset == DRIVE_LOG_BLOCK_SIZE) {
+    logFile.flush();
+  }
+  unsigned long writeUs = micros() - start;
+  if (writeUs > maxWriteUs) {
+    maxWriteUs = writeUs;
+  }
+
+  if (!ok) {
+    writeErrors++;
+  } else if (writeOffset < DRIVE_LOG_BLOCK_SIZE) {
+    return;
+  } else {
+    unsigned int index = ramTail % ramBlocks;
+    fileBlocks++;
+    blocksWritten++;
+    framesWritten += blockFrames[index];
+    bytesEncoded += blockUsed[index];
+  }
+  writeOffset = 0;
+  ramTail++;
+}
+
+static void openBlock(uint32_t us) {
+  // Ring full: the oldest block goes to flash now, whatever the traffic
+  if (ramHead - ramTail >= ramBlocks) {
+    forcedWrites++;
+    writeChunk(DRIVE_LOG_BLOCK_SIZE);
+  }
+
+  // Anchor to the wall clock once set, again if it moved (RTC read after boot, time set by the NAC)
+  if (clockIsSet()) {
+    uint32_t wall = clockNow() - (micros() - us) / 1000000UL;
+    long offset = (long) (wall - (anchorEpoch + (uint32_t) (elapsedUs / 1000000UL)));
+    if (!anchorValid || offset > 2 || offset < -2) {
+      anchorValid = true;
+      anchorEpoch = wall;
+      elapsedUs %= 1000000UL;
+    }
+  }
+
+  uint32_t epoch = anchorEpoch + (uint32_t) (elapsedUs / 1000000UL);
+  uint32_t baseUs = us - (uint32_t) (elapsedUs % 1000000UL);
+  logEncoderOpen(encoder, ramBlock(ramHead), DRIVE_LOG_BLOCK_SIZE, sequence++, epoch, anchorValid, baseUs);
+  blockOpen = true;
+}
+
+static void closeBlock() {
+  if (!blockOpen) {
+    return;
+  }
+  logEncoderClose(encoder);
+  blockOpen = false;
+
+  unsigned int index = ramHead % ramBlocks;
+  blockFrames[index] = encoder->frames;
+  blockUsed[index] = encoder->used;
+  ramHead++;
+}
+
+// Buses asleep or ignition off: nothing stalls on a flash write
+static void writeAll() {
+  while (ramTail != ramHead) {
+    writeChunk(DRIVE_LOG_BLOCK_SIZE);
+  }
+}
+
+static void encodeFrame(const LoggedFrame& frame) {
+  advanceClock(frame.us);
+  if (!blockOpen) {
+    openBlock(frame.us);
+  }
+  if (!logEncodeFrame(encoder, &frame)) {
+    closeBlock();
+    openBlock(frame.us);
+    logEncodeFrame(encoder, &frame);
+  }
+  framesLogged++;
+}
+
+static void drainQueue() {
+  uint32_t tail = queueTail.load(std::memory_order_relaxed);
+  uint32_t head = queueHead.load(std::memory_order_acquire);
+
+  while (tail != head) {
+    const QueuedFrame& queued = queue[tail & (DRIVE_LOG_QUEUE_SIZE - 1)];
+    LoggedFrame frame;
+
+    frame.us = queued.us;
+    frame.id = queued.id;
+    frame.bus = (queued.info >> 4) & 0x01;
+    frame.tx = (queued.info & QUEUED_TX) ? 1 : 0;
+    frame.dlc = queued.info & 0x0F;
+    memcpy(frame.data, queued.data, CAN_MAX_DLEN);
+    queueTail.store(++tail, std::memory_order_release);
+
+    encodeFrame(frame);
+  }
+}
+
+static void eraseFiles() {
+  unsigned long lowest;
+  char path[LOG_PATH_SIZE];
+
+  blockOpen = false;
+  ramTail = ramHead;
+  writeOffset = 0;
+  logFile.close();
+  dumpFile.close();
+  dumping = false;
+  scanFiles(&lowest, 0);
+  while (lowest != 0) {
+    filePath(path, lowest);
+    if (!LittleFS.remove(path)) {
+      break;
+    }
+    scanFiles(&lowest, 0);
+  }
+  fileBlocks = DRIVE_LOG_FILE_BLOCKS;
+}
+
+// Write as much of the dumped file as Serial takes without blocking
+static void dumpChunk() {
+  unsigned long number = dumpRequested.exchange(0);
+  if (number != 0) {
+    char path[LOG_PATH_SIZE];
+    filePath(path, number);
+    dumpFile = LittleFS.open(path, FILE_READ);
+    dumping = dumpFile;
+  }
+  if (!dumpFile) {
+    return;
+  }
+
+  byte buffer[DRIVE_LOG_DUMP_CHUNK];
+  int room = Serial.availableForWrite();
+  size_t length = dumpFile.read(buffer, (room < (int) sizeof(buffer)) ? (room > 0 ? room : 0) : sizeof(buffer));
+  if (length > 0) {
+    Serial.write(buffer, length);
+  } else if (room > 0) {
+    dumpFile.close(); // End of file
+    dumping = false;
+  }
+}
+
+static void logStep() {
+  if (logState == LOG_MOUNTING) {
+    if (mount()) {
+      logState = LOG_RUNNING;
+      driveLogActive = true;
+    } else {
+      logState = LOG_FAILED;
+      if (SerialEnabled) {
+        Serial.println("Drive log: unable to mount the LittleFS partition");
+      }
+    }
+  }
+  if (logState != LOG_RUNNING) {
+    return;
+  }
+
+  countWriteOverruns();
+  drainQueue();
+  if (eraseRequested.exchange(false)) {
+    eraseFiles();
+  }
+  if (flushRequested.exchange(false)) {
+    closeBlock();
+    writeAll();
+  } else if (!schedulerBusAwake(BUS_CAN0) && !schedulerBusAwake(BUS_CAN1)) {
+    writeAll();
+  } else if (ramHead - ramTail >= ramBlocks / 2) {
+    busyWrites++;
+    writeChunk(DRIVE_LOG_WRITE_CHUNK);
+  }
+  dumpChunk();
+}
+
+static void logTask(void*) {
+  for (;;) {
+    logStep();
+    vTaskDelay(dumping ? 1 : pdMS_TO_TICKS(DRIVE_LOG_PERIOD_MS));
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void driveLogBegin() {
+  if (!settings.driveLog) {
+    return;
+  }
+
+  queue = (QueuedFrame*) malloc(DRIVE_LOG_QUEUE_SIZE * sizeof(QueuedFrame));
+  encoder = (LogEncoder*) malloc(sizeof(LogEncoder));
+  if (psramFound()) {
+    blocks = (uint8_t*) ps_malloc((size_t) DRIVE_LOG_RAM_BLOCKS * DRIVE_LOG_BLOCK_SIZE);
+    ramBlocks = DRIVE_LOG_RAM_BLOCKS;
+    inPsram = true;
+  }
+  if (blocks == NULL) {
+    blocks = (uint8_t*) malloc((size_t) DRIVE_LOG_HEAP_BLOCKS * DRIVE_LOG_BLOCK_SIZE);
+    ramBlocks = DRIVE_LOG_HEAP_BLOCKS;
+    inPsram = false;
+  }
+  if (queue == NULL || encoder == NULL || blocks == NULL) {
+    logState = LOG_FAILED;
+    if (SerialEnabled) {
+      Serial.println("Drive log: unable to allocate the buffers");
+    }
+    return;
+  }
+
+  lastUs = micros();
+  elapsedUs = lastUs; // Seconds since start until the clock is set
+  logState = LOG_MOUNTING;
+
+  if (xTaskCreatePinnedToCore(logTask, "driveLog", 6144, NULL, DRIVE_LOG_TASK_PRIORITY, &logTaskHandle, DRIVE_LOG_TASK_CORE) != pdPASS) {
+    logTaskHandle = NULL; // Run from driveLogService()
+  }
+}
+
+void driveLogFrame(byte bus, const struct can_frame* frame, bool tx, unsigned long us) {
+  portENTER_CRITICAL(&queueMux);
+  uint32_t head = queueHead.load(std::memory_order_relaxed);
+  if (head - queueTail.load(std::memory_order_acquire) < DRIVE_LOG_QUEUE_SIZE) {
+    QueuedFrame& queued = queue[head & (DRIVE_LOG_QUEUE_SIZE - 1)];
+    queued.us = us;
+    queued.id = frame->can_id;
+    queued.info = (frame->can_dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : frame->can_dlc) | (bus << 4) | (tx ? QUEUED_TX : 0);
+    memcpy(queued.data, frame->data, CAN_MAX_DLEN);
+    queueHead.store(head + 1, std::memory_order_release);
+  } else {
+    dropped++;
+  }
+  portEXIT_CRITICAL(&queueMux);
+}
+
+void driveLogFlush() {
+  flushRequested = true;
+}
+
+bool driveLogDump(unsigned long number) {
+  char path[LOG_PATH_SIZE];
+
+  if (logState != LOG_RUNNING || number == 0 || dumpRequested.load() != 0 || dumping) {
+    return false;
+  }
+  filePath(path, number);
+  if (!LittleFS.exists(path)) {
+    return false;
+  }
+  dumpRequested = number;
+  return true;
+}
+
+void driveLogErase() {
+  eraseRequested = true;
+}
+
+void driveLogList() {
+  if (logState != LOG_RUNNING) {
+    Serial.println("Drive log not running");
+    return;
+  }
+
+  File dir = LittleFS.open(DRIVE_LOG_DIR);
+  for (File file = dir ? dir.openNextFile() : File(); file; file = dir.openNextFile()) {
+    unsigned long number = fileNumberOf(file.name());
+    if (number == 0) {
+      continue;
+    }
+    Serial.print("  ");
+    Serial.print(number);
+    Serial.print(": ");
+    Serial.print((unsigned long) file.size());
+    Serial.println(number == fileNumber ? " bytes (current)" : " bytes");
+  }
+}
+
+void driveLogService() {
+  if (logTaskHandle == NULL && logState != LOG_OFF) {
+    logStep();
+  }
+}
+
+void driveLogPrintStats() {
+  static const char* const stateNames[] = {"off", "mounting", "running", "mount failed"};
+
+  Serial.print("Drive log: ");
+  Serial.print(stateNames[logState]);
+  if (logState != LOG_RUNNING) {
+    Serial.println();
+    return;
+  }
+  Serial.print(", file ");
+  Serial.print(fileNumber);
+  Serial.print(" (");
+  Serial.print(fileBlocks >= DRIVE_LOG_FILE_BLOCKS ? 0 : fileBlocks);
+  Serial.print("/");
+  Serial.print(DRIVE_LOG_FILE_BLOCKS);
+  Serial.print(" blocks), ");
+  Serial.print(ramHead - ramTail);
+  Serial.print("/");
+  Serial.print(ramBlocks);
+  Serial.print(inPsram ? " blocks in PSRAM" : " blocks in RAM");
+  Serial.print(", frames=");
+  Serial.print(framesLogged);
+  if (framesWritten > 0) {
+    Serial.print(", ");
+    Serial.print((float) bytesEncoded / framesWritten, 1);
+    Serial.print(" bytes/frame");
+  }
+  Serial.print(", dropped=");
+  Serial.print(dropped);
+  Serial.print(", write errors=");
+  Serial.print(writeErrors);
+  Serial.print(", deleted files=");
+  Serial.print(filesDeleted);
+  Serial.print(", busy writes=");
+  Serial.print(busyWrites);
+  Serial.print(", forced=");
+  Serial.print(forcedWrites);
+  Serial.print(", longest write ");
+  Serial.print(maxWriteUs);
+  Serial.print(" us, overruns after writes=");
+  Serial.print(writeOverruns);
+  Serial.print(", partition ");
+  Serial.print((unsigned long) (LittleFS.usedBytes() / 1024));
+  Serial.print("/");
+  Serial.print((unsigned long) (LittleFS.totalBytes() / 1024));
+  Serial.println(" KiB");
+}
@@ -0,0 +1,117 @@
+/*
+ * @file echo_filter.cpp
+ * @brief Suppression of frames the adapter emitted coming back on the other bus
+ *
+ * One direct-mapped table per destination bus, indexed by ID and payload
+ * hash: recording and lookup are O(1). A record overwritten before its TTL
+ * ran out is counted as an eviction; if evictions grow, increase
+ * ECHO_TABLE_SIZE. canSend() runs on several tasks, so the tables are
+ * protected by a spinlock.
+ */
+
+#include <echo_filter.h>
+#include <can_bus.h>
+#include <config.h>
+#include <freertos/FreeRTOS.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert((ECHO_TABLE_SIZE & (ECHO_TABLE_SIZE - 1)) == 0, "ECHO_TABLE_SIZE must be a power of two");
+
+struct EchoRecord {
+  canid_t id;
+  uint32_t hash;
+  unsigned long expiresAt;  // millis(), record unused when 0
+};
+
+struct EchoStats {
+  unsigned long recorded;    // Frames recorded on this bus
+  unsigned long suppressed;  // Echoes of this bus dropped on the other one
+  unsigned long evictions;   // Live records overwritten
+};
+
+static EchoRecord records[BUS_COUNT][ECHO_TABLE_SIZE];
+static EchoStats stats[BUS_COUNT];
+static canid_t inputId[BUS_COUNT] = {0, 0};     // Last frame received per bus, to skip unchanged forwards
+static uint32_t inputHash[BUS_COUNT] = {0, 0};
+static portMUX_TYPE echoMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+// Payload and DLC hash (bytes past the DLC are ignored)
+static uint32_t payloadHash(const struct can_frame* frame) {
+  byte len = frame->can_dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : frame->can_dlc;
+  uint64_t word = 0;
+  memcpy(&word, frame->data, len);
+  word = (word ^ (word >> 29)) * 0xBF58476D1CE4E5B9ULL;
+  return (uint32_t) (word ^ (word >> 32)) ^ len;
+}
+
+static inline unsigned int slotOf(canid_t id, uint32_t hash) {
+  return ((id * 0x9E3779B1UL) ^ hash) & (ECHO_TABLE_SIZE - 1);
+}
+
+static inline bool live(const EchoRecord& record, unsigned long now) {
+  return record.expiresAt != 0 && (long) (record.expiresAt - now) > 0;
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void echoRecord(byte bus, const struct can_frame* frame) {
+  uint32_t hash = payloadHash(frame);
+  byte source = bus ^ 1;
+  unsigned long now = millis();
+
+  portENTER_CRITICAL(&echoMux);
+  if (frame->can_id != inputId[source] || hash != inputHash[source]) {
+    EchoRecord& record = records[bus][slotOf(frame->can_id, hash)];
+    if (live(record, now) && (record.id != frame->can_id || record.hash != hash)) {
+      stats[bus].evictions++;
+    }
+    record.id = frame->can_id;
+    record.hash = hash;
+    record.expiresAt = (now + ECHO_TTL_MS) | 1; // Never 0
+    stats[bus].recorded++;
+  }
+  portEXIT_CRITICAL(&echoMux);
+}
+
+bool echoSuppress(byte bus, const struct can_frame* frame) {
+  uint32_t hash = payloadHash(frame);
+  byte sentOn = bus ^ 1;
+  bool echo = false;
+
+  portENTER_CRITICAL(&echoMux);
+  inputId[bus] = frame->can_id;
+  inputHash[bus] = hash;
+
+  EchoRecord& record = records[sentOn][slotOf(frame->can_id, hash)];
+  if (record.id == frame->can_id && record.hash == hash && live(record, millis())) {
+    record.expiresAt = 0;
+    stats[sentOn].suppressed++;
+    echo = true;
+  }
+  portEXIT_CRITICAL(&echoMux);
+  return echo;
+}
+
+void echoPrintStats() {
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    Serial.print("Echo filter CAN");
+    Serial.print(bus);
+    Serial.print(": recorded=");
+    Serial.print(stats[bus].recorded);
+    Serial.print(", echoes suppressed on CAN");
+    Serial.print(bus ^ 1);
+    Serial.print("=");
+    Serial.print(stats[bus].suppressed);
+    Serial.print(", evictions=");
+    Serial.println(stats[bus].evictions);
+  }
+}
@@ -0,0 +1,339 @@
+/*
+ * @file flight_recorder.cpp
+ * @brief Rolling record of both buses in PSRAM, frozen by a trigger
+ *
+ * Multi-producer ring without locks: a writer reserves a position with
+ * fetch_add on head, fills the record and stores its sequence (position + 1)
+ * last. The dump only runs once the recorder is frozen, so writers have
+ * stopped; a record reserved just before the freeze and not finished has a
+ * stale sequence and is skipped. Positions before startPos belong to an
+ * earlier recording and are never dumped, so the ring needs no clearing.
+ */
+
+#include <flight_recorder.h>
+#include <can_bus.h>
+#include <capture.h>
+#include <config.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert((FLIGHT_RECORDER_RECORDS & (FLIGHT_RECORDER_RECORDS - 1)) == 0, "FLIGHT_RECORDER_RECORDS must be a power of two");
+static_assert((FLIGHT_RECORDER_HEAP_RECORDS & (FLIGHT_RECORDER_HEAP_RECORDS - 1)) == 0, "FLIGHT_RECORDER_HEAP_RECORDS must be a power of two");
+
+#define RECORD_TX 0x20  // info: frame sent by the adapter
+
+struct FlightRecord {
+  uint32_t seq;      // Ring position + 1, stored last
+  uint32_t us;       // micros() when read from / loaded into the controller
+  uint32_t id;       // can_id, EFF/RTR flags included
+  uint8_t info;      // DLC (bits 0-3), bus (bit 4), RECORD_TX
+  uint8_t data[CAN_MAX_DLEN];
+};
+
+std::atomic<byte> flightState(FLIGHT_RECORDING);
+
+static FlightRecord* records = NULL;
+static uint32_t recordMask = 0;                // Capacity - 1
+static bool inPsram = false;
+static std::atomic<uint32_t> head(0);          // Next position to reserve
+static uint32_t startPos = 0;                  // First position of the current recording
+static std::atomic<byte> armed(FLIGHT_RECORDER_TRIGGERS);
+static portMUX_TYPE triggerMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ID / data pattern trigger
+static canid_t matchId = 0;
+static uint64_t matchMask = 0;
+static uint64_t matchValue = 0;
+
+// Last trigger
+static byte triggerCause = 0;
+static byte triggerBus = 0xFF;
+static unsigned long triggerUs = 0;
+static unsigned long triggerMs = 0;
+static unsigned long freezeAtUs = 0;    // End of the post-trigger window
+static unsigned long triggerCount = 0;
+static bool freezeReported = true;
+
+// Dump
+static TaskHandle_t dumpTaskHandle = NULL;
+static uint32_t dumpPos = 0;
+static uint32_t dumpEnd = 0;
+static unsigned long dumped = 0;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static const char* causeName(byte cause) {
+  switch (cause) {
+  case FLIGHT_TRIGGER_MANUAL: return "manual";
+  case FLIGHT_TRIGGER_MATCH: return "match";
+  case FLIGHT_TRIGGER_BUS_OFF: return "bus-off";
+  case FLIGHT_TRIGGER_TX_DROP: return "TX drop";
+  default: return "none";
+  }
+}
+
+static inline bool matchesPattern(const struct can_frame* frame) {
+  uint64_t data;
+  memcpy(&data, frame->data, sizeof(data));
+  return ((data ^ matchValue) & matchMask) == 0;
+}
+
+static void freeze() {
+  byte expected = FLIGHT_TRIGGERED;
+  flightState.compare_exchange_strong(expected, FLIGHT_FROZEN);
+}
+
+// Oldest position still in the ring
+static uint32_t oldestPos(uint32_t end) {
+  uint32_t capacity = recordMask + 1;
+  return (end - startPos > capacity) ? end - capacity : startPos;
+}
+
+// Trigger record, first of the dump (layout in capture.h)
+static void writeTriggerRecord() {
+  struct can_frame record;
+  byte encoded[CAPTURE_RECORD_MAX];
+  uint32_t count = dumpEnd - dumpPos;
+
+  record.can_id = CAPTURE_RECORDER_ID;
+  record.can_dlc = 6;
+  record.data[0] = triggerCause;
+  record.data[1] = triggerBus;
+  record.data[2] = count;
+  record.data[3] = count >> 8;
+  record.data[4] = count >> 16;
+  record.data[5] = count >> 24;
+  Serial.write(encoded, captureEncode(encoded, triggerBus == 0xFF ? BUS_CAN0 : triggerBus, &record, false, triggerUs));
+}
+
+// Write as many records as Serial takes without blocking, returns false once done
+static bool dumpChunk() {
+  byte buffer[FLIGHT_RECORDER_DUMP_CHUNK * CAPTURE_RECORD_MAX];
+  int room = Serial.availableForWrite();
+  unsigned int length = 0;
+
+  while (dumpPos != dumpEnd && room - (int) length >= CAPTURE_RECORD_MAX && length + CAPTURE_RECORD_MAX <= sizeof(buffer)) {
+    const FlightRecord& record = records[dumpPos & recordMask];
+    if (__atomic_load_n(&record.seq, __ATOMIC_ACQUIRE) == dumpPos + 1) {
+      struct can_frame frame;
+      frame.can_id = record.id;
+      frame.can_dlc = record.info & 0x0F;
+      memcpy(frame.data, record.data, CAN_MAX_DLEN);
+      length += captureEncode(buffer + length, (record.info >> 4) & 0x01, &frame, record.info & RECORD_TX, record.us);
+      dumped++;
+    }
+    dumpPos++;
+  }
+  if (length > 0) {
+    Serial.write(buffer, length);
+  }
+
+  if (dumpPos == dumpEnd) {
+    flightState.store(FLIGHT_FROZEN);
+    return false;
+  }
+  return true;
+}
+
+static void dumpTask(void*) {
+  while (dumpChunk()) {
+    vTaskDelay(1);
+  }
+  dumpTaskHandle = NULL;
+  vTaskDelete(NULL);
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void flightRecorderBegin() {
+  if (psramFound()) {
+    records = (FlightRecord*) ps_malloc(FLIGHT_RECORDER_RECORDS * sizeof(FlightRecord));
+  }
+  if (records != NULL) {
+    recordMask = FLIGHT_RECORDER_RECORDS - 1;
+    inPsram = true;
+  } else {
+    records = (FlightRecord*) malloc(FLIGHT_RECORDER_HEAP_RECORDS * sizeof(FlightRecord));
+    recordMask = FLIGHT_RECORDER_HEAP_RECORDS - 1;
+  }
+
+  if (records == NULL && SerialEnabled) {
+    Serial.println("Flight recorder: unable to allocate the ring");
+  }
+}
+
+void flightRecordFrame(byte bus, const struct can_frame* frame, bool tx, unsigned long us) {
+  if (records == NULL) {
+    return;
+  }
+
+  uint32_t pos = head.fetch_add(1, std::memory_order_relaxed);
+  FlightRecord& record = records[pos & recordMask];
+  record.us = us;
+  record.id = frame->can_id;
+  record.info = (frame->can_dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : frame->can_dlc) | (bus << 4) | (tx ? RECORD_TX : 0);
+  memcpy(record.data, frame->data, CAN_MAX_DLEN);
+  __atomic_store_n(&record.seq, pos + 1, __ATOMIC_RELEASE);
+
+  if ((armed.load(std::memory_order_relaxed) & FLIGHT_TRIGGER_MATCH) && frame->can_id == matchId && matchesPattern(frame)) {
+    flightRecorderTrigger(FLIGHT_TRIGGER_MATCH, bus);
+  }
+  if (flightState.load(std::memory_order_acquire) == FLIGHT_TRIGGERED && (long) (us - freezeAtUs) >= 0) {
+    freeze();
+  }
+}
+
+void flightRecorderTrigger(FlightTrigger cause, byte bus) {
+  if (records == NULL || (cause != FLIGHT_TRIGGER_MANUAL && !(armed.load(std::memory_order_relaxed) & cause))) {
+    return;
+  }
+
+  portENTER_CRITICAL(&triggerMux);
+  if (flightState.load(std::memory_order_relaxed) == FLIGHT_RECORDING) {
+    triggerCause = cause;
+    triggerBus = bus;
+    triggerUs = micros();
+    triggerMs = millis();
+    freezeAtUs = triggerUs + FLIGHT_RECORDER_POST_MS * 1000UL;
+    triggerCount++;
+    freezeReported = false;
+    flightState.store(FLIGHT_RECORDER_POST_MS > 0 ? FLIGHT_TRIGGERED : FLIGHT_FROZEN, std::memory_order_release);
+  }
+  portEXIT_CRITICAL(&triggerMux);
+}
+
+void flightRecorderArm(byte triggers, bool enable) {
+  if (enable) {
+    armed.fetch_or(triggers);
+  } else {
+    armed.fetch_and(~triggers);
+  }
+}
+
+void flightRecorderSetMatch(canid_t id, const uint8_t* mask, const uint8_t* value) {
+  armed.fetch_and(~FLIGHT_TRIGGER_MATCH);
+  matchId = id;
+  memcpy(&matchMask, mask, sizeof(matchMask));
+  memcpy(&matchValue, value, sizeof(matchValue));
+  matchValue &= matchMask;
+  armed.fetch_or(FLIGHT_TRIGGER_MATCH);
+}
+
+void flightRecorderResume() {
+  if (flightState.load() == FLIGHT_DUMPING) {
+    return;
+  }
+
+  portENTER_CRITICAL(&triggerMux);
+  startPos = head.load();
+  triggerCause = 0;
+  triggerBus = 0xFF;
+  flightState.store(FLIGHT_RECORDING);
+  portEXIT_CRITICAL(&triggerMux);
+}
+
+bool flightRecorderDump() {
+  if (records == NULL || flightState.load() == FLIGHT_DUMPING) {
+    return false;
+  }
+
+  if (flightState.load() != FLIGHT_FROZEN) {
+    flightRecorderTrigger(FLIGHT_TRIGGER_MANUAL, 0xFF);
+    flightState.store(FLIGHT_FROZEN);
+    freezeReported = true;
+    delay(1); // Let writers that reserved a record before the freeze finish it
+  }
+
+  dumpEnd = head.load(std::memory_order_acquire);
+  dumpPos = oldestPos(dumpEnd);
+  dumped = 0;
+  flightState.store(FLIGHT_DUMPING);
+  writeTriggerRecord();
+
+  if (xTaskCreatePinnedToCore(dumpTask, "recorderDump", 4096, NULL, FLIGHT_RECORDER_TASK_PRIORITY, &dumpTaskHandle, FLIGHT_RECORDER_TASK_CORE) != pdPASS) {
+    dumpTaskHandle = NULL; // Written from flightRecorderService()
+  }
+  return true;
+}
+
+void flightRecorderService() {
+  byte state = flightState.load();
+
+  if (state == FLIGHT_TRIGGERED && (long) (micros() - freezeAtUs) >= 0) {
+    freeze(); // No traffic since the end of the post-trigger window
+  } else if (state == FLIGHT_DUMPING && dumpTaskHandle == NULL) {
+    dumpChunk();
+  }
+
+  if (state >= FLIGHT_FROZEN && !freezeReported) {
+    freezeReported = true;
+    if (SerialEnabled && !captureActive()) {
+      Serial.print("Flight recorder frozen by ");
+      Serial.print(causeName(triggerCause));
+      Serial.println(", \"recorder dump\" to read it");
+    }
+  }
+}
+
+void flightRecorderPrintStats() {
+  static const char* const stateNames[] = {"recording", "triggered", "frozen", "dumping"};
+
+  Serial.print("Flight recorder: ");
+  if (records == NULL) {
+    Serial.println("no ring allocated");
+    return;
+  }
+
+  uint32_t end = head.load();
+  uint32_t oldest = oldestPos(end);
+  Serial.print(stateNames[flightState.load()]);
+  Serial.print(", ");
+  Serial.print(end - oldest);
+  Serial.print("/");
+  Serial.print(recordMask + 1);
+  Serial.print(inPsram ? " records in PSRAM" : " records in RAM");
+  if (end != oldest) {
+    Serial.print(", span=");
+    Serial.print((records[(end - 1) & recordMask].us - records[oldest & recordMask].us) / 1000000.0f, 1);
+    Serial.print(" s");
+  }
+  if (flightState.load() == FLIGHT_DUMPING) {
+    Serial.print(", dumped=");
+    Serial.print(dumped);
+  }
+  Serial.println();
+
+  byte triggers = armed.load();
+  Serial.print("  armed: manual");
+  if (triggers & FLIGHT_TRIGGER_MATCH) {
+    Serial.print(", match 0x");
+    Serial.print((unsigned long) (matchId & CAN_EFF_MASK), HEX);
+  }
+  if (triggers & FLIGHT_TRIGGER_BUS_OFF) Serial.print(", bus-off");
+  if (triggers & FLIGHT_TRIGGER_TX_DROP) Serial.print(", TX drop");
+  Serial.print("; triggers=");
+  Serial.print(triggerCount);
+  if (triggerCause != 0) {
+    Serial.print(", last: ");
+    Serial.print(causeName(triggerCause));
+    if (triggerBus != 0xFF) {
+      Serial.print(" CAN");
+      Serial.print(triggerBus);
+    }
+    Serial.print(" at ");
+    Serial.print(triggerMs);
+    Serial.print(" ms");
+  }
+  Serial.println();
+}
@@ -0,0 +1,220 @@
+/*
+ * @file gateway.cpp
+ * @brief Dual-core gateway: one task per direction and cross-direction state
+ *
+ * Each path owns one single-producer/single-consumer mailbox. The other path
+ * is the only producer (gatewayPost) and the owning path the only consumer
+ * (gatewayApply), so no lock is needed between the two cores.
+ *
+ * Posting never waits: a value that finds the mailbox full is kept on the
+ * producer side (a newer value of the same variable replaces it) and posted
+ * at the producer path's next gatewayPost() or gatewayApply().
+ */
+
+#include <gateway.h>
+#include <can_bus.h>
+#include <config.h>
+#include <settings.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert((GATEWAY_MAILBOX_SIZE & (GATEWAY_MAILBOX_SIZE - 1)) == 0, "GATEWAY_MAILBOX_SIZE must be a power of two");
+
+struct StatePost {
+  void* dst;
+  byte len;
+  byte value[8];
+};
+
+struct PendingPost {
+  void* dst;
+  byte len;
+  byte value[8];
+};
+
+struct Mailbox {
+  StatePost posts[GATEWAY_MAILBOX_SIZE];
+  std::atomic<unsigned int> head;  // Written by the posting path
+  std::atomic<unsigned int> tail;  // Written by the owning path
+
+  // Producer side only: values that found the mailbox full, in posting order
+  PendingPost pending[GATEWAY_PENDING_MAX];
+  byte pendingCount;
+  unsigned long deferred;  // Posts kept pending or replacing a pending value
+  unsigned long lost;      // Mailbox full and GATEWAY_PENDING_MAX variables already pending
+};
+
+static Mailbox mailbox[PATH_COUNT];
+static TaskHandle_t deviceTaskHandle = NULL;
+static void (*deviceBatchFn)() = NULL;
+
+static std::atomic<unsigned long> busyUs[PATH_COUNT];
+static unsigned long lastBusyUs[PATH_COUNT] = {0, 0};
+static unsigned long lastStatsTime = 0;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+// Producer side: false if the mailbox is full
+static bool enqueuePost(Mailbox& box, void* dst, const void* value, byte len) {
+  unsigned int head = box.head.load(std::memory_order_relaxed);
+  if (head - box.tail.load(std::memory_order_acquire) >= GATEWAY_MAILBOX_SIZE) {
+    return false;
+  }
+
+  StatePost& post = box.posts[head & (GATEWAY_MAILBOX_SIZE - 1)];
+  post.dst = dst;
+  post.len = len;
+  memcpy(post.value, value, len);
+  box.head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+// Producer side: post the values kept while the mailbox was full, oldest first
+static void flushPending(Mailbox& box) {
+  byte sent = 0;
+  while (sent < box.pendingCount && enqueuePost(box, box.pending[sent].dst, box.pending[sent].value, box.pending[sent].len)) {
+    sent++;
+  }
+  if (sent > 0) {
+    box.pendingCount -= sent;
+    memmove(box.pending, box.pending + sent, box.pendingCount * sizeof(PendingPost));
+  }
+}
+
+static void deviceTask(void*) {
+  for (;;) {
+    // Woken by the RX task when CAN1 frames arrive, timeout keeps posted state flowing
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GATEWAY_DEVICE_IDLE_MS));
+    deviceBatchFn();
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void gatewayBegin(void (*deviceBatch)()) {
+  deviceBatchFn = deviceBatch;
+  lastStatsTime = micros();
+
+  if (!settings.dualCoreGateway) {
+    return;
+  }
+
+  if (xTaskCreatePinnedToCore(deviceTask, "gwDevice", 8192, NULL, GATEWAY_DEVICE_TASK_PRIORITY, &deviceTaskHandle, GATEWAY_DEVICE_TASK_CORE) != pdPASS) {
+    deviceTaskHandle = NULL;
+    if (SerialEnabled) {
+      Serial.println("Gateway: unable to start device task, single-loop mode");
+    }
+    return;
+  }
+
+  canSetConsumer(BUS_CAN1, deviceTaskHandle);
+
+  if (SerialEnabled) {
+    Serial.print("Gateway: dual-core mode, CAN0 path on core ");
+    Serial.print(xPortGetCoreID());
+    Serial.print(", CAN1 path on core ");
+    Serial.println(GATEWAY_DEVICE_TASK_CORE);
+  }
+}
+
+bool gatewayDualCore() {
+  return deviceTaskHandle != NULL;
+}
+
+void gatewayPost(byte path, void* dst, const void* value, byte len) {
+  if (deviceTaskHandle == NULL) {
+    memcpy(dst, value, len);
+    return;
+  }
+
+  Mailbox& box = mailbox[path];
+  if (box.pendingCount > 0) {
+    flushPending(box);
+  }
+
+  // Still waiting for room: replace a pending value of the same variable, or queue behind them
+  if (box.pendingCount > 0) {
+    box.deferred++;
+    for (byte i = 0; i < box.pendingCount; i++) {
+      if (box.pending[i].dst == dst) {
+        box.pending[i].len = len;
+        memcpy(box.pending[i].value, value, len);
+        return;
+      }
+    }
+  } else if (enqueuePost(box, dst, value, len)) {
+    return;
+  } else {
+    box.deferred++;
+  }
+
+  if (box.pendingCount == GATEWAY_PENDING_MAX) {
+    box.lost++;
+    return;
+  }
+  PendingPost& entry = box.pending[box.pendingCount++];
+  entry.dst = dst;
+  entry.len = len;
+  memcpy(entry.value, value, len);
+}
+
+void gatewayApply(byte path) {
+  Mailbox& box = mailbox[path];
+  unsigned int tail = box.tail.load(std::memory_order_relaxed);
+  unsigned int head = box.head.load(std::memory_order_acquire);
+
+  while (tail != head) {
+    const StatePost& post = box.posts[tail & (GATEWAY_MAILBOX_SIZE - 1)];
+    memcpy(post.dst, post.value, post.len);
+    tail++;
+  }
+  box.tail.store(tail, std::memory_order_release);
+
+  // This path produces the other path's mailbox
+  Mailbox& other = mailbox[PATH_COUNT - 1 - path];
+  if (other.pendingCount > 0) {
+    flushPending(other);
+  }
+}
+
+void gatewayAddBusy(byte path, unsigned long us) {
+  busyUs[path].fetch_add(us, std::memory_order_relaxed);
+}
+
+void gatewayPrintStats() {
+  unsigned long now = micros();
+  unsigned long window = now - lastStatsTime;
+  lastStatsTime = now;
+
+  if (window == 0) {
+    return;
+  }
+
+  for (byte path = 0; path < PATH_COUNT; path++) {
+    unsigned long total = busyUs[path].load(std::memory_order_relaxed);
+    unsigned long busy = total - lastBusyUs[path];
+    lastBusyUs[path] = total;
+
+    Serial.print(path == PATH_CAR ? "CAN0 -> CAN1 path" : "CAN1 -> CAN0 path");
+    Serial.print(" (core ");
+    Serial.print((path == PATH_DEVICE && deviceTaskHandle != NULL) ? GATEWAY_DEVICE_TASK_CORE : ARDUINO_RUNNING_CORE);
+    Serial.print("): ");
+    Serial.print(100.0 * busy / window, 1);
+    Serial.print("% busy, posts to it deferred/lost: ");
+    Serial.print(mailbox[path].deferred);
+    Serial.print("/");
+    Serial.println(mailbox[path].lost);
+  }
+}
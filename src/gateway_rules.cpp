@@ -0,0 +1,672 @@
+/*
+ * @file gateway_rules.cpp
+ * @brief Frame rewrite rules loaded from NVS and compiled at boot
+ */
+
+#include <gateway_rules.h>
+#include <can_bus.h>
+#include <can_dispatch.h>
+#include <can_utils.h>
+#include <config.h>
+#include <settings.h>
+#include <Preferences.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+extern struct can_frame canMsgRcv;
+extern struct can_frame canMsgRcvDevice;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert(GATEWAY_RULES_MAX < 256, "Rule links are stored on one byte");
+static_assert(GATEWAY_RULES_MAX_TABLES <= 256, "Table indexes are stored on one byte");
+
+// Output byte computed from a received byte (copy, lut, scale)
+struct RuleMap {
+  uint8_t dst;    // Output byte
+  uint8_t src;    // Received byte
+  uint8_t table;  // 256-byte table
+};
+
+#define KEEP_DLC 0xFF
+#define NO_SUM 0xFF
+
+struct Rule {
+  uint64_t matchMask;    // Received bytes 0-7 as loaded by memcpy()
+  uint64_t matchValue;
+  uint64_t keepMask;     // Received bytes kept in the output
+  uint64_t setValue;     // Constant output bytes (set)
+  uint16_t dlcMask;      // Accepted received lengths (can_dispatch.h)
+  uint16_t id;
+  uint16_t outId;
+  uint16_t firstMap;
+  uint8_t mapCount;
+  uint8_t outDlc;        // KEEP_DLC: received length
+  uint8_t sumByte;       // Output byte of the 0xE6 checksum, NO_SUM: none
+  uint8_t sendMask;      // Bit n: send to bus n
+  uint8_t bus;
+  uint8_t next;          // Next rule of the same ID + 1, 0 = none
+  uint8_t line;          // Line in the rule text, from 1
+  unsigned long hits;    // Written by the path of the rule's bus only
+};
+
+// Default rules: the byte rewrites formerly hand-written in main.cpp
+static const char defaultRules[] =
+  "can0 E6 dlc<8: len 8, sum 7 e6\n"      // ABS status: 8 bytes on CAN2010, checksum / counter in byte 7
+  "can0 321 dlc<5: len 5, set 4 00\n"     // DrumVlado: 5-byte 0x321
+  "can1 1E5 dlc=7: "                      // Audio settings
+    "lut 6 5 00=40 08=44 10=48 18=4C 28=54 20=50 *=40, "  // Ambience: User, Classical, Jazz, Pop-Rock, Techno, Vocal
+    "lut 5 4 10=40 14=47 04=07 00=00 *=00, "              // Loudness / volume linked to speed
+    "scale 2 2 1/4+49, scale 4 3 1/4+49, "                // Bass, treble (moved to byte 4): "32" > "88" to "54" > "72"
+    "scale 1 1 1/4+49, scale 0 0 1/4+49, "                // Balance left / right, front / back
+    "set 3 3F\n";                                          // Mediums ?
+
+// Stored record: version byte followed by the rule lines ('\n' terminated)
+static char ruleRecord[1 + GATEWAY_RULES_TEXT_SIZE];
+static char* const ruleText = ruleRecord + 1;
+static bool edited = false;  // Rule text changed since boot: line numbers no longer match the compiled rules
+
+static Rule rules[GATEWAY_RULES_MAX];
+static byte ruleCount = 0;
+static RuleMap maps[GATEWAY_RULES_MAX_MAPS];
+static uint16_t mapCount = 0;
+static uint8_t tables[GATEWAY_RULES_MAX_TABLES][256];
+static uint16_t tableCount = 0;
+static byte ruleIndex[BUS_COUNT][0x800];  // First rule of each ID + 1, 0 = none
+static uint64_t lengthMask[16];           // Bytes 0 to DLC - 1 as loaded by memcpy()
+
+// Compiler output not committed yet
+struct RuleCompiler {
+  uint16_t mapCount;
+  uint16_t tableCount;
+};
+
+// Output of the actions of one rule: the last action writing a byte wins
+struct RuleBuilder {
+  uint8_t setMask[8];
+  uint8_t setValue[8];
+  int16_t table[8];  // Map of each output byte, -1: none
+  uint8_t src[8];
+  bool sent;
+  bool dropped;
+};
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static void runRules(byte bus, const struct can_frame* in) {
+  uint64_t data;
+  memcpy(&data, in->data, sizeof(data));
+
+  for (byte r = ruleIndex[bus][in->can_id]; r != 0; r = rules[r - 1].next) {
+    Rule& rule = rules[r - 1];
+    if (!((rule.dlcMask >> in->can_dlc) & 1) || (data & rule.matchMask) != rule.matchValue) {
+      continue;
+    }
+    rule.hits++;
+
+    // Kept and constant bytes at once, bytes past the received length are zero
+    struct can_frame out;
+    uint64_t bytes = (data & rule.keepMask & lengthMask[in->can_dlc]) | rule.setValue;
+    memcpy(out.data, &bytes, sizeof(bytes));
+    out.can_id = rule.outId;
+    out.can_dlc = (rule.outDlc == KEEP_DLC) ? in->can_dlc : rule.outDlc;
+
+    const RuleMap* map = maps + rule.firstMap;
+    for (const RuleMap* end = map + rule.mapCount; map < end; map++) {
+      out.data[map->dst] = tables[map->table][in->data[map->src]];
+    }
+    if (rule.sumByte != NO_SUM) {
+      out.data[rule.sumByte] = checksumm_0E6(out.data);
+    }
+    if (rule.sendMask & (1 << BUS_CAN0)) {
+      canSend(BUS_CAN0, & out);
+    }
+    if (rule.sendMask & (1 << BUS_CAN1)) {
+      canSend(BUS_CAN1, & out);
+    }
+    return;
+  }
+
+  canSend(bus == BUS_CAN0 ? BUS_CAN1 : BUS_CAN0, in); // No rule matches: forward unchanged
+}
+
+static void handleCAN0_Rules() {
+  runRules(BUS_CAN0, & canMsgRcv);
+}
+
+static void handleCAN1_Rules() {
+  runRules(BUS_CAN1, & canMsgRcvDevice);
+}
+
+static bool parseNumber(const char* token, int base, long min, long max, long* value) {
+  char* end;
+  if (token == NULL || *token == '\0') {
+    return false;
+  }
+  *value = strtol(token, &end, base);
+  return *end == '\0' && *value >= min && *value <= max;
+}
+
+static bool parseBus(const char* token, uint8_t* bus) {
+  if (token != NULL && strcmp(token, "can0") == 0) {
+    *bus = BUS_CAN0;
+  } else if (token != NULL && strcmp(token, "can1") == 0) {
+    *bus = BUS_CAN1;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// "dlc=N", "dlc<N", "dlc>=N"
+static bool parseDlc(const char* token, uint16_t* dlcMask) {
+  long n;
+  if (strncmp(token, "dlc>=", 5) == 0 && parseNumber(token + 5, 10, 0, 8, &n)) {
+    *dlcMask &= DLC_FROM(n);
+  } else if (strncmp(token, "dlc<", 4) == 0 && parseNumber(token + 4, 10, 1, 9, &n)) {
+    *dlcMask &= DLC_BELOW(n);
+  } else if (strncmp(token, "dlc=", 4) == 0 && parseNumber(token + 4, 10, 0, 8, &n)) {
+    *dlcMask &= DLC_EQ(n);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// "bN&MM=VV" or "bN=VV"
+static bool parseByteMatch(const char* token, uint8_t* mask, uint8_t* value) {
+  char* end;
+  if (token[0] != 'b' || token[1] < '0' || token[1] > '7') {
+    return false;
+  }
+  byte n = token[1] - '0';
+  const char* p = token + 2;
+  unsigned long m = 0xFF;
+
+  if (*p == '&') {
+    m = strtoul(p + 1, &end, 16);
+    if (end == p + 1 || m > 0xFF) {
+      return false;
+    }
+    p = end;
+  }
+  if (*p != '=') {
+    return false;
+  }
+  unsigned long v = strtoul(p + 1, &end, 16);
+  if (end == p + 1 || *end != '\0' || v > 0xFF || (v & ~m) != 0) {
+    return false;
+  }
+  mask[n] |= m;
+  value[n] = (value[n] & ~m) | v;
+  return true;
+}
+
+// Index of an identical existing table, or keep the candidate built at tables[compiler->tableCount]
+static uint8_t addTable(RuleCompiler* compiler) {
+  const uint8_t* candidate = tables[compiler->tableCount];
+  for (uint16_t i = 0; i < compiler->tableCount; i++) {
+    if (memcmp(tables[i], candidate, 256) == 0) {
+      return i;
+    }
+  }
+  return compiler->tableCount++;
+}
+
+static bool isIdentity(const uint8_t* table) {
+  for (int k = 0; k < 256; k++) {
+    if (table[k] != k) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// "lut D S K=V ... [*=V]": built at tables[compiler->tableCount]
+static const char* buildLut(RuleCompiler* compiler, char** save) {
+  uint8_t* table = tables[compiler->tableCount];
+  bool listed[256] = {false};
+  long def = -1;
+  char* token;
+
+  for (int k = 0; k < 256; k++) {
+    table[k] = k;
+  }
+  while ((token = strtok_r(NULL, " ", save)) != NULL) {
+    char* equal = strchr(token, '=');
+    long k, v;
+    if (equal == NULL) {
+      return "lut entries are K=V";
+    }
+    *equal = '\0';
+    if (!parseNumber(equal + 1, 16, 0, 0xFF, &v)) {
+      return "invalid lut value";
+    }
+    if (strcmp(token, "*") == 0) {
+      def = v;
+    } else if (parseNumber(token, 16, 0, 0xFF, &k)) {
+      table[k] = v;
+      listed[k] = true;
+    } else {
+      return "invalid lut key";
+    }
+  }
+  if (def >= 0) {
+    for (int k = 0; k < 256; k++) {
+      if (!listed[k]) {
+        table[k] = def;
+      }
+    }
+  }
+  return NULL;
+}
+
+// "scale D S M/Q+O": built at tables[compiler->tableCount]
+static const char* buildScale(RuleCompiler* compiler, const char* expression) {
+  uint8_t* table = tables[compiler->tableCount];
+  char* end;
+  long mul, div = 1, offset = 0;
+
+  mul = strtol(expression, &end, 10);
+  if (end == expression) {
+    return "invalid scale";
+  }
+  if (*end == '/') {
+    const char* start = end + 1;
+    div = strtol(start, &end, 10);
+    if (end == start || div == 0) {
+      return "invalid scale divisor";
+    }
+  }
+  if (*end == '+' || *end == '-') {
+    const char* start = end;
+    offset = strtol(start, &end, 10);
+    if (end == start + 1) {
+      return "invalid scale offset";
+    }
+  }
+  if (*end != '\0') {
+    return "invalid scale";
+  }
+
+  for (long k = 0; k < 256; k++) {
+    long v = k * mul / div + offset;
+    table[k] = v < 0 ? 0 : (v > 0xFF ? 0xFF : v);
+  }
+  return NULL;
+}
+
+static const char* compileAction(RuleCompiler* compiler, Rule* rule, RuleBuilder* builder, char* action) {
+  char* save;
+  char* keyword = strtok_r(action, " ", &save);
+  long dst, src, value;
+
+  if (keyword == NULL) {
+    return "empty action";
+  }
+
+  if (strcmp(keyword, "id") == 0) {
+    if (!parseNumber(strtok_r(NULL, " ", &save), 16, 0, 0x7FF, &value)) {
+      return "invalid id";
+    }
+    rule->outId = value;
+  } else if (strcmp(keyword, "len") == 0) {
+    if (!parseNumber(strtok_r(NULL, " ", &save), 10, 0, 8, &value)) {
+      return "invalid len";
+    }
+    rule->outDlc = value;
+  } else if (strcmp(keyword, "drop") == 0) {
+    builder->dropped = true;
+  } else if (strcmp(keyword, "send") == 0) {
+    uint8_t bus;
+    if (!parseBus(strtok_r(NULL, " ", &save), &bus)) {
+      return "send needs can0 or can1";
+    }
+    rule->sendMask |= 1 << bus;
+    builder->sent = true;
+  } else if (strcmp(keyword, "set") == 0 || strcmp(keyword, "sum") == 0 || strcmp(keyword, "copy") == 0 ||
+             strcmp(keyword, "lut") == 0 || strcmp(keyword, "scale") == 0) {
+    if (!parseNumber(strtok_r(NULL, " ", &save), 10, 0, 7, &dst)) {
+      return "invalid output byte";
+    }
+    builder->setMask[dst] = 0;
+    builder->setValue[dst] = 0;
+    builder->table[dst] = -1;
+
+    if (strcmp(keyword, "set") == 0) {
+      if (!parseNumber(strtok_r(NULL, " ", &save), 16, 0, 0xFF, &value)) {
+        return "invalid value";
+      }
+      builder->setMask[dst] = 0xFF;
+      builder->setValue[dst] = value;
+    } else if (strcmp(keyword, "sum") == 0) {
+      const char* algorithm = strtok_r(NULL, " ", &save);
+      if (algorithm == NULL || strcmp(algorithm, "e6") != 0) {
+        return "unknown checksum (e6)";
+      }
+      rule->sumByte = dst;
+    } else {
+      if (!parseNumber(strtok_r(NULL, " ", &save), 10, 0, 7, &src)) {
+        return "invalid source byte";
+      }
+      if (compiler->tableCount >= GATEWAY_RULES_MAX_TABLES) {
+        return "too many tables, increase GATEWAY_RULES_MAX_TABLES";
+      }
+
+      const char* error = NULL;
+      if (keyword[0] == 'c') {
+        for (int k = 0; k < 256; k++) {
+          tables[compiler->tableCount][k] = k;
+        }
+      } else if (keyword[0] == 'l') {
+        error = buildLut(compiler, &save);
+      } else {
+        const char* expression = strtok_r(NULL, " ", &save);
+        error = expression == NULL ? "scale needs M/Q+O" : buildScale(compiler, expression);
+      }
+      if (error != NULL) {
+        return error;
+      }
+      builder->table[dst] = addTable(compiler);
+      builder->src[dst] = src;
+    }
+  } else {
+    return "unknown action";
+  }
+
+  return strtok_r(NULL, " ", &save) == NULL ? NULL : "too many arguments";
+}
+
+// Compile one rule line (modified in place) into maps and tables past the committed ones
+static const char* compileRule(RuleCompiler* compiler, Rule* rule, char* text) {
+  char* actions = strchr(text, ':');
+  char* save;
+  uint8_t mask[8] = {0}, value[8] = {0};
+  RuleBuilder builder;
+  long id;
+
+  if (actions == NULL) {
+    return "missing ':' between match and actions";
+  }
+  *actions++ = '\0';
+
+  memset(rule, 0, sizeof(*rule));
+  rule->dlcMask = DLC_ANY;
+  rule->outDlc = KEEP_DLC;
+  rule->sumByte = NO_SUM;
+  memset(&builder, 0, sizeof(builder));
+  memset(builder.table, 0xFF, sizeof(builder.table));
+
+  if (!parseBus(strtok_r(text, " ", &save), &rule->bus)) {
+    return "rule starts with can0 or can1";
+  }
+  if (!parseNumber(strtok_r(NULL, " ", &save), 16, 0, 0x7FF, &id)) {
+    return "invalid ID";
+  }
+  rule->id = id;
+  rule->outId = id;
+
+  for (char* token = strtok_r(NULL, " ", &save); token != NULL; token = strtok_r(NULL, " ", &save)) {
+    if (!(strncmp(token, "dlc", 3) == 0 ? parseDlc(token, &rule->dlcMask) : parseByteMatch(token, mask, value))) {
+      return "invalid condition";
+    }
+  }
+  if (rule->dlcMask == 0) {
+    return "no length accepted";
+  }
+  memcpy(&rule->matchMask, mask, sizeof(rule->matchMask));
+  memcpy(&rule->matchValue, value, sizeof(rule->matchValue));
+
+  char* actionSave;
+  for (char* action = strtok_r(actions, ",", &actionSave); action != NULL; action = strtok_r(NULL, ",", &actionSave)) {
+    const char* error = compileAction(compiler, rule, &builder, action);
+    if (error != NULL) {
+      return error;
+    }
+  }
+
+  if (builder.dropped && builder.sent) {
+    return "drop with send";
+  }
+  if (!builder.dropped && !builder.sent) {
+    rule->sendMask = 1 << (rule->bus == BUS_CAN0 ? BUS_CAN1 : BUS_CAN0);
+  }
+
+  // Bytes written by an action are not kept; a copy of a byte onto itself is just kept
+  uint8_t keep[8];
+  rule->firstMap = compiler->mapCount;
+  for (byte i = 0; i < 8; i++) {
+    bool identity = builder.table[i] >= 0 && builder.src[i] == i && isIdentity(tables[builder.table[i]]);
+    keep[i] = (builder.setMask[i] == 0 && (builder.table[i] < 0 || identity) && rule->sumByte != i) ? 0xFF : 0;
+    if (builder.table[i] >= 0 && !identity) {
+      if (compiler->mapCount >= GATEWAY_RULES_MAX_MAPS) {
+        return "too many actions, increase GATEWAY_RULES_MAX_MAPS";
+      }
+      maps[compiler->mapCount++] = {i, builder.src[i], (uint8_t) builder.table[i]};
+      rule->mapCount++;
+    }
+  }
+  memcpy(&rule->keepMask, keep, sizeof(rule->keepMask));
+  memcpy(&rule->setValue, builder.setValue, sizeof(rule->setValue));
+  return NULL;
+}
+
+// Copy line number "number" (from 1) of the rule text, NULL if there is none
+static const char* findLine(byte number, size_t* length) {
+  const char* line = ruleText;
+  while (*line != '\0') {
+    const char* end = strchr(line, '\n');
+    size_t size = end ? (size_t) (end - line) : strlen(line);
+    if (--number == 0) {
+      *length = size;
+      return line;
+    }
+    line += size + (end ? 1 : 0);
+  }
+  return NULL;
+}
+
+static bool copyLine(char* buffer, const char* line, size_t length) {
+  if (length >= GATEWAY_RULES_LINE_SIZE) {
+    return false;
+  }
+  memcpy(buffer, line, length);
+  buffer[length] = '\0';
+  return true;
+}
+
+static void loadRules() {
+  Preferences prefs;
+  size_t length = 0;
+
+  if (prefs.begin(SETTINGS_NAMESPACE, true)) {
+    length = prefs.getBytes(GATEWAY_RULES_KEY, ruleRecord, sizeof(ruleRecord) - 1);
+    prefs.end();
+  }
+  if (length == 0 || ruleRecord[0] != GATEWAY_RULES_VERSION) {
+    strcpy(ruleText, defaultRules);
+  } else {
+    ruleRecord[length] = '\0';
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void gatewayRulesBegin() {
+  char buffer[GATEWAY_RULES_LINE_SIZE];
+  const char* line;
+  size_t length;
+
+  for (byte dlc = 0; dlc < 16; dlc++) {
+    uint8_t bytes[8];
+    for (byte i = 0; i < 8; i++) {
+      bytes[i] = i < dlc ? 0xFF : 0;
+    }
+    memcpy(&lengthMask[dlc], bytes, sizeof(lengthMask[dlc]));
+  }
+  loadRules();
+
+  for (byte number = 1; (line = findLine(number, &length)) != NULL; number++) {
+    RuleCompiler compiler = {mapCount, tableCount};
+    Rule rule;
+    const char* error;
+
+    if (!copyLine(buffer, line, length)) {
+      error = "rule too long";
+    } else if (ruleCount >= GATEWAY_RULES_MAX) {
+      error = "too many rules, increase GATEWAY_RULES_MAX";
+    } else {
+      error = compileRule(&compiler, &rule, buffer);
+    }
+    if (error != NULL) {
+      if (SerialEnabled) {
+        Serial.print("Gateway rule ");
+        Serial.print(number);
+        Serial.print(" skipped: ");
+        Serial.println(error);
+      }
+      continue;
+    }
+
+    // Commit, and chain behind the previous rules of the same ID
+    rule.line = number;
+    rules[ruleCount] = rule;
+    mapCount = compiler.mapCount;
+    tableCount = compiler.tableCount;
+
+    byte* link = &ruleIndex[rule.bus][rule.id];
+    while (*link != 0) {
+      link = &rules[*link - 1].next;
+    }
+    *link = ++ruleCount;
+  }
+
+  // One route per ID, accepting the lengths of all its rules
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    for (uint16_t id = 0; id < 0x800; id++) {
+      uint16_t dlcMask = 0;
+      for (byte r = ruleIndex[bus][id]; r != 0; r = rules[r - 1].next) {
+        dlcMask |= rules[r - 1].dlcMask;
+      }
+      if (dlcMask != 0 && !canDispatchAdd(bus, id, dlcMask, bus == BUS_CAN0 ? handleCAN0_Rules : handleCAN1_Rules) && SerialEnabled) {
+        Serial.print("Gateway rules: no dispatch route for ID 0x");
+        Serial.println(id, HEX);
+      }
+    }
+  }
+}
+
+bool gatewayRulesAdd(const char* text, const char** error) {
+  char buffer[GATEWAY_RULES_LINE_SIZE];
+  size_t length = strlen(text);
+  size_t used = strlen(ruleText);
+  RuleCompiler compiler = {mapCount, tableCount};  // Checked only: nothing is committed
+  Rule rule;
+
+  if (!copyLine(buffer, text, length) || strchr(text, '\n') != NULL) {
+    *error = "rule too long";
+    return false;
+  }
+  if (used + length + 1 >= GATEWAY_RULES_TEXT_SIZE) {
+    *error = "no room left, increase GATEWAY_RULES_TEXT_SIZE";
+    return false;
+  }
+  if ((*error = compileRule(&compiler, &rule, buffer)) != NULL) {
+    return false;
+  }
+
+  memcpy(ruleText + used, text, length);
+  ruleText[used + length] = '\n';
+  ruleText[used + length + 1] = '\0';
+  edited = true;
+  return true;
+}
+
+bool gatewayRulesDelete(byte number) {
+  size_t length;
+  char* line = (char*) findLine(number, &length);
+
+  if (number == 0 || line == NULL) {
+    return false;
+  }
+  if (line[length] == '\n') {
+    length++;
+  }
+  memmove(line, line + length, strlen(line + length) + 1);
+  edited = true;
+  return true;
+}
+
+void gatewayRulesDefaults() {
+  strcpy(ruleText, defaultRules);
+  edited = true;
+}
+
+bool gatewayRulesSave() {
+  Preferences prefs;
+
+  ruleRecord[0] = GATEWAY_RULES_VERSION;
+  if (!prefs.begin(SETTINGS_NAMESPACE, false)) {
+    return false;
+  }
+  size_t length = 1 + strlen(ruleText);
+  bool ok = prefs.putBytes(GATEWAY_RULES_KEY, ruleRecord, length) == length;
+  prefs.end();
+  return ok;
+}
+
+void gatewayRulesPrint() {
+  const char* line;
+  size_t length;
+
+  for (byte number = 1; (line = findLine(number, &length)) != NULL; number++) {
+    Serial.print("  ");
+    Serial.print(number);
+    Serial.print(": ");
+    Serial.write((const uint8_t*) line, length);
+
+    if (!edited) {
+      const Rule* compiled = NULL;
+      for (byte r = 0; r < ruleCount; r++) {
+        if (rules[r].line == number) {
+          compiled = &rules[r];
+        }
+      }
+      if (compiled != NULL) {
+        Serial.print("  (");
+        Serial.print(compiled->hits);
+        Serial.println(" frames)");
+      } else {
+        Serial.println("  (not compiled)");
+      }
+    } else {
+      Serial.println();
+    }
+  }
+  if (edited) {
+    Serial.println("  (edited: \"rules save\", then restart to apply)");
+  }
+}
+
+void gatewayRulesPrintStats() {
+  unsigned long hits = 0;
+  for (byte r = 0; r < ruleCount; r++) {
+    hits += rules[r].hits;
+  }
+
+  Serial.print("Gateway rules: ");
+  Serial.print(ruleCount);
+  Serial.print(" compiled (");
+  Serial.print(mapCount);
+  Serial.print(" byte maps, ");
+  Serial.print(tableCount);
+  Serial.print(" tables), ");
+  Serial.print(hits);
+  Serial.println(" frames rewritten");
+}
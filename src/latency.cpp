@@ -0,0 +1,149 @@
+/*
+ * @file latency.cpp
+ * @brief Per-CAN-ID end-to-end gateway latency histograms
+ */
+
+#include <latency.h>
+
+#ifdef GATEWAY_LATENCY
+
+#include <can_bus.h>
+#include <freertos/FreeRTOS.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define LATENCY_DIRECTIONS (BUS_COUNT * BUS_COUNT)  // origin bus * BUS_COUNT + TX bus
+
+static_assert(LATENCY_MAX_IDS < 256, "Slot indexes are stored on one byte");
+
+struct LatencySlot {
+  uint16_t id;
+  unsigned long count;
+  unsigned long totalUs;
+  unsigned long maxUs;
+  unsigned long buckets[LATENCY_BUCKETS];
+};
+
+volatile bool latencyEnabled = true;
+
+// Slot 0 unused, so a zero-initialised index means "no slot yet"
+static LatencySlot slots[LATENCY_DIRECTIONS][LATENCY_MAX_IDS + 1];
+static byte slotCount[LATENCY_DIRECTIONS];
+static byte slotIndex[LATENCY_DIRECTIONS][0x800];
+static unsigned long slotOverflows = 0;
+
+static LatencyOrigin lastRx[BUS_COUNT];             // Written by the consumer of each bus
+static LatencyOrigin current[portNUM_PROCESSORS];   // Frame being handled on each core
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static byte bucketOf(unsigned long us) {
+  byte bucket = 0;
+  while (us > 1 && bucket < LATENCY_BUCKETS - 1) {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+static LatencySlot* slotFor(byte direction, uint16_t id) {
+  byte index = slotIndex[direction][id & 0x7FF];
+  if (index == 0) {
+    if (slotCount[direction] >= LATENCY_MAX_IDS) {
+      slotOverflows++;
+      return NULL;
+    }
+    index = ++slotCount[direction];
+    slots[direction][index].id = id;
+    slotIndex[direction][id & 0x7FF] = index;
+  }
+  return &slots[direction][index];
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void latencyNoteRx(byte bus, uint16_t id, unsigned long rxUs) {
+  lastRx[bus].rxUs = rxUs;
+  lastRx[bus].id = id;
+  lastRx[bus].bus = bus;
+  lastRx[bus].valid = (id <= 0x7FF);
+}
+
+void latencyEnter(byte bus) {
+  current[xPortGetCoreID()] = lastRx[bus];
+}
+
+void latencyLeave() {
+  current[xPortGetCoreID()].valid = false;
+}
+
+LatencyOrigin latencyCurrent() {
+  return current[xPortGetCoreID()];
+}
+
+void latencyRecord(const LatencyOrigin& origin, byte txBus, unsigned long txUs) {
+  LatencySlot* slot = slotFor(origin.bus * BUS_COUNT + txBus, origin.id);
+  if (slot == NULL) {
+    return;
+  }
+
+  unsigned long us = txUs - origin.rxUs;
+  slot->count++;
+  slot->totalUs += us;
+  if (us > slot->maxUs) {
+    slot->maxUs = us;
+  }
+  slot->buckets[bucketOf(us)]++;
+}
+
+void latencyPrint() {
+  Serial.print("Latency RX -> TX buffer (us), recording ");
+  Serial.println(latencyEnabled ? "on" : "off");
+
+  for (byte direction = 0; direction < LATENCY_DIRECTIONS; direction++) {
+    for (byte index = 1; index <= slotCount[direction]; index++) {
+      const LatencySlot& slot = slots[direction][index];
+      if (slot.count == 0) {
+        continue;
+      }
+
+      char line[64];
+      snprintf(line, sizeof line, "CAN%u -> CAN%u 0x%03X: n=%lu avg=%lu max=%lu", direction / BUS_COUNT, direction % BUS_COUNT, slot.id, slot.count, slot.totalUs / slot.count, slot.maxUs);
+      Serial.println(line);
+
+      Serial.print("  ");
+      for (byte bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        if (slot.buckets[bucket] == 0) {
+          continue;
+        }
+        if (bucket == LATENCY_BUCKETS - 1) {
+          snprintf(line, sizeof line, ">=%lu:%lu ", 1UL << bucket, slot.buckets[bucket]);
+        } else {
+          snprintf(line, sizeof line, "<%lu:%lu ", 2UL << bucket, slot.buckets[bucket]);
+        }
+        Serial.print(line);
+      }
+      Serial.println();
+    }
+  }
+
+  if (slotOverflows > 0) {
+    Serial.print("Latency: IDs not tracked (increase LATENCY_MAX_IDS): ");
+    Serial.println(slotOverflows);
+  }
+}
+
+void latencyReset() {
+  memset(slots, 0, sizeof(slots));
+  memset(slotCount, 0, sizeof(slotCount));
+  memset(slotIndex, 0, sizeof(slotIndex));
+  slotOverflows = 0;
+}
+
+#endif
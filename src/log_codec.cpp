@@ -0,0 +1,301 @@
+/*
+ * @file log_codec.cpp
+ * @brief Compressed drive log block format (encoder and decoder)
+ *
+ * Built into the firmware and into the host decoder: no Arduino or FreeRTOS
+ * dependency. The encoder finds the dictionary entry of a frame through an
+ * open-addressing hash of twice the dictionary size.
+ */
+
+#include <log_codec.h>
+#include <string.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define EFF_FLAG 0x80000000UL  // Same bits as CAN_EFF_FLAG / CAN_RTR_FLAG (mcp2515 can.h)
+#define RTR_FLAG 0x40000000UL
+#define EFF_MASK 0x1FFFFFFFUL
+
+#define SLOT_COUNT (2 * LOG_DICTIONARY_SIZE)
+
+static_assert((SLOT_COUNT & (SLOT_COUNT - 1)) == 0, "LOG_DICTIONARY_SIZE must be a power of two");
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static void putLe(uint8_t* out, uint32_t value, uint8_t bytes) {
+  for (uint8_t i = 0; i < bytes; i++) {
+    out[i] = value >> (8 * i);
+  }
+}
+
+static uint32_t getLe(const uint8_t* in, uint8_t bytes) {
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < bytes; i++) {
+    value |= (uint32_t) in[i] << (8 * i);
+  }
+  return value;
+}
+
+// CRC-32 (IEEE 802.3, reflected), bitwise: once per block. Start with 0xFFFFFFFF, invert the result
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return crc;
+}
+
+static uint8_t* putVarint(uint8_t* out, uint32_t value) {
+  while (value >= 0x80) {
+    *out++ = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  *out++ = value;
+  return out;
+}
+
+// Returns NULL past end or on an over-long varint
+static const uint8_t* getVarint(const uint8_t* in, const uint8_t* end, uint32_t* value) {
+  uint32_t result = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (in >= end) {
+      return NULL;
+    }
+    uint8_t c = *in++;
+    result |= (uint32_t) (c & 0x7F) << shift;
+    if (!(c & 0x80)) {
+      *value = result;
+      return in;
+    }
+  }
+  return NULL;
+}
+
+static uint32_t idValue(uint32_t canId) {
+  if (canId & EFF_FLAG) {
+    return ((canId & EFF_MASK) << 2) | 0x02 | ((canId & RTR_FLAG) ? 1 : 0);
+  }
+  return ((canId & 0x7FF) << 2) | ((canId & RTR_FLAG) ? 1 : 0);
+}
+
+static uint32_t canIdOf(uint32_t value) {
+  return (value >> 2) | ((value & 0x02) ? EFF_FLAG : 0) | ((value & 0x01) ? RTR_FLAG : 0);
+}
+
+static uint32_t slotOf(uint32_t id, uint8_t key) {
+  return ((id ^ ((uint32_t) key << 30)) * 2654435761UL) >> 22 & (SLOT_COUNT - 1);
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void logEncoderOpen(LogEncoder* encoder, uint8_t* block, uint32_t blockSize, uint32_t sequence, uint32_t epoch, bool epochValid, uint32_t baseUs) {
+  uint8_t log2Size = 0;
+  while ((1UL << log2Size) < blockSize) {
+    log2Size++;
+  }
+
+  encoder->block = block;
+  encoder->blockSize = blockSize;
+  encoder->used = LOG_HEADER_SIZE;
+  encoder->frames = 0;
+  encoder->prevUs = baseUs;
+  encoder->entries = 0;
+  memset(encoder->slots, 0xFF, sizeof(encoder->slots));
+
+  putLe(block, LOG_MAGIC, 4);
+  block[4] = LOG_VERSION;
+  block[5] = epochValid ? LOG_FLAG_EPOCH : 0;
+  block[6] = log2Size;
+  block[7] = 0;
+  putLe(block + 8, 0, 4);  // Used bytes and frames, written by logEncoderClose()
+  putLe(block + 12, sequence, 4);
+  putLe(block + 16, epoch, 4);
+  putLe(block + 20, baseUs, 4);
+  putLe(block + 24, 0, 4);  // CRC, written by logEncoderClose()
+}
+
+bool logEncodeFrame(LogEncoder* encoder, const LoggedFrame* frame) {
+  if (encoder->blockSize - encoder->used < LOG_RECORD_MAX) {
+    return false;
+  }
+
+  uint8_t dlc = frame->dlc > 8 ? 8 : frame->dlc;
+  uint32_t id = idValue(frame->id);
+  uint8_t key = (frame->bus & 0x01) | (frame->tx ? 0x02 : 0);
+
+  uint32_t slot = slotOf(id, key);
+  while (encoder->slots[slot] >= 0 && (encoder->dictionary[encoder->slots[slot]].id != id || encoder->dictionary[encoder->slots[slot]].key != key)) {
+    slot = (slot + 1) & (SLOT_COUNT - 1);
+  }
+  int16_t index = encoder->slots[slot];
+  if (index < 0 && encoder->entries == LOG_DICTIONARY_SIZE) {
+    return false;
+  }
+
+  uint8_t* out = encoder->block + encoder->used;
+  int32_t delta = (int32_t) (frame->us - encoder->prevUs);
+  out = putVarint(out, ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31));
+  encoder->prevUs = frame->us;
+
+  if (index < 0) {
+    index = encoder->entries++;
+    encoder->slots[slot] = index;
+    LogEntry& entry = encoder->dictionary[index];
+    entry.id = id;
+    entry.key = key;
+    entry.dlc = dlc;
+    memcpy(entry.data, frame->data, dlc);
+
+    out = putVarint(out, (uint32_t) index << 1);
+    *out++ = key;
+    out = putVarint(out, id);
+    *out++ = dlc;
+    memcpy(out, frame->data, dlc);
+    out += dlc;
+  } else {
+    LogEntry& entry = encoder->dictionary[index];
+    bool dlcChanged = (dlc != entry.dlc);
+    uint8_t mask = 0;
+
+    for (uint8_t i = 0; i < dlc; i++) {
+      if (i >= entry.dlc || frame->data[i] != entry.data[i]) {
+        mask |= 1 << i;
+      }
+    }
+
+    out = putVarint(out, ((uint32_t) index << 1) | (dlcChanged ? 1 : 0));
+    if (dlcChanged) {
+      *out++ = dlc;
+      entry.dlc = dlc;
+    }
+    *out++ = mask;
+    for (uint8_t i = 0; i < dlc; i++) {
+      if (mask & (1 << i)) {
+        *out++ = frame->data[i];
+        entry.data[i] = frame->data[i];
+      }
+    }
+  }
+
+  encoder->used = out - encoder->block;
+  encoder->frames++;
+  return true;
+}
+
+void logEncoderClose(LogEncoder* encoder) {
+  putLe(encoder->block + 8, encoder->used, 2);
+  putLe(encoder->block + 10, encoder->frames, 2);
+  putLe(encoder->block + 24, ~crc32Update(0xFFFFFFFF, encoder->block, encoder->used), 4);
+  memset(encoder->block + encoder->used, 0, encoder->blockSize - encoder->used);
+}
+
+bool logParseHeader(const uint8_t* data, LogBlockHeader* header) {
+  if (getLe(data, 4) != LOG_MAGIC || data[4] != LOG_VERSION || data[6] < 8 || data[6] > 15) {
+    return false;
+  }
+
+  header->version = data[4];
+  header->flags = data[5];
+  header->blockSize = 1UL << data[6];
+  header->used = getLe(data + 8, 2);
+  header->frames = getLe(data + 10, 2);
+  header->sequence = getLe(data + 12, 4);
+  header->epoch = getLe(data + 16, 4);
+  header->baseUs = getLe(data + 20, 4);
+  header->crc = getLe(data + 24, 4);
+  return header->used >= LOG_HEADER_SIZE && header->used <= header->blockSize;
+}
+
+int logDecodeBlock(const uint8_t* block, LogFrameCallback callback, void* context) {
+  LogBlockHeader header;
+  LogEntry dictionary[LOG_DICTIONARY_SIZE];
+  uint16_t entries = 0;
+
+  if (!logParseHeader(block, &header)) {
+    return -1;
+  }
+
+  static const uint8_t zero[4] = {0, 0, 0, 0};
+  uint32_t crc = crc32Update(0xFFFFFFFF, block, 24);
+  crc = crc32Update(crc, zero, 4);
+  crc = crc32Update(crc, block + LOG_HEADER_SIZE, header.used - LOG_HEADER_SIZE);
+  if (~crc != header.crc) {
+    return -1;
+  }
+
+  const uint8_t* in = block + LOG_HEADER_SIZE;
+  const uint8_t* end = block + header.used;
+  uint32_t us = header.baseUs;
+  int frames = 0;
+
+  while (in < end) {
+    uint32_t zigzag, tag;
+    LoggedFrame frame;
+
+    if ((in = getVarint(in, end, &zigzag)) == NULL || (in = getVarint(in, end, &tag)) == NULL) {
+      return -1;
+    }
+    us += (uint32_t) ((zigzag >> 1) ^ (0 - (zigzag & 1)));
+    uint32_t index = tag >> 1;
+
+    if (index == entries) {
+      uint32_t id;
+      if (entries == LOG_DICTIONARY_SIZE || in >= end) {
+        return -1;
+      }
+      uint8_t key = *in++;
+      if ((in = getVarint(in, end, &id)) == NULL || in >= end || *in > 8 || end - (in + 1) < *in) {
+        return -1;
+      }
+      LogEntry& entry = dictionary[entries++];
+      entry.id = id;
+      entry.key = key & 0x03;
+      entry.dlc = *in++;
+      memcpy(entry.data, in, entry.dlc);
+      in += entry.dlc;
+    } else if (index < entries) {
+      LogEntry& entry = dictionary[index];
+      if (tag & 1) {
+        if (in >= end || *in > 8) {
+          return -1;
+        }
+        entry.dlc = *in++;
+      }
+      if (in >= end) {
+        return -1;
+      }
+      uint8_t mask = *in++;
+      for (uint8_t i = 0; i < 8; i++) {
+        if (mask & (1 << i)) {
+          if (i >= entry.dlc || in >= end) {
+            return -1;
+          }
+          entry.data[i] = *in++;
+        }
+      }
+    } else {
+      return -1;
+    }
+
+    const LogEntry& entry = dictionary[index];
+    frame.us = us;
+    frame.id = canIdOf(entry.id);
+    frame.bus = entry.key & 0x01;
+    frame.tx = (entry.key >> 1) & 0x01;
+    frame.dlc = entry.dlc;
+    memset(frame.data, 0, sizeof(frame.data));
+    memcpy(frame.data, entry.data, entry.dlc);
+    callback(&header, &frame, context);
+    frames++;
+  }
+
+  return frames;
+}
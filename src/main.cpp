@@ -21,18 +21,35 @@ all copies or substantial portions of the Software.
 //    Libraries    //
 /////////////////////
 
-#include <EEPROM.h>
 #include <SPI.h>
-#include <Time.h>
-#include <TimeLib.h>
 #include <Wire.h>
-#include <DS1307RTC.h> // https://github.com/PaulStoffregen/DS1307RTC
 #include <mcp2515.h> // https://github.com/autowp/arduino-mcp2515 + https://github.com/watterott/Arduino-Libs/tree/master/digitalWriteFast
 
 // Include configuration and utility functions
 #include <config.h>
+#include <can_bus.h>
+#include <can_health.h>
+#include <echo_filter.h>
+#include <boot_timing.h>
+#include <flight_recorder.h>
+#include <drive_log.h>
+#include <gateway_rules.h>
+#include <settings.h>
+#include <can_dispatch.h>
 #include <can_utils.h>
+#include <gateway.h>
+#include <latency.h>
+#include <console.h>
+#include <capture.h>
+#include <persist.h>
+#include <time_service.h>
+#include <scheduler.h>
+#include <popup.h>
+#include <alerts_journal.h>
+#include <signal_codec.h>
+#include <translation_memo.h>
 #include <cluster_test.h>
+#include <buttons.h>
 
 ////////////////////
 // Initialization //
@@ -55,17 +72,16 @@ static bool spiInitialized = []() {
   return true;
 }();
 
-MCP2515 CAN0(CS_PIN_CAN0); // CAN-BUS Shield N°1 (destination)
-MCP2515 CAN1(CS_PIN_CAN1); // CAN-BUS Shield N°2 (source)
+MCP2515 CAN0(CS_PIN_CAN0, CAN_SPI_CLOCK); // CAN-BUS Shield N°1 (destination)
+MCP2515 CAN1(CS_PIN_CAN1, CAN_SPI_CLOCK); // CAN-BUS Shield N°2 (source)
 
 ////////////////////
 //   Variables    //
 ////////////////////
 
 // My variables
-bool debugGeneral = false; // Get some debug informations on Serial
-bool debugCAN0 = false; // Read data sent by ECUs from the car to Entertainment CAN bus using https://github.com/alexandreblin/python-can-monitor
-bool debugCAN1 = false; // Read data sent by the NAC / SMEG to Entertainment CAN bus using https://github.com/alexandreblin/python-can-monitor
+// Debug and feature flags (debugGeneral, CVM_Emul, noFMUX, vinNumber, ...) are in settings.cpp:
+// compiled-in defaults, overridden by the record saved from the serial console (see settings.h)
 
 // ============================================================================
 // INSTRUMENT CLUSTER TEST MODE (CAN2010)
@@ -76,43 +92,27 @@ bool debugCAN1 = false; // Read data sent by the NAC / SMEG to Entertainment CAN
 bool testClusterMode = false;  // Set to true to enable cluster test mode
 
 // Test values - manually configure these for testing
-unsigned long testClusterCounter = 0;  // Internal counter (managed by cluster_test.cpp)
-int testSpeed = 0;                     // Vehicle speed (km/h)
-int testRPM = 0;                       // Engine RPM
-int testFuel = 0;                      // Fuel level (0-100%)
-unsigned long testOdometer = 0;        // Odometer (km)
+int testSpeed = 0;                     // Vehicle speed (km/h), set by the scenario
+int testRPM = 0;                       // Engine RPM, set by the scenario
+int testFuel = 0;                      // Fuel level (0-100%), set by the scenario
+unsigned long testOdometer = 0;        // Odometer (km), advances with the simulated speed
 bool testIgnition = true;              // Ignition state
-byte testScenario = 0;                 // Test scenario (0-15)
-bool testAutoIncrement = false;        // Auto-cycle through scenarios
+byte testScenario = 0;                 // Test scenario: 0-15 fixed levels, 16 steps, 17 sweep, 18 city (see cluster_test.h)
+bool testAutoIncrement = false;        // Auto-cycle through scenarios 0-15 (same as scenario 16)
 int testOilTemp = 0xAC;                // Oil temperature (default 0xAC)
 // ============================================================================
 
-bool EconomyModeEnabled = true; // You can disable economy mode on the Telematic if you want to - Not recommended at all
-bool Send_CAN2010_ForgedMessages = false; // Send forged CAN2010 messages to the CAR CAN-BUS Network (useful for testing CAN2010 device(s) from already existent connectors)
 bool TemperatureInF = false; // Default Temperature in Celcius
 bool mpgMi = false;
-bool kmL = false; // km/L statistics instead of L/100
-bool fixedBrightness = false; // Force Brightness value in case the calibration does not match your brightness value range
-bool noFMUX = false; // If you don't have any useful button on the main panel, turn the SRC button on steering wheel commands into MENU - only works for CAN2010 SMEG / NAC -
-byte steeringWheelCommands_Type = 0; // noFMUX extra setting : 0 = Generic, 1 = C4 I / C5 X7 NAV+MUSIC+APPS+PHONE mapping, 2 = C4 I / C5 X7 MENU mapping, 3 = C4 I / C5 X7 MENU mapping + SRC on wiper command button, 4 = C4 I / C5 X7 MENU mapping + TRIP on wiper command button, 5 = C4 I / C5 X7 MENU mapping + SRC on wiper command button + TRIP on ESC button
+bool kmLDetected = false; // km/L reported by the CAN2004 matrix (0x2D7), until the next start: not a saved setting
 byte languageID = 0; // Default is FR: 0 - EN: 1 / DE: 2 / ES: 3 / IT: 4 / PT: 5 / NL: 6 / BR: 9 / TR: 12 / RU: 14
-bool listenCAN2004Language = false; // Switch language on CAN2010 devices if changed on supported CAN2004 devices, default: no
 byte Time_day = 1; // Default day if the RTC module is not configured
 byte Time_month = 1; // Default month if the RTC module is not configured
 int Time_year = 2022; // Default year if the RTC module is not configured
 byte Time_hour = 0; // Default hour if the RTC module is not configured
 byte Time_minute = 0; // Default minute if the RTC module is not configured
 bool resetEEPROM = false; // Switch to true to reset all EEPROM values
-bool CVM_Emul = true; // Send suggested speed from Telematic to fake CVM (Multifunction camera inside the windshield) frame
-bool generatePOPups = false; // Generate notifications from alerts journal - useful for C5 (X7)
 
-bool emulateVIN = false; // Replace network VIN by another (donor car for example)
-char vinNumber[18] = "VF3XXXXXXXXXXXXXX";
-
-bool hasAnalogicButtons = false; // Analog buttons instead of FMUX
-byte menuButton = 4;
-byte volDownButton = 5;
-byte volUpButton = 6;
 byte scrollValue = 0;
 
 // Default variables
@@ -137,15 +137,16 @@ bool CentralAerator = false;
 bool AutoFan = false;
 byte FanPosition = 0;
 bool MaintenanceDisplayed = false;
-int buttonState = 0;
-int lastButtonState = 0;
-long lastDebounceTime = 0;
-long buttonPushTime = 0;
-long buttonSendTime = 0;
-long debounceDelay = 100;
-int daysSinceYearStart = 0;
-unsigned long customTimeStamp = 0;
+int8_t analogButtonGroup = -1; // Button engine groups (buttons.h), -1 = not used
+int8_t wheelButtonGroup = -1;
 int vehicleSpeed = 0;
+int postedSpeed = -1;   // Last vehicleSpeed / statusCMB posted to the device path (car path side)
+byte postedCMB[8];
+bool postedCMBValid = false;
+byte cvmSpeedThreshold = 0; // Last CVM data from the NAC (0x1E9), sent in 0x268 by the scheduler
+byte cvmSpeedLimit = 0;
+byte cvmPoiType = 0;
+unsigned long lastCvmMillis = 0;
 int engineRPM = 0;
 bool darkMode = false;
 bool resetTrip1 = false;
@@ -164,337 +165,1072 @@ byte statusCMB[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 byte statusTRIP[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 bool TelematicPresent = false;
 bool ClusterPresent = false;
-bool pushA2 = false;
-int alertsCache[] = {0, 0, 0, 0, 0, 0, 0, 0}; // Max 8
-byte alertsParametersCache[] = {0, 0, 0, 0, 0, 0, 0, 0}; // Max 8
 bool isBVMP = false;
-byte statusOpenings = 0;
-byte notificationParameters = 0;
+unsigned long lastStatsPrint = 0;
 
 // Language & Unit CAN2010 value
 byte languageAndUnitNum = (languageID * 4) + 128;
 
 // CAN-BUS Messages
-struct can_frame canMsgSnd;
+struct can_frame canMsgSnd; // CAN0 > CAN1 direction (loop)
 struct can_frame canMsgRcv;
+struct can_frame canMsgSndDevice; // CAN1 > CAN0 direction (own task in dual-core mode)
+struct can_frame canMsgRcvDevice;
 
-// Helper function to update EEPROM only if value changed (protects flash wear)
-// ESP32 EEPROM is emulated using flash with limited write cycles
-// This function reads before writing and skips if unchanged
-inline void eepromUpdate(int address, byte value) {
-  if (EEPROM.read(address) != value) {
-    EEPROM.write(address, value);
-  }
-}
+void registerButtons();
+void registerFrameHandlers();
+void registerScheduledFrames();
+void processCAN1Batch();
+void sendEmfVersion(byte bus);
 
 void setup() {
   int tmpVal;
 
-  if (resetEEPROM) {
-    EEPROM.write(0, 0);
-    EEPROM.write(1, 0);
-    EEPROM.write(2, 0);
-    EEPROM.write(3, 0);
-    EEPROM.write(4, 0);
-    EEPROM.write(5, 0);
-    EEPROM.write(6, 0);
-    EEPROM.write(7, 0);
-    EEPROM.write(10, 0);
-    EEPROM.write(11, 0);
-    EEPROM.write(12, 0);
-    EEPROM.write(13, 0);
-    EEPROM.write(14, 0);
-    EEPROM.write(15, 0);
-    EEPROM.write(16, 0);
-  }
-
-  if (debugCAN0 || debugCAN1 || debugGeneral) {
+  // Feature flags: compiled-in defaults overridden by the saved record (one NVS read)
+  settingsBegin();
+
+  if (settings.debugCAN0 || settings.debugCAN1 || settings.debugGeneral) {
     SerialEnabled = true;
   }
 
+  // Re-initialize SPI with custom pins to ensure they're correct after MCP2515 constructors
+  // On ESP32-S3, MCP2515 constructor calls SPI.begin() without pins, which might use defaults
+  // This ensures we use the correct pins from BoardConfig_t2can.h
+  SPI.begin(BOARD_SCK_PIN, BOARD_MISO_PIN, BOARD_MOSI_PIN);
+  
+  // Initialize I2C for RTC (DS1307/DS3231) with custom pins for T2CAN QWIIC interface
+  Wire.begin(BOARD_SDA_PIN, BOARD_SCL_PIN);
+
+  // Serial is always started so settings can be changed from the console; debug output needs SerialEnabled
+  Serial.begin(SERIAL_SPEED);
+
+  if (SerialEnabled) {
+    // CAN-BUS from car, CAN-BUS to CAN2010 device(s)
+    Serial.println("Initialization CAN0");
+    Serial.println("Initialization CAN1");
+  }
+
+  // Rolling record of both buses in PSRAM, frozen by a trigger
+  flightRecorderBegin();
+
+  // Compressed log of both buses on LittleFS (mounted by its task)
+  driveLogBegin();
+
+  // Fake EMF version, sent whenever CAN0 enters normal mode (also when it comes up late)
+  canSetBusUpHandler(sendEmfVersion);
+
+  // Start both controllers without waiting on either (a slow one is retried in the background)
+  // and interrupt-driven reception (falls back to polling in loop())
+  canBusBegin();
+
+  // Saved settings (language, units, date), loaded while the controllers come up; before any
+  // task that dispatches frames (written back to flash by the persist task)
+  persistBegin();
+
+  if (resetEEPROM) {
+    for (int address = 0; address < PERSIST_SIZE; address++) {
+      persistWrite(address, 0);
+    }
+  }
+
   // Read data from EEPROM
-  tmpVal = EEPROM.read(0);
+  tmpVal = persistRead(PERSIST_LANGUAGE_UNIT);
   if (tmpVal >= 128) {
     languageAndUnitNum = tmpVal;
   }
 
-  if ((languageAndUnitNum % 2) == 0 && kmL) {
+  if ((languageAndUnitNum % 2) == 0 && (settings.kmL || kmLDetected)) {
     languageAndUnitNum = languageAndUnitNum + 1;
   }
 
-  tmpVal = EEPROM.read(1);
+  tmpVal = persistRead(PERSIST_LANGUAGE_CAN2004);
   if (tmpVal <= 32) {
     languageID_CAN2004 = tmpVal;
   }
 
-  tmpVal = EEPROM.read(2);
+  tmpVal = persistRead(PERSIST_LANGUAGE);
   if (tmpVal <= 32) {
     languageID = tmpVal;
   }
 
-  tmpVal = EEPROM.read(3);
+  tmpVal = persistRead(PERSIST_TEMPERATURE_F);
   if (tmpVal == 1) {
     TemperatureInF = true;
   }
 
-  tmpVal = EEPROM.read(4);
+  tmpVal = persistRead(PERSIST_MPG_MI);
   if (tmpVal == 1) {
     mpgMi = true;
   }
 
-  tmpVal = EEPROM.read(5);
+  tmpVal = persistRead(PERSIST_TIME_DAY);
   if (tmpVal <= 31) {
     Time_day = tmpVal;
   }
 
-  tmpVal = EEPROM.read(6);
+  tmpVal = persistRead(PERSIST_TIME_MONTH);
   if (tmpVal <= 12) {
     Time_month = tmpVal;
   }
 
-  EEPROM.get(7, tmpVal); // int
-  if (tmpVal >= 1872 && tmpVal <= 2127) {
-    Time_year = tmpVal;
+  uint16_t storedYear;
+  persistGet(PERSIST_TIME_YEAR, storedYear);
+  if (storedYear >= 1872 && storedYear <= 2127) {
+    Time_year = storedYear;
   }
 
-  personalizationSettings[0] = EEPROM.read(10);
-  personalizationSettings[1] = EEPROM.read(11);
-  personalizationSettings[2] = EEPROM.read(12);
-  personalizationSettings[3] = EEPROM.read(13);
-  personalizationSettings[4] = EEPROM.read(14);
-  personalizationSettings[5] = EEPROM.read(15);
-  personalizationSettings[6] = EEPROM.read(16);
+  for (int i = 0; i < 7; i++) {
+    personalizationSettings[i] = persistRead(PERSIST_PERSONALIZATION + i);
+  }
 
-  if (hasAnalogicButtons) {
-    //Initialize buttons - MENU/VOL+/VOL-
-    pinMode(menuButton, INPUT_PULLUP);
-    pinMode(volDownButton, INPUT_PULLUP);
-    pinMode(volUpButton, INPUT_PULLUP);
+  // Saved date until the RTC task has read the RTC, so setup() never waits on I2C
+  clockSet(Time_year, Time_month, Time_day, Time_hour, Time_minute, false);
+  persistWrite(PERSIST_TIME_DAY, Time_day);
+  persistWrite(PERSIST_TIME_MONTH, Time_month);
+  persistPut(PERSIST_TIME_YEAR, (uint16_t) Time_year);
+  clockBegin();
+
+  // Analog buttons and steering wheel commands, before the 0xA2 handler is registered
+  registerButtons();
+
+  // Build the CAN-ID dispatch tables from the feature flags above
+  registerFrameHandlers();
+
+  // Sample TEC/REC/EFLG of both controllers, recover from bus-off
+  canHealthBegin();
+
+  // Binary capture writer (debugBinaryCapture)
+  captureBegin();
+
+  // Move the CAN1 > CAN0 path to the other core if dualCoreGateway is enabled
+  gatewayBegin(processCAN1Batch);
+
+  // Start sending the generated frames (0x3F6, 0x228, 0x268) on their own periods
+  registerScheduledFrames();
+
+  // Initialize cluster test mode if enabled (its frames are scheduled too)
+  if (testClusterMode) {
+    clusterTestInit();
   }
 
-  // Re-initialize SPI with custom pins to ensure they're correct after MCP2515 constructors
-  // On ESP32-S3, MCP2515 constructor calls SPI.begin() without pins, which might use defaults
-  // This ensures we use the correct pins from BoardConfig_t2can.h
-  SPI.begin(BOARD_SCK_PIN, BOARD_MISO_PIN, BOARD_MOSI_PIN);
-  
-  // Initialize I2C for RTC (DS1307/DS3231) with custom pins for T2CAN QWIIC interface
-  Wire.begin(BOARD_SDA_PIN, BOARD_SCL_PIN);
+  schedulerBegin();
 
-  if (SerialEnabled) {
-    // Initalize Serial for debug
-    Serial.begin(SERIAL_SPEED);
+  // loop() forwards from here on (boot-to-first-forward timing, see boot_timing.h)
+  bootTimingMark(BOOT_SETUP_DONE);
+}
 
-    // CAN-BUS from car
-    Serial.println("Initialization CAN0");
+// ============================================================================
+// FRAMES FROM THE CAR (CAN0 → CAN1), held in canMsgRcv
+// ============================================================================
+
+// Generated by this adapter from CAN2010 frames
+static void handleCAN0_15B() {
+  // Do not send back converted frames between networks
+}
+
+// Economy Mode detection
+static void handleCAN0_036() {
+  int tmpVal;
+
+  if (bitRead(canMsgRcv.data[2], 7) == 1) {
+    if (!EconomyMode && SerialEnabled) {
+      Serial.println("Economy mode ON");
+    }
+
+    EconomyMode = true;
+  } else {
+    if (EconomyMode && SerialEnabled) {
+      Serial.println("Economy mode OFF");
+    }
+
+    EconomyMode = false;
   }
 
-  CAN0.reset();
-  CAN0.setBitrate(CAN_SPEED, CAN_FREQ);
-  while (CAN0.setNormalMode() != MCP2515::ERROR_OK) {
-    delay(100);
+  tmpVal = canMsgRcv.data[3];
+
+  // Fix brightness when car lights are ON - Brightness Instrument Panel "20" > "2F" (32 > 47) - Depends on your car
+  if (settings.fixedBrightness && tmpVal >= 32) {
+    canMsgRcv.data[3] = 0x28; // Set fixed value to avoid low brightness due to incorrect CAN2010 Telematic calibration
   }
+  canSend(BUS_CAN1, & canMsgRcv);
+}
 
-  if (SerialEnabled) {
-    // CAN-BUS to CAN2010 device(s)
-    Serial.println("Initialization CAN1");
+static void handleCAN0_0B6() {
+  int tmpVal;
+
+  engineRPM = ((canMsgRcv.data[0] << 8) | canMsgRcv.data[1]) * 0.125;
+  if (engineRPM > 0) {
+    EngineRunning = true;
+  } else {
+    EngineRunning = false;
   }
+  tmpVal = ((canMsgRcv.data[2] << 8) | canMsgRcv.data[3]) * 0.01;
+  if (tmpVal != postedSpeed) {
+    postedSpeed = tmpVal;
+    gatewayPost(PATH_DEVICE, &vehicleSpeed, &tmpVal, sizeof(vehicleSpeed));
+  }
+  canSend(BUS_CAN1, & canMsgRcv);
+}
 
-  CAN1.reset();
-  CAN1.setBitrate(CAN_SPEED, CAN_FREQ);
-  while (CAN1.setNormalMode() != MCP2515::ERROR_OK) {
-    delay(100);
+// ASCII coded first 3 letters of VIN
+static void handleCAN0_336() {
+  canMsgSnd.data[0] = settings.vinNumber[0]; //V
+  canMsgSnd.data[1] = settings.vinNumber[1]; //F
+  canMsgSnd.data[2] = settings.vinNumber[2]; //3
+  canMsgSnd.can_id = 0x336;
+  canMsgSnd.can_dlc = 3;
+  canSend(BUS_CAN1, & canMsgSnd);
+}
+
+// ASCII coded 4-9 letters of VIN
+static void handleCAN0_3B6() {
+  canMsgSnd.data[0] = settings.vinNumber[3]; //X
+  canMsgSnd.data[1] = settings.vinNumber[4]; //X
+  canMsgSnd.data[2] = settings.vinNumber[5]; //X
+  canMsgSnd.data[3] = settings.vinNumber[6]; //X
+  canMsgSnd.data[4] = settings.vinNumber[7]; //X
+  canMsgSnd.data[5] = settings.vinNumber[8]; //X
+  canMsgSnd.can_id = 0x3B6;
+  canMsgSnd.can_dlc = 6;
+  canSend(BUS_CAN1, & canMsgSnd);
+}
+
+// ASCII coded 10-17 letters (last 8) of VIN
+static void handleCAN0_2B6() {
+  canMsgSnd.data[0] = settings.vinNumber[9]; //X
+  canMsgSnd.data[1] = settings.vinNumber[10]; //X
+  canMsgSnd.data[2] = settings.vinNumber[11]; //X
+  canMsgSnd.data[3] = settings.vinNumber[12]; //X
+  canMsgSnd.data[4] = settings.vinNumber[13]; //X
+  canMsgSnd.data[5] = settings.vinNumber[14]; //X
+  canMsgSnd.data[6] = settings.vinNumber[15]; //X
+  canMsgSnd.data[7] = settings.vinNumber[16]; //X
+  canMsgSnd.can_id = 0x2B6;
+  canMsgSnd.can_dlc = 8;
+  canSend(BUS_CAN1, & canMsgSnd);
+}
+
+// Idle FMUX panel (0x122, no button pressed) sent with each 0x21F when the car has no FMUX buttons
+static void sendIdleFMUX() {
+  canMsgSnd.data[0] = 0x00;
+  canMsgSnd.data[1] = 0x00;
+  canMsgSnd.data[2] = 0x00;
+  canMsgSnd.data[3] = 0x00;
+  canMsgSnd.data[4] = 0x00;
+  canMsgSnd.data[5] = 0x02;
+  canMsgSnd.data[6] = 0x00; // Volume potentiometer button
+  canMsgSnd.data[7] = 0x00;
+  canMsgSnd.can_id = 0x122;
+  canMsgSnd.can_dlc = 8;
+  canSend(BUS_CAN1, & canMsgSnd);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, & canMsgSnd);
   }
+}
 
-  setSyncProvider(RTC.get); // Get time from the RTC module
-  if (timeStatus() != timeSet) {
-    if (SerialEnabled) {
-      Serial.println("Unable to sync with the RTC");
+// Steering wheel commands - Generic
+static void handleCAN0_21F() {
+  scrollValue = canMsgRcv.data[1];
+  canSend(BUS_CAN1, & canMsgRcv);
+}
+
+// Steering wheel commands - Generic, fake FMUX buttons in the car (noFMUX or analog buttons)
+static void handleCAN0_21F_FakeFMUX() {
+  scrollValue = canMsgRcv.data[1];
+  canSend(BUS_CAN1, & canMsgRcv);
+  sendIdleFMUX();
+}
+
+// Steering wheel commands - Generic with noFMUX: replace MODE/SRC by MENU (Valid for 208, C-Elysee calibrations for example)
+static void handleCAN0_21F_SrcToMenu() {
+  scrollValue = canMsgRcv.data[1];
+
+  if (bitRead(canMsgRcv.data[0], 1)) {
+    canMsgSnd.data[0] = 0x80; // MENU button
+    canMsgSnd.data[1] = 0x00;
+    canMsgSnd.data[2] = 0x00;
+    canMsgSnd.data[3] = 0x00;
+    canMsgSnd.data[4] = 0x00;
+    canMsgSnd.data[5] = 0x02;
+    canMsgSnd.data[6] = 0x00; // Volume potentiometer button
+    canMsgSnd.data[7] = 0x00;
+    canMsgSnd.can_id = 0x122;
+    canMsgSnd.can_dlc = 8;
+    canSend(BUS_CAN1, & canMsgSnd);
+    if (settings.Send_CAN2010_ForgedMessages) {
+      canSend(BUS_CAN0, & canMsgSnd);
     }
+  } else {
+    canSend(BUS_CAN1, & canMsgRcv);
+    sendIdleFMUX();
+  }
+}
+
+// Steering wheel button pressed: FMUX button bytes 0-2 of the 0x122 sent by handleCAN0_0A2()
+static void wheelFmuxEvent(const ButtonAction& action, ButtonEvent event) {
+  if (event == BUTTON_PRESS) {
+    canMsgSnd.data[0] = action.arg[0];
+    canMsgSnd.data[1] = action.arg[1];
+    canMsgSnd.data[2] = action.arg[2];
+  }
+}
+
+// Steering wheel button pressed: TRIP (0x221 sent by handleCAN0_0A2())
+static void wheelTripEvent(const ButtonAction&, ButtonEvent event) {
+  if (event == BUTTON_PRESS) {
+    pushTRIP = true;
+  }
+}
 
-    // Set default time (01/01/2020 00:00)
-    setTime(Time_hour, Time_minute, 0, Time_day, Time_month, Time_year);
-    eepromUpdate(5, Time_day);
-    eepromUpdate(6, Time_month);
-    EEPROM.put(7, Time_year);
-  } else if (SerialEnabled) {
-    Serial.println("RTC has set the system time");
-  }
-
-  // Set hour on CAN-BUS Clock
-  canMsgSnd.data[0] = hour();
-  canMsgSnd.data[1] = minute();
-  canMsgSnd.can_id = 0x228;
-  canMsgSnd.can_dlc = 2;
-  CAN0.sendMessage( & canMsgSnd);
-
-  // Send fake EMF version
-  canMsgSnd.data[0] = 0x25;
-  canMsgSnd.data[1] = 0x0A;
-  canMsgSnd.data[2] = 0x0B;
-  canMsgSnd.data[3] = 0x04;
-  canMsgSnd.data[4] = 0x0C;
-  canMsgSnd.data[5] = 0x01;
-  canMsgSnd.data[6] = 0x20;
-  canMsgSnd.data[7] = 0x11;
-  canMsgSnd.can_id = 0x5E5;
+// Steering wheel commands - C4 I / C5 X7, by steeringWheelCommands_Type. Bits of 0xA2 byte 1, by priority
+static const ButtonAction wheelButtonsMapping[] = {
+  {"MUSIC", 0x08, 0x08, wheelFmuxEvent, {0x00, 0x20, 0x00}, 0, 0, 0, 0, 0}, // MENU button
+  {"NAV", 0x04, 0x04, wheelFmuxEvent, {0x00, 0x08, 0x00}, 0, 0, 0, 0, 0},   // MODE button
+  {"APPS", 0x10, 0x10, wheelFmuxEvent, {0x00, 0x40, 0x00}, 0, 0, 0, 0, 0},  // ESC button
+  {"PHONE", 0x20, 0x20, wheelFmuxEvent, {0x00, 0x04, 0x08}, 0, 0, 0, 0, 0}, // OK button
+};
+static const ButtonAction wheelButtonsMenu[] = {
+  {"MENU", 0x08, 0x08, wheelFmuxEvent, {0x80, 0x00, 0x00}, 0, 0, 0, 0, 0},  // MENU button
+};
+static const ButtonAction wheelButtonsMenuSrc[] = {
+  {"MENU", 0x08, 0x08, wheelFmuxEvent, {0x80, 0x00, 0x00}, 0, 0, 0, 0, 0},  // MENU button
+  {"SRC", 0x04, 0x04, wheelFmuxEvent, {0x40, 0x00, 0x00}, 0, 0, 0, 0, 0},   // Right push button / MODE/SRC
+};
+static const ButtonAction wheelButtonsMenuTrip[] = {
+  {"MENU", 0x08, 0x08, wheelFmuxEvent, {0x80, 0x00, 0x00}, 0, 0, 0, 0, 0},  // MENU button
+  {"SRC", 0x10, 0x10, wheelFmuxEvent, {0x40, 0x00, 0x00}, 0, 0, 0, 0, 0},   // ESC button
+  {"TRIP", 0x04, 0x04, wheelTripEvent, {0x00, 0x00, 0x00}, 0, 0, 0, 0, 0},  // Right push button / MODE/SRC
+};
+static const ButtonAction wheelButtonsMenuSrcTrip[] = {
+  {"MENU", 0x08, 0x08, wheelFmuxEvent, {0x80, 0x00, 0x00}, 0, 0, 0, 0, 0},  // MENU button
+  {"SRC", 0x04, 0x04, wheelFmuxEvent, {0x40, 0x00, 0x00}, 0, 0, 0, 0, 0},   // Right push button / MODE/SRC
+  {"TRIP", 0x10, 0x10, wheelTripEvent, {0x00, 0x00, 0x00}, 0, 0, 0, 0, 0},  // ESC button
+};
+
+// Steering wheel commands - C4 I / C5 X7: a press sends one FMUX button (or TRIP), released buttons forward 0xA2
+static void handleCAN0_0A2() {
+  // Fake FMUX Buttons in the car
+  canMsgSnd.data[0] = 0x00;
+  canMsgSnd.data[1] = 0x00;
+  canMsgSnd.data[2] = 0x00;
+  canMsgSnd.data[3] = 0x00;
+  canMsgSnd.data[4] = 0x00;
+  canMsgSnd.data[5] = 0x02;
+  canMsgSnd.data[6] = 0x00; // Volume potentiometer button
+  canMsgSnd.data[7] = 0x00;
+
+  buttonsUpdate(wheelButtonGroup, canMsgRcv.data[1], micros());
+  if (!buttonsHeld(wheelButtonGroup)) {
+    canSend(BUS_CAN1, & canMsgRcv);
+  }
+  canMsgSnd.can_id = 0x122;
   canMsgSnd.can_dlc = 8;
-  CAN0.sendMessage( & canMsgSnd);
+  canSend(BUS_CAN1, & canMsgSnd);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, & canMsgSnd);
+  }
 
-  if (SerialEnabled) {
-    Serial.print("Current Time: ");
-    Serial.print(day());
-    Serial.print("/");
-    Serial.print(month());
-    Serial.print("/");
-    Serial.print(year());
+  if (pushTRIP) {
+    pushTRIP = false;
+
+    canMsgSnd.data[0] = statusTRIP[0];
+    bitWrite(canMsgSnd.data[0], 3, 1);
+    canMsgSnd.data[1] = statusTRIP[1];
+    canMsgSnd.data[2] = statusTRIP[2];
+    canMsgSnd.data[3] = statusTRIP[3];
+    canMsgSnd.data[4] = statusTRIP[4];
+    canMsgSnd.data[5] = statusTRIP[5];
+    canMsgSnd.data[6] = statusTRIP[6];
+    canMsgSnd.data[7] = statusTRIP[7];
+    canMsgSnd.can_id = 0x221;
+    canMsgSnd.can_dlc = 8;
+    canSend(BUS_CAN1, & canMsgSnd);
+    if (settings.Send_CAN2010_ForgedMessages) {
+      canSend(BUS_CAN0, & canMsgSnd);
+    }
+  }
+}
 
-    Serial.print(" ");
+// Cache cluster status (CMB)
+static void handleCAN0_217() {
+  if (!postedCMBValid || memcmp(postedCMB, canMsgRcv.data, 8) != 0) {
+    memcpy(postedCMB, canMsgRcv.data, 8);
+    postedCMBValid = true;
+    gatewayPost(PATH_DEVICE, statusCMB, canMsgRcv.data, 8);
+  }
 
-    Serial.print(hour());
-    Serial.print(":");
-    Serial.print(minute());
+  canSend(BUS_CAN1, & canMsgRcv);
+}
 
-    Serial.println();
+// No fan activated if the engine is not ON on old models
+static TranslationMemo memo_1D0 = TRANSLATION_MEMO(0x1D0);
+
+static void handleCAN0_1D0() {
+  int tmpVal;
+
+  if (!EngineRunning) {
+    canSend(BUS_CAN1, & canMsgRcv);
+    return;
   }
 
-  // Initialize cluster test mode if enabled
-  if (testClusterMode) {
-    clusterTestInit();
+  const struct can_frame* out = memoLookup(memo_1D0, canMsgRcv, 0);
+  if (out == NULL) {
+    LeftTemp = canMsgRcv.data[5];
+    RightTemp = canMsgRcv.data[6];
+    if (LeftTemp == RightTemp) { // No other way to detect MONO mode
+      Mono = true;
+      LeftTemp = LeftTemp + 64;
+    } else {
+      Mono = false;
+    }
+
+    FanOff = false;
+    // Fan Speed BSI_2010 = "41" (Off) > "49" (Full speed)
+    tmpVal = canMsgRcv.data[2];
+    if (tmpVal == 15) {
+      FanOff = true;
+      FanSpeed = 0x41;
+    } else {
+      FanSpeed = (tmpVal + 66);
+    }
+
+    // Position Fan
+    tmpVal = canMsgRcv.data[3];
+
+    if (tmpVal == 0x40) {
+      FootAerator = false;
+      WindShieldAerator = true;
+      CentralAerator = false;
+    } else if (tmpVal == 0x30) {
+      FootAerator = false;
+      WindShieldAerator = false;
+      CentralAerator = true;
+    } else if (tmpVal == 0x20) {
+      FootAerator = true;
+      WindShieldAerator = false;
+      CentralAerator = false;
+    } else if (tmpVal == 0x70) {
+      FootAerator = false;
+      WindShieldAerator = true;
+      CentralAerator = true;
+    } else if (tmpVal == 0x80) {
+      FootAerator = true;
+      WindShieldAerator = true;
+      CentralAerator = true;
+    } else if (tmpVal == 0x50) {
+      FootAerator = true;
+      WindShieldAerator = false;
+      CentralAerator = true;
+    } else if (tmpVal == 0x10) {
+      FootAerator = false;
+      WindShieldAerator = false;
+      CentralAerator = false;
+    } else if (tmpVal == 0x60) {
+      FootAerator = true;
+      WindShieldAerator = true;
+      CentralAerator = false;
+    } else {
+      FootAerator = false;
+      WindShieldAerator = false;
+      CentralAerator = false;
+    }
+
+    tmpVal = canMsgRcv.data[4];
+    if (tmpVal == 0x10) {
+      DeMist = true;
+      AirRecycle = false;
+    } else if (tmpVal == 0x30) {
+      AirRecycle = true;
+    } else {
+      AirRecycle = false;
+    }
+
+    AutoFan = false;
+    DeMist = false;
+
+    tmpVal = canMsgRcv.data[0];
+    if (tmpVal == 0x11) {
+      DeMist = true;
+      AirConditioningON = true;
+      FanOff = false;
+    } else if (tmpVal == 0x12) {
+      DeMist = true;
+      AirConditioningON = false;
+      FanOff = false;
+    } else if (tmpVal == 0x21) {
+      DeMist = true;
+      AirConditioningON = true;
+      FanOff = false;
+    } else if (tmpVal == 0xA2) {
+      FanOff = true;
+      AirConditioningON = false;
+    } else if (tmpVal == 0x22) {
+      AirConditioningON = false;
+    } else if (tmpVal == 0x20) {
+      AirConditioningON = true;
+    } else if (tmpVal == 0x02) {
+      AirConditioningON = false;
+      AutoFan = false;
+    } else if (tmpVal == 0x00) {
+      AirConditioningON = true;
+      AutoFan = true;
+    }
+
+    if (!FootAerator && !WindShieldAerator && CentralAerator) {
+      FanPosition = 0x34;
+    } else if (FootAerator && WindShieldAerator && CentralAerator) {
+      FanPosition = 0x84;
+    } else if (!FootAerator && WindShieldAerator && CentralAerator) {
+      FanPosition = 0x74;
+    } else if (FootAerator && !WindShieldAerator && CentralAerator) {
+      FanPosition = 0x54;
+    } else if (FootAerator && !WindShieldAerator && !CentralAerator) {
+      FanPosition = 0x24;
+    } else if (!FootAerator && WindShieldAerator && !CentralAerator) {
+      FanPosition = 0x44;
+    } else if (FootAerator && WindShieldAerator && !CentralAerator) {
+      FanPosition = 0x64;
+    } else {
+      FanPosition = 0x04; // Nothing
+    }
+
+    if (DeMist) {
+      FanSpeed = 0x10;
+      FanPosition = FanPosition + 16;
+    } else if (AutoFan) {
+      FanSpeed = 0x10;
+    }
+
+    if (FanOff) {
+      AirConditioningON = false;
+      FanSpeed = 0x41;
+      LeftTemp = 0x00;
+      RightTemp = 0x00;
+      FanPosition = 0x04;
+    }
+
+    if (AirConditioningON) {
+      canMsgSnd.data[0] = 0x01; // A/C ON - Auto Soft : "00" / Auto Normal "01" / Auto Fast "02"
+    } else {
+      canMsgSnd.data[0] = 0x09; // A/C OFF - Auto Soft : "08" / Auto Normal "09" / Auto Fast "0A"
+    }
+
+    canMsgSnd.data[1] = 0x00;
+    canMsgSnd.data[2] = 0x00;
+    canMsgSnd.data[3] = LeftTemp;
+    canMsgSnd.data[4] = RightTemp;
+    canMsgSnd.data[5] = FanSpeed;
+    canMsgSnd.data[6] = FanPosition;
+    canMsgSnd.data[7] = 0x00;
+    canMsgSnd.can_id = 0x350;
+    canMsgSnd.can_dlc = 8;
+    out = memoStore(memo_1D0, canMsgSnd);
+  }
+
+  canSend(BUS_CAN1, out);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, out);
   }
 }
 
-void loop() {
+static void handleCAN0_0F6() {
   int tmpVal;
 
-  if (hasAnalogicButtons) {
-    // Receive buttons from the car
-    if (((millis() - lastDebounceTime) > debounceDelay)) {
-      tmpVal = 0;
-      if (!digitalRead(menuButton)) tmpVal += 0b001;
-      if (!digitalRead(volDownButton)) tmpVal += 0b010;
-      if (!digitalRead(volUpButton)) tmpVal += 0b100;
-      if (tmpVal != lastButtonState) {
-        buttonPushTime = millis();
-        buttonSendTime = 0;
-        //buttonPushState = 0;
+  tmpVal = canMsgRcv.data[0];
+  if (tmpVal > 128) {
+    if (!Ignition) {
+      persistIgnition(true); // New drive for the flash commit counter
+      if (SerialEnabled) {
+        Serial.println("Ignition ON");
       }
-      if ((millis() - buttonPushTime) > 100) {
-        switch (tmpVal) {
-        case 0b001:
-          //canMsgSnd.data[0] = 0x02; // MENU button
-          canMsgSnd.data[0] = 0x02;
-          canMsgSnd.data[1] = 0x00;
-          canMsgSnd.data[2] = 0x00;
-          canMsgSnd.data[3] = 0x00;
-          canMsgSnd.data[4] = 0x00;
-          canMsgSnd.data[5] = 0xFF;
-          canMsgSnd.data[6] = 0x00;
-          canMsgSnd.data[7] = 0x00;
-          canMsgSnd.can_id = 0x122;
-          canMsgSnd.can_dlc = 8;
-          // Menu button
-          if (buttonSendTime == 0) {
-            CAN1.sendMessage( & canMsgSnd);
-            if (SerialEnabled) {
-              Serial.println("Menu");
-            }
-            lastDebounceTime = millis();
-            buttonSendTime = millis();
-            //buttonPushState = 1;
-          } else if (millis() - buttonPushTime > 800 && ((millis() - buttonPushTime < 2000 && millis() - buttonSendTime > 600) || (millis() - buttonPushTime > 2000 && millis() - buttonSendTime > 350))) {
-            CAN1.sendMessage( & canMsgSnd);
-            if (SerialEnabled) {
-              Serial.println("Menu");
-            }
-            buttonSendTime = millis();
-            lastDebounceTime = millis();
-          }
-          break;
-        case 0b010:
-          canMsgSnd.data[0] = 0x04; //Volume down
-          canMsgSnd.data[1] = scrollValue;
-          canMsgSnd.data[2] = 0x00;
-          canMsgSnd.can_id = 0x21F;
-          canMsgSnd.can_dlc = 3;
-          // Menu button
-          if (buttonSendTime == 0) {
-            CAN1.sendMessage( & canMsgSnd);
-            if (SerialEnabled) {
-              Serial.println("Vol -");
-            }
-            lastDebounceTime = millis();
-            buttonSendTime = millis();
-            //buttonPushState = 1;
-          } else if (millis() - buttonPushTime > 800 && ((millis() - buttonPushTime < 2000 && millis() - buttonSendTime > 600) || (millis() - buttonPushTime > 2000 && millis() - buttonSendTime > 350))) {
-            CAN1.sendMessage( & canMsgSnd);
-            if (SerialEnabled) {
-              Serial.println("Vol -");
-            }
-            buttonSendTime = millis();
-            lastDebounceTime = millis();
-          }
-          break;
-        case 0b100:
-          canMsgSnd.data[0] = 0x08; //Volume down
-          canMsgSnd.data[1] = scrollValue;
-          canMsgSnd.data[2] = 0x00;
-          canMsgSnd.can_id = 0x21F;
-          canMsgSnd.can_dlc = 3;
-          // Menu button
-          if (buttonSendTime == 0) {
-            CAN1.sendMessage( & canMsgSnd);
-            if (SerialEnabled) {
-              Serial.println("Vol +");
-            }
-            lastDebounceTime = millis();
-            buttonSendTime = millis();
-            //buttonPushState = 1;
-          } else if (millis() - buttonPushTime > 800 && ((millis() - buttonPushTime < 2000 && millis() - buttonSendTime > 600) || (millis() - buttonPushTime > 2000 && millis() - buttonSendTime > 350))) {
-            CAN1.sendMessage( & canMsgSnd);
-            if (SerialEnabled) {
-              Serial.println("Vol +");
-            }
-            buttonSendTime = millis();
-            lastDebounceTime = millis();
-          }
-          break;
-        case 0b110:
-          canMsgSnd.data[0] = 0x0C; //Mute
-          canMsgSnd.data[1] = scrollValue;
-          canMsgSnd.data[2] = 0x00;
-          canMsgSnd.can_id = 0x21F;
-          canMsgSnd.can_dlc = 3;
-          // Menu button
-          if (buttonSendTime == 0) {
-            CAN1.sendMessage( & canMsgSnd);
-            if (SerialEnabled) {
-              Serial.println("Mute");
-            }
-            lastDebounceTime = millis();
-            buttonSendTime = millis();
-            //buttonPushState = 1;
-          }
-          break;
-        default:
-          //buttonPushState = 0;
-          lastDebounceTime = millis();
-        }
+    }
+
+    Ignition = true;
+  } else {
+    if (Ignition) {
+      persistIgnition(false); // Commit pending settings before power goes
+      driveLogFlush();        // Write the partial log block too
+      if (SerialEnabled) {
+        Serial.println("Ignition OFF");
       }
-      lastButtonState = tmpVal;
     }
+
+    Ignition = false;
   }
 
-  // Instrument Cluster Test Mode
-  if (testClusterMode) {
-    clusterTestLoop();
+  tmpVal = (canMsgRcv.data[5] >> 1) - 40; // Temperatures can be negative but we only have 0 > 255, the new range is starting from -40°C
+  if (Temperature != tmpVal) {
+    Temperature = tmpVal;
+
+    if (SerialEnabled) {
+      Serial.print("Ext. Temperature: ");
+      Serial.print(tmpVal);
+      Serial.println("°C");
+    }
   }
 
-  // Receive CAN messages from the car
-  if (CAN0.readMessage( & canMsgRcv) == MCP2515::ERROR_OK) {
-    int id = canMsgRcv.can_id;
-    int len = canMsgRcv.can_dlc;
+  canSend(BUS_CAN1, & canMsgRcv);
+}
+
+// Instrument Panel - WIP
+typedef Translation<
+  Copy<Signal<0, 7, 8>, Signal<0, 7, 8>>, // Alerts
+  Copy<Signal<1, 7, 8>, Signal<1, 7, 8>>,
+  Copy<Signal<2, 7, 8>, Signal<2, 7, 8>>,
+  Copy<Signal<3, 7, 8>, Signal<3, 7, 8>>,
+  Copy<Signal<4, 7, 8>, Signal<4, 7, 8>>,
+  Copy<Signal<5, 7, 8>, Signal<5, 7, 8>>,
+  Const<Signal<6, 7>, 0>,
+  Const<Signal<6, 6>, 1>, // Ambiance
+  Const<Signal<6, 5>, 1>, // EMF availability
+  Copy<Signal<5, 0>, Signal<6, 4>>, // Gearbox report while driving
+  Copy<Signal<6, 7, 3>, Signal<6, 3, 3>>, // Gearbox report while driving
+  Const<Signal<6, 0>, 0>,
+  Copy<Signal<7, 7, 8>, Signal<7, 7, 8>>
+> Translation_168;
+
+static TranslationMemo memo_168 = TRANSLATION_MEMO(0x168);
+
+static void handleCAN0_168() {
+  const struct can_frame* out = memoLookup(memo_168, canMsgRcv, 0);
+  if (out == NULL) {
+    Translation_168::apply(canMsgRcv.data, canMsgSnd.data);
+    canMsgSnd.can_id = 0x168;
+    canMsgSnd.can_dlc = 8;
+    out = memoStore(memo_168, canMsgSnd);
+  }
+
+  canSend(BUS_CAN1, out);
+  if (settings.Send_CAN2010_ForgedMessages) { // Will generate some light issues on the instrument panel
+    canSend(BUS_CAN0, out);
+  }
+}
+
+// Alerts journal / Diagnostic > Popup notifications - Work in progress
+static void handleCAN0_120() {
+  // C5 (X7) Cluster is connected to CAN High Speed, no notifications are sent on CAN Low Speed, let's rebuild alerts from the journal (slighly slower than original alerts)
+  journalDecode(canMsgRcv); // Alert table per block, see alerts_journal.cpp
 
-    if (debugCAN0) {
+  canSend(BUS_CAN1, & canMsgRcv); // Forward original frame
+}
+
+// Trip info
+static void handleCAN0_221() {
+  statusTRIP[0] = canMsgRcv.data[0];
+  statusTRIP[1] = canMsgRcv.data[1];
+  statusTRIP[2] = canMsgRcv.data[2];
+  statusTRIP[3] = canMsgRcv.data[3];
+  statusTRIP[4] = canMsgRcv.data[4];
+  statusTRIP[5] = canMsgRcv.data[5];
+  statusTRIP[6] = canMsgRcv.data[6];
+  statusTRIP[7] = canMsgRcv.data[7];
+  canSend(BUS_CAN1, & canMsgRcv); // Forward original frame
+}
+
+// Instrument Panel
+typedef Translation<
+  Copy<Signal<4, 7, 8>, Signal<0, 7, 8>>, // Main driving lights
+  Copy<Signal<6, 7, 4>, Signal<1, 7, 4>>, // Gearbox report
+  Copy<Signal<6, 3, 3>, Signal<1, 3, 3>>, // Gearbox report while driving
+  Copy<Signal<6, 0>, Signal<1, 0>>, // Gearbox report blinking
+  Copy<Signal<7, 7>, Signal<2, 7>>, // Arrow blinking
+  Copy<Signal<7, 6, 3>, Signal<2, 6, 3>>, // BVA mode
+  Copy<Signal<7, 3, 2>, Signal<2, 3, 2>>, // Arrow type
+  Copy<Signal<7, 1, 2>, Signal<2, 1, 2>>, // Gearbox type
+  Copy<Signal<1, 7>, Signal<3, 7>>, // Service
+  Copy<Signal<1, 6>, Signal<3, 6>>, // STOP
+  Copy<Signal<2, 5>, Signal<3, 5>>, // Child security
+  Copy<Signal<0, 7>, Signal<3, 4>>, // Passenger Airbag
+  Copy<Signal<3, 2, 2>, Signal<3, 3, 2>>, // Foot on brake
+  Copy<Signal<0, 5>, Signal<3, 1>>, // Parking brake
+  Const<Signal<3, 0>, 0>, // Electric parking brake
+  Copy<Signal<0, 2>, Signal<4, 7>>, // Diesel pre-heating
+  Copy<Signal<1, 4>, Signal<4, 6>>, // Opening open
+  Copy<Signal<3, 4>, Signal<4, 5>>, // Automatic parking
+  Copy<Signal<3, 3>, Signal<4, 4>>, // Automatic parking blinking
+  Const<Signal<4, 3>, 0>, // Automatic high beam
+  Copy<Signal<2, 4>, Signal<4, 2>>, // ESP Disabled
+  Copy<Signal<2, 3>, Signal<4, 1>>, // ESP active
+  Copy<Signal<2, 2>, Signal<4, 0>>, // Active suspension
+  Copy<Signal<0, 4>, Signal<5, 7>>, // Low fuel
+  Copy<Signal<0, 6>, Signal<5, 6>>, // Driver seatbelt
+  Copy<Signal<3, 7>, Signal<5, 5>>, // Driver seatbelt blinking
+  Copy<Signal<0, 1>, Signal<5, 4>>, // Passenger seatbelt
+  Copy<Signal<3, 6>, Signal<5, 3>>, // Passenger seatbelt Blinking
+  Const<Signal<5, 2, 2>, 0>, // SCR
+  Copy<Signal<5, 6>, Signal<5, 0>>, // Rear left seatbelt
+  Copy<Signal<5, 5>, Signal<6, 7>>, // Rear seatbelt left blinking
+  Copy<Signal<5, 2>, Signal<6, 6>>, // Rear right seatbelt
+  Copy<Signal<5, 1>, Signal<6, 5>>, // Rear right seatbelt blinking
+  Copy<Signal<5, 4>, Signal<6, 4>>, // Rear middle seatbelt
+  Copy<Signal<5, 3>, Signal<6, 3>>, // Rear middle seatbelt blinking
+  Copy<Signal<5, 7>, Signal<6, 2>>, // Instrument Panel ON
+  Copy<Signal<2, 1>, Signal<6, 1>>, // Warnings
+  Const<Signal<6, 0>, 0>, // Passenger protection
+  Const<Signal<7, 7, 8>, 0x00>
+> Translation_128;
+
+static TranslationMemo memo_128 = TRANSLATION_MEMO(0x128);
+
+static void handleCAN0_128() {
+  const struct can_frame* out = memoLookup(memo_128, canMsgRcv, 0);
+  if (out == NULL) {
+    Translation_128::apply(canMsgRcv.data, canMsgSnd.data);
+    if (bitRead(canMsgRcv.data[7], 1) == 1 && bitRead(canMsgRcv.data[7], 0) == 0) { // BVMP to BVA
+      isBVMP = true;
+      bitWrite(canMsgSnd.data[2], 1, 0); // Gearbox type
+      bitWrite(canMsgSnd.data[2], 0, 0); // Gearbox type
+    }
+    canMsgSnd.can_id = 0x128;
+    canMsgSnd.can_dlc = 8;
+    out = memoStore(memo_128, canMsgSnd);
+  }
+
+  canSend(BUS_CAN1, out);
+  if (settings.Send_CAN2010_ForgedMessages) { // Will generate some light issues on the instrument panel
+    canSend(BUS_CAN0, out);
+  }
+}
+
+// Maintenance
+static TranslationMemo memo_3A7 = TRANSLATION_MEMO(0x3A7);
+
+static void handleCAN0_3A7() {
+  const struct can_frame* out = memoLookup(memo_3A7, canMsgRcv, 0);
+  if (out == NULL) {
+    canMsgSnd.data[0] = 0x40;
+    // Values are coded with WORD data type HIGH byte fisrt, LOW byte second
+    canMsgSnd.data[1] = canMsgRcv.data[5]; // Value x256 +
+    canMsgSnd.data[2] = canMsgRcv.data[6]; // Value x1 = Number of days till maintenance (FF FF if disabled)
+    canMsgSnd.data[3] = canMsgRcv.data[3]; // Value x256 * 20 +
+    canMsgSnd.data[4] = canMsgRcv.data[4]; // Value x20 = km left till maintenance
+    canMsgSnd.can_id = 0x3E7; // New maintenance frame ID
+    canMsgSnd.can_dlc = 5;
+
+    if (SerialEnabled && !MaintenanceDisplayed) {
+      uint16_t tmpVal = (canMsgRcv.data[3] << 8) | canMsgRcv.data[4];
+      // Not multiply to 20 to avoid overflow
+      Serial.print("Next maintenance in: ");
+      if (tmpVal != 0xFFFF) {
+        Serial.print(tmpVal);
+        Serial.println(" * 20 km");
+      }
+      tmpVal = (canMsgRcv.data[5] << 8) | canMsgRcv.data[6];
+      if (tmpVal != 0xFFFF) {
+        Serial.print(tmpVal);
+        Serial.println(" days");
+      }
+      MaintenanceDisplayed = true;
+    }
+    out = memoStore(memo_3A7, canMsgSnd);
+  }
+
+  canSend(BUS_CAN1, out);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, out);
+  }
+}
+
+// Cruise control
+static void handleCAN0_1A8() {
+  canSend(BUS_CAN1, & canMsgRcv);
+
+  canMsgSnd.data[0] = canMsgRcv.data[1];
+  canMsgSnd.data[1] = canMsgRcv.data[2];
+  canMsgSnd.data[2] = canMsgRcv.data[0];
+  canMsgSnd.data[3] = 0x80;
+  canMsgSnd.data[4] = 0x14;
+  canMsgSnd.data[5] = 0x7F;
+  canMsgSnd.data[6] = 0xFF;
+  canMsgSnd.data[7] = 0x98;
+  canMsgSnd.can_id = 0x228; // New cruise control frame ID
+  canMsgSnd.can_dlc = 8;
+  canSend(BUS_CAN1, & canMsgSnd);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, & canMsgSnd);
+  }
+}
+
+// CAN2004 Matrix
+static void handleCAN0_2D7() {
+  int tmpVal;
+
+  tmpVal = canMsgRcv.data[0];
+  if (tmpVal > 32) {
+    kmLDetected = true;
+    tmpVal = tmpVal - 32;
+  }
+
+  if (tmpVal <= 32 && languageID_CAN2004 != tmpVal) {
+    languageID_CAN2004 = tmpVal;
+    persistWrite(PERSIST_LANGUAGE_CAN2004, languageID_CAN2004);
+
+    // Change language and unit on ID 608 for CAN2010 Telematic language change
+    languageAndUnitNum = (languageID_CAN2004 * 4) + 128;
+    if (settings.kmL || kmLDetected) {
+      languageAndUnitNum = languageAndUnitNum + 1;
+    }
+    persistWrite(PERSIST_LANGUAGE_UNIT, languageAndUnitNum);
+
+    if (SerialEnabled) {
+      Serial.print("CAN2004 Matrix - Change Language: ");
+      Serial.print(tmpVal);
+      Serial.println();
+    }
+  } else {
+    Serial.print("CAN2004 Matrix - Unsupported language ID: ");
+    Serial.print(tmpVal);
+    Serial.println();
+  }
+}
+
+// Personalization menus availability
+typedef Translation<
+  Const<Signal<0, 7>, 1>, // Parameters availability
+  Copy<Signal<2, 3>, Signal<0, 6>>, // Beam
+  Const<Signal<0, 5>, 0>, // Lighting
+  Copy<Signal<3, 7>, Signal<0, 4>>, // Adaptative lighting
+  Copy<Signal<4, 1>, Signal<0, 3>>, // SAM
+  Copy<Signal<4, 2>, Signal<0, 2>>, // Ambiance lighting
+  Copy<Signal<2, 0>, Signal<0, 1>>, // Automatic headlights
+  Copy<Signal<3, 6>, Signal<0, 0>>, // Daytime running lights
+  Copy<Signal<5, 5>, Signal<1, 7>>, // AAS
+  Copy<Signal<3, 5>, Signal<1, 6>>, // Wiper in reverse
+  Copy<Signal<2, 4>, Signal<1, 5>>, // Guide-me home lighting
+  Copy<Signal<1, 2>, Signal<1, 4>>, // Driver welcome
+  Copy<Signal<2, 6>, Signal<1, 3>>, // Motorized tailgate
+  Copy<Signal<2, 0>, Signal<1, 2>>, // Selective openings - Rear
+  Copy<Signal<2, 7>, Signal<1, 1>>, // Selective openings - Key
+  Const<Signal<1, 0>, 0>, // Selective openings
+  Const<Signal<2, 7>, 1>, // TNB - Seatbelt indicator
+  Const<Signal<2, 6>, 1>, // XVV - Custom cruise limits
+  Copy<Signal<1, 4>, Signal<2, 5>>, // Configurable button
+  Copy<Signal<2, 2>, Signal<2, 4>>, // Automatic parking brake
+  Const<Signal<2, 3>, 0>, // Sound Harmony
+  Const<Signal<2, 2>, 0>, // Rear mirror index
+  Const<Signal<2, 1, 2>, 0>,
+  Const<Signal<3, 7>, 1>, // DSG Reset
+  Const<Signal<3, 6>, 0>, // Front Collision Warning
+  Const<Signal<3, 5>, 0>,
+  Const<Signal<3, 4>, 1>, // XVV - Custom cruise limits Menu
+  Const<Signal<3, 3>, 1>, // Recommended speed indicator
+  Copy<Signal<5, 6, 3>, Signal<3, 2, 3>>, // DSG - Underinflating (3b)
+  Const<Signal<4, 7, 8>, 0x00>,
+  Const<Signal<5, 7, 8>, 0x00>,
+  Const<Signal<6, 7, 8>, 0x20>, // Privacy mode
+  Const<Signal<7, 7, 8>, 0x00>
+> Translation_361;
+
+static TranslationMemo memo_361 = TRANSLATION_MEMO(0x361);
+
+static void handleCAN0_361() {
+  const struct can_frame* out = memoLookup(memo_361, canMsgRcv, 0);
+  if (out == NULL) {
+    Translation_361::apply(canMsgRcv.data, canMsgSnd.data);
+    canMsgSnd.can_id = 0x361;
+    canMsgSnd.can_dlc = 8;
+    out = memoStore(memo_361, canMsgSnd);
+  }
+
+  canSend(BUS_CAN1, out);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, out);
+  }
+}
+
+// Personalization settings status (user profile 1)
+typedef Translation<
+  Const<Signal<1, 5>, 0>, // Ambiance level
+  Const<Signal<1, 4>, 1>, // Ambiance level
+  Const<Signal<1, 3>, 1>, // Ambiance level
+  Const<Signal<1, 2>, 1>, // Parameters availability
+  Const<Signal<1, 1, 2>, 0>, // Sound Harmony
+  Copy<Signal<1, 0>, Signal<2, 7>>, // Automatic parking brake
+  Copy<Signal<1, 7>, Signal<2, 6>>, // Selective openings - Key
+  Copy<Signal<1, 4>, Signal<2, 5>>, // Selective openings
+  Copy<Signal<1, 5>, Signal<2, 4>>, // Selective openings - Rear
+  Copy<Signal<1, 1>, Signal<2, 3>>, // Driver Welcome
+  Copy<Signal<2, 7>, Signal<2, 2>>, // Adaptative lighting
+  Copy<Signal<3, 6>, Signal<2, 1>>, // Daytime running lights
+  Copy<Signal<3, 7>, Signal<2, 0>>, // Ambiance lighting
+  Copy<Signal<2, 5>, Signal<3, 7>>, // Guide-me home lighting
+  Copy<Signal<2, 1, 2>, Signal<3, 6, 2>>, // Duration Guide-me home lighting (2b)
+  Copy<Signal<2, 6>, Signal<3, 4>>, // Beam
+  Const<Signal<3, 3>, 0>, // Lighting ?
+  Const<Signal<3, 2, 2>, 0>, // Duration Lighting (2b) ?
+  Copy<Signal<2, 4>, Signal<3, 0>>, // Automatic headlights
+  Copy<Signal<5, 6>, Signal<4, 7>>, // AAS
+  Copy<Signal<6, 5>, Signal<4, 6>>, // SAM
+  Copy<Signal<5, 4>, Signal<4, 5>>, // Wiper in reverse
+  Const<Signal<4, 4>, 0>, // Motorized tailgate
+  Copy<Signal<7, 7, 4>, Signal<4, 3, 4>> // Configurable button
+> Translation_260;
+
+// Personalization settings status
+static void handleCAN0_260() {
+  // Do not forward original message, it has been completely redesigned on CAN2010
+  // Also forge missing messages from CAN2004
+
+  if (canMsgRcv.data[0] == 0x01) { // User profile 1
+    Translation_260::apply(canMsgRcv.data, canMsgSnd.data);
+    canMsgSnd.data[0] = languageAndUnitNum;
+    bitWrite(canMsgSnd.data[1], 7, (mpgMi)?1:0);
+    bitWrite(canMsgSnd.data[1], 6, (TemperatureInF)?1:0);
+
+    personalizationSettings[7] = canMsgSnd.data[1];
+    personalizationSettings[8] = canMsgSnd.data[2];
+    personalizationSettings[9] = canMsgSnd.data[3];
+    personalizationSettings[10] = canMsgSnd.data[4];
+  } else { // Cached information if any other profile
+    canMsgSnd.data[0] = languageAndUnitNum;
+    canMsgSnd.data[1] = personalizationSettings[7];
+    canMsgSnd.data[2] = personalizationSettings[8];
+    canMsgSnd.data[3] = personalizationSettings[9];
+    canMsgSnd.data[4] = personalizationSettings[10];
+  }
+  canMsgSnd.data[5] = 0x00;
+  canMsgSnd.data[6] = 0x00;
+  canMsgSnd.can_id = 0x260;
+  canMsgSnd.can_dlc = 7;
+  canSend(BUS_CAN1, & canMsgSnd);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, & canMsgSnd);
+  }
+
+  bitWrite(canMsgSnd.data[0], 7, 0);
+  bitWrite(canMsgSnd.data[0], 6, 0);
+  bitWrite(canMsgSnd.data[0], 5, 0);
+  bitWrite(canMsgSnd.data[0], 4, 0);
+  bitWrite(canMsgSnd.data[0], 3, 0);
+  bitWrite(canMsgSnd.data[0], 2, 1); // Parameters validity
+  bitWrite(canMsgSnd.data[0], 1, 0); // User profile
+  bitWrite(canMsgSnd.data[0], 0, 1); // User profile = 1
+  canMsgSnd.data[1] = personalizationSettings[0];
+  canMsgSnd.data[2] = personalizationSettings[1];
+  canMsgSnd.data[3] = personalizationSettings[2];
+  canMsgSnd.data[4] = personalizationSettings[3];
+  canMsgSnd.data[5] = personalizationSettings[4];
+  canMsgSnd.data[6] = personalizationSettings[5];
+  canMsgSnd.data[7] = personalizationSettings[6];
+  canMsgSnd.can_id = 0x15B; // Personalization frame status
+  canMsgSnd.can_dlc = 8;
+  canSend(BUS_CAN0, & canMsgSnd);
+
+  if (!TelematicPresent && Ignition) {
+    canMsgSnd.data[0] = 0x00;
+    canMsgSnd.data[1] = 0x10;
+    canMsgSnd.data[2] = 0xFF;
+    canMsgSnd.data[3] = 0xFF;
+    canMsgSnd.data[4] = 0x7F;
+    canMsgSnd.data[5] = 0xFF;
+    canMsgSnd.data[6] = 0x00;
+    canMsgSnd.data[7] = 0x00;
+    canMsgSnd.can_id = 0x167; // Fake EMF status frame
+    canMsgSnd.can_dlc = 8;
+    canSend(BUS_CAN0, & canMsgSnd);
+  }
+
+  // Economy mode simulation
+  if (EconomyMode && settings.EconomyModeEnabled) {
+    canMsgSnd.data[0] = 0x14;
+    if (Ignition) {
+      canMsgSnd.data[5] = 0x0E;
+    } else {
+      canMsgSnd.data[5] = 0x0C;
+    }
+  } else {
+    if (EngineRunning) {
+      canMsgSnd.data[0] = 0x54;
+    } else {
+      canMsgSnd.data[0] = 0x04;
+    }
+    canMsgSnd.data[5] = 0x0F;
+  }
+  canMsgSnd.data[1] = 0x03;
+  canMsgSnd.data[2] = 0xDE;
+
+  canMsgSnd.data[3] = 0x00; // Increasing value,
+  canMsgSnd.data[4] = 0x00; // counter ?
+
+  canMsgSnd.data[6] = 0xFE;
+  canMsgSnd.data[7] = 0x00;
+  canMsgSnd.can_id = 0x236;
+  canMsgSnd.can_dlc = 8;
+  canSend(BUS_CAN1, & canMsgSnd);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, & canMsgSnd);
+  }
+
+  // Current Time
+  // If time is synced
+  if (clockIsSet()) {
+    tmElements_t tm;
+    clockRead(tm);
+    canMsgSnd.data[0] = (tmYearToCalendar(tm.Year) - 1872); // Year would not fit inside one byte (0 > 255), substract 1872 and you get this new range (1872 > 2127)
+    canMsgSnd.data[1] = tm.Month;
+    canMsgSnd.data[2] = tm.Day;
+    canMsgSnd.data[3] = tm.Hour;
+    canMsgSnd.data[4] = tm.Minute;
+    canMsgSnd.data[5] = 0x3F;
+    canMsgSnd.data[6] = 0xFE;
+  } else {
+    canMsgSnd.data[0] = (Time_year - 1872); // Year would not fit inside one byte (0 > 255), substract 1872 and you get this new range (1872 > 2127)
+    canMsgSnd.data[1] = Time_month;
+    canMsgSnd.data[2] = Time_day;
+    canMsgSnd.data[3] = Time_hour;
+    canMsgSnd.data[4] = Time_minute;
+    canMsgSnd.data[5] = 0x3F;
+    canMsgSnd.data[6] = 0xFE;
+  }
+  canMsgSnd.can_id = 0x276;
+  canMsgSnd.can_dlc = 7;
+  canSend(BUS_CAN1, & canMsgSnd);
+  if (settings.Send_CAN2010_ForgedMessages) {
+    canSend(BUS_CAN0, & canMsgSnd);
+  }
+
+  if (!EngineRunning) {
+    memoInvalidate(memo_1D0); // A/C state reset here, 0x1D0 must be translated again
+    AirConditioningON = false;
+    FanSpeed = 0x41;
+    LeftTemp = 0x00;
+    RightTemp = 0x00;
+    FanPosition = 0x04;
+
+    canMsgSnd.data[0] = 0x09;
+    canMsgSnd.data[1] = 0x00;
+    canMsgSnd.data[2] = 0x00;
+    canMsgSnd.data[3] = LeftTemp;
+    canMsgSnd.data[4] = RightTemp;
+    canMsgSnd.data[5] = FanSpeed;
+    canMsgSnd.data[6] = FanPosition;
+    canMsgSnd.data[7] = 0x00;
+    canMsgSnd.can_id = 0x350;
+    canMsgSnd.can_dlc = 8;
+    canSend(BUS_CAN1, & canMsgSnd);
+    if (settings.Send_CAN2010_ForgedMessages) {
+      canSend(BUS_CAN0, & canMsgSnd);
+    }
+  }
+}
+
+// Process one frame received from the car (CAN0 → CAN1), held in canMsgRcv
+void processCAN0Frame() {
+  LATENCY_SCOPE(BUS_CAN0);
+  BOOT_TIMING_SCOPE(BUS_CAN0, canMsgRcv);
+
+  // A frame this adapter sent on CAN1 coming back through another bridge
+  if (echoSuppress(BUS_CAN0, & canMsgRcv)) {
+    return;
+  }
+
+  int id = canMsgRcv.can_id;
+  int len = canMsgRcv.can_dlc;
+
+  if (settings.debugCAN0) {
+    if (settings.debugBinaryCapture) {
+      captureFrame(BUS_CAN0, & canMsgRcv, false);
+    } else {
       Serial.print("FRAME:ID=");
       Serial.print(id);
       Serial.print(":LEN=");
@@ -510,1112 +1246,428 @@ void loop() {
       }
 
       Serial.println();
+    }
 
-      CAN1.sendMessage( & canMsgRcv);
-    } else if (!debugCAN1) {
-      if (id == 0x15B) {
-        // Do not send back converted frames between networks
-      } else if (id == 0x36 && len == 8) { // Economy Mode detection
-        if (bitRead(canMsgRcv.data[2], 7) == 1) {
-          if (!EconomyMode && SerialEnabled) {
-            Serial.println("Economy mode ON");
-          }
-
-          EconomyMode = true;
-        } else {
-          if (EconomyMode && SerialEnabled) {
-            Serial.println("Economy mode OFF");
-          }
-
-          EconomyMode = false;
-        }
+    canSend(BUS_CAN1, & canMsgRcv);
+  } else if (!settings.debugCAN1) {
+    CanFrameHandler handler = canDispatchLookup(BUS_CAN0, & canMsgRcv);
+    if (handler != NULL) {
+      handler();
+    } else {
+      canSend(BUS_CAN1, & canMsgRcv); // No handler for this ID: forward unchanged
+    }
+  } else {
+    canSend(BUS_CAN1, & canMsgRcv);
+  }
+}
 
-        tmpVal = canMsgRcv.data[3];
+// ============================================================================
+// FRAMES FROM THE CAN2010 DEVICE(S) (CAN1 → CAN0), held in canMsgRcvDevice
+// ============================================================================
 
-        // Fix brightness when car lights are ON - Brightness Instrument Panel "20" > "2F" (32 > 47) - Depends on your car
-        if (fixedBrightness && tmpVal >= 32) {
-          canMsgRcv.data[3] = 0x28; // Set fixed value to avoid low brightness due to incorrect CAN2010 Telematic calibration
-        }
-        CAN1.sendMessage( & canMsgRcv);
-      } else if (id == 0xB6 && len == 8) {
-        engineRPM = ((canMsgRcv.data[0] << 8) | canMsgRcv.data[1]) * 0.125;
-        if (engineRPM > 0) {
-          EngineRunning = true;
-        } else {
-          EngineRunning = false;
-        }
-        vehicleSpeed = ((canMsgRcv.data[2] << 8) | canMsgRcv.data[3]) * 0.01;
-        CAN1.sendMessage( & canMsgRcv);
-      } else if (id == 0x336 && len == 3 && emulateVIN) { // ASCII coded first 3 letters of VIN
-        canMsgSnd.data[0] = vinNumber[0]; //V
-        canMsgSnd.data[1] = vinNumber[1]; //F
-        canMsgSnd.data[2] = vinNumber[2]; //3
-        canMsgSnd.can_id = 0x336;
-        canMsgSnd.can_dlc = 3;
-        CAN1.sendMessage( & canMsgSnd);
-      } else if (id == 0x3B6 && len == 6 && emulateVIN) { // ASCII coded 4-9 letters of VIN
-        canMsgSnd.data[0] = vinNumber[3]; //X
-        canMsgSnd.data[1] = vinNumber[4]; //X
-        canMsgSnd.data[2] = vinNumber[5]; //X
-        canMsgSnd.data[3] = vinNumber[6]; //X
-        canMsgSnd.data[4] = vinNumber[7]; //X
-        canMsgSnd.data[5] = vinNumber[8]; //X
-        canMsgSnd.can_id = 0x3B6;
-        canMsgSnd.can_dlc = 6;
-        CAN1.sendMessage( & canMsgSnd);
-      } else if (id == 0x2B6 && len == 8 && emulateVIN) { // ASCII coded 10-17 letters (last 8) of VIN
-        canMsgSnd.data[0] = vinNumber[9]; //X
-        canMsgSnd.data[1] = vinNumber[10]; //X
-        canMsgSnd.data[2] = vinNumber[11]; //X
-        canMsgSnd.data[3] = vinNumber[12]; //X
-        canMsgSnd.data[4] = vinNumber[13]; //X
-        canMsgSnd.data[5] = vinNumber[14]; //X
-        canMsgSnd.data[6] = vinNumber[15]; //X
-        canMsgSnd.data[7] = vinNumber[16]; //X
-        canMsgSnd.can_id = 0x2B6;
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-      } else if (id == 0xE6 && len < 8) { // ABS status frame, increase length
-        canMsgSnd.data[0] = canMsgRcv.data[0]; // Status lights / Alerts
-        canMsgSnd.data[1] = canMsgRcv.data[1]; // Rear left rotations
-        canMsgSnd.data[2] = canMsgRcv.data[2]; // Rear left rotations
-        canMsgSnd.data[3] = canMsgRcv.data[3]; // Rear right rotations
-        canMsgSnd.data[4] = canMsgRcv.data[4]; // Rear right rotations
-        canMsgSnd.data[5] = canMsgRcv.data[5]; // Battery Voltage measured by ABS
-        canMsgSnd.data[6] = canMsgRcv.data[6]; // STT / Slope / Emergency Braking
-        canMsgSnd.data[7] = checksumm_0E6(canMsgSnd.data); // Checksum / Counter : Test needed
-        canMsgSnd.can_id = 0xE6;
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-      } else if (id == 0x21F && len == 3) { // Steering wheel commands - Generic
-        tmpVal = canMsgRcv.data[0];
-        scrollValue = canMsgRcv.data[1];
-
-        if (bitRead(canMsgRcv.data[0], 1) && noFMUX && steeringWheelCommands_Type == 0) { // Replace MODE/SRC by MENU (Valid for 208, C-Elysee calibrations for example)
-          canMsgSnd.data[0] = 0x80; // MENU button
-          canMsgSnd.data[1] = 0x00;
-          canMsgSnd.data[2] = 0x00;
-          canMsgSnd.data[3] = 0x00;
-          canMsgSnd.data[4] = 0x00;
-          canMsgSnd.data[5] = 0x02;
-          canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-          canMsgSnd.data[7] = 0x00;
-          canMsgSnd.can_id = 0x122;
-          canMsgSnd.can_dlc = 8;
-          CAN1.sendMessage( & canMsgSnd);
-          if (Send_CAN2010_ForgedMessages) {
-            CAN0.sendMessage( & canMsgSnd);
-          }
-        } else {
-          CAN1.sendMessage( & canMsgRcv);
-
-          if (noFMUX || hasAnalogicButtons) { // Fake FMUX Buttons in the car
-            canMsgSnd.data[0] = 0x00;
-            canMsgSnd.data[1] = 0x00;
-            canMsgSnd.data[2] = 0x00;
-            canMsgSnd.data[3] = 0x00;
-            canMsgSnd.data[4] = 0x00;
-            canMsgSnd.data[5] = 0x02;
-            canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-            canMsgSnd.data[7] = 0x00;
-            canMsgSnd.can_id = 0x122;
-            canMsgSnd.can_dlc = 8;
-            CAN1.sendMessage( & canMsgSnd);
-            if (Send_CAN2010_ForgedMessages) {
-              CAN0.sendMessage( & canMsgSnd);
-            }
-          }
-        }
-      } else if (id == 0xA2 && noFMUX && steeringWheelCommands_Type == 1) { // Steering wheel commands - C4 I / C5 X7
-        // Fake FMUX Buttons in the car
-        canMsgSnd.data[0] = 0x00;
-        canMsgSnd.data[1] = 0x00;
-        canMsgSnd.data[2] = 0x00;
-        canMsgSnd.data[3] = 0x00;
-        canMsgSnd.data[4] = 0x00;
-        canMsgSnd.data[5] = 0x02;
-        canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-        canMsgSnd.data[7] = 0x00;
-
-        if (bitRead(canMsgRcv.data[1], 3)) { // MENU button pushed > MUSIC
-          if (!pushA2) {
-            canMsgSnd.data[0] = 0x00;
-            canMsgSnd.data[1] = 0x20;
-            canMsgSnd.data[2] = 0x00;
-            canMsgSnd.data[3] = 0x00;
-            canMsgSnd.data[4] = 0x00;
-            canMsgSnd.data[5] = 0x02;
-            canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-            canMsgSnd.data[7] = 0x00;
-            pushA2 = true;
-          }
-        } else if (bitRead(canMsgRcv.data[1], 2)) { // MODE button pushed > NAV
-          if (!pushA2) {
-            canMsgSnd.data[0] = 0x00;
-            canMsgSnd.data[1] = 0x08;
-            canMsgSnd.data[2] = 0x00;
-            canMsgSnd.data[3] = 0x00;
-            canMsgSnd.data[4] = 0x00;
-            canMsgSnd.data[5] = 0x02;
-            canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-            canMsgSnd.data[7] = 0x00;
-            pushA2 = true;
-          }
-        } else if (bitRead(canMsgRcv.data[1], 4)) { // ESC button pushed > APPS
-          if (!pushA2) {
-            canMsgSnd.data[0] = 0x00;
-            canMsgSnd.data[1] = 0x40;
-            canMsgSnd.data[2] = 0x00;
-            canMsgSnd.data[3] = 0x00;
-            canMsgSnd.data[4] = 0x00;
-            canMsgSnd.data[5] = 0x02;
-            canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-            canMsgSnd.data[7] = 0x00;
-            pushA2 = true;
-          }
-        } else if (bitRead(canMsgRcv.data[1], 5)) { // OK button pushed > PHONE
-          if (!pushA2) {
-            canMsgSnd.data[0] = 0x00;
-            canMsgSnd.data[1] = 0x04;
-            canMsgSnd.data[2] = 0x08;
-            canMsgSnd.data[3] = 0x00;
-            canMsgSnd.data[4] = 0x00;
-            canMsgSnd.data[5] = 0x02;
-            canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-            canMsgSnd.data[7] = 0x00;
-            pushA2 = true;
-          }
-        } else {
-          pushA2 = false;
-          CAN1.sendMessage( & canMsgRcv);
-        }
-        canMsgSnd.can_id = 0x122;
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
-        }
-      } else if (id == 0xA2 && noFMUX && (steeringWheelCommands_Type == 2 || steeringWheelCommands_Type == 3 || steeringWheelCommands_Type == 4 || steeringWheelCommands_Type == 5)) { // Steering wheel commands - C4 I / C5 X7
-        // Fake FMUX Buttons in the car
-        canMsgSnd.data[0] = 0x00;
-        canMsgSnd.data[1] = 0x00;
-        canMsgSnd.data[2] = 0x00;
-        canMsgSnd.data[3] = 0x00;
-        canMsgSnd.data[4] = 0x00;
-        canMsgSnd.data[5] = 0x02;
-        canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-        canMsgSnd.data[7] = 0x00;
-
-        if (bitRead(canMsgRcv.data[1], 3)) { // MENU button pushed > MENU
-          if (!pushA2) {
-            canMsgSnd.data[0] = 0x80;
-            canMsgSnd.data[1] = 0x00;
-            canMsgSnd.data[2] = 0x00;
-            canMsgSnd.data[3] = 0x00;
-            canMsgSnd.data[4] = 0x00;
-            canMsgSnd.data[5] = 0x02;
-            canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-            canMsgSnd.data[7] = 0x00;
-            pushA2 = true;
-          }
-        } else if (bitRead(canMsgRcv.data[1], 2) && (steeringWheelCommands_Type == 3 || steeringWheelCommands_Type == 5)) { // Right push button / MODE/SRC > SRC
-          if (!pushA2) {
-            canMsgSnd.data[0] = 0x40;
-            canMsgSnd.data[1] = 0x00;
-            canMsgSnd.data[2] = 0x00;
-            canMsgSnd.data[3] = 0x00;
-            canMsgSnd.data[4] = 0x00;
-            canMsgSnd.data[5] = 0x02;
-            canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-            canMsgSnd.data[7] = 0x00;
-            pushA2 = true;
-          }
-        } else if (bitRead(canMsgRcv.data[1], 4) && steeringWheelCommands_Type == 4) { // ESC button pushed > SRC
-          if (!pushA2) {
-            canMsgSnd.data[0] = 0x40;
-            canMsgSnd.data[1] = 0x00;
-            canMsgSnd.data[2] = 0x00;
-            canMsgSnd.data[3] = 0x00;
-            canMsgSnd.data[4] = 0x00;
-            canMsgSnd.data[5] = 0x02;
-            canMsgSnd.data[6] = 0x00; // Volume potentiometer button
-            canMsgSnd.data[7] = 0x00;
-            pushA2 = true;
-          }
-        } else if (bitRead(canMsgRcv.data[1], 4) && steeringWheelCommands_Type == 5) { // ESC button pushed > TRIP
-          if (!pushA2) {
-            pushTRIP = true;
-            pushA2 = true;
-          }
-        } else if (bitRead(canMsgRcv.data[1], 2) && steeringWheelCommands_Type == 4) { // Right push button / MODE/SRC > TRIP
-          if (!pushA2) {
-            pushTRIP = true;
-            pushA2 = true;
-          }
-        } else {
-          pushA2 = false;
-          CAN1.sendMessage( & canMsgRcv);
-        }
-        canMsgSnd.can_id = 0x122;
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
-        }
+// Generated by this adapter from CAN2004 frames
+static void handleCAN1_Converted() {
+  // Do not send back converted frames between networks
+}
 
-        if (pushTRIP) {
-          pushTRIP = false;
-
-          canMsgSnd.data[0] = statusTRIP[0];
-          bitWrite(canMsgSnd.data[0], 3, 1);
-          canMsgSnd.data[1] = statusTRIP[1];
-          canMsgSnd.data[2] = statusTRIP[2];
-          canMsgSnd.data[3] = statusTRIP[3];
-          canMsgSnd.data[4] = statusTRIP[4];
-          canMsgSnd.data[5] = statusTRIP[5];
-          canMsgSnd.data[6] = statusTRIP[6];
-          canMsgSnd.data[7] = statusTRIP[7];
-          canMsgSnd.can_id = 0x221;
-          canMsgSnd.can_dlc = 8;
-          CAN1.sendMessage( & canMsgSnd);
-          if (Send_CAN2010_ForgedMessages) {
-            CAN0.sendMessage( & canMsgSnd);
-          }
-        }
-      } else if (id == 0x217 && len == 8) { // Cache cluster status (CMB)
-        statusCMB[0] = canMsgRcv.data[0];
-        statusCMB[1] = canMsgRcv.data[1];
-        statusCMB[2] = canMsgRcv.data[2];
-        statusCMB[3] = canMsgRcv.data[3];
-        statusCMB[4] = canMsgRcv.data[4];
-        statusCMB[5] = canMsgRcv.data[5];
-        statusCMB[6] = canMsgRcv.data[6];
-        statusCMB[7] = canMsgRcv.data[7];
-
-        CAN1.sendMessage( & canMsgRcv);
-      } else if (id == 0x1D0 && len == 7 && EngineRunning) { // No fan activated if the engine is not ON on old models
-        LeftTemp = canMsgRcv.data[5];
-        RightTemp = canMsgRcv.data[6];
-        if (LeftTemp == RightTemp) { // No other way to detect MONO mode
-          Mono = true;
-          LeftTemp = LeftTemp + 64;
-        } else {
-          Mono = false;
-        }
+static void handleCAN1_39B() {
+  Time_year = canMsgRcvDevice.data[0] + 1872; // Year would not fit inside one byte (0 > 255), add 1872 and you get this new range (1872 > 2127)
+  Time_month = canMsgRcvDevice.data[1];
+  Time_day = canMsgRcvDevice.data[2];
+  Time_hour = canMsgRcvDevice.data[3];
+  Time_minute = canMsgRcvDevice.data[4];
 
-        FanOff = false;
-        // Fan Speed BSI_2010 = "41" (Off) > "49" (Full speed)
-        tmpVal = canMsgRcv.data[2];
-        if (tmpVal == 15) {
-          FanOff = true;
-          FanSpeed = 0x41;
-        } else {
-          FanSpeed = (tmpVal + 66);
-        }
+  clockSet(Time_year, Time_month, Time_day, Time_hour, Time_minute, true); // The RTC task writes the RTC module too
+  persistWrite(PERSIST_TIME_DAY, Time_day);
+  persistWrite(PERSIST_TIME_MONTH, Time_month);
+  persistPut(PERSIST_TIME_YEAR, (uint16_t) Time_year);
 
-        // Position Fan
-        tmpVal = canMsgRcv.data[3];
-
-        if (tmpVal == 0x40) {
-          FootAerator = false;
-          WindShieldAerator = true;
-          CentralAerator = false;
-        } else if (tmpVal == 0x30) {
-          FootAerator = false;
-          WindShieldAerator = false;
-          CentralAerator = true;
-        } else if (tmpVal == 0x20) {
-          FootAerator = true;
-          WindShieldAerator = false;
-          CentralAerator = false;
-        } else if (tmpVal == 0x70) {
-          FootAerator = false;
-          WindShieldAerator = true;
-          CentralAerator = true;
-        } else if (tmpVal == 0x80) {
-          FootAerator = true;
-          WindShieldAerator = true;
-          CentralAerator = true;
-        } else if (tmpVal == 0x50) {
-          FootAerator = true;
-          WindShieldAerator = false;
-          CentralAerator = true;
-        } else if (tmpVal == 0x10) {
-          FootAerator = false;
-          WindShieldAerator = false;
-          CentralAerator = false;
-        } else if (tmpVal == 0x60) {
-          FootAerator = true;
-          WindShieldAerator = true;
-          CentralAerator = false;
-        } else {
-          FootAerator = false;
-          WindShieldAerator = false;
-          CentralAerator = false;
-        }
+  // Send the new hour on the CAN-BUS Clock right away
+  schedulerKick(BUS_CAN0, 0x228);
 
-        tmpVal = canMsgRcv.data[4];
-        if (tmpVal == 0x10) {
-          DeMist = true;
-          AirRecycle = false;
-        } else if (tmpVal == 0x30) {
-          AirRecycle = true;
-        } else {
-          AirRecycle = false;
-        }
+  if (SerialEnabled) {
+    Serial.print("Change Hour/Date: ");
+    Serial.print(Time_day);
+    Serial.print("/");
+    Serial.print(Time_month);
+    Serial.print("/");
+    Serial.print(Time_year);
 
-        AutoFan = false;
-        DeMist = false;
-
-        tmpVal = canMsgRcv.data[0];
-        if (tmpVal == 0x11) {
-          DeMist = true;
-          AirConditioningON = true;
-          FanOff = false;
-        } else if (tmpVal == 0x12) {
-          DeMist = true;
-          AirConditioningON = false;
-          FanOff = false;
-        } else if (tmpVal == 0x21) {
-          DeMist = true;
-          AirConditioningON = true;
-          FanOff = false;
-        } else if (tmpVal == 0xA2) {
-          FanOff = true;
-          AirConditioningON = false;
-        } else if (tmpVal == 0x22) {
-          AirConditioningON = false;
-        } else if (tmpVal == 0x20) {
-          AirConditioningON = true;
-        } else if (tmpVal == 0x02) {
-          AirConditioningON = false;
-          AutoFan = false;
-        } else if (tmpVal == 0x00) {
-          AirConditioningON = true;
-          AutoFan = true;
-        }
+    Serial.print(" ");
 
-        if (!FootAerator && !WindShieldAerator && CentralAerator) {
-          FanPosition = 0x34;
-        } else if (FootAerator && WindShieldAerator && CentralAerator) {
-          FanPosition = 0x84;
-        } else if (!FootAerator && WindShieldAerator && CentralAerator) {
-          FanPosition = 0x74;
-        } else if (FootAerator && !WindShieldAerator && CentralAerator) {
-          FanPosition = 0x54;
-        } else if (FootAerator && !WindShieldAerator && !CentralAerator) {
-          FanPosition = 0x24;
-        } else if (!FootAerator && WindShieldAerator && !CentralAerator) {
-          FanPosition = 0x44;
-        } else if (FootAerator && WindShieldAerator && !CentralAerator) {
-          FanPosition = 0x64;
-        } else {
-          FanPosition = 0x04; // Nothing
-        }
+    Serial.print(Time_hour);
+    Serial.print(":");
+    Serial.print(Time_minute);
 
-        if (DeMist) {
-          FanSpeed = 0x10;
-          FanPosition = FanPosition + 16;
-        } else if (AutoFan) {
-          FanSpeed = 0x10;
-        }
+    Serial.println();
+  }
+}
 
-        if (FanOff) {
-          AirConditioningON = false;
-          FanSpeed = 0x41;
-          LeftTemp = 0x00;
-          RightTemp = 0x00;
-          FanPosition = 0x04;
-        }
+// Telematic commands
+static void handleCAN1_1A9() {
+  bool flag;
 
-        if (AirConditioningON) {
-          canMsgSnd.data[0] = 0x01; // A/C ON - Auto Soft : "00" / Auto Normal "01" / Auto Fast "02"
-        } else {
-          canMsgSnd.data[0] = 0x09; // A/C OFF - Auto Soft : "08" / Auto Normal "09" / Auto Fast "0A"
-        }
+  if (!TelematicPresent) {
+    flag = true;
+    gatewayPost(PATH_CAR, &TelematicPresent, &flag, sizeof(TelematicPresent));
+  }
 
-        canMsgSnd.data[1] = 0x00;
-        canMsgSnd.data[2] = 0x00;
-        canMsgSnd.data[3] = LeftTemp;
-        canMsgSnd.data[4] = RightTemp;
-        canMsgSnd.data[5] = FanSpeed;
-        canMsgSnd.data[6] = FanPosition;
-        canMsgSnd.data[7] = 0x00;
-        canMsgSnd.can_id = 0x350;
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
-        }
-      } else if (id == 0xF6 && len == 8) {
-        tmpVal = canMsgRcv.data[0];
-        if (tmpVal > 128) {
-          if (!Ignition && SerialEnabled) {
-            Serial.println("Ignition ON");
-          }
-
-          Ignition = true;
-        } else {
-          if (Ignition && SerialEnabled) {
-            Serial.println("Ignition OFF");
-          }
-
-          Ignition = false;
-        }
+  darkMode = bitRead(canMsgRcvDevice.data[0], 7); // Dark mode
+  resetTrip1 = bitRead(canMsgRcvDevice.data[0], 1); // Reset Trip 1
+  resetTrip2 = bitRead(canMsgRcvDevice.data[0], 0); // Reset Trip 2
+  pushAAS = bitRead(canMsgRcvDevice.data[3], 2); // AAS
+  pushSAM = bitRead(canMsgRcvDevice.data[3], 2); // SAM
+  pushDSG = bitRead(canMsgRcvDevice.data[5], 0); // Indirect DSG reset
+  pushSTT = bitRead(canMsgRcvDevice.data[6], 7); // Start&Stop
+  pushCHECK = bitRead(canMsgRcvDevice.data[6], 0); // Check
+  stopCHECK = bitRead(canMsgRcvDevice.data[1], 7); // Stop Check
+  pushBLACK = bitRead(canMsgRcvDevice.data[5], 0); // Black Panel
+
+  if (Ignition) {
+    canMsgSndDevice.data[0] = 0x00;
+    bitWrite(canMsgSndDevice.data[0], 7, resetTrip1); // Reset Trip 1
+    bitWrite(canMsgSndDevice.data[0], 6, resetTrip2); // Reset Trip 2
+    canMsgSndDevice.data[1] = 0x10;
+    bitWrite(canMsgSndDevice.data[1], 5, darkMode); // Dark mode
+    canMsgSndDevice.data[2] = 0xFF;
+    canMsgSndDevice.data[3] = 0xFF;
+    canMsgSndDevice.data[4] = 0x7F;
+    canMsgSndDevice.data[5] = 0xFF;
+    canMsgSndDevice.data[6] = 0x00;
+    canMsgSndDevice.data[7] = 0x00;
+    canMsgSndDevice.can_id = 0x167; // Fake EMF Status frame
+    canMsgSndDevice.can_dlc = 8;
+    canSend(BUS_CAN0, & canMsgSndDevice);
+  }
 
-        tmpVal = (canMsgRcv.data[5] >> 1) - 40; // Temperatures can be negative but we only have 0 > 255, the new range is starting from -40°C
-        if (Temperature != tmpVal) {
-          Temperature = tmpVal;
+  if (!ClusterPresent && Ignition && (resetTrip1 || resetTrip2 || pushAAS || pushSAM || pushDSG || pushSTT || pushCHECK)) {
+    canMsgSndDevice.data[0] = statusCMB[0];
+    canMsgSndDevice.data[1] = statusCMB[1];
+    bitWrite(canMsgSndDevice.data[1], 4, pushCHECK);
+    bitWrite(canMsgSndDevice.data[1], 2, resetTrip1);
+    canMsgSndDevice.data[2] = statusCMB[2];
+    bitWrite(canMsgSndDevice.data[2], 7, pushAAS);
+    bitWrite(canMsgSndDevice.data[2], 6, pushASR);
+    canMsgSndDevice.data[3] = statusCMB[3];
+    bitWrite(canMsgSndDevice.data[3], 3, pushSAM);
+    bitWrite(canMsgSndDevice.data[3], 0, resetTrip2);
+    canMsgSndDevice.data[4] = statusCMB[4];
+    bitWrite(canMsgSndDevice.data[4], 7, pushDSG);
+    canMsgSndDevice.data[5] = statusCMB[5];
+    canMsgSndDevice.data[6] = statusCMB[6];
+    bitWrite(canMsgSndDevice.data[6], 7, pushSTT);
+    canMsgSndDevice.data[7] = statusCMB[7];
+    canMsgSndDevice.can_id = 0x217;
+    canMsgSndDevice.can_dlc = 8;
+    canSend(BUS_CAN0, & canMsgSndDevice);
+  }
+}
 
-          if (SerialEnabled) {
-            Serial.print("Ext. Temperature: ");
-            Serial.print(tmpVal);
-            Serial.println("°C");
-          }
-        }
+static void handleCAN1_329() {
+  pushASR = bitRead(canMsgRcvDevice.data[3], 0); // ESP
+}
 
-        CAN1.sendMessage( & canMsgRcv);
-      } else if (id == 0x168 && len == 8) { // Instrument Panel - WIP
-        canMsgSnd.data[0] = canMsgRcv.data[0]; // Alerts
-        canMsgSnd.data[1] = canMsgRcv.data[1];
-        canMsgSnd.data[2] = canMsgRcv.data[2];
-        canMsgSnd.data[3] = canMsgRcv.data[3];
-        canMsgSnd.data[4] = canMsgRcv.data[4];
-        canMsgSnd.data[5] = canMsgRcv.data[5];
-        bitWrite(canMsgSnd.data[6], 7, 0);
-        bitWrite(canMsgSnd.data[6], 6, 1); // Ambiance
-        bitWrite(canMsgSnd.data[6], 5, 1); // EMF availability
-        bitWrite(canMsgSnd.data[6], 4, bitRead(canMsgRcv.data[5], 0)); // Gearbox report while driving
-        bitWrite(canMsgSnd.data[6], 3, bitRead(canMsgRcv.data[6], 7)); // Gearbox report while driving
-        bitWrite(canMsgSnd.data[6], 2, bitRead(canMsgRcv.data[6], 6)); // Gearbox report while driving
-        bitWrite(canMsgSnd.data[6], 1, bitRead(canMsgRcv.data[6], 5)); // Gearbox report while driving
-        bitWrite(canMsgSnd.data[6], 0, 0);
-        canMsgSnd.data[7] = canMsgRcv.data[7];
-        canMsgSnd.can_id = 0x168;
-        canMsgSnd.can_dlc = 8;
-
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) { // Will generate some light issues on the instrument panel
-          CAN0.sendMessage( & canMsgSnd);
-        }
-      } else if (id == 0x120 && generatePOPups) { // Alerts journal / Diagnostic > Popup notifications - Work in progress
-        // C5 (X7) Cluster is connected to CAN High Speed, no notifications are sent on CAN Low Speed, let's rebuild alerts from the journal (slighly slower than original alerts)
-        // Bloc 1
-        if (bitRead(canMsgRcv.data[0], 7) == 0 && bitRead(canMsgRcv.data[0], 6) == 1) {
-          sendPOPup(bitRead(canMsgRcv.data[1], 7), 5, 1, 0x00); // Engine oil pressure fault: stop the vehicle (STOP)
-          sendPOPup(bitRead(canMsgRcv.data[1], 6), 1, 1, 0x00); // Engine temperature fault: stop the vehicle (STOP)
-          sendPOPup(bitRead(canMsgRcv.data[1], 5), 138, 6, 0x00); // Charging system fault: repair needed (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[1], 4), 106, 1, 0x00); // Braking system fault: stop the vehicle (STOP)
-          // bitRead(canMsgRcv.data[1], 3); // N/A
-          sendPOPup(bitRead(canMsgRcv.data[1], 2), 109, 2, 0x00); // Power steering fault: stop the vehicle (STOP)
-          sendPOPup(bitRead(canMsgRcv.data[1], 1), 3, 4, 0x00); // Top up coolant level (WARNING)
-          // bitRead(canMsgRcv.data[1], 0); // Fault with LKA (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[2], 7), 4, 4, 0x00); // Top up engine oil level (WARNING)
-          // bitRead(canMsgRcv.data[2], 6); // N/A
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[2], 5)); // Front right door
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[2], 4)); // Front left door
-          bitWrite(notificationParameters, 5, bitRead(canMsgRcv.data[2], 3)); // Rear right door
-          bitWrite(notificationParameters, 4, bitRead(canMsgRcv.data[2], 2)); // Rear left door
-          bitWrite(notificationParameters, 3, bitRead(canMsgRcv.data[2], 0)); // Boot open
-          // bitWrite(notificationParameters, 2, ?); // Hood open
-          bitWrite(notificationParameters, 1, bitRead(canMsgRcv.data[3], 7)); // Rear Screen open
-          // bitWrite(notificationParameters, 0, ?); // Fuel door open
-          sendPOPup((bitRead(canMsgRcv.data[2], 5) || bitRead(canMsgRcv.data[2], 4) || bitRead(canMsgRcv.data[2], 3) || bitRead(canMsgRcv.data[2], 2) || bitRead(canMsgRcv.data[2], 0) || bitRead(canMsgRcv.data[3], 7)), 8, 8, notificationParameters); // Left hand front door opened (WARNING) || Right hand front door opened (WARNING) || Left hand rear door opened (WARNING) || Right hand rear door opened (WARNING) || Boot open (WARNING) || Rear screen open (WARNING)
-          // bitRead(canMsgRcv.data[2], 1); // N/A
-          sendPOPup(bitRead(canMsgRcv.data[3], 6), 107, 2, 0x00); // ESP/ASR system fault, repair the vehicle (WARNING)
-          // bitRead(canMsgRcv.data[3], 5); // Battery charge fault, stop the vehicle (WARNING)
-          // bitRead(canMsgRcv.data[3], 4); // N/A
-          sendPOPup(bitRead(canMsgRcv.data[3], 3), 125, 6, 0x00); // Water in diesel fuel filter (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[3], 2), 103, 6, 0x00); // Have brake pads replaced (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[3], 1), 224, 10, 0x00); // Fuel level low (INFO)
-          sendPOPup(bitRead(canMsgRcv.data[3], 0), 120, 6, 0x00); // Airbag(s) or seatbelt(s) pretensioner fault(s) (WARNING)
-          // bitRead(canMsgRcv.data[4], 7); // N/A
-          // bitRead(canMsgRcv.data[4], 6); // Engine fault, repair the vehicle (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[4], 5), 106, 2, 0x00); // ABS braking system fault, repair the vehicle (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[4], 4), 15, 4, 0x00); // Particle filter is full, please drive 20min to clean it (WARNING)
-          // bitRead(canMsgRcv.data[4], 3); // N/A
-          sendPOPup(bitRead(canMsgRcv.data[4], 2), 129, 6, 0x00); // Particle filter additive level low (WARNING)
-          // bitRead(canMsgRcv.data[4], 1); // N/A
-          sendPOPup(bitRead(canMsgRcv.data[4], 0), 17, 4, 0x00); // Suspension fault, repair the vehicle (WARNING)
-          // bitRead(canMsgRcv.data[5], 7); // Preheating deactivated, battery charge too low (INFO)
-          // bitRead(canMsgRcv.data[5], 6); // Preheating deactivated, fuel level too low (INFO)
-          // bitRead(canMsgRcv.data[5], 5); // Check the centre brake lamp (WARNING)
-          // bitRead(canMsgRcv.data[5], 4); // Retractable roof mechanism fault (WARNING)
-          // sendPOPup(bitRead(canMsgRcv.data[5], 3), ?, 8, 0x00); // Steering lock fault, repair the vehicle (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[5], 2), 131, 6, 0x00); // Electronic immobiliser fault (WARNING)
-          // bitRead(canMsgRcv.data[5], 1); // N/A
-          // bitRead(canMsgRcv.data[5], 0); // Roof operation not possible, system temperature too high (WARNING)
-          // bitRead(canMsgRcv.data[6], 7); // Roof operation not possible, start the engine (WARNING)
-          // bitRead(canMsgRcv.data[6], 6); // Roof operation not possible, apply parking brake (WARNING)
-          // bitRead(canMsgRcv.data[6], 5); // Hybrid system fault (STOP)
-          // bitRead(canMsgRcv.data[6], 4); // Automatic headlamp adjustment fault (WARNING)
-          // bitRead(canMsgRcv.data[6], 3); // Hybrid system fault (WARNING)
-          // bitRead(canMsgRcv.data[6], 2); // Hybrid system fault: speed restricted (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[6], 1), 223, 10, 0x00); // Top Up screenwash fluid level (INFO)
-          sendPOPup(bitRead(canMsgRcv.data[6], 0), 227, 14, 0x00); // Replace remote control battery (INFO)
-          // bitRead(canMsgRcv.data[7], 7); // N/A
-          // bitRead(canMsgRcv.data[7], 6); // Preheating deactivated, set the clock (INFO)
-          // bitRead(canMsgRcv.data[7], 5); // Trailer connection fault (WARNING)
-          // bitRead(canMsgRcv.data[7], 4); // N/A
-          // bitRead(canMsgRcv.data[7], 3); // Tyre under-inflation (WARNING)
-          // bitRead(canMsgRcv.data[7], 2); // Driving aid camera limited visibility (INFO)
-          // bitRead(canMsgRcv.data[7], 1); // N/A
-          // bitRead(canMsgRcv.data[7], 0); // N/A
-        }
+// MATT status
+static void handleCAN1_31C() {
+  canMsgSndDevice.data[0] = canMsgRcvDevice.data[0];
+  // Rewrite if necessary to make BTEL commands working
+  if (resetTrip1) { // Reset Trip 1
+    bitWrite(canMsgSndDevice.data[0], 3, 1);
+  }
+  if (resetTrip2) { // Reset Trip 2
+    bitWrite(canMsgSndDevice.data[0], 2, 1);
+  }
+  canMsgSndDevice.data[1] = canMsgRcvDevice.data[1];
+  canMsgSndDevice.data[2] = canMsgRcvDevice.data[2];
+  canMsgSndDevice.data[3] = canMsgRcvDevice.data[3];
+  canMsgSndDevice.data[4] = canMsgRcvDevice.data[4];
+  canMsgSndDevice.can_id = 0x31C;
+  canMsgSndDevice.can_dlc = 5;
+  canSend(BUS_CAN0, & canMsgSndDevice);
+}
 
-        // Bloc 2
-        if (bitRead(canMsgRcv.data[0], 7) == 1 && bitRead(canMsgRcv.data[0], 6) == 0) {
-          // bitRead(canMsgRcv.data[1], 7); // N/A
-          // bitRead(canMsgRcv.data[1], 6); // Electric mode not available : Particle filter regenerating (INFO)
-          // bitRead(canMsgRcv.data[1], 5); // N/A
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[1], 4)); // Front left tyre
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[1], 3)); // Front right tyre
-          bitWrite(notificationParameters, 5, bitRead(canMsgRcv.data[1], 2)); // Rear right tyre
-          bitWrite(notificationParameters, 4, bitRead(canMsgRcv.data[1], 1)); // Rear left tyre
-          sendPOPup((bitRead(canMsgRcv.data[1], 4) || bitRead(canMsgRcv.data[1], 3) || bitRead(canMsgRcv.data[1], 2) || bitRead(canMsgRcv.data[1], 1)), 13, 6, notificationParameters); // Puncture: Replace or repair the wheel (STOP)
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[1], 0)); // Front right sidelamp
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[2], 7)); // Front left sidelamp
-          bitWrite(notificationParameters, 5, bitRead(canMsgRcv.data[2], 6)); // Rear right sidelamp
-          bitWrite(notificationParameters, 4, bitRead(canMsgRcv.data[2], 5)); // Rear left sidelamp
-          sendPOPup((bitRead(canMsgRcv.data[1], 0) || bitRead(canMsgRcv.data[2], 7) || bitRead(canMsgRcv.data[2], 6) || bitRead(canMsgRcv.data[2], 5)), 160, 6, notificationParameters); // Check sidelamps (WARNING)
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[2], 4)); // Right dipped beam headlamp
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[2], 3)); // Left dipped beam headlamp
-          sendPOPup((bitRead(canMsgRcv.data[2], 4) || bitRead(canMsgRcv.data[2], 3)), 154, 6, notificationParameters); // Check the dipped beam headlamps (WARNING)
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[2], 2)); // Right main beam headlamp
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[2], 1)); // Left main beam headlamp
-          sendPOPup((bitRead(canMsgRcv.data[2], 2) || bitRead(canMsgRcv.data[2], 1)), 155, 6, notificationParameters); // Check the main beam headlamps (WARNING)
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[2], 0)); // Right brake lamp
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[3], 7)); // Left brake lamp
-          sendPOPup((bitRead(canMsgRcv.data[2], 0) || bitRead(canMsgRcv.data[3], 7)), 156, 6, notificationParameters); // Check the RH brake lamp (WARNING) || Check the LH brake lamp (WARNING)
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[3], 6)); // Front right foglamp
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[3], 5)); // Front left foglamp
-          bitWrite(notificationParameters, 5, bitRead(canMsgRcv.data[3], 4)); // Rear right foglamp
-          bitWrite(notificationParameters, 4, bitRead(canMsgRcv.data[3], 3)); // Rear left foglamp
-          sendPOPup((bitRead(canMsgRcv.data[3], 6) || bitRead(canMsgRcv.data[3], 5) || bitRead(canMsgRcv.data[3], 4) || bitRead(canMsgRcv.data[3], 3)), 157, 6, notificationParameters); // Check the front foglamps (WARNING) || Check the front foglamps (WARNING) || Check the rear foglamps (WARNING) || Check the rear foglamps (WARNING)
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[3], 2)); // Front right direction indicator
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[3], 1)); // Front left direction indicator
-          bitWrite(notificationParameters, 5, bitRead(canMsgRcv.data[3], 0)); // Rear right direction indicator
-          bitWrite(notificationParameters, 4, bitRead(canMsgRcv.data[4], 7)); // Rear left direction indicator
-          sendPOPup((bitRead(canMsgRcv.data[3], 2) || bitRead(canMsgRcv.data[3], 1) || bitRead(canMsgRcv.data[3], 0) || bitRead(canMsgRcv.data[4], 7)), 159, 6, notificationParameters); // Check the direction indicators (WARNING)
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[4], 6)); // Right reversing lamp
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[4], 5)); // Left reversing lamp
-          sendPOPup((bitRead(canMsgRcv.data[4], 6) || bitRead(canMsgRcv.data[4], 5)), 159, 6, notificationParameters); // Check the reversing lamp(s) (WARNING)
-          // bitRead(canMsgRcv.data[4], 4); // N/A
-          // bitRead(canMsgRcv.data[4], 3); // N/A
-          // bitRead(canMsgRcv.data[4], 2); // N/A
-          // bitRead(canMsgRcv.data[4], 1); // N/A
-          // bitRead(canMsgRcv.data[4], 0); // N/A
-          // bitRead(canMsgRcv.data[5], 7); // N/A
-          // bitRead(canMsgRcv.data[5], 6); // N/A
-          // bitRead(canMsgRcv.data[5], 5); // N/A
-          sendPOPup(bitRead(canMsgRcv.data[5], 4), 136, 8, 0x00); // Parking assistance system fault (WARNING)
-          // bitRead(canMsgRcv.data[5], 3); // N/A
-          // bitRead(canMsgRcv.data[5], 2); // N/A
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[5], 1)); // Front left tyre
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[5], 0)); // Front right tyre
-          bitWrite(notificationParameters, 5, bitRead(canMsgRcv.data[6], 7)); // Rear right tyre
-          bitWrite(notificationParameters, 4, bitRead(canMsgRcv.data[6], 5)); // Rear left tyre
-          sendPOPup((bitRead(canMsgRcv.data[5], 1) || bitRead(canMsgRcv.data[5], 0) || bitRead(canMsgRcv.data[6], 7) || bitRead(canMsgRcv.data[6], 5)), 13, 8, notificationParameters); // Adjust tyre pressures (WARNING)
-          // bitRead(canMsgRcv.data[6], 5); // Switch off lighting (INFO)
-          // bitRead(canMsgRcv.data[6], 4); // N/A
-          sendPOPup((bitRead(canMsgRcv.data[6], 3) || bitRead(canMsgRcv.data[6], 1)), 190, 8, 0x00); // Emissions fault (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[6], 2), 192, 8, 0x00); // Emissions fault: Starting Prevented (WARNING)
-          // bitRead(canMsgRcv.data[6], 0); // N/A
-          // bitRead(canMsgRcv.data[7], 7); // N/A
-          // bitRead(canMsgRcv.data[7], 6); // N/A
-          sendPOPup(bitRead(canMsgRcv.data[7], 5), 215, 10, 0x00); // "P" (INFO)
-          sendPOPup(bitRead(canMsgRcv.data[7], 4), 216, 10, 0x00); // Ice warning (INFO)
-          bitWrite(statusOpenings, 7, bitRead(canMsgRcv.data[7], 3)); // Front right door
-          bitWrite(statusOpenings, 6, bitRead(canMsgRcv.data[7], 2)); // Front left door
-          bitWrite(statusOpenings, 5, bitRead(canMsgRcv.data[7], 1)); // Rear right door
-          bitWrite(statusOpenings, 4, bitRead(canMsgRcv.data[7], 0)); // Rear left door
-          sendPOPup((bitRead(canMsgRcv.data[7], 3) || bitRead(canMsgRcv.data[7], 2) || bitRead(canMsgRcv.data[7], 1) || bitRead(canMsgRcv.data[7], 0) || bitRead(statusOpenings, 3) || bitRead(statusOpenings, 1)), 222, 8, statusOpenings); // Front right door opened (INFO) || Front left door opened (INFO) || Rear right door opened (INFO) || Rear left door opened (INFO)
-        }
+// Rewrite Cluster status (CIROCCO for example) for tactile touch buttons (telematic) because it is not listened by BSI
+static void handleCAN1_217() {
+  ClusterPresent = true;
+
+  canMsgSndDevice.data[0] = canMsgRcvDevice.data[0];
+  canMsgSndDevice.data[1] = canMsgRcvDevice.data[1];
+  bitWrite(canMsgSndDevice.data[1], 4, pushCHECK);
+  bitWrite(canMsgSndDevice.data[1], 2, resetTrip1);
+  canMsgSndDevice.data[2] = canMsgRcvDevice.data[2];
+  bitWrite(canMsgSndDevice.data[2], 7, pushAAS);
+  bitWrite(canMsgSndDevice.data[2], 6, pushASR);
+  canMsgSndDevice.data[3] = canMsgRcvDevice.data[3];
+  bitWrite(canMsgSndDevice.data[3], 3, pushSAM);
+  bitWrite(canMsgSndDevice.data[3], 0, resetTrip2);
+  canMsgSndDevice.data[4] = canMsgRcvDevice.data[4];
+  bitWrite(canMsgSndDevice.data[4], 7, pushDSG);
+  canMsgSndDevice.data[5] = canMsgRcvDevice.data[5];
+  canMsgSndDevice.data[6] = canMsgRcvDevice.data[6];
+  bitWrite(canMsgSndDevice.data[6], 7, pushSTT);
+  canMsgSndDevice.data[7] = canMsgRcvDevice.data[7];
+  canMsgSndDevice.can_id = 0x217;
+  canMsgSndDevice.can_dlc = 8;
+  canSend(BUS_CAN0, & canMsgSndDevice);
+}
 
-        // Bloc 3
-        if (bitRead(canMsgRcv.data[0], 7) == 1 && bitRead(canMsgRcv.data[0], 6) == 1) {
-          bitWrite(statusOpenings, 3, bitRead(canMsgRcv.data[1], 7)); // Boot open
-          // bitWrite(statusOpenings, 2, ?); // Hood open
-          bitWrite(statusOpenings, 1, bitRead(canMsgRcv.data[1], 5)); // Rear Screen open
-          // bitWrite(statusOpenings, 0, ?); // Fuel door open
-          sendPOPup((bitRead(canMsgRcv.data[1], 7) || bitRead(canMsgRcv.data[1], 5) ||  bitRead(statusOpenings, 7) ||  bitRead(statusOpenings, 6) ||  bitRead(statusOpenings, 5) ||  bitRead(statusOpenings, 4)), 222, 8, statusOpenings); // Boot open (INFO) || Rear Screen open (INFO)
-          // bitRead(canMsgRcv.data[1], 6); // Collision detection risk system fault (INFO)
-          // bitRead(canMsgRcv.data[1], 4); // N/A
-          // bitRead(canMsgRcv.data[1], 3); // N/A
-          // bitRead(canMsgRcv.data[1], 2); // N/A
-          // bitRead(canMsgRcv.data[1], 1); // N/A
-          // bitRead(canMsgRcv.data[1], 0); // N/A
-          // bitRead(canMsgRcv.data[2], 7); // N/A
-          // bitRead(canMsgRcv.data[2], 6); // N/A
-          // bitRead(canMsgRcv.data[2], 5); // N/A
-          sendPOPup(bitRead(canMsgRcv.data[2], 4), 100, 6, 0x00); // Parking brake fault (WARNING)
-          // bitRead(canMsgRcv.data[2], 3); // Active spoiler fault: speed restricted (WARNING)
-          // bitRead(canMsgRcv.data[2], 2); // Automatic braking system fault (INFO)
-          // bitRead(canMsgRcv.data[2], 1); // Directional headlamps fault (WARNING)
-          // bitRead(canMsgRcv.data[2], 0); // N/A
-          // bitRead(canMsgRcv.data[3], 7); // N/A
-          // bitRead(canMsgRcv.data[3], 6); // N/A
-          // bitRead(canMsgRcv.data[3], 5); // N/A
-          // bitRead(canMsgRcv.data[3], 4); // N/A
-          // bitRead(canMsgRcv.data[3], 3); // N/A
-          if (isBVMP) {
-            sendPOPup(bitRead(canMsgRcv.data[3], 2), 122, 4, 0x00); // Gearbox fault (WARNING)
-          } else {
-            sendPOPup(bitRead(canMsgRcv.data[3], 2), 110, 4, 0x00); // Gearbox fault (WARNING)
-          }
-          // bitRead(canMsgRcv.data[3], 1); // N/A
-          // bitRead(canMsgRcv.data[3], 0); // N/A
-          // bitRead(canMsgRcv.data[4], 7); // N/A
-          // bitRead(canMsgRcv.data[4], 6); // N/A
-          // bitRead(canMsgRcv.data[4], 5); // N/A
-          // bitRead(canMsgRcv.data[4], 4); // N/A
-          // bitRead(canMsgRcv.data[4], 3); // N/A
-          // bitRead(canMsgRcv.data[4], 2); // Engine fault (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[4], 1), 17, 3, 0x00); // Suspension fault: limit your speed to 90km/h (WARNING)
-          // bitRead(canMsgRcv.data[4], 0); // N/A
-          // bitRead(canMsgRcv.data[5], 7); // N/A
-          // bitRead(canMsgRcv.data[5], 6); // N/A
-          // bitRead(canMsgRcv.data[5], 5); // N/A
-          // bitRead(canMsgRcv.data[5], 4); // N/A
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[5], 3)); // Front left tyre
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[5], 2)); // Front right tyre
-          bitWrite(notificationParameters, 5, bitRead(canMsgRcv.data[5], 1)); // Rear right tyre
-          bitWrite(notificationParameters, 4, bitRead(canMsgRcv.data[5], 0)); // Rear left tyre
-          sendPOPup((bitRead(canMsgRcv.data[5], 3) || bitRead(canMsgRcv.data[5], 2) || bitRead(canMsgRcv.data[5], 1) || bitRead(canMsgRcv.data[5], 0)), 229, 10, notificationParameters); // Sensor fault: Left hand front tyre pressure not monitored (INFO)
-          sendPOPup(bitRead(canMsgRcv.data[6], 7), 18, 4, 0x00); // Suspension fault: repair the vehicle (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[6], 6), 109, 4, 0x00); // Power steering fault: repair the vehicle (WARNING)
-          // bitRead(canMsgRcv.data[6], 5); // N/A
-          // bitRead(canMsgRcv.data[6], 4); // N/A
-          // bitRead(canMsgRcv.data[6], 3); // Inter-vehicle time measurement fault (WARNING)
-          // bitRead(canMsgRcv.data[6], 2); // Engine fault, stop the vehicle (STOP)
-          // bitRead(canMsgRcv.data[6], 1); // Fault with LKA (INFO)
-          // bitRead(canMsgRcv.data[6], 0); // Tyre under-inflation detection system fault (WARNING)
-          notificationParameters = 0x00;
-          bitWrite(notificationParameters, 7, bitRead(canMsgRcv.data[7], 7)); // Front left tyre
-          bitWrite(notificationParameters, 6, bitRead(canMsgRcv.data[7], 6)); // Front right tyre
-          bitWrite(notificationParameters, 5, bitRead(canMsgRcv.data[7], 5)); // Rear right tyre
-          //bitWrite(notificationParameters, 4, ?); // Rear left tyre
-          sendPOPup((bitRead(canMsgRcv.data[7], 7) || bitRead(canMsgRcv.data[7], 6) || bitRead(canMsgRcv.data[7], 5)), 183, 8, notificationParameters); // Underinflated wheel, ajust pressure and reset (INFO)
-          // bitRead(canMsgRcv.data[7], 4); // Spare wheel fitted: driving aids deactivated (INFO)
-          // bitRead(canMsgRcv.data[7], 3); // Automatic braking disabled (INFO)
-          sendPOPup(bitRead(canMsgRcv.data[7], 2), 188, 6, 0x00); // Refill AdBlue (WARNING)
-          sendPOPup(bitRead(canMsgRcv.data[7], 1), 187, 10, 0x00); // Refill AdBlue (INFO)
-          sendPOPup(bitRead(canMsgRcv.data[7], 0), 189, 4, 0x00); // Impossible engine start, refill AdBlue (WARNING)
-        }
+static void handleCAN1_15B() {
+  int tmpVal;
+  byte setting;
+  bool flag;
+
+  if (bitRead(canMsgRcvDevice.data[1], 2)) { // Parameters validity
+    tmpVal = canMsgRcvDevice.data[0];
+    if (tmpVal >= 128) {
+      setting = tmpVal;
+      gatewayPost(PATH_CAR, &languageAndUnitNum, &setting, sizeof(languageAndUnitNum));
+      persistWrite(PERSIST_LANGUAGE_UNIT, setting);
+
+      if (SerialEnabled) {
+        Serial.print("Telematic - Change Language and Unit (Number): ");
+        Serial.print(tmpVal);
+        Serial.println();
+      }
 
-        CAN1.sendMessage( & canMsgRcv); // Forward original frame
-      } else if (id == 0x221) { // Trip info
-        statusTRIP[0] = canMsgRcv.data[0];
-        statusTRIP[1] = canMsgRcv.data[1];
-        statusTRIP[2] = canMsgRcv.data[2];
-        statusTRIP[3] = canMsgRcv.data[3];
-        statusTRIP[4] = canMsgRcv.data[4];
-        statusTRIP[5] = canMsgRcv.data[5];
-        statusTRIP[6] = canMsgRcv.data[6];
-        statusTRIP[7] = canMsgRcv.data[7];
-        CAN1.sendMessage( & canMsgRcv); // Forward original frame
-
-        customTimeStamp = (long) hour() * (long) 3600 + minute() * 60 + second();
-        daysSinceYearStart = daysSinceYearStartFct();
-
-        canMsgSnd.data[0] = (((1 << 8) - 1) & (customTimeStamp >> (12)));
-        canMsgSnd.data[1] = (((1 << 8) - 1) & (customTimeStamp >> (4)));
-        canMsgSnd.data[2] = (((((1 << 4) - 1) & (customTimeStamp)) << 4)) + (((1 << 4) - 1) & (daysSinceYearStart >> (8)));
-        canMsgSnd.data[3] = (((1 << 8) - 1) & (daysSinceYearStart));
-        canMsgSnd.data[4] = 0x00;
-        canMsgSnd.data[5] = 0xC0;
-        canMsgSnd.data[6] = languageID;
-        canMsgSnd.can_id = 0x3F6; // Fake EMF Time frame
-        canMsgSnd.can_dlc = 7;
-
-        CAN0.sendMessage( & canMsgSnd);
-      } else if (id == 0x128 && len == 8) { // Instrument Panel
-        canMsgSnd.data[0] = canMsgRcv.data[4]; // Main driving lights
-        bitWrite(canMsgSnd.data[1], 7, bitRead(canMsgRcv.data[6], 7)); // Gearbox report
-        bitWrite(canMsgSnd.data[1], 6, bitRead(canMsgRcv.data[6], 6)); // Gearbox report
-        bitWrite(canMsgSnd.data[1], 5, bitRead(canMsgRcv.data[6], 5)); // Gearbox report
-        bitWrite(canMsgSnd.data[1], 4, bitRead(canMsgRcv.data[6], 4)); // Gearbox report
-        bitWrite(canMsgSnd.data[1], 3, bitRead(canMsgRcv.data[6], 3)); // Gearbox report while driving
-        bitWrite(canMsgSnd.data[1], 2, bitRead(canMsgRcv.data[6], 2)); // Gearbox report while driving
-        bitWrite(canMsgSnd.data[1], 1, bitRead(canMsgRcv.data[6], 1)); // Gearbox report while driving
-        bitWrite(canMsgSnd.data[1], 0, bitRead(canMsgRcv.data[6], 0)); // Gearbox report blinking
-        bitWrite(canMsgSnd.data[2], 7, bitRead(canMsgRcv.data[7], 7)); // Arrow blinking
-        bitWrite(canMsgSnd.data[2], 6, bitRead(canMsgRcv.data[7], 6)); // BVA mode
-        bitWrite(canMsgSnd.data[2], 5, bitRead(canMsgRcv.data[7], 5)); // BVA mode
-        bitWrite(canMsgSnd.data[2], 4, bitRead(canMsgRcv.data[7], 4)); // BVA mode
-        bitWrite(canMsgSnd.data[2], 3, bitRead(canMsgRcv.data[7], 3)); // Arrow type
-        bitWrite(canMsgSnd.data[2], 2, bitRead(canMsgRcv.data[7], 2)); // Arrow type
-        if (bitRead(canMsgRcv.data[7], 1) == 1 && bitRead(canMsgRcv.data[7], 0) == 0) { // BVMP to BVA
-          isBVMP = true;
-          bitWrite(canMsgSnd.data[2], 1, 0); // Gearbox type
-          bitWrite(canMsgSnd.data[2], 0, 0); // Gearbox type
-        } else {
-          bitWrite(canMsgSnd.data[2], 1, bitRead(canMsgRcv.data[7], 1)); // Gearbox type
-          bitWrite(canMsgSnd.data[2], 0, bitRead(canMsgRcv.data[7], 0)); // Gearbox type
-        }
-        bitWrite(canMsgSnd.data[3], 7, bitRead(canMsgRcv.data[1], 7)); // Service
-        bitWrite(canMsgSnd.data[3], 6, bitRead(canMsgRcv.data[1], 6)); // STOP
-        bitWrite(canMsgSnd.data[3], 5, bitRead(canMsgRcv.data[2], 5)); // Child security
-        bitWrite(canMsgSnd.data[3], 4, bitRead(canMsgRcv.data[0], 7)); // Passenger Airbag
-        bitWrite(canMsgSnd.data[3], 3, bitRead(canMsgRcv.data[3], 2)); // Foot on brake
-        bitWrite(canMsgSnd.data[3], 2, bitRead(canMsgRcv.data[3], 1)); // Foot on brake
-        bitWrite(canMsgSnd.data[3], 1, bitRead(canMsgRcv.data[0], 5)); // Parking brake
-        bitWrite(canMsgSnd.data[3], 0, 0); // Electric parking brake
-        bitWrite(canMsgSnd.data[4], 7, bitRead(canMsgRcv.data[0], 2)); // Diesel pre-heating
-        bitWrite(canMsgSnd.data[4], 6, bitRead(canMsgRcv.data[1], 4)); // Opening open
-        bitWrite(canMsgSnd.data[4], 5, bitRead(canMsgRcv.data[3], 4)); // Automatic parking
-        bitWrite(canMsgSnd.data[4], 4, bitRead(canMsgRcv.data[3], 3)); // Automatic parking blinking
-        bitWrite(canMsgSnd.data[4], 3, 0); // Automatic high beam
-        bitWrite(canMsgSnd.data[4], 2, bitRead(canMsgRcv.data[2], 4)); // ESP Disabled
-        bitWrite(canMsgSnd.data[4], 1, bitRead(canMsgRcv.data[2], 3)); // ESP active
-        bitWrite(canMsgSnd.data[4], 0, bitRead(canMsgRcv.data[2], 2)); // Active suspension
-        bitWrite(canMsgSnd.data[5], 7, bitRead(canMsgRcv.data[0], 4)); // Low fuel
-        bitWrite(canMsgSnd.data[5], 6, bitRead(canMsgRcv.data[0], 6)); // Driver seatbelt
-        bitWrite(canMsgSnd.data[5], 5, bitRead(canMsgRcv.data[3], 7)); // Driver seatbelt blinking
-        bitWrite(canMsgSnd.data[5], 4, bitRead(canMsgRcv.data[0], 1)); // Passenger seatbelt
-        bitWrite(canMsgSnd.data[5], 3, bitRead(canMsgRcv.data[3], 6)); // Passenger seatbelt Blinking
-        bitWrite(canMsgSnd.data[5], 2, 0); // SCR
-        bitWrite(canMsgSnd.data[5], 1, 0); // SCR
-        bitWrite(canMsgSnd.data[5], 0, bitRead(canMsgRcv.data[5], 6)); // Rear left seatbelt
-        bitWrite(canMsgSnd.data[6], 7, bitRead(canMsgRcv.data[5], 5)); // Rear seatbelt left blinking
-        bitWrite(canMsgSnd.data[6], 6, bitRead(canMsgRcv.data[5], 2)); // Rear right seatbelt
-        bitWrite(canMsgSnd.data[6], 5, bitRead(canMsgRcv.data[5], 1)); // Rear right seatbelt blinking
-        bitWrite(canMsgSnd.data[6], 4, bitRead(canMsgRcv.data[5], 4)); // Rear middle seatbelt
-        bitWrite(canMsgSnd.data[6], 3, bitRead(canMsgRcv.data[5], 3)); // Rear middle seatbelt blinking
-        bitWrite(canMsgSnd.data[6], 2, bitRead(canMsgRcv.data[5], 7)); // Instrument Panel ON
-        bitWrite(canMsgSnd.data[6], 1, bitRead(canMsgRcv.data[2], 1)); // Warnings
-        bitWrite(canMsgSnd.data[6], 0, 0); // Passenger protection
-        canMsgSnd.data[7] = 0x00;
-        canMsgSnd.can_id = 0x128;
-        canMsgSnd.can_dlc = 8;
-
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) { // Will generate some light issues on the instrument panel
-          CAN0.sendMessage( & canMsgSnd);
-        }
-      } else if (id == 0x3A7 && len == 8) { // Maintenance
-        canMsgSnd.data[0] = 0x40;
-        // Values are coded with WORD data type HIGH byte fisrt, LOW byte second
-        canMsgSnd.data[1] = canMsgRcv.data[5]; // Value x256 +
-        canMsgSnd.data[2] = canMsgRcv.data[6]; // Value x1 = Number of days till maintenance (FF FF if disabled)
-        canMsgSnd.data[3] = canMsgRcv.data[3]; // Value x256 * 20 +
-        canMsgSnd.data[4] = canMsgRcv.data[4]; // Value x20 = km left till maintenance
-        canMsgSnd.can_id = 0x3E7; // New maintenance frame ID
-        canMsgSnd.can_dlc = 5;
-
-        if (SerialEnabled && !MaintenanceDisplayed) {
-          uint16_t tmpVal = (canMsgRcv.data[3] << 8) | canMsgRcv.data[4];
-          // Not multiply to 20 to avoid overflow
-          Serial.print("Next maintenance in: ");
-          if (tmpVal != 0xFFFF) {
-            Serial.print(tmpVal);
-            Serial.println(" * 20 km");
-          }
-          tmpVal = (canMsgRcv.data[5] << 8) | canMsgRcv.data[6];
-          if (tmpVal != 0xFFFF) {
-            Serial.print(tmpVal);
-            Serial.println(" days");
-          }
-          MaintenanceDisplayed = true;
-        }
+      tmpVal = canMsgRcvDevice.data[1];
+      if (tmpVal >= 128) {
+        flag = true;
+        gatewayPost(PATH_CAR, &mpgMi, &flag, sizeof(mpgMi));
+        persistWrite(PERSIST_MPG_MI, 1);
 
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
-        }
-      } else if (id == 0x1A8 && len == 8) { // Cruise control
-        CAN1.sendMessage( & canMsgRcv);
-
-        canMsgSnd.data[0] = canMsgRcv.data[1];
-        canMsgSnd.data[1] = canMsgRcv.data[2];
-        canMsgSnd.data[2] = canMsgRcv.data[0];
-        canMsgSnd.data[3] = 0x80;
-        canMsgSnd.data[4] = 0x14;
-        canMsgSnd.data[5] = 0x7F;
-        canMsgSnd.data[6] = 0xFF;
-        canMsgSnd.data[7] = 0x98;
-        canMsgSnd.can_id = 0x228; // New cruise control frame ID
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
-        }
-      } else if (id == 0x2D7 && len == 5 && listenCAN2004Language) { // CAN2004 Matrix
-        tmpVal = canMsgRcv.data[0];
-        if (tmpVal > 32) {
-          kmL = true;
-          tmpVal = tmpVal - 32;
-        }
+        tmpVal = tmpVal - 128;
+      } else {
+        flag = false;
+        gatewayPost(PATH_CAR, &mpgMi, &flag, sizeof(mpgMi));
+        persistWrite(PERSIST_MPG_MI, 0);
+      }
 
-        if (tmpVal <= 32 && languageID_CAN2004 != tmpVal) {
-          languageID_CAN2004 = tmpVal;
-          eepromUpdate(1, languageID_CAN2004);
-
-          // Change language and unit on ID 608 for CAN2010 Telematic language change
-          languageAndUnitNum = (languageID_CAN2004 * 4) + 128;
-          if (kmL) {
-            languageAndUnitNum = languageAndUnitNum + 1;
-          }
-          eepromUpdate(0, languageAndUnitNum);
-
-          if (SerialEnabled) {
-            Serial.print("CAN2004 Matrix - Change Language: ");
-            Serial.print(tmpVal);
-            Serial.println();
-          }
-        } else {
-          Serial.print("CAN2004 Matrix - Unsupported language ID: ");
-          Serial.print(tmpVal);
-          Serial.println();
-        }
-      } else if (id == 0x361) { // Personalization menus availability
-        bitWrite(canMsgSnd.data[0], 7, 1); // Parameters availability
-        bitWrite(canMsgSnd.data[0], 6, bitRead(canMsgRcv.data[2], 3)); // Beam
-        bitWrite(canMsgSnd.data[0], 5, 0); // Lighting
-        bitWrite(canMsgSnd.data[0], 4, bitRead(canMsgRcv.data[3], 7)); // Adaptative lighting
-        bitWrite(canMsgSnd.data[0], 3, bitRead(canMsgRcv.data[4], 1)); // SAM
-        bitWrite(canMsgSnd.data[0], 2, bitRead(canMsgRcv.data[4], 2)); // Ambiance lighting
-        bitWrite(canMsgSnd.data[0], 1, bitRead(canMsgRcv.data[2], 0)); // Automatic headlights
-        bitWrite(canMsgSnd.data[0], 0, bitRead(canMsgRcv.data[3], 6)); // Daytime running lights
-        bitWrite(canMsgSnd.data[1], 7, bitRead(canMsgRcv.data[5], 5)); // AAS
-        bitWrite(canMsgSnd.data[1], 6, bitRead(canMsgRcv.data[3], 5)); // Wiper in reverse
-        bitWrite(canMsgSnd.data[1], 5, bitRead(canMsgRcv.data[2], 4)); // Guide-me home lighting
-        bitWrite(canMsgSnd.data[1], 4, bitRead(canMsgRcv.data[1], 2)); // Driver welcome
-        bitWrite(canMsgSnd.data[1], 3, bitRead(canMsgRcv.data[2], 6)); // Motorized tailgate
-        bitWrite(canMsgSnd.data[1], 2, bitRead(canMsgRcv.data[2], 0)); // Selective openings - Rear
-        bitWrite(canMsgSnd.data[1], 1, bitRead(canMsgRcv.data[2], 7)); // Selective openings - Key
-        bitWrite(canMsgSnd.data[1], 0, 0); // Selective openings
-        bitWrite(canMsgSnd.data[2], 7, 1); // TNB - Seatbelt indicator
-        bitWrite(canMsgSnd.data[2], 6, 1); // XVV - Custom cruise limits
-        bitWrite(canMsgSnd.data[2], 5, bitRead(canMsgRcv.data[1], 4)); // Configurable button
-        bitWrite(canMsgSnd.data[2], 4, bitRead(canMsgRcv.data[2], 2)); // Automatic parking brake
-        bitWrite(canMsgSnd.data[2], 3, 0); // Sound Harmony
-        bitWrite(canMsgSnd.data[2], 2, 0); // Rear mirror index
-        bitWrite(canMsgSnd.data[2], 1, 0);
-        bitWrite(canMsgSnd.data[2], 0, 0);
-        bitWrite(canMsgSnd.data[3], 7, 1); // DSG Reset
-        bitWrite(canMsgSnd.data[3], 6, 0); // Front Collision Warning
-        bitWrite(canMsgSnd.data[3], 5, 0);
-        bitWrite(canMsgSnd.data[3], 4, 1); // XVV - Custom cruise limits Menu
-        bitWrite(canMsgSnd.data[3], 3, 1); // Recommended speed indicator
-        bitWrite(canMsgSnd.data[3], 2, bitRead(canMsgRcv.data[5], 6)); // DSG - Underinflating (3b)
-        bitWrite(canMsgSnd.data[3], 1, bitRead(canMsgRcv.data[5], 5)); // DSG - Underinflating (3b)
-        bitWrite(canMsgSnd.data[3], 0, bitRead(canMsgRcv.data[5], 4)); // DSG - Underinflating (3b)
-        canMsgSnd.data[4] = 0x00;
-        canMsgSnd.data[5] = 0x00;
-        canMsgSnd.data[6] = 0x00;
-        bitWrite(canMsgSnd.data[6], 5, 1); // Privacy mode
-        canMsgSnd.data[7] = 0x00;
-        canMsgSnd.can_id = 0x361;
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
-        }
-      } else if (id == 0x260 && len == 8) { // Personalization settings status
-        // Do not forward original message, it has been completely redesigned on CAN2010
-        // Also forge missing messages from CAN2004
-
-        if (canMsgRcv.data[0] == 0x01) { // User profile 1
-          canMsgSnd.data[0] = languageAndUnitNum;
-          bitWrite(canMsgSnd.data[1], 7, (mpgMi)?1:0);
-          bitWrite(canMsgSnd.data[1], 6, (TemperatureInF)?1:0);
-          bitWrite(canMsgSnd.data[1], 5, 0); // Ambiance level
-          bitWrite(canMsgSnd.data[1], 4, 1); // Ambiance level
-          bitWrite(canMsgSnd.data[1], 3, 1); // Ambiance level
-          bitWrite(canMsgSnd.data[1], 2, 1); // Parameters availability
-          bitWrite(canMsgSnd.data[1], 1, 0); // Sound Harmony
-          bitWrite(canMsgSnd.data[1], 0, 0); // Sound Harmony
-          bitWrite(canMsgSnd.data[2], 7, bitRead(canMsgRcv.data[1], 0)); // Automatic parking brake
-          bitWrite(canMsgSnd.data[2], 6, bitRead(canMsgRcv.data[1], 7)); // Selective openings - Key
-          bitWrite(canMsgSnd.data[2], 5, bitRead(canMsgRcv.data[1], 4)); // Selective openings
-          bitWrite(canMsgSnd.data[2], 4, bitRead(canMsgRcv.data[1], 5)); // Selective openings - Rear
-          bitWrite(canMsgSnd.data[2], 3, bitRead(canMsgRcv.data[1], 1)); // Driver Welcome
-          bitWrite(canMsgSnd.data[2], 2, bitRead(canMsgRcv.data[2], 7)); // Adaptative lighting
-          bitWrite(canMsgSnd.data[2], 1, bitRead(canMsgRcv.data[3], 6)); // Daytime running lights
-          bitWrite(canMsgSnd.data[2], 0, bitRead(canMsgRcv.data[3], 7)); // Ambiance lighting
-          bitWrite(canMsgSnd.data[3], 7, bitRead(canMsgRcv.data[2], 5)); // Guide-me home lighting
-          bitWrite(canMsgSnd.data[3], 6, bitRead(canMsgRcv.data[2], 1)); // Duration Guide-me home lighting (2b)
-          bitWrite(canMsgSnd.data[3], 5, bitRead(canMsgRcv.data[2], 0)); // Duration Guide-me home lighting (2b)
-          bitWrite(canMsgSnd.data[3], 4, bitRead(canMsgRcv.data[2], 6)); // Beam
-          bitWrite(canMsgSnd.data[3], 3, 0); // Lighting ?
-          bitWrite(canMsgSnd.data[3], 2, 0); // Duration Lighting (2b) ?
-          bitWrite(canMsgSnd.data[3], 1, 0); // Duration Lighting (2b) ?
-          bitWrite(canMsgSnd.data[3], 0, bitRead(canMsgRcv.data[2], 4)); // Automatic headlights
-          bitWrite(canMsgSnd.data[4], 7, bitRead(canMsgRcv.data[5], 6)); // AAS
-          bitWrite(canMsgSnd.data[4], 6, bitRead(canMsgRcv.data[6], 5)); // SAM
-          bitWrite(canMsgSnd.data[4], 5, bitRead(canMsgRcv.data[5], 4)); // Wiper in reverse
-          bitWrite(canMsgSnd.data[4], 4, 0); // Motorized tailgate
-          bitWrite(canMsgSnd.data[4], 3, bitRead(canMsgRcv.data[7], 7)); // Configurable button
-          bitWrite(canMsgSnd.data[4], 2, bitRead(canMsgRcv.data[7], 6)); // Configurable button
-          bitWrite(canMsgSnd.data[4], 1, bitRead(canMsgRcv.data[7], 5)); // Configurable button
-          bitWrite(canMsgSnd.data[4], 0, bitRead(canMsgRcv.data[7], 4)); // Configurable button
-
-          personalizationSettings[7] = canMsgSnd.data[1];
-          personalizationSettings[8] = canMsgSnd.data[2];
-          personalizationSettings[9] = canMsgSnd.data[3];
-          personalizationSettings[10] = canMsgSnd.data[4];
-        } else { // Cached information if any other profile
-          canMsgSnd.data[0] = languageAndUnitNum;
-          canMsgSnd.data[1] = personalizationSettings[7];
-          canMsgSnd.data[2] = personalizationSettings[8];
-          canMsgSnd.data[3] = personalizationSettings[9];
-          canMsgSnd.data[4] = personalizationSettings[10];
-        }
-        canMsgSnd.data[5] = 0x00;
-        canMsgSnd.data[6] = 0x00;
-        canMsgSnd.can_id = 0x260;
-        canMsgSnd.can_dlc = 7;
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
-        }
+      if (tmpVal >= 64) {
+        flag = true;
+        gatewayPost(PATH_CAR, &TemperatureInF, &flag, sizeof(TemperatureInF));
+        persistWrite(PERSIST_TEMPERATURE_F, 1);
 
-        bitWrite(canMsgSnd.data[0], 7, 0);
-        bitWrite(canMsgSnd.data[0], 6, 0);
-        bitWrite(canMsgSnd.data[0], 5, 0);
-        bitWrite(canMsgSnd.data[0], 4, 0);
-        bitWrite(canMsgSnd.data[0], 3, 0);
-        bitWrite(canMsgSnd.data[0], 2, 1); // Parameters validity
-        bitWrite(canMsgSnd.data[0], 1, 0); // User profile
-        bitWrite(canMsgSnd.data[0], 0, 1); // User profile = 1
-        canMsgSnd.data[1] = personalizationSettings[0];
-        canMsgSnd.data[2] = personalizationSettings[1];
-        canMsgSnd.data[3] = personalizationSettings[2];
-        canMsgSnd.data[4] = personalizationSettings[3];
-        canMsgSnd.data[5] = personalizationSettings[4];
-        canMsgSnd.data[6] = personalizationSettings[5];
-        canMsgSnd.data[7] = personalizationSettings[6];
-        canMsgSnd.can_id = 0x15B; // Personalization frame status
-        canMsgSnd.can_dlc = 8;
-        CAN0.sendMessage( & canMsgSnd);
-
-        if (!TelematicPresent && Ignition) {
-          canMsgSnd.data[0] = 0x00;
-          canMsgSnd.data[1] = 0x10;
-          canMsgSnd.data[2] = 0xFF;
-          canMsgSnd.data[3] = 0xFF;
-          canMsgSnd.data[4] = 0x7F;
-          canMsgSnd.data[5] = 0xFF;
-          canMsgSnd.data[6] = 0x00;
-          canMsgSnd.data[7] = 0x00;
-          canMsgSnd.can_id = 0x167; // Fake EMF status frame
-          canMsgSnd.can_dlc = 8;
-          CAN0.sendMessage( & canMsgSnd);
+        if (SerialEnabled) {
+          Serial.print("Telematic - Change Temperature Type: Fahrenheit");
+          Serial.println();
         }
+      } else if (tmpVal >= 0) {
+        flag = false;
+        gatewayPost(PATH_CAR, &TemperatureInF, &flag, sizeof(TemperatureInF));
+        persistWrite(PERSIST_TEMPERATURE_F, 0);
 
-        // Economy mode simulation
-        if (EconomyMode && EconomyModeEnabled) {
-          canMsgSnd.data[0] = 0x14;
-          if (Ignition) {
-            canMsgSnd.data[5] = 0x0E;
-          } else {
-            canMsgSnd.data[5] = 0x0C;
-          }
-        } else {
-          if (EngineRunning) {
-            canMsgSnd.data[0] = 0x54;
-          } else {
-            canMsgSnd.data[0] = 0x04;
-          }
-          canMsgSnd.data[5] = 0x0F;
-        }
-        canMsgSnd.data[1] = 0x03;
-        canMsgSnd.data[2] = 0xDE;
-
-        canMsgSnd.data[3] = 0x00; // Increasing value,
-        canMsgSnd.data[4] = 0x00; // counter ?
-
-        canMsgSnd.data[6] = 0xFE;
-        canMsgSnd.data[7] = 0x00;
-        canMsgSnd.can_id = 0x236;
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
+        if (SerialEnabled) {
+          Serial.print("Telematic - Change Temperature Type: Celcius");
+          Serial.println();
         }
+      }
+    } else {
+      tmpVal = tmpVal >> 2;
+      if (canMsgRcvDevice.data[1] >= 128) {
+        tmpVal--;
+      }
+      setting = tmpVal;
+      gatewayPost(PATH_CAR, &languageID, &setting, sizeof(languageID));
 
-        // Current Time
-        // If time is synced
-        if (timeStatus() != timeNotSet) {
-          canMsgSnd.data[0] = (year() - 1872); // Year would not fit inside one byte (0 > 255), substract 1872 and you get this new range (1872 > 2127)
-          canMsgSnd.data[1] = month();
-          canMsgSnd.data[2] = day();
-          canMsgSnd.data[3] = hour();
-          canMsgSnd.data[4] = minute();
-          canMsgSnd.data[5] = 0x3F;
-          canMsgSnd.data[6] = 0xFE;
-        } else {
-          canMsgSnd.data[0] = (Time_year - 1872); // Year would not fit inside one byte (0 > 255), substract 1872 and you get this new range (1872 > 2127)
-          canMsgSnd.data[1] = Time_month;
-          canMsgSnd.data[2] = Time_day;
-          canMsgSnd.data[3] = Time_hour;
-          canMsgSnd.data[4] = Time_minute;
-          canMsgSnd.data[5] = 0x3F;
-          canMsgSnd.data[6] = 0xFE;
-        }
-        canMsgSnd.can_id = 0x276;
-        canMsgSnd.can_dlc = 7;
-        CAN1.sendMessage( & canMsgSnd);
-        if (Send_CAN2010_ForgedMessages) {
-          CAN0.sendMessage( & canMsgSnd);
-        }
+      // CAN2004 Head-up panel is only one-way talking, we can't change the language on it from the CAN2010 Telematic :-(
 
-        if (!EngineRunning) {
-          AirConditioningON = false;
-          FanSpeed = 0x41;
-          LeftTemp = 0x00;
-          RightTemp = 0x00;
-          FanPosition = 0x04;
-
-          canMsgSnd.data[0] = 0x09;
-          canMsgSnd.data[1] = 0x00;
-          canMsgSnd.data[2] = 0x00;
-          canMsgSnd.data[3] = LeftTemp;
-          canMsgSnd.data[4] = RightTemp;
-          canMsgSnd.data[5] = FanSpeed;
-          canMsgSnd.data[6] = FanPosition;
-          canMsgSnd.data[7] = 0x00;
-          canMsgSnd.can_id = 0x350;
-          canMsgSnd.can_dlc = 8;
-          CAN1.sendMessage( & canMsgSnd);
-          if (Send_CAN2010_ForgedMessages) {
-            CAN0.sendMessage( & canMsgSnd);
-          }
-        }
-      } else if (id == 0x321 && len < 5)  { // Intercept 0x321 and reconstruct it with 5 bytes DrumVlado
-        canMsgSnd.can_id = 0x321;  // Set CAN ID to 0x321
-        canMsgSnd.can_dlc = 5;     // Set length to 5 bytes
-        for (int i = 0; i < 4; i++) {
-          canMsgSnd.data[i] = canMsgRcv.data[i];  // Copy the first 4 bytes from the received message
-        }
-        canMsgSnd.data[4] = 0x00;  // Add the missing byte
-        CAN1.sendMessage(&canMsgSnd);
-      } else {
-        CAN1.sendMessage( & canMsgRcv);
+      if (SerialEnabled) {
+        Serial.print("Telematic - Change Language (ID): ");
+        Serial.print(tmpVal);
+        Serial.println();
       }
-    } else {
-      CAN1.sendMessage( & canMsgRcv);
+    }
+
+    // Personalization settings change
+    bitWrite(canMsgSndDevice.data[0], 7, 0);
+    bitWrite(canMsgSndDevice.data[0], 6, 0);
+    bitWrite(canMsgSndDevice.data[0], 5, 0);
+    bitWrite(canMsgSndDevice.data[0], 4, 0);
+    bitWrite(canMsgSndDevice.data[0], 3, 0);
+    bitWrite(canMsgSndDevice.data[0], 2, 0); // Parameters validity, 0 = Changed parameter(s) the BSI must take into account
+    bitWrite(canMsgSndDevice.data[0], 1, 0); // User profile
+    bitWrite(canMsgSndDevice.data[0], 0, 1); // User profile = 1
+    bitWrite(canMsgSndDevice.data[1], 7, bitRead(canMsgRcvDevice.data[2], 6)); // Selective openings
+    bitWrite(canMsgSndDevice.data[1], 6, 1);
+    bitWrite(canMsgSndDevice.data[1], 5, bitRead(canMsgRcvDevice.data[2], 4)); // Selective rear openings
+    bitWrite(canMsgSndDevice.data[1], 4, bitRead(canMsgRcvDevice.data[2], 5)); // Selective openings
+    bitWrite(canMsgSndDevice.data[1], 3, 0);
+    bitWrite(canMsgSndDevice.data[1], 2, 0);
+    bitWrite(canMsgSndDevice.data[1], 1, bitRead(canMsgRcvDevice.data[2], 3)); // Driver welcome
+    bitWrite(canMsgSndDevice.data[1], 0, bitRead(canMsgRcvDevice.data[2], 7)); // Parking brake
+    bitWrite(canMsgSndDevice.data[2], 7, bitRead(canMsgRcvDevice.data[2], 2)); // Adaptative lighting
+    bitWrite(canMsgSndDevice.data[2], 6, bitRead(canMsgRcvDevice.data[3], 4)); // Beam
+    bitWrite(canMsgSndDevice.data[2], 5, bitRead(canMsgRcvDevice.data[3], 7)); // Guide-me home lighting
+    bitWrite(canMsgSndDevice.data[2], 4, bitRead(canMsgRcvDevice.data[3], 0)); // Automatic headlights
+    bitWrite(canMsgSndDevice.data[2], 3, 0);
+    bitWrite(canMsgSndDevice.data[2], 2, 0);
+    bitWrite(canMsgSndDevice.data[2], 1, bitRead(canMsgRcvDevice.data[3], 6)); // Duration Guide-me home lighting (2b)
+    bitWrite(canMsgSndDevice.data[2], 0, bitRead(canMsgRcvDevice.data[3], 5)); // Duration Guide-me home lighting (2b)
+    bitWrite(canMsgSndDevice.data[3], 7, bitRead(canMsgRcvDevice.data[2], 0)); // Ambiance lighting
+    bitWrite(canMsgSndDevice.data[3], 6, bitRead(canMsgRcvDevice.data[2], 1)); // Daytime running lights
+    bitWrite(canMsgSndDevice.data[3], 5, 0);
+    bitWrite(canMsgSndDevice.data[3], 4, 0);
+    bitWrite(canMsgSndDevice.data[3], 3, 0);
+    bitWrite(canMsgSndDevice.data[3], 2, 0);
+    bitWrite(canMsgSndDevice.data[3], 1, 0);
+    bitWrite(canMsgSndDevice.data[3], 0, 0);
+    canMsgSndDevice.data[4] = 0x00;
+    bitWrite(canMsgSndDevice.data[5], 7, bitRead(canMsgRcvDevice.data[4], 7)); // AAS
+    bitWrite(canMsgSndDevice.data[5], 6, bitRead(canMsgRcvDevice.data[4], 7)); // AAS
+    bitWrite(canMsgSndDevice.data[5], 5, 0);
+    bitWrite(canMsgSndDevice.data[5], 4, bitRead(canMsgRcvDevice.data[4], 5)); // Wiper in reverse
+    bitWrite(canMsgSndDevice.data[5], 3, 0);
+    bitWrite(canMsgSndDevice.data[5], 2, 0);
+    bitWrite(canMsgSndDevice.data[5], 1, 0);
+    bitWrite(canMsgSndDevice.data[5], 0, 0);
+    bitWrite(canMsgSndDevice.data[6], 7, 0);
+    bitWrite(canMsgSndDevice.data[6], 6, bitRead(canMsgRcvDevice.data[4], 6)); // SAM
+    bitWrite(canMsgSndDevice.data[6], 5, bitRead(canMsgRcvDevice.data[4], 6)); // SAM
+    bitWrite(canMsgSndDevice.data[6], 4, 0);
+    bitWrite(canMsgSndDevice.data[6], 3, 0);
+    bitWrite(canMsgSndDevice.data[6], 2, 0);
+    bitWrite(canMsgSndDevice.data[6], 1, 0);
+    bitWrite(canMsgSndDevice.data[6], 0, 0);
+    bitWrite(canMsgSndDevice.data[7], 7, bitRead(canMsgRcvDevice.data[4], 3)); // Configurable button
+    bitWrite(canMsgSndDevice.data[7], 6, bitRead(canMsgRcvDevice.data[4], 2)); // Configurable button
+    bitWrite(canMsgSndDevice.data[7], 5, bitRead(canMsgRcvDevice.data[4], 1)); // Configurable button
+    bitWrite(canMsgSndDevice.data[7], 4, bitRead(canMsgRcvDevice.data[4], 0)); // Configurable button
+    bitWrite(canMsgSndDevice.data[7], 3, 0);
+    bitWrite(canMsgSndDevice.data[7], 2, 0);
+    bitWrite(canMsgSndDevice.data[7], 1, 0);
+    bitWrite(canMsgSndDevice.data[7], 0, 0);
+    canMsgSndDevice.can_id = 0x15B;
+    canMsgSndDevice.can_dlc = 8;
+    canSend(BUS_CAN0, & canMsgSndDevice);
+
+    // Store personalization settings for the recurring frame
+    gatewayPost(PATH_CAR, personalizationSettings, & canMsgSndDevice.data[1], 7);
+    for (int i = 0; i < 7; i++) {
+      persistWrite(PERSIST_PERSONALIZATION + i, canMsgSndDevice.data[i + 1]);
     }
   }
+}
+
+// Telematic suggested speed to fake CVM frame (0x268, sent by the scheduler)
+static void handleCAN1_1E9() {
+  byte poiType;
+  bool changed;
 
-  // Forward messages from the CAN2010 device(s) to the car
-  if (CAN1.readMessage( & canMsgRcv) == MCP2515::ERROR_OK) {
-    int id = canMsgRcv.can_id;
-    int len = canMsgRcv.can_dlc;
+  canSend(BUS_CAN0, & canMsgRcvDevice);
 
-    if (debugCAN1) {
+  poiType = (canMsgRcvDevice.data[3] >> 2); // POI type - Gen2 (6b)
+
+  changed = (cvmSpeedLimit != canMsgRcvDevice.data[1] || cvmPoiType != poiType || lastCvmMillis == 0);
+  cvmSpeedThreshold = canMsgRcvDevice.data[0];
+  cvmSpeedLimit = canMsgRcvDevice.data[1];
+  cvmPoiType = poiType;
+  lastCvmMillis = millis();
+
+  if (changed) {
+    schedulerKick(BUS_CAN1, 0x268);
+  }
+}
+
+// ============================================================================
+// FRAMES GENERATED BY THE ADAPTER, sent by the scheduler (see scheduler.h)
+// ============================================================================
+
+// Fake EMF version, once each time CAN0 enters normal mode (bus-up handler, see can_bus.h):
+// a frame sent before the controller is up would be dropped, one loaded before a recovery is lost
+void sendEmfVersion(byte bus) {
+  if (bus != BUS_CAN0) {
+    return;
+  }
+
+  struct can_frame frame;
+  frame.data[0] = 0x25;
+  frame.data[1] = 0x0A;
+  frame.data[2] = 0x0B;
+  frame.data[3] = 0x04;
+  frame.data[4] = 0x0C;
+  frame.data[5] = 0x01;
+  frame.data[6] = 0x20;
+  frame.data[7] = 0x11;
+  frame.can_id = 0x5E5;
+  frame.can_dlc = 8;
+  canSend(BUS_CAN0, & frame);
+}
+
+// Fake EMF time frame
+static bool buildFrame_3F6(struct can_frame* frame) {
+  tmElements_t tm;
+  unsigned long customTimeStamp;
+  int daysSinceYearStart;
+
+  if (!schedulerBusAwake(BUS_CAN0)) {
+    return false;
+  }
+
+  clockRead(tm);
+  customTimeStamp = (long) tm.Hour * (long) 3600 + tm.Minute * 60 + tm.Second;
+  daysSinceYearStart = daysSinceYearStartFct(tmYearToCalendar(tm.Year), tm.Month, tm.Day);
+
+  frame->data[0] = (((1 << 8) - 1) & (customTimeStamp >> (12)));
+  frame->data[1] = (((1 << 8) - 1) & (customTimeStamp >> (4)));
+  frame->data[2] = (((((1 << 4) - 1) & (customTimeStamp)) << 4)) + (((1 << 4) - 1) & (daysSinceYearStart >> (8)));
+  frame->data[3] = (((1 << 8) - 1) & (daysSinceYearStart));
+  frame->data[4] = 0x00;
+  frame->data[5] = 0xC0;
+  frame->data[6] = languageID;
+  frame->can_dlc = 7;
+  return true;
+}
+
+// Hour on CAN-BUS Clock
+static bool buildFrame_228(struct can_frame* frame) {
+  tmElements_t tm;
+
+  if (!schedulerBusAwake(BUS_CAN0)) {
+    return false;
+  }
+
+  clockRead(tm);
+  frame->data[0] = tm.Hour;
+  frame->data[1] = tm.Minute;
+  frame->can_dlc = 2;
+  return true;
+}
+
+// CVM frame, from the last Telematic suggested speed (0x1E9)
+static bool buildFrame_268(struct can_frame* frame) {
+  if (lastCvmMillis == 0 || millis() - lastCvmMillis >= SCHEDULER_BUS_TIMEOUT_MS) {
+    return false;
+  }
+
+  frame->data[0] = cvmSpeedLimit;
+  frame->data[1] = ((cvmPoiType > 0 && vehicleSpeed > cvmSpeedThreshold) ? 0x30 : 0x10); // POI Over-speed, make speed limit blink
+  frame->data[2] = 0x00;
+  frame->data[3] = 0x00;
+  frame->data[4] = 0x7C;
+  frame->data[5] = 0xF8;
+  frame->data[6] = 0x00;
+  frame->data[7] = 0x00;
+  frame->can_dlc = 8;
+  return true;
+}
+
+// Process one frame received from the CAN2010 device(s) (CAN1 → CAN0), held in canMsgRcvDevice
+void processCAN1Frame() {
+  LATENCY_SCOPE(BUS_CAN1);
+  BOOT_TIMING_SCOPE(BUS_CAN1, canMsgRcvDevice);
+
+  // A frame this adapter sent on CAN0 coming back through another bridge
+  if (echoSuppress(BUS_CAN1, & canMsgRcvDevice)) {
+    return;
+  }
+
+  int id = canMsgRcvDevice.can_id;
+  int len = canMsgRcvDevice.can_dlc;
+
+  if (settings.debugCAN1) {
+    if (settings.debugBinaryCapture) {
+      captureFrame(BUS_CAN1, & canMsgRcvDevice, false);
+    } else {
       Serial.print("FRAME:ID=");
       Serial.print(id);
       Serial.print(":LEN=");
@@ -1625,364 +1677,255 @@ void loop() {
       for (int i = 0; i < len; i++) {
         Serial.print(":");
 
-        snprintf(tmp, (size_t)3, "%02X", canMsgRcv.data[i]);
+        snprintf(tmp, (size_t)3, "%02X", canMsgRcvDevice.data[i]);
 
         Serial.print(tmp);
       }
 
       Serial.println();
+    }
 
-      CAN0.sendMessage( & canMsgRcv);
-    } else if (!debugCAN0) {
-      if (id == 0x260 || id == 0x361) {
-        // Do not send back converted frames between networks
-      } else if (id == 0x39B && len == 5) {
-        Time_year = canMsgRcv.data[0] + 1872; // Year would not fit inside one byte (0 > 255), add 1872 and you get this new range (1872 > 2127)
-        Time_month = canMsgRcv.data[1];
-        Time_day = canMsgRcv.data[2];
-        Time_hour = canMsgRcv.data[3];
-        Time_minute = canMsgRcv.data[4];
-
-        setTime(Time_hour, Time_minute, 0, Time_day, Time_month, Time_year);
-        RTC.set(now()); // Set the time on the RTC module too
-        eepromUpdate(5, Time_day);
-        eepromUpdate(6, Time_month);
-        EEPROM.put(7, Time_year);
-
-        // Set hour on CAN-BUS Clock
-        canMsgSnd.data[0] = hour();
-        canMsgSnd.data[1] = minute();
-        canMsgSnd.can_id = 0x228;
-        canMsgSnd.can_dlc = 1;
-        CAN0.sendMessage( & canMsgSnd);
+    canSend(BUS_CAN0, & canMsgRcvDevice);
+  } else if (!settings.debugCAN0) {
+    CanFrameHandler handler = canDispatchLookup(BUS_CAN1, & canMsgRcvDevice);
+    if (handler != NULL) {
+      handler();
+    } else {
+      canSend(BUS_CAN0, & canMsgRcvDevice); // No handler for this ID: forward unchanged
+    }
+  } else {
+    canSend(BUS_CAN0, & canMsgRcvDevice);
+  }
+}
 
-        if (SerialEnabled) {
-          Serial.print("Change Hour/Date: ");
-          Serial.print(day());
-          Serial.print("/");
-          Serial.print(month());
-          Serial.print("/");
-          Serial.print(year());
+// Analog MENU button: FMUX MENU (0x122)
+static void analogMenuEvent(const ButtonAction& action, ButtonEvent event) {
+  if (event != BUTTON_PRESS && event != BUTTON_REPEAT) {
+    return;
+  }
+  struct can_frame frame;
+  frame.can_id = 0x122;
+  frame.can_dlc = 8;
+  frame.data[0] = 0x02;
+  frame.data[1] = 0x00;
+  frame.data[2] = 0x00;
+  frame.data[3] = 0x00;
+  frame.data[4] = 0x00;
+  frame.data[5] = 0xFF;
+  frame.data[6] = 0x00;
+  frame.data[7] = 0x00;
+  canSend(BUS_CAN1, & frame);
+  if (SerialEnabled) {
+    Serial.println(action.name);
+  }
+}
 
-          Serial.print(" ");
+// Analog volume buttons: steering wheel command arg[0] (0x21F) with the last scroll value
+static void analogVolumeEvent(const ButtonAction& action, ButtonEvent event) {
+  if (event != BUTTON_PRESS && event != BUTTON_REPEAT) {
+    return;
+  }
+  struct can_frame frame;
+  frame.can_id = 0x21F;
+  frame.can_dlc = 3;
+  frame.data[0] = action.arg[0];
+  frame.data[1] = scrollValue;
+  frame.data[2] = 0x00;
+  canSend(BUS_CAN1, & frame);
+  if (SerialEnabled) {
+    Serial.println(action.name);
+  }
+}
 
-          Serial.print(hour());
-          Serial.print(":");
-          Serial.print(minute());
+// Analog buttons, inputs MENU 0b001 / VOL- 0b010 / VOL+ 0b100: exact combinations
+static const ButtonAction analogButtons[] = {
+  {"Menu", 0b111, 0b001, analogMenuEvent, {0x00, 0x00, 0x00}, BUTTON_REPEAT_DELAY_MS, BUTTON_REPEAT_MS, BUTTON_FAST_AFTER_MS, BUTTON_FAST_REPEAT_MS, 0},
+  {"Vol -", 0b111, 0b010, analogVolumeEvent, {0x04, 0x00, 0x00}, BUTTON_REPEAT_DELAY_MS, BUTTON_REPEAT_MS, BUTTON_FAST_AFTER_MS, BUTTON_FAST_REPEAT_MS, 0},
+  {"Vol +", 0b111, 0b100, analogVolumeEvent, {0x08, 0x00, 0x00}, BUTTON_REPEAT_DELAY_MS, BUTTON_REPEAT_MS, BUTTON_FAST_AFTER_MS, BUTTON_FAST_REPEAT_MS, 0},
+  {"Mute", 0b111, 0b110, analogVolumeEvent, {0x0C, 0x00, 0x00}, 0, 0, 0, 0, 0}, // VOL- + VOL+, no repeat
+};
 
-          Serial.println();
-        }
-      } else if (id == 0x1A9 && len == 8) { // Telematic commands
-        TelematicPresent = true;
-
-        darkMode = bitRead(canMsgRcv.data[0], 7); // Dark mode
-        resetTrip1 = bitRead(canMsgRcv.data[0], 1); // Reset Trip 1
-        resetTrip2 = bitRead(canMsgRcv.data[0], 0); // Reset Trip 2
-        pushAAS = bitRead(canMsgRcv.data[3], 2); // AAS
-        pushSAM = bitRead(canMsgRcv.data[3], 2); // SAM
-        pushDSG = bitRead(canMsgRcv.data[5], 0); // Indirect DSG reset
-        pushSTT = bitRead(canMsgRcv.data[6], 7); // Start&Stop
-        pushCHECK = bitRead(canMsgRcv.data[6], 0); // Check
-        stopCHECK = bitRead(canMsgRcv.data[1], 7); // Stop Check
-        pushBLACK = bitRead(canMsgRcv.data[5], 0); // Black Panel
-
-        if (Ignition) {
-          canMsgSnd.data[0] = 0x00;
-          bitWrite(canMsgSnd.data[0], 7, resetTrip1); // Reset Trip 1
-          bitWrite(canMsgSnd.data[0], 6, resetTrip2); // Reset Trip 2
-          canMsgSnd.data[1] = 0x10;
-          bitWrite(canMsgSnd.data[1], 5, darkMode); // Dark mode
-          canMsgSnd.data[2] = 0xFF;
-          canMsgSnd.data[3] = 0xFF;
-          canMsgSnd.data[4] = 0x7F;
-          canMsgSnd.data[5] = 0xFF;
-          canMsgSnd.data[6] = 0x00;
-          canMsgSnd.data[7] = 0x00;
-          canMsgSnd.can_id = 0x167; // Fake EMF Status frame
-          canMsgSnd.can_dlc = 8;
-          CAN0.sendMessage( & canMsgSnd);
-        }
-
-        if (!ClusterPresent && Ignition && (resetTrip1 || resetTrip2 || pushAAS || pushSAM || pushDSG || pushSTT || pushCHECK)) {
-          canMsgSnd.data[0] = statusCMB[0];
-          canMsgSnd.data[1] = statusCMB[1];
-          bitWrite(canMsgSnd.data[1], 4, pushCHECK);
-          bitWrite(canMsgSnd.data[1], 2, resetTrip1);
-          canMsgSnd.data[2] = statusCMB[2];
-          bitWrite(canMsgSnd.data[2], 7, pushAAS);
-          bitWrite(canMsgSnd.data[2], 6, pushASR);
-          canMsgSnd.data[3] = statusCMB[3];
-          bitWrite(canMsgSnd.data[3], 3, pushSAM);
-          bitWrite(canMsgSnd.data[3], 0, resetTrip2);
-          canMsgSnd.data[4] = statusCMB[4];
-          bitWrite(canMsgSnd.data[4], 7, pushDSG);
-          canMsgSnd.data[5] = statusCMB[5];
-          canMsgSnd.data[6] = statusCMB[6];
-          bitWrite(canMsgSnd.data[6], 7, pushSTT);
-          canMsgSnd.data[7] = statusCMB[7];
-          canMsgSnd.can_id = 0x217;
-          canMsgSnd.can_dlc = 8;
-          CAN0.sendMessage( & canMsgSnd);
-        }
-      } else if (id == 0x329 && len == 8) {
-        pushASR = bitRead(canMsgRcv.data[3], 0); // ESP
-      } else if (id == 0x31C && len == 5) { // MATT status
-        canMsgSnd.data[0] = canMsgRcv.data[0];
-        // Rewrite if necessary to make BTEL commands working
-        if (resetTrip1) { // Reset Trip 1
-          bitWrite(canMsgSnd.data[0], 3, 1);
-        }
-        if (resetTrip2) { // Reset Trip 2
-          bitWrite(canMsgSnd.data[0], 2, 1);
-        }
-        canMsgSnd.data[1] = canMsgRcv.data[1];
-        canMsgSnd.data[2] = canMsgRcv.data[2];
-        canMsgSnd.data[3] = canMsgRcv.data[3];
-        canMsgSnd.data[4] = canMsgRcv.data[4];
-        canMsgSnd.can_id = 0x31C;
-        canMsgSnd.can_dlc = 5;
-        CAN0.sendMessage( & canMsgSnd);
-      } else if (id == 0x217 && len == 8) { // Rewrite Cluster status (CIROCCO for example) for tactile touch buttons (telematic) because it is not listened by BSI
-        ClusterPresent = true;
-
-        canMsgSnd.data[0] = canMsgRcv.data[0];
-        canMsgSnd.data[1] = canMsgRcv.data[1];
-        bitWrite(canMsgSnd.data[1], 4, pushCHECK);
-        bitWrite(canMsgSnd.data[1], 2, resetTrip1);
-        canMsgSnd.data[2] = canMsgRcv.data[2];
-        bitWrite(canMsgSnd.data[2], 7, pushAAS);
-        bitWrite(canMsgSnd.data[2], 6, pushASR);
-        canMsgSnd.data[3] = canMsgRcv.data[3];
-        bitWrite(canMsgSnd.data[3], 3, pushSAM);
-        bitWrite(canMsgSnd.data[3], 0, resetTrip2);
-        canMsgSnd.data[4] = canMsgRcv.data[4];
-        bitWrite(canMsgSnd.data[4], 7, pushDSG);
-        canMsgSnd.data[5] = canMsgRcv.data[5];
-        canMsgSnd.data[6] = canMsgRcv.data[6];
-        bitWrite(canMsgSnd.data[6], 7, pushSTT);
-        canMsgSnd.data[7] = canMsgRcv.data[7];
-        canMsgSnd.can_id = 0x217;
-        canMsgSnd.can_dlc = 8;
-        CAN0.sendMessage( & canMsgSnd);
-      } else if (id == 0x15B && len == 8) {
-        if (bitRead(canMsgRcv.data[1], 2)) { // Parameters validity
-          tmpVal = canMsgRcv.data[0];
-          if (tmpVal >= 128) {
-            languageAndUnitNum = tmpVal;
-            eepromUpdate(0, languageAndUnitNum);
-
-            if (SerialEnabled) {
-              Serial.print("Telematic - Change Language and Unit (Number): ");
-              Serial.print(tmpVal);
-              Serial.println();
-            }
-
-            tmpVal = canMsgRcv.data[1];
-            if (tmpVal >= 128) {
-              mpgMi = true;
-              eepromUpdate(4, 1);
-
-              tmpVal = tmpVal - 128;
-            } else {
-              mpgMi = false;
-              eepromUpdate(4, 0);
-            }
-
-            if (tmpVal >= 64) {
-              TemperatureInF = true;
-              eepromUpdate(3, 1);
-
-              if (SerialEnabled) {
-                Serial.print("Telematic - Change Temperature Type: Fahrenheit");
-                Serial.println();
-              }
-            } else if (tmpVal >= 0) {
-              TemperatureInF = false;
-              eepromUpdate(3, 0);
-
-              if (SerialEnabled) {
-                Serial.print("Telematic - Change Temperature Type: Celcius");
-                Serial.println();
-              }
-            }
-          } else {
-            tmpVal = tmpVal >> 2;
-            if (canMsgRcv.data[1] >= 128) {
-              tmpVal--;
-            }
-            languageID = tmpVal;
-
-            // CAN2004 Head-up panel is only one-way talking, we can't change the language on it from the CAN2010 Telematic :-(
-
-            if (SerialEnabled) {
-              Serial.print("Telematic - Change Language (ID): ");
-              Serial.print(tmpVal);
-              Serial.println();
-            }
-          }
-
-          // Personalization settings change
-          bitWrite(canMsgSnd.data[0], 7, 0);
-          bitWrite(canMsgSnd.data[0], 6, 0);
-          bitWrite(canMsgSnd.data[0], 5, 0);
-          bitWrite(canMsgSnd.data[0], 4, 0);
-          bitWrite(canMsgSnd.data[0], 3, 0);
-          bitWrite(canMsgSnd.data[0], 2, 0); // Parameters validity, 0 = Changed parameter(s) the BSI must take into account
-          bitWrite(canMsgSnd.data[0], 1, 0); // User profile
-          bitWrite(canMsgSnd.data[0], 0, 1); // User profile = 1
-          bitWrite(canMsgSnd.data[1], 7, bitRead(canMsgRcv.data[2], 6)); // Selective openings
-          bitWrite(canMsgSnd.data[1], 6, 1);
-          bitWrite(canMsgSnd.data[1], 5, bitRead(canMsgRcv.data[2], 4)); // Selective rear openings
-          bitWrite(canMsgSnd.data[1], 4, bitRead(canMsgRcv.data[2], 5)); // Selective openings
-          bitWrite(canMsgSnd.data[1], 3, 0);
-          bitWrite(canMsgSnd.data[1], 2, 0);
-          bitWrite(canMsgSnd.data[1], 1, bitRead(canMsgRcv.data[2], 3)); // Driver welcome
-          bitWrite(canMsgSnd.data[1], 0, bitRead(canMsgRcv.data[2], 7)); // Parking brake
-          bitWrite(canMsgSnd.data[2], 7, bitRead(canMsgRcv.data[2], 2)); // Adaptative lighting
-          bitWrite(canMsgSnd.data[2], 6, bitRead(canMsgRcv.data[3], 4)); // Beam
-          bitWrite(canMsgSnd.data[2], 5, bitRead(canMsgRcv.data[3], 7)); // Guide-me home lighting
-          bitWrite(canMsgSnd.data[2], 4, bitRead(canMsgRcv.data[3], 0)); // Automatic headlights
-          bitWrite(canMsgSnd.data[2], 3, 0);
-          bitWrite(canMsgSnd.data[2], 2, 0);
-          bitWrite(canMsgSnd.data[2], 1, bitRead(canMsgRcv.data[3], 6)); // Duration Guide-me home lighting (2b)
-          bitWrite(canMsgSnd.data[2], 0, bitRead(canMsgRcv.data[3], 5)); // Duration Guide-me home lighting (2b)
-          bitWrite(canMsgSnd.data[3], 7, bitRead(canMsgRcv.data[2], 0)); // Ambiance lighting
-          bitWrite(canMsgSnd.data[3], 6, bitRead(canMsgRcv.data[2], 1)); // Daytime running lights
-          bitWrite(canMsgSnd.data[3], 5, 0);
-          bitWrite(canMsgSnd.data[3], 4, 0);
-          bitWrite(canMsgSnd.data[3], 3, 0);
-          bitWrite(canMsgSnd.data[3], 2, 0);
-          bitWrite(canMsgSnd.data[3], 1, 0);
-          bitWrite(canMsgSnd.data[3], 0, 0);
-          canMsgSnd.data[4] = 0x00;
-          bitWrite(canMsgSnd.data[5], 7, bitRead(canMsgRcv.data[4], 7)); // AAS
-          bitWrite(canMsgSnd.data[5], 6, bitRead(canMsgRcv.data[4], 7)); // AAS
-          bitWrite(canMsgSnd.data[5], 5, 0);
-          bitWrite(canMsgSnd.data[5], 4, bitRead(canMsgRcv.data[4], 5)); // Wiper in reverse
-          bitWrite(canMsgSnd.data[5], 3, 0);
-          bitWrite(canMsgSnd.data[5], 2, 0);
-          bitWrite(canMsgSnd.data[5], 1, 0);
-          bitWrite(canMsgSnd.data[5], 0, 0);
-          bitWrite(canMsgSnd.data[6], 7, 0);
-          bitWrite(canMsgSnd.data[6], 6, bitRead(canMsgRcv.data[4], 6)); // SAM
-          bitWrite(canMsgSnd.data[6], 5, bitRead(canMsgRcv.data[4], 6)); // SAM
-          bitWrite(canMsgSnd.data[6], 4, 0);
-          bitWrite(canMsgSnd.data[6], 3, 0);
-          bitWrite(canMsgSnd.data[6], 2, 0);
-          bitWrite(canMsgSnd.data[6], 1, 0);
-          bitWrite(canMsgSnd.data[6], 0, 0);
-          bitWrite(canMsgSnd.data[7], 7, bitRead(canMsgRcv.data[4], 3)); // Configurable button
-          bitWrite(canMsgSnd.data[7], 6, bitRead(canMsgRcv.data[4], 2)); // Configurable button
-          bitWrite(canMsgSnd.data[7], 5, bitRead(canMsgRcv.data[4], 1)); // Configurable button
-          bitWrite(canMsgSnd.data[7], 4, bitRead(canMsgRcv.data[4], 0)); // Configurable button
-          bitWrite(canMsgSnd.data[7], 3, 0);
-          bitWrite(canMsgSnd.data[7], 2, 0);
-          bitWrite(canMsgSnd.data[7], 1, 0);
-          bitWrite(canMsgSnd.data[7], 0, 0);
-          canMsgSnd.can_id = 0x15B;
-          canMsgSnd.can_dlc = 8;
-          CAN0.sendMessage( & canMsgSnd);
-
-          // Store personalization settings for the recurring frame
-          personalizationSettings[0] = canMsgSnd.data[1];
-          personalizationSettings[1] = canMsgSnd.data[2];
-          personalizationSettings[2] = canMsgSnd.data[3];
-          personalizationSettings[3] = canMsgSnd.data[4];
-          personalizationSettings[4] = canMsgSnd.data[5];
-          personalizationSettings[5] = canMsgSnd.data[6];
-          personalizationSettings[6] = canMsgSnd.data[7];
-          eepromUpdate(10, personalizationSettings[0]);
-          eepromUpdate(11, personalizationSettings[1]);
-          eepromUpdate(12, personalizationSettings[2]);
-          eepromUpdate(13, personalizationSettings[3]);
-          eepromUpdate(14, personalizationSettings[4]);
-          eepromUpdate(15, personalizationSettings[5]);
-          eepromUpdate(16, personalizationSettings[6]);
-        }
-      } else if (id == 0x1E9 && len >= 2 && CVM_Emul) { // Telematic suggested speed to fake CVM frame
-        CAN0.sendMessage( & canMsgRcv);
-
-        tmpVal = (canMsgRcv.data[3] >> 2); // POI type - Gen2 (6b)
-
-        canMsgSnd.data[0] = canMsgRcv.data[1];
-        canMsgSnd.data[1] = ((tmpVal > 0 && vehicleSpeed > canMsgRcv.data[0]) ? 0x30 : 0x10); // POI Over-speed, make speed limit blink
-        canMsgSnd.data[2] = 0x00;
-        canMsgSnd.data[3] = 0x00;
-        canMsgSnd.data[4] = 0x7C;
-        canMsgSnd.data[5] = 0xF8;
-        canMsgSnd.data[6] = 0x00;
-        canMsgSnd.data[7] = 0x00;
-        canMsgSnd.can_id = 0x268; // CVM Frame ID
-        canMsgSnd.can_dlc = 8;
-        CAN1.sendMessage( & canMsgSnd);
-      } else if (id == 0x1E5 && len == 7) {
-        // Ambience mapping
-        tmpVal = canMsgRcv.data[5];
-        if (tmpVal == 0x00) { // User
-          canMsgRcv.data[6] = 0x40;
-        } else if (tmpVal == 0x08) { // Classical
-          canMsgRcv.data[6] = 0x44;
-        } else if (tmpVal == 0x10) { // Jazz
-          canMsgRcv.data[6] = 0x48;
-        } else if (tmpVal == 0x18) { // Pop-Rock
-          canMsgRcv.data[6] = 0x4C;
-        } else if (tmpVal == 0x28) { // Techno
-          canMsgRcv.data[6] = 0x54;
-        } else if (tmpVal == 0x20) { // Vocal
-          canMsgRcv.data[6] = 0x50;
-        } else { // Default : User
-          canMsgRcv.data[6] = 0x40;
-        }
+#define BUTTON_TABLE(table) table, sizeof(table) / sizeof(table[0])
 
-        // Loudness / Volume linked to speed
-        tmpVal = canMsgRcv.data[4];
-        if (tmpVal == 0x10) { // Loudness / not linked to speed
-          canMsgRcv.data[5] = 0x40;
-        } else if (tmpVal == 0x14) { // Loudness / Volume linked to speed
-          canMsgRcv.data[5] = 0x47;
-        } else if (tmpVal == 0x04) { // No Loudness / Volume linked to speed
-          canMsgRcv.data[5] = 0x07;
-        } else if (tmpVal == 0x00) { // No Loudness / not linked to speed
-          canMsgRcv.data[5] = 0x00;
-        } else { // Default : No Loudness / not linked to speed
-          canMsgRcv.data[5] = 0x00;
-        }
+// Declare the button groups enabled by the settings
+void registerButtons() {
+  if (settings.hasAnalogicButtons) {
+    //Initialize buttons - MENU/VOL+/VOL-
+    pinMode(settings.menuButton, INPUT_PULLUP);
+    pinMode(settings.volDownButton, INPUT_PULLUP);
+    pinMode(settings.volUpButton, INPUT_PULLUP);
+    analogButtonGroup = buttonsAddGroup("Analog", BUTTON_TABLE(analogButtons), BUTTON_DEBOUNCE_MS);
+  }
 
-        // Bass
-        // CAN2004 Telematic Range: (-9) "54" > (-7) "57" > ... > "72" (+9) ("63" = 0)
-        // CAN2010 Telematic Range: "32" > "88" ("60" = 0)
-        tmpVal = canMsgRcv.data[2];
-        canMsgRcv.data[2] = ((tmpVal - 32) >> 2) + 57; // Converted value
-
-        // Treble
-        // CAN2004 Telematic Range: (-9) "54" > (-7) "57" > ... > "72" (+9) ("63" = 0)
-        // CAN2010 Telematic Range: "32" > "88" ("60" = 0)
-        tmpVal = canMsgRcv.data[3];
-        canMsgRcv.data[4] = ((tmpVal - 32) >> 2) + 57; // Converted value on position 4 (while it's on 3 on a old amplifier)
-
-        // Balance - Left / Right
-        // CAN2004 Telematic Range: (-9) "54" > (-7) "57" > ... > "72" (+9) ("63" = 0)
-        // CAN2010 Telematic Range: "32" > "88" ("60" = 0)
-        tmpVal = canMsgRcv.data[1];
-        canMsgRcv.data[1] = ((tmpVal - 32) >> 2) + 57; // Converted value
-
-        // Balance - Front / Back
-        // CAN2004 Telematic Range: (-9) "54" > (-7) "57" > ... > "72" (+9) ("63" = 0)
-        // CAN2010 Telematic Range: "32" > "88" ("60" = 0)
-        tmpVal = canMsgRcv.data[0];
-        canMsgRcv.data[0] = ((tmpVal - 32) >> 2) + 57; // Converted value
-
-        // Mediums ?
-        canMsgRcv.data[3] = 63; // 0x3F = 63
-
-        CAN0.sendMessage( & canMsgRcv);
-      } else {
-        CAN0.sendMessage( & canMsgRcv);
-      }
-    } else {
-      CAN0.sendMessage( & canMsgRcv);
+  if (settings.noFMUX) {
+    // 0xA2 is sampled once per frame, debouncing would only delay the press
+    switch (settings.steeringWheelCommands_Type) {
+    case 1:
+      wheelButtonGroup = buttonsAddGroup("Wheel", BUTTON_TABLE(wheelButtonsMapping), 0);
+      break;
+    case 2:
+      wheelButtonGroup = buttonsAddGroup("Wheel", BUTTON_TABLE(wheelButtonsMenu), 0);
+      break;
+    case 3:
+      wheelButtonGroup = buttonsAddGroup("Wheel", BUTTON_TABLE(wheelButtonsMenuSrc), 0);
+      break;
+    case 4:
+      wheelButtonGroup = buttonsAddGroup("Wheel", BUTTON_TABLE(wheelButtonsMenuTrip), 0);
+      break;
+    case 5:
+      wheelButtonGroup = buttonsAddGroup("Wheel", BUTTON_TABLE(wheelButtonsMenuSrcTrip), 0);
+      break;
     }
+  }
+}
+
+// Fill the dispatch tables once: feature flags and DLC checks are resolved here, not on every frame.
+// Where two handlers claim the same ID, the first one registered wins.
+void registerFrameHandlers() {
+  // Loaded rules first: a rule takes its ID over from a handler below (0xE6, 0x321 and 0x1E5 are default rules)
+  gatewayRulesBegin();
+
+  // Frames from the car
+  canDispatchAdd(BUS_CAN0, 0x15B, DLC_ANY, handleCAN0_15B);
+  canDispatchAdd(BUS_CAN0, 0x36, DLC_EQ(8), handleCAN0_036);
+  canDispatchAdd(BUS_CAN0, 0xB6, DLC_EQ(8), handleCAN0_0B6);
+  if (settings.emulateVIN) {
+    canDispatchAdd(BUS_CAN0, 0x336, DLC_EQ(3), handleCAN0_336);
+    canDispatchAdd(BUS_CAN0, 0x3B6, DLC_EQ(6), handleCAN0_3B6);
+    canDispatchAdd(BUS_CAN0, 0x2B6, DLC_EQ(8), handleCAN0_2B6);
+  }
+  if (settings.noFMUX && settings.steeringWheelCommands_Type == 0) {
+    canDispatchAdd(BUS_CAN0, 0x21F, DLC_EQ(3), handleCAN0_21F_SrcToMenu);
+  } else if (settings.noFMUX || settings.hasAnalogicButtons) {
+    canDispatchAdd(BUS_CAN0, 0x21F, DLC_EQ(3), handleCAN0_21F_FakeFMUX);
+  } else {
+    canDispatchAdd(BUS_CAN0, 0x21F, DLC_EQ(3), handleCAN0_21F);
+  }
+  if (wheelButtonGroup >= 0) {
+    canDispatchAdd(BUS_CAN0, 0xA2, DLC_ANY, handleCAN0_0A2);
+  }
+  canDispatchAdd(BUS_CAN0, 0x217, DLC_EQ(8), handleCAN0_217);
+  canDispatchAdd(BUS_CAN0, 0x1D0, DLC_EQ(7), handleCAN0_1D0);
+  canDispatchAdd(BUS_CAN0, 0xF6, DLC_EQ(8), handleCAN0_0F6);
+  canDispatchAdd(BUS_CAN0, 0x168, DLC_EQ(8), handleCAN0_168);
+  if (settings.generatePOPups) {
+    journalBegin();
+    canDispatchAdd(BUS_CAN0, 0x120, DLC_ANY, handleCAN0_120);
+  }
+  canDispatchAdd(BUS_CAN0, 0x221, DLC_ANY, handleCAN0_221);
+  canDispatchAdd(BUS_CAN0, 0x128, DLC_EQ(8), handleCAN0_128);
+  canDispatchAdd(BUS_CAN0, 0x3A7, DLC_EQ(8), handleCAN0_3A7);
+  canDispatchAdd(BUS_CAN0, 0x1A8, DLC_EQ(8), handleCAN0_1A8);
+  if (settings.listenCAN2004Language) {
+    canDispatchAdd(BUS_CAN0, 0x2D7, DLC_EQ(5), handleCAN0_2D7);
+  }
+  canDispatchAdd(BUS_CAN0, 0x361, DLC_ANY, handleCAN0_361);
+  canDispatchAdd(BUS_CAN0, 0x260, DLC_EQ(8), handleCAN0_260);
+
+  // Frames from the CAN2010 device(s)
+  canDispatchAdd(BUS_CAN1, 0x260, DLC_ANY, handleCAN1_Converted);
+  canDispatchAdd(BUS_CAN1, 0x361, DLC_ANY, handleCAN1_Converted);
+  canDispatchAdd(BUS_CAN1, 0x39B, DLC_EQ(5), handleCAN1_39B);
+  canDispatchAdd(BUS_CAN1, 0x1A9, DLC_EQ(8), handleCAN1_1A9);
+  canDispatchAdd(BUS_CAN1, 0x329, DLC_EQ(8), handleCAN1_329);
+  canDispatchAdd(BUS_CAN1, 0x31C, DLC_EQ(5), handleCAN1_31C);
+  canDispatchAdd(BUS_CAN1, 0x217, DLC_EQ(8), handleCAN1_217);
+  canDispatchAdd(BUS_CAN1, 0x15B, DLC_EQ(8), handleCAN1_15B);
+  if (settings.CVM_Emul) {
+    canDispatchAdd(BUS_CAN1, 0x1E9, DLC_FROM(2), handleCAN1_1E9);
+  }
+}
+
+// Declare the generated frames. Phases put each frame in its own scheduler slot.
+void registerScheduledFrames() {
+  schedulerAdd(BUS_CAN0, 0x3F6, 1000, 0, buildFrame_3F6);   // Fake EMF time
+  schedulerAdd(BUS_CAN0, 0x228, 1000, 500, buildFrame_228); // Clock
+  if (settings.CVM_Emul) {
+    schedulerAdd(BUS_CAN1, 0x268, 500, 250, buildFrame_268); // CVM
+  }
+  if (settings.generatePOPups) {
+    popupBegin(); // Popups rebuilt from the alerts journal (0x1A1)
+  }
+}
+
+// One batch of the CAN1 > CAN0 path, from loop() or from the device task in dual-core mode
+void processCAN1Batch() {
+  gatewayApply(PATH_DEVICE);
+  unsigned long batchStart = micros();
+  for (byte n = 0; n < CAN_RX_BATCH && canReceive(BUS_CAN1, & canMsgRcvDevice); n++) {
+    processCAN1Frame();
+  }
+  gatewayAddBusy(PATH_DEVICE, micros() - batchStart);
+}
+
+void loop() {
+  if (analogButtonGroup >= 0) {
+    // Receive buttons from the car (pressed = LOW): one sample and one timestamp per pass
+    byte inputs = 0;
+    if (!digitalRead(settings.menuButton)) inputs |= 0b001;
+    if (!digitalRead(settings.volDownButton)) inputs |= 0b010;
+    if (!digitalRead(settings.volUpButton)) inputs |= 0b100;
+    buttonsUpdate(analogButtonGroup, inputs, micros());
+  }
+
+  // Instrument Cluster Test Mode
+  if (testClusterMode) {
+    clusterTestLoop();
+  }
+
+  // Serial commands (stats, latency histograms), or GVRET host commands in binary capture
+  if (captureActive()) {
+    captureService();
+  } else {
+    consoleService();
+  }
+
+  // Drain the controllers if reception is not interrupt-driven
+  canBusService();
+  canHealthService();
+
+  // Report a flight recorder freeze, write a dump if its task is not running
+  flightRecorderService();
+
+  // Encode and write the drive log if its task is not running
+  driveLogService();
+
+  // Commit pending settings and access the RTC if their tasks are not running
+  persistService();
+  clockService();
+
+  // Send due generated frames if the scheduler task is not running
+  schedulerService();
+
+  // Receive CAN messages from the car
+  gatewayApply(PATH_CAR);
+  unsigned long batchStart = micros();
+  for (byte n = 0; n < CAN_RX_BATCH && canReceive(BUS_CAN0, & canMsgRcv); n++) {
+    processCAN0Frame();
+  }
+  gatewayAddBusy(PATH_CAR, micros() - batchStart);
+
+  // Forward messages from the CAN2010 device(s) to the car, unless the device task does it
+  if (!gatewayDualCore()) {
+    processCAN1Batch();
+  }
 
+  if (settings.debugGeneral && millis() - lastStatsPrint >= 10000) {
+    lastStatsPrint = millis();
+    bootTimingPrint();
+    canBusPrintStats();
+    canHealthPrintStats();
+    echoPrintStats();
+    flightRecorderPrintStats();
+    driveLogPrintStats();
+    gatewayRulesPrintStats();
+    buttonsPrintStats();
+    gatewayPrintStats();
+    persistPrintStats();
+    clockPrintStats();
+    journalPrintStats();
+    popupPrintStats();
+    memoPrintStats();
   }
 }
 
@@ -0,0 +1,207 @@
+/*
+ * @file mcp2515_spi.cpp
+ * @brief Frame transfers with the MCP2515 quick SPI instructions
+ *
+ * Buffer layout shared by RXBn and TXBn, from SIDH: SIDL, EID8, EID0, DLC,
+ * D0..D7. Identifiers are packed the same way as the generic driver.
+ */
+
+#include <mcp2515_spi.h>
+#include <can_bus.h>
+#include <config.h>
+#include <SPI.h>
+
+// External variables from main.cpp
+extern MCP2515 CAN0;
+extern MCP2515 CAN1;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+// SPI instructions (MCP2515 datasheet, table 12-1)
+#define MCP_INSTRUCTION_READ 0x03
+#define MCP_INSTRUCTION_BITMOD 0x05
+#define MCP_INSTRUCTION_READ_STATUS 0xA0
+#define MCP_INSTRUCTION_READ_RX 0x90  // | 0x04 for RXB1
+#define MCP_INSTRUCTION_LOAD_TX 0x40  // | 0x02 * n for TXBn
+#define MCP_INSTRUCTION_RTS 0x80      // | 1 << n for TXBn
+
+#define MCP_BUFFER_SIZE 13  // SIDH..D7
+#define MCP_HEADER_SIZE 5   // SIDH..DLC
+#define MCP_SIDL_EXIDE 0x08
+#define MCP_SIDL_SRR 0x10   // Standard remote frame received
+#define MCP_DLC_RTR 0x40
+#define MCP_DLC_MASK 0x0F
+
+static_assert(CAN_SPI_CLOCK <= 10000000, "The MCP2515 SPI clock is limited to 10 MHz");
+
+// The native build always goes through the (mock) generic driver
+#if CAN_SPI_FAST_PATH && !defined(NATIVE_BUILD)
+#define MCP_QUICK_INSTRUCTIONS 1
+#else
+#define MCP_QUICK_INSTRUCTIONS 0
+#endif
+
+static const int csPins[BUS_COUNT] = {CS_PIN_CAN0, CS_PIN_CAN1};
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static inline void selectController(byte bus) {
+  SPI.beginTransaction(SPISettings(CAN_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+  digitalWrite(csPins[bus], LOW);
+}
+
+static inline void releaseController(byte bus) {
+  digitalWrite(csPins[bus], HIGH);
+  SPI.endTransaction();
+}
+
+#if MCP_QUICK_INSTRUCTIONS
+
+// RXBn registers → frame, false if the DLC is invalid
+static bool decodeBuffer(const uint8_t* buf, struct can_frame* frame) {
+  canid_t id = ((canid_t) buf[0] << 3) | (buf[1] >> 5);
+  bool rtr;
+
+  if (buf[1] & MCP_SIDL_EXIDE) {
+    id = (id << 2) | (buf[1] & 0x03);
+    id = (id << 16) | ((canid_t) buf[2] << 8) | buf[3];
+    id |= CAN_EFF_FLAG;
+    rtr = buf[4] & MCP_DLC_RTR;
+  } else {
+    rtr = buf[1] & MCP_SIDL_SRR;
+  }
+
+  uint8_t dlc = buf[4] & MCP_DLC_MASK;
+  if (dlc > CAN_MAX_DLEN) {
+    return false;
+  }
+
+  frame->can_id = rtr ? id | CAN_RTR_FLAG : id;
+  frame->can_dlc = dlc;
+  memcpy(frame->data, buf + MCP_HEADER_SIZE, dlc);
+  memset(frame->data + dlc, 0, CAN_MAX_DLEN - dlc);
+  return true;
+}
+
+// Frame → TXBn registers, returns the number of bytes to load
+static byte encodeBuffer(const struct can_frame* frame, uint8_t* buf) {
+  canid_t id = frame->can_id;
+
+  if (id & CAN_EFF_FLAG) {
+    id &= CAN_EFF_MASK;
+    buf[3] = id & 0xFF;
+    buf[2] = (id >> 8) & 0xFF;
+    id >>= 16;
+    buf[1] = (id & 0x03) | ((id & 0x1C) << 3) | MCP_SIDL_EXIDE;
+    buf[0] = id >> 5;
+  } else {
+    id &= CAN_SFF_MASK;
+    buf[0] = id >> 3;
+    buf[1] = (id & 0x07) << 5;
+    buf[2] = 0;
+    buf[3] = 0;
+  }
+
+  byte dlc = frame->can_dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : frame->can_dlc;
+  buf[4] = (frame->can_id & CAN_RTR_FLAG) ? dlc | MCP_DLC_RTR : dlc;
+  memcpy(buf + MCP_HEADER_SIZE, frame->data, dlc);
+  return MCP_HEADER_SIZE + dlc;
+}
+
+#endif
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+#if MCP_QUICK_INSTRUCTIONS
+
+uint8_t mcpReadStatus(byte bus) {
+  selectController(bus);
+  SPI.transfer(MCP_INSTRUCTION_READ_STATUS);
+  uint8_t status = SPI.transfer(0x00);
+  releaseController(bus);
+  return status;
+}
+
+byte mcpReadMessages(byte bus, struct can_frame* frames) {
+  uint8_t status = mcpReadStatus(bus);
+  byte count = 0;
+
+  for (byte n = 0; n < MCP_RX_BUFFERS; n++) {
+    if (!(status & (MCP2515::CANINTF_RX0IF << n))) {
+      continue;
+    }
+
+    uint8_t out[1 + MCP_BUFFER_SIZE] = {(uint8_t) (MCP_INSTRUCTION_READ_RX | (n << 2))};
+    uint8_t in[1 + MCP_BUFFER_SIZE];
+    selectController(bus);
+    SPI.transferBytes(out, in, sizeof(out));
+    releaseController(bus); // Clears RXnIF
+
+    if (decodeBuffer(in + 1, &frames[count])) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void mcpLoadTx(byte bus, byte txb, const struct can_frame* frame) {
+  uint8_t out[1 + MCP_BUFFER_SIZE];
+  out[0] = MCP_INSTRUCTION_LOAD_TX | (txb << 1);
+  byte length = encodeBuffer(frame, out + 1);
+
+  selectController(bus);
+  SPI.writeBytes(out, 1 + length);
+  releaseController(bus);
+
+  selectController(bus);
+  SPI.transfer(MCP_INSTRUCTION_RTS | (1 << txb));
+  releaseController(bus);
+}
+
+#else
+
+static MCP2515& controller(byte bus) {
+  return (bus == BUS_CAN0) ? CAN0 : CAN1;
+}
+
+uint8_t mcpReadStatus(byte bus) {
+  return controller(bus).getStatus();
+}
+
+byte mcpReadMessages(byte bus, struct can_frame* frames) {
+  byte count = 0;
+  while (count < MCP_RX_BUFFERS && controller(bus).readMessage(&frames[count]) == MCP2515::ERROR_OK) {
+    count++;
+  }
+  return count;
+}
+
+void mcpLoadTx(byte bus, byte txb, const struct can_frame* frame) {
+  controller(bus).sendMessage((MCP2515::TXBn) txb, frame);
+}
+
+#endif
+
+void mcpModifyRegister(byte bus, uint8_t reg, uint8_t mask, uint8_t data) {
+  selectController(bus);
+  SPI.transfer(MCP_INSTRUCTION_BITMOD);
+  SPI.transfer(reg);
+  SPI.transfer(mask);
+  SPI.transfer(data);
+  releaseController(bus);
+}
+
+uint8_t mcpReadRegister(byte bus, uint8_t reg) {
+  selectController(bus);
+  SPI.transfer(MCP_INSTRUCTION_READ);
+  SPI.transfer(reg);
+  uint8_t value = SPI.transfer(0x00);
+  releaseController(bus);
+  return value;
+}
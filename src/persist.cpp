@@ -0,0 +1,181 @@
+/*
+ * @file persist.cpp
+ * @brief Write-behind storage of the settings kept in EEPROM
+ *
+ * Both gateway paths write the shadow under a spinlock; the flush task is
+ * the only one touching the EEPROM library and flash.
+ */
+
+#include <persist.h>
+#include <config.h>
+#include <EEPROM.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static_assert(PERSIST_SIZE <= 32, "PERSIST_SIZE must fit the 32-bit dirty mask");
+
+static byte shadow[PERSIST_SIZE];
+static uint32_t dirty = 0;              // One bit per shadow byte not yet committed
+static unsigned long firstChangeMs = 0; // First change since the last commit
+static unsigned long lastChangeMs = 0;
+static bool flushRequested = false;     // Ignition off: commit without waiting for the quiet period
+static portMUX_TYPE shadowMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t flushTaskHandle = NULL;
+
+static unsigned long commits = 0;
+static unsigned long driveCommits = 0;
+static unsigned long failedCommits = 0;
+static unsigned long lastCommitUs = 0;
+static unsigned long maxCommitUs = 0;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static bool flushDue() {
+  bool due = false;
+  unsigned long now = millis();
+
+  portENTER_CRITICAL(&shadowMux);
+  if (dirty != 0) {
+    due = flushRequested || now - lastChangeMs >= PERSIST_QUIET_MS || now - firstChangeMs >= PERSIST_MAX_DELAY_MS;
+  }
+  portEXIT_CRITICAL(&shadowMux);
+
+  return due;
+}
+
+// Copy every dirty byte into the EEPROM library and commit them at once
+static void flush() {
+  byte pending[PERSIST_SIZE];
+  uint32_t mask;
+
+  portENTER_CRITICAL(&shadowMux);
+  mask = dirty;
+  dirty = 0;
+  flushRequested = false;
+  memcpy(pending, shadow, PERSIST_SIZE);
+  portEXIT_CRITICAL(&shadowMux);
+
+  if (mask == 0) {
+    return;
+  }
+
+  for (int address = 0; address < PERSIST_SIZE; address++) {
+    if (mask & (1UL << address)) {
+      EEPROM.write(address, pending[address]);
+    }
+  }
+
+  unsigned long start = micros();
+  bool ok = EEPROM.commit();
+  lastCommitUs = micros() - start;
+  if (lastCommitUs > maxCommitUs) {
+    maxCommitUs = lastCommitUs;
+  }
+
+  if (ok) {
+    commits++;
+    driveCommits++;
+  } else {
+    // Keep the bytes pending, retried after the next quiet period
+    failedCommits++;
+    portENTER_CRITICAL(&shadowMux);
+    dirty |= mask;
+    lastChangeMs = millis();
+    portEXIT_CRITICAL(&shadowMux);
+  }
+}
+
+static void flushTask(void*) {
+  for (;;) {
+    // Woken at ignition off, otherwise checks the quiet period periodically
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PERSIST_POLL_MS));
+    if (flushDue()) {
+      flush();
+    }
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void persistBegin() {
+  EEPROM.begin(PERSIST_SIZE);
+  for (int address = 0; address < PERSIST_SIZE; address++) {
+    shadow[address] = EEPROM.read(address);
+  }
+
+  if (xTaskCreatePinnedToCore(flushTask, "persist", 4096, NULL, PERSIST_TASK_PRIORITY, &flushTaskHandle, PERSIST_TASK_CORE) != pdPASS) {
+    flushTaskHandle = NULL;
+  }
+}
+
+void persistService() {
+  if (flushTaskHandle == NULL && flushDue()) {
+    flush();
+  }
+}
+
+byte persistRead(int address) {
+  return shadow[address];
+}
+
+void persistWrite(int address, byte value) {
+  unsigned long now = millis();
+
+  portENTER_CRITICAL(&shadowMux);
+  if (shadow[address] != value) {
+    shadow[address] = value;
+    if (dirty == 0) {
+      firstChangeMs = now;
+    }
+    dirty |= 1UL << address;
+    lastChangeMs = now;
+  }
+  portEXIT_CRITICAL(&shadowMux);
+}
+
+void persistIgnition(bool ignition) {
+  if (ignition) {
+    driveCommits = 0;
+    return;
+  }
+
+  portENTER_CRITICAL(&shadowMux);
+  flushRequested = (dirty != 0);
+  portEXIT_CRITICAL(&shadowMux);
+
+  if (flushTaskHandle != NULL) {
+    xTaskNotifyGive(flushTaskHandle);
+  }
+}
+
+void persistPrintStats() {
+  byte pendingBytes = 0;
+
+  portENTER_CRITICAL(&shadowMux);
+  for (uint32_t mask = dirty; mask != 0; mask &= mask - 1) {
+    pendingBytes++;
+  }
+  portEXIT_CRITICAL(&shadowMux);
+
+  Serial.print("EEPROM: ");
+  Serial.print(driveCommits);
+  Serial.print(" commits this drive, ");
+  Serial.print(commits);
+  Serial.print(" total, ");
+  Serial.print(failedCommits);
+  Serial.print(" failed, ");
+  Serial.print(pendingBytes);
+  Serial.print(" bytes pending, last commit ");
+  Serial.print(lastCommitUs);
+  Serial.print(" us, max ");
+  Serial.print(maxCommitUs);
+  Serial.println(" us");
+}
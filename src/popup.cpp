@@ -0,0 +1,261 @@
+/*
+ * @file popup.cpp
+ * @brief Popup notifications (0x1A1) rebuilt from the alerts journal for CAN2010 devices
+ *
+ * popupSet() runs on the CAN0 path, the 0x1A1 builder on the scheduler: the
+ * bitsets and the active slots are shared under a spinlock, held only for
+ * bit operations and a scan of at most POPUP_MAX_ID / 32 words.
+ */
+
+#include <popup.h>
+#include <scheduler.h>
+#include <can_bus.h>
+#include <config.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define POPUP_WORDS (POPUP_MAX_ID / 32)
+#define POPUP_NONE 0xFFFF
+
+static_assert(POPUP_MAX_ID % 32 == 0, "POPUP_MAX_ID must be a multiple of 32");
+
+struct ActivePopup {
+  uint16_t id;
+  byte priority;
+  byte parameters; // As sent
+};
+
+static uint32_t presentBits[POPUP_WORDS]; // Reported active by the journal
+static uint32_t shownBits[POPUP_WORDS];   // Sent to the device, in activePopups
+static uint32_t pendingBits[POPUP_WORDS]; // Changed since last sent
+static byte alertParameters[POPUP_MAX_ID];
+static byte alertPriority[POPUP_MAX_ID];
+
+static ActivePopup activePopups[POPUP_MAX_ACTIVE]; // Most urgent first
+static byte activeCount = 0;
+static portMUX_TYPE popupMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Statistics
+static unsigned long setCalls = 0;
+static unsigned long changes = 0;
+static unsigned long shownCount = 0;
+static unsigned long closedCount = 0;
+static unsigned long fullWaits = 0;   // Emitter periods with alerts waiting for a free slot
+static unsigned long outOfRange = 0;  // IDs >= POPUP_MAX_ID
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static inline bool testBit(const uint32_t* bits, uint16_t id) {
+  return bits[id >> 5] & (1UL << (id & 31));
+}
+
+static inline void setBit(uint32_t* bits, uint16_t id) {
+  bits[id >> 5] |= 1UL << (id & 31);
+}
+
+static inline void clearBit(uint32_t* bits, uint16_t id) {
+  bits[id >> 5] &= ~(1UL << (id & 31));
+}
+
+static void removeActive(byte index) {
+  for (byte i = index; i + 1 < activeCount; i++) {
+    activePopups[i] = activePopups[i + 1];
+  }
+  activeCount--;
+}
+
+static void insertActive(uint16_t id, byte priority, byte parameters) {
+  byte i = activeCount++;
+  while (i > 0 && activePopups[i - 1].priority > priority) {
+    activePopups[i] = activePopups[i - 1];
+    i--;
+  }
+  activePopups[i] = {id, priority, parameters};
+}
+
+// Most urgent pending alert that is not shown yet (lowest ID first on equal priority)
+static uint16_t nextToShow() {
+  uint16_t best = POPUP_NONE;
+
+  for (byte w = 0; w < POPUP_WORDS; w++) {
+    uint32_t bits = pendingBits[w] & ~shownBits[w];
+    while (bits) {
+      uint16_t id = w * 32 + __builtin_ctz(bits);
+      bits &= bits - 1;
+      if (!testBit(presentBits, id)) {
+        clearBit(pendingBits, id); // Came and went before being sent
+      } else if (best == POPUP_NONE || alertPriority[id] < alertPriority[best]) {
+        best = id;
+      }
+    }
+  }
+  return best;
+}
+
+// Pick the next close or popup to send, under popupMux
+static bool nextFrame(uint16_t& id, bool& present, byte& priority, byte& parameters) {
+  // A shown alert that went away or changed parameters or priority is closed first
+  for (byte i = 0; i < activeCount; i++) {
+    ActivePopup& popup = activePopups[i];
+    if (!testBit(pendingBits, popup.id)) {
+      continue;
+    }
+    if (testBit(presentBits, popup.id) && alertParameters[popup.id] == popup.parameters && alertPriority[popup.id] == popup.priority) {
+      clearBit(pendingBits, popup.id); // Back to what is shown
+      continue;
+    }
+    if (!testBit(presentBits, popup.id)) {
+      clearBit(pendingBits, popup.id);
+    } // else stays pending, shown again with the new parameters and priority
+    clearBit(shownBits, popup.id);
+    id = popup.id;
+    present = false;
+    priority = popup.priority;
+    parameters = 0x00;
+    removeActive(i);
+    closedCount++;
+    return true;
+  }
+
+  uint16_t next = nextToShow();
+  if (next == POPUP_NONE) {
+    return false;
+  }
+  if (activeCount >= POPUP_MAX_ACTIVE) {
+    fullWaits++;
+    return false;
+  }
+
+  clearBit(pendingBits, next);
+  setBit(shownBits, next);
+  insertActive(next, alertPriority[next], alertParameters[next]);
+  id = next;
+  present = true;
+  priority = alertPriority[next];
+  parameters = alertParameters[next];
+  shownCount++;
+  return true;
+}
+
+static bool buildFrame_1A1(struct can_frame* frame) {
+  uint16_t id;
+  bool present;
+  byte priority;
+  byte parameters;
+
+  portENTER_CRITICAL(&popupMux);
+  bool send = nextFrame(id, present, priority, parameters);
+  portEXIT_CRITICAL(&popupMux);
+
+  if (!send) {
+    return false;
+  }
+
+  if (present) {
+    frame->data[0] = highByte(id);
+    frame->data[1] = lowByte(id);
+    bitWrite(frame->data[0], 7, 1); // New message
+  } else { // Close Popup
+    frame->data[0] = 0x7F;
+    frame->data[1] = 0xFF;
+  }
+  frame->data[2] = priority; // Priority (0 > 14)
+  bitWrite(frame->data[2], 7, 1); // Destination: NAC / EMF / MATT
+  bitWrite(frame->data[2], 6, 1); // Destination: CMB
+  frame->data[3] = parameters; // Parameters
+  frame->data[4] = 0x00; // Parameters
+  frame->data[5] = 0x00; // Parameters
+  frame->data[6] = 0x00; // Parameters
+  frame->data[7] = 0x00; // Parameters
+  frame->can_dlc = 8;
+
+  if (SerialEnabled && present) {
+    Serial.print("Notification sent with message ID: ");
+    Serial.println(id);
+  }
+  return true;
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void popupBegin() {
+  schedulerAdd(BUS_CAN1, 0x1A1, POPUP_TX_INTERVAL_MS, POPUP_TX_PHASE_MS, buildFrame_1A1);
+}
+
+void popupSet(bool present, int id, byte priority, byte parameters) {
+  if (id <= 0 || id >= POPUP_MAX_ID) {
+    outOfRange++;
+    return;
+  }
+  if (priority > 14) {
+    priority = 14;
+  }
+
+  portENTER_CRITICAL(&popupMux);
+  setCalls++;
+  if (present) {
+    if (!testBit(presentBits, id) || alertParameters[id] != parameters || alertPriority[id] != priority) {
+      setBit(presentBits, id);
+      setBit(pendingBits, id);
+      alertParameters[id] = parameters;
+      alertPriority[id] = priority;
+      changes++;
+    }
+  } else if (testBit(presentBits, id)) {
+    clearBit(presentBits, id);
+    setBit(pendingBits, id);
+    changes++;
+  }
+  portEXIT_CRITICAL(&popupMux);
+}
+
+void popupPrintStats() {
+  ActivePopup active[POPUP_MAX_ACTIVE];
+  byte count;
+  unsigned int pending = 0;
+
+  portENTER_CRITICAL(&popupMux);
+  count = activeCount;
+  memcpy(active, activePopups, sizeof(active));
+  for (byte w = 0; w < POPUP_WORDS; w++) {
+    pending += __builtin_popcount(pendingBits[w]);
+  }
+  portEXIT_CRITICAL(&popupMux);
+
+  Serial.print("Popups: ");
+  Serial.print(setCalls);
+  Serial.print(" updates, ");
+  Serial.print(changes);
+  Serial.print(" changes, ");
+  Serial.print(shownCount);
+  Serial.print(" shown, ");
+  Serial.print(closedCount);
+  Serial.print(" closed, ");
+  Serial.print(pending);
+  Serial.print(" pending, ");
+  Serial.print(fullWaits);
+  Serial.print(" full waits, ");
+  Serial.print(outOfRange);
+  Serial.print(" out of range | active:");
+  if (count == 0) {
+    Serial.print(" none");
+  }
+  for (byte i = 0; i < count; i++) {
+    Serial.print(" ");
+    Serial.print(active[i].id);
+    Serial.print("/P");
+    Serial.print(active[i].priority);
+  }
+  Serial.println();
+}
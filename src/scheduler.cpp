@@ -0,0 +1,293 @@
+/*
+ * @file scheduler.cpp
+ * @brief Time-triggered transmission of the frames generated by the adapter
+ *
+ * Frames are declared in setup() and the wheel is then only touched by the
+ * scheduler (task, or loop() in polled mode). schedulerKick() from the
+ * gateway paths only sets a flag read at the next tick.
+ */
+
+#include <scheduler.h>
+#include <can_bus.h>
+#include <config.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+#define SLOT_EMPTY 0xFF
+
+static_assert(SCHEDULER_MAX_FRAMES < SLOT_EMPTY, "SCHEDULER_MAX_FRAMES must fit a byte index");
+
+struct ScheduledFrame {
+  struct can_frame frame;
+  ScheduledFrameBuilder build;
+  byte bus;
+  unsigned int periodTicks;
+  unsigned int rounds;      // Remaining wheel turns before the frame is due
+  byte next;                // Next frame in the same slot
+  std::atomic<bool> kicked;
+
+  // Statistics
+  unsigned long sent;
+  unsigned long skipped;
+  unsigned long kicks;
+  unsigned long missed;     // Periods not sent because the scheduler was stalled
+  unsigned long lastSentUs; // Last periodic send, 0 = none yet
+  unsigned long periods;    // Measured periods
+  unsigned long minPeriodUs;
+  unsigned long maxPeriodUs;
+  uint64_t periodSumUs;
+  uint64_t jitterSumUs;      // Sum of |period - nominal|
+};
+
+static ScheduledFrame frames[SCHEDULER_MAX_FRAMES];
+static byte frameCount = 0;
+static byte wheel[SCHEDULER_WHEEL_SLOTS]; // First frame of each slot
+static unsigned long currentTick = 0;
+static unsigned long startMillis = 0;
+static TaskHandle_t schedulerTaskHandle = NULL;
+
+// Bus activity, sampled every tick
+static unsigned long lastReceived[BUS_COUNT] = {0, 0};
+static unsigned long lastActivity[BUS_COUNT] = {0, 0};
+static bool seenActivity[BUS_COUNT] = {false, false};
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+// Put a frame in the slot due ticksFromNow (>= 1) ticks after currentTick
+static void wheelInsert(byte index, unsigned long ticksFromNow) {
+  byte slot = (currentTick + ticksFromNow) % SCHEDULER_WHEEL_SLOTS;
+  frames[index].rounds = (ticksFromNow - 1) / SCHEDULER_WHEEL_SLOTS;
+  frames[index].next = wheel[slot];
+  wheel[slot] = index;
+}
+
+static void sendFrame(ScheduledFrame& entry, bool periodic) {
+  if (!entry.build(&entry.frame)) {
+    entry.skipped++;
+    entry.lastSentUs = 0; // Do not count the gap as jitter
+    return;
+  }
+
+  canSend(entry.bus, &entry.frame);
+  entry.sent++;
+
+  if (!periodic) {
+    entry.kicks++;
+    return;
+  }
+
+  unsigned long now = micros();
+  if (entry.lastSentUs != 0) {
+    unsigned long period = now - entry.lastSentUs;
+    unsigned long nominal = entry.periodTicks * SCHEDULER_TICK_MS * 1000UL;
+    entry.periods++;
+    entry.periodSumUs += period;
+    entry.jitterSumUs += (period > nominal) ? period - nominal : nominal - period;
+    if (entry.minPeriodUs == 0 || period < entry.minPeriodUs) {
+      entry.minPeriodUs = period;
+    }
+    if (period > entry.maxPeriodUs) {
+      entry.maxPeriodUs = period;
+    }
+  }
+  entry.lastSentUs = (now != 0) ? now : 1;
+}
+
+static void sampleBusActivity() {
+  for (byte bus = 0; bus < BUS_COUNT; bus++) {
+    unsigned long received = canRxStats(bus).received;
+    if (received != lastReceived[bus]) {
+      lastReceived[bus] = received;
+      lastActivity[bus] = millis();
+      seenActivity[bus] = true;
+    }
+  }
+}
+
+// Process the next tick; lateTicks = ticks still to run after this one to catch up
+static void tick(unsigned long lateTicks) {
+  currentTick++;
+  sampleBusActivity();
+
+  // Frames whose data changed, outside of their period
+  for (byte i = 0; i < frameCount; i++) {
+    if (frames[i].kicked.exchange(false, std::memory_order_acq_rel)) {
+      sendFrame(frames[i], false);
+    }
+  }
+
+  byte slot = currentTick % SCHEDULER_WHEEL_SLOTS;
+  byte index = wheel[slot];
+  byte keep = SLOT_EMPTY;
+  wheel[slot] = SLOT_EMPTY;
+
+  while (index != SLOT_EMPTY) {
+    ScheduledFrame& entry = frames[index];
+    byte next = entry.next;
+
+    if (entry.rounds > 0) {
+      entry.rounds--;
+      entry.next = keep;
+      keep = index;
+    } else {
+      // After a stall, a frame late by half a period or more is skipped: the next one is closer
+      if (lateTicks * 2 < entry.periodTicks) {
+        sendFrame(entry, true);
+      } else {
+        entry.missed++;
+        entry.lastSentUs = 0;
+      }
+      if (entry.periodTicks % SCHEDULER_WHEEL_SLOTS == 0) {
+        // Due again in this very slot, which is being rebuilt
+        entry.rounds = entry.periodTicks / SCHEDULER_WHEEL_SLOTS - 1;
+        entry.next = keep;
+        keep = index;
+      } else {
+        wheelInsert(index, entry.periodTicks);
+      }
+    }
+    index = next;
+  }
+
+  // Frames not due yet stay in this slot
+  while (keep != SLOT_EMPTY) {
+    byte next = frames[keep].next;
+    frames[keep].next = wheel[slot];
+    wheel[slot] = keep;
+    keep = next;
+  }
+}
+
+// Catch up with the ticks elapsed since the last call
+static void runDueTicks() {
+  unsigned long target = (millis() - startMillis) / SCHEDULER_TICK_MS;
+  while ((long) (target - currentTick) > 0) {
+    tick(target - currentTick - 1);
+  }
+}
+
+static void schedulerTask(void*) {
+  TickType_t lastWake = xTaskGetTickCount();
+
+  for (;;) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SCHEDULER_TICK_MS));
+    runDueTicks();
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+bool schedulerAdd(byte bus, uint16_t id, unsigned int periodMs, unsigned int phaseMs, ScheduledFrameBuilder builder) {
+  if (frameCount == 0) {
+    memset(wheel, SLOT_EMPTY, sizeof(wheel));
+  }
+  if (frameCount >= SCHEDULER_MAX_FRAMES) {
+    return false;
+  }
+
+  byte index = frameCount++;
+  ScheduledFrame& entry = frames[index];
+  entry.frame.can_id = id;
+  entry.build = builder;
+  entry.bus = bus;
+  entry.periodTicks = (periodMs + SCHEDULER_TICK_MS / 2) / SCHEDULER_TICK_MS;
+  if (entry.periodTicks == 0) {
+    entry.periodTicks = 1;
+  }
+  entry.kicked.store(false);
+  wheelInsert(index, phaseMs / SCHEDULER_TICK_MS + 1);
+  return true;
+}
+
+void schedulerBegin() {
+  startMillis = millis();
+
+  if (frameCount == 0) {
+    return;
+  }
+
+  if (xTaskCreatePinnedToCore(schedulerTask, "scheduler", 4096, NULL, SCHEDULER_TASK_PRIORITY, &schedulerTaskHandle, SCHEDULER_TASK_CORE) != pdPASS) {
+    schedulerTaskHandle = NULL;
+    if (SerialEnabled) {
+      Serial.println("Scheduler: unable to start task, running from loop()");
+    }
+  }
+}
+
+void schedulerService() {
+  if (schedulerTaskHandle == NULL && frameCount > 0) {
+    runDueTicks();
+  }
+}
+
+void schedulerKick(byte bus, uint16_t id) {
+  for (byte i = 0; i < frameCount; i++) {
+    if (frames[i].bus == bus && frames[i].frame.can_id == id) {
+      frames[i].kicked.store(true, std::memory_order_release);
+    }
+  }
+}
+
+bool schedulerBusAwake(byte bus) {
+  return seenActivity[bus] && millis() - lastActivity[bus] < SCHEDULER_BUS_TIMEOUT_MS;
+}
+
+void schedulerPrintStats() {
+  Serial.println("Scheduled frames: ID, bus, period | sent, skipped, missed, kicked | period min/avg/max, avg jitter (us)");
+
+  for (byte i = 0; i < frameCount; i++) {
+    const ScheduledFrame& entry = frames[i];
+    Serial.print("  0x");
+    Serial.print(entry.frame.can_id, HEX);
+    Serial.print(entry.bus == BUS_CAN0 ? " CAN0 " : " CAN1 ");
+    Serial.print(entry.periodTicks * SCHEDULER_TICK_MS);
+    Serial.print(" ms | ");
+    Serial.print(entry.sent);
+    Serial.print(", ");
+    Serial.print(entry.skipped);
+    Serial.print(", ");
+    Serial.print(entry.missed);
+    Serial.print(", ");
+    Serial.print(entry.kicks);
+    Serial.print(" | ");
+    if (entry.periods == 0) {
+      Serial.println("-");
+      continue;
+    }
+    Serial.print(entry.minPeriodUs);
+    Serial.print("/");
+    Serial.print((unsigned long) (entry.periodSumUs / entry.periods));
+    Serial.print("/");
+    Serial.print(entry.maxPeriodUs);
+    Serial.print(", ");
+    Serial.println((unsigned long) (entry.jitterSumUs / entry.periods));
+  }
+}
+
+void schedulerResetStats() {
+  for (byte i = 0; i < frameCount; i++) {
+    ScheduledFrame& entry = frames[i];
+    entry.sent = 0;
+    entry.skipped = 0;
+    entry.kicks = 0;
+    entry.missed = 0;
+    entry.lastSentUs = 0;
+    entry.periods = 0;
+    entry.minPeriodUs = 0;
+    entry.maxPeriodUs = 0;
+    entry.periodSumUs = 0;
+    entry.jitterSumUs = 0;
+  }
+}
@@ -0,0 +1,251 @@
+/*
+ * @file settings.cpp
+ * @brief Feature flags in one versioned, CRC-checked record in NVS
+ *
+ * Every setting has a descriptor (name, type, offset in Settings, range),
+ * used by the console to list, parse and validate values. NVS is only
+ * accessed by settingsBegin() and settingsSave(), never from the frame path.
+ */
+
+#include <settings.h>
+#include <translation_memo.h>
+#include <Preferences.h>
+#include <stddef.h>
+
+// External variables from main.cpp
+extern bool SerialEnabled;
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+// Compiled-in defaults, used when no valid record is saved
+static const Settings defaults = {
+  false, // debugGeneral: Get some debug informations on Serial
+  false, // debugCAN0: Read data sent by ECUs from the car to Entertainment CAN bus using https://github.com/alexandreblin/python-can-monitor
+  false, // debugCAN1: Read data sent by the NAC / SMEG to Entertainment CAN bus using https://github.com/alexandreblin/python-can-monitor
+  false, // debugBinaryCapture: debugCAN0 / debugCAN1 output as a GVRET binary stream (SavvyCAN) instead of "FRAME:ID=" text, see capture.h
+  false, // debugCaptureTx: With debugBinaryCapture, also capture the frames sent by the adapter (GVRET buses 2 / 3)
+  false, // dualCoreGateway: Run the CAN1 > CAN0 direction in its own task on the other core, so slow NAC frames never delay the car > NAC direction
+
+  true,  // EconomyModeEnabled: You can disable economy mode on the Telematic if you want to - Not recommended at all
+  false, // Send_CAN2010_ForgedMessages: Send forged CAN2010 messages to the CAR CAN-BUS Network (useful for testing CAN2010 device(s) from already existent connectors)
+  false, // kmL: km/L statistics instead of L/100
+  false, // fixedBrightness: Force Brightness value in case the calibration does not match your brightness value range
+  false, // noFMUX: If you don't have any useful button on the main panel, turn the SRC button on steering wheel commands into MENU - only works for CAN2010 SMEG / NAC -
+  0,     // steeringWheelCommands_Type: noFMUX extra setting : 0 = Generic, 1 = C4 I / C5 X7 NAV+MUSIC+APPS+PHONE mapping, 2 = C4 I / C5 X7 MENU mapping, 3 = C4 I / C5 X7 MENU mapping + SRC on wiper command button, 4 = C4 I / C5 X7 MENU mapping + TRIP on wiper command button, 5 = C4 I / C5 X7 MENU mapping + SRC on wiper command button + TRIP on ESC button
+  false, // listenCAN2004Language: Switch language on CAN2010 devices if changed on supported CAN2004 devices, default: no
+  true,  // CVM_Emul: Send suggested speed from Telematic to fake CVM (Multifunction camera inside the windshield) frame
+  false, // generatePOPups: Generate notifications from alerts journal - useful for C5 (X7)
+  false, // emulateVIN: Replace network VIN by another (donor car for example)
+  "VF3XXXXXXXXXXXXXX", // vinNumber
+
+  false, // hasAnalogicButtons: Analog buttons instead of FMUX
+  4,     // menuButton
+  5,     // volDownButton
+  6,     // volUpButton
+
+  false  // driveLog: Compressed log of both buses on the LittleFS partition, see drive_log.h
+};
+
+Settings settings = defaults;
+
+enum SettingType : byte {
+  SETTING_BOOL,
+  SETTING_BYTE,
+  SETTING_VIN
+};
+
+struct SettingDescriptor {
+  const char* name;
+  SettingType type;
+  uint16_t offset;
+  byte max;      // SETTING_BYTE only
+  bool restart;  // Read at boot only (dispatch tables, tasks, pins)
+};
+
+#define SETTING(field, type, max, restart) {#field, type, offsetof(Settings, field), max, restart}
+
+static const SettingDescriptor descriptors[] = {
+  SETTING(debugGeneral, SETTING_BOOL, 1, false),
+  SETTING(debugCAN0, SETTING_BOOL, 1, false),
+  SETTING(debugCAN1, SETTING_BOOL, 1, false),
+  SETTING(debugBinaryCapture, SETTING_BOOL, 1, true),
+  SETTING(debugCaptureTx, SETTING_BOOL, 1, false),
+  SETTING(dualCoreGateway, SETTING_BOOL, 1, true),
+  SETTING(EconomyModeEnabled, SETTING_BOOL, 1, false),
+  SETTING(Send_CAN2010_ForgedMessages, SETTING_BOOL, 1, false),
+  SETTING(kmL, SETTING_BOOL, 1, true),
+  SETTING(fixedBrightness, SETTING_BOOL, 1, false),
+  SETTING(noFMUX, SETTING_BOOL, 1, true),
+  SETTING(steeringWheelCommands_Type, SETTING_BYTE, 5, true),
+  SETTING(listenCAN2004Language, SETTING_BOOL, 1, true),
+  SETTING(CVM_Emul, SETTING_BOOL, 1, true),
+  SETTING(generatePOPups, SETTING_BOOL, 1, true),
+  SETTING(emulateVIN, SETTING_BOOL, 1, true),
+  SETTING(vinNumber, SETTING_VIN, 0, false),
+  SETTING(hasAnalogicButtons, SETTING_BOOL, 1, true),
+  SETTING(menuButton, SETTING_BYTE, 48, true),
+  SETTING(volDownButton, SETTING_BYTE, 48, true),
+  SETTING(volUpButton, SETTING_BYTE, 48, true),
+  SETTING(driveLog, SETTING_BOOL, 1, true),
+};
+
+#define SETTINGS_HEADER_SIZE 5  // magic (2) + version (1) + size (2)
+#define SETTINGS_CRC_SIZE 4
+
+// Size of Settings in each record version: append a line when SETTINGS_VERSION is bumped
+static const uint16_t recordSizes[SETTINGS_VERSION + 1] = {
+  0,
+  offsetof(Settings, driveLog),  // 1: up to volUpButton
+  sizeof(Settings)               // 2: driveLog
+};
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+// CRC-32 (IEEE 802.3, reflected), bitwise: only run at boot and on save
+static uint32_t crc32(const byte* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (byte bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static const SettingDescriptor* findSetting(const char* name) {
+  for (const SettingDescriptor& descriptor : descriptors) {
+    if (strcmp(descriptor.name, name) == 0) {
+      return &descriptor;
+    }
+  }
+  return NULL;
+}
+
+// Derived state after a change
+static void applySettings() {
+  SerialEnabled = settings.debugCAN0 || settings.debugCAN1 || settings.debugGeneral;
+  memoInvalidateAll(); // Cached translations may depend on a flag
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+bool settingsBegin() {
+  byte record[SETTINGS_HEADER_SIZE + sizeof(Settings) + SETTINGS_CRC_SIZE];
+  Preferences prefs;
+
+  settings = defaults;
+  if (!prefs.begin(SETTINGS_NAMESPACE, true)) {
+    return false;
+  }
+  size_t length = prefs.getBytes(SETTINGS_KEY, record, sizeof(record));
+  prefs.end();
+
+  if (length < SETTINGS_HEADER_SIZE + SETTINGS_CRC_SIZE) {
+    return false;
+  }
+
+  uint16_t magic = record[0] | (record[1] << 8);
+  byte version = record[2];
+  uint16_t size = record[3] | (record[4] << 8);
+  if (magic != SETTINGS_MAGIC || length != (size_t) (SETTINGS_HEADER_SIZE + size + SETTINGS_CRC_SIZE)) {
+    return false;
+  }
+  // Unknown (newer) layouts are rejected, a known version must have its own size
+  if (version == 0 || version > SETTINGS_VERSION || size != recordSizes[version]) {
+    return false;
+  }
+
+  const byte* crcBytes = record + SETTINGS_HEADER_SIZE + size;
+  uint32_t crc = crcBytes[0] | (crcBytes[1] << 8) | ((uint32_t) crcBytes[2] << 16) | ((uint32_t) crcBytes[3] << 24);
+  if (crc != crc32(record, SETTINGS_HEADER_SIZE + size)) {
+    return false;
+  }
+
+  // Migration: an older (shorter) record only covers the first fields, the others keep their default
+  memcpy(&settings, record + SETTINGS_HEADER_SIZE, size);
+  settings.vinNumber[sizeof(settings.vinNumber) - 1] = '\0';
+  return true;
+}
+
+bool settingsSet(const char* name, const char* value) {
+  const SettingDescriptor* descriptor = findSetting(name);
+  if (descriptor == NULL) {
+    return false;
+  }
+
+  byte* field = (byte*) &settings + descriptor->offset;
+  if (descriptor->type == SETTING_VIN) {
+    if (strlen(value) != sizeof(settings.vinNumber) - 1) {
+      return false;
+    }
+    memcpy(field, value, sizeof(settings.vinNumber));
+  } else {
+    char* end;
+    long number = strtol(value, &end, 0);
+    if (end == value || *end != '\0' || number < 0 || number > descriptor->max) {
+      return false;
+    }
+    if (descriptor->type == SETTING_BOOL) {
+      *(bool*) field = (number != 0);
+    } else {
+      *field = (byte) number;
+    }
+  }
+
+  applySettings();
+  return true;
+}
+
+bool settingsSave() {
+  byte record[SETTINGS_HEADER_SIZE + sizeof(Settings) + SETTINGS_CRC_SIZE];
+  Preferences prefs;
+
+  record[0] = SETTINGS_MAGIC & 0xFF;
+  record[1] = SETTINGS_MAGIC >> 8;
+  record[2] = SETTINGS_VERSION;
+  record[3] = sizeof(Settings) & 0xFF;
+  record[4] = sizeof(Settings) >> 8;
+  memcpy(record + SETTINGS_HEADER_SIZE, &settings, sizeof(Settings));
+
+  uint32_t crc = crc32(record, SETTINGS_HEADER_SIZE + sizeof(Settings));
+  for (byte i = 0; i < SETTINGS_CRC_SIZE; i++) {
+    record[SETTINGS_HEADER_SIZE + sizeof(Settings) + i] = (crc >> (8 * i)) & 0xFF;
+  }
+
+  if (!prefs.begin(SETTINGS_NAMESPACE, false)) {
+    return false;
+  }
+  bool ok = prefs.putBytes(SETTINGS_KEY, record, sizeof(record)) == sizeof(record);
+  prefs.end();
+  return ok;
+}
+
+void settingsDefaults() {
+  settings = defaults;
+  applySettings();
+}
+
+void settingsPrint() {
+  for (const SettingDescriptor& descriptor : descriptors) {
+    const byte* field = (const byte*) &settings + descriptor.offset;
+
+    Serial.print("  ");
+    Serial.print(descriptor.name);
+    Serial.print(" = ");
+    if (descriptor.type == SETTING_VIN) {
+      Serial.print((const char*) field);
+    } else if (descriptor.type == SETTING_BOOL) {
+      Serial.print(*(const bool*) field ? 1 : 0);
+    } else {
+      Serial.print(*field);
+    }
+    Serial.println(descriptor.restart ? " (restart)" : "");
+  }
+}
@@ -0,0 +1,187 @@
+/*
+ * @file time_service.cpp
+ * @brief Cached system clock, the RTC module is only accessed by a background task
+ *
+ * The clock base (epoch + millis()) is shared by both gateway paths and the
+ * RTC task under a spinlock. The RTC task is the only user of the Wire bus.
+ */
+
+#include <time_service.h>
+#include <config.h>
+#include <DS1307RTC.h> // https://github.com/PaulStoffregen/DS1307RTC
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static time_t baseTime = 0;          // Time at baseMillis
+static unsigned long baseMillis = 0;
+static bool clockValid = false;
+static bool rtcWritePending = false; // Set by clockSet(), handled by the RTC task
+static portMUX_TYPE clockMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t rtcTaskHandle = NULL;
+static unsigned long lastRtcSync = 0;
+
+// I2C accesses, all made from the RTC task
+static unsigned long rtcReads = 0;
+static unsigned long rtcWrites = 0;
+static unsigned long rtcErrors = 0;
+static unsigned long rtcCorrections = 0; // Resyncs that moved the clock
+static unsigned long rtcTotalUs = 0;
+static unsigned long rtcMaxUs = 0;
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+static void setBase(time_t t) {
+  unsigned long ms = millis();
+
+  portENTER_CRITICAL(&clockMux);
+  baseTime = t;
+  baseMillis = ms;
+  clockValid = true;
+  portEXIT_CRITICAL(&clockMux);
+}
+
+static void accountI2C(unsigned long start) {
+  unsigned long us = micros() - start;
+  rtcTotalUs += us;
+  if (us > rtcMaxUs) {
+    rtcMaxUs = us;
+  }
+}
+
+// One RTC write or resync, runs in the RTC task (or loop() without it)
+static void rtcUpdate() {
+  bool write;
+
+  portENTER_CRITICAL(&clockMux);
+  write = rtcWritePending;
+  rtcWritePending = false;
+  portEXIT_CRITICAL(&clockMux);
+
+  unsigned long start = micros();
+  if (write) {
+    rtcWrites++;
+    if (!RTC.set(clockNow())) {
+      rtcErrors++;
+    }
+    accountI2C(start);
+    return;
+  }
+
+  rtcReads++;
+  time_t t = RTC.get();
+  accountI2C(start);
+  if (t == 0) {
+    rtcErrors++;
+    return;
+  }
+
+  // The crystal drifts slowly, only move the clock for a whole second or more.
+  // A time set by the NAC meanwhile wins over what was just read.
+  unsigned long ms = millis();
+  time_t current = clockNow();
+  portENTER_CRITICAL(&clockMux);
+  if (!rtcWritePending && (!clockValid || t > current + 1 || t < current - 1)) {
+    baseTime = t;
+    baseMillis = ms;
+    clockValid = true;
+    rtcCorrections++;
+  }
+  portEXIT_CRITICAL(&clockMux);
+}
+
+static void rtcTask(void*) {
+  for (;;) {
+    rtcUpdate(); // First pass: initial read of the RTC
+
+    // Woken by clockSet(), otherwise resyncs periodically
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CLOCK_RTC_SYNC_S * 1000UL));
+  }
+}
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+void clockBegin() {
+  if (xTaskCreatePinnedToCore(rtcTask, "rtc", 4096, NULL, CLOCK_TASK_PRIORITY, &rtcTaskHandle, CLOCK_TASK_CORE) != pdPASS) {
+    rtcTaskHandle = NULL;
+    lastRtcSync = millis() - CLOCK_RTC_SYNC_S * 1000UL; // Initial read on the first clockService()
+  }
+}
+
+void clockService() {
+  if (rtcTaskHandle != NULL) {
+    return;
+  }
+
+  if (rtcWritePending || millis() - lastRtcSync >= CLOCK_RTC_SYNC_S * 1000UL) {
+    lastRtcSync = millis();
+    rtcUpdate();
+  }
+}
+
+bool clockIsSet() {
+  return clockValid;
+}
+
+time_t clockNow() {
+  time_t t;
+  unsigned long ms = millis();
+
+  portENTER_CRITICAL(&clockMux);
+  t = baseTime + (ms - baseMillis) / 1000;
+  portEXIT_CRITICAL(&clockMux);
+
+  return t;
+}
+
+void clockRead(tmElements_t& tm) {
+  breakTime(clockNow(), tm);
+}
+
+void clockSet(int year, byte month, byte day, byte hour, byte minute, bool writeRtc) {
+  tmElements_t tm;
+  tm.Year = CalendarYrToTm(year);
+  tm.Month = month;
+  tm.Day = day;
+  tm.Hour = hour;
+  tm.Minute = minute;
+  tm.Second = 0;
+  setBase(makeTime(tm));
+
+  if (!writeRtc) {
+    return;
+  }
+
+  portENTER_CRITICAL(&clockMux);
+  rtcWritePending = true;
+  portEXIT_CRITICAL(&clockMux);
+
+  if (rtcTaskHandle != NULL) {
+    xTaskNotifyGive(rtcTaskHandle);
+  }
+}
+
+void clockPrintStats() {
+  unsigned long accesses = rtcReads + rtcWrites;
+
+  Serial.print("RTC: ");
+  Serial.print(rtcReads);
+  Serial.print(" reads, ");
+  Serial.print(rtcWrites);
+  Serial.print(" writes, ");
+  Serial.print(rtcErrors);
+  Serial.print(" errors, ");
+  Serial.print(rtcCorrections);
+  Serial.print(" corrections, I2C avg ");
+  Serial.print(accesses ? rtcTotalUs / accesses : 0);
+  Serial.print(" us, max ");
+  Serial.print(rtcMaxUs);
+  Serial.println(rtcTaskHandle != NULL ? " us (RTC task)" : " us (loop)");
+}
@@ -0,0 +1,81 @@
+/*
+ * @file translation_memo.cpp
+ * @brief Per-ID memo of the last translation: unchanged input → cached output frame
+ *
+ * The memos themselves live next to their handler (main.cpp); this module
+ * only compares, stores and lists them for the statistics.
+ */
+
+#include <translation_memo.h>
+#include <config.h>
+
+// ============================================================================
+// INTERNAL VARIABLES
+// ============================================================================
+
+static TranslationMemo* memos[TRANSLATION_MEMO_MAX];
+static byte memoCount = 0;
+
+// ============================================================================
+// MAIN FUNCTIONS
+// ============================================================================
+
+const struct can_frame* memoLookup(TranslationMemo& memo, const struct can_frame& in, uint32_t state) {
+  if (memo.valid && memo.state == state && memo.inDlc == in.can_dlc && memcmp(memo.in, in.data, 8) == 0) {
+    memo.hits++;
+    return &memo.out;
+  }
+
+  memo.misses++;
+  memo.valid = false; // Until memoStore()
+  memo.state = state;
+  memo.inDlc = in.can_dlc;
+  memcpy(memo.in, in.data, 8);
+  return NULL;
+}
+
+const struct can_frame* memoStore(TranslationMemo& memo, const struct can_frame& out) {
+  memo.out = out;
+  memo.valid = true;
+
+  if (!memo.listed && memoCount < TRANSLATION_MEMO_MAX) {
+    memos[memoCount++] = &memo;
+    memo.listed = true;
+  }
+  return &memo.out;
+}
+
+void memoInvalidate(TranslationMemo& memo) {
+  memo.valid = false;
+}
+
+void memoInvalidateAll() {
+  for (byte i = 0; i < memoCount; i++) {
+    memos[i]->valid = false;
+  }
+}
+
+void memoPrintStats() {
+  Serial.println("Translation memo: ID | hits, misses, hit rate");
+
+  for (byte i = 0; i < memoCount; i++) {
+    const TranslationMemo& memo = *memos[i];
+    unsigned long total = memo.hits + memo.misses;
+    Serial.print("  0x");
+    Serial.print(memo.id, HEX);
+    Serial.print(" | ");
+    Serial.print(memo.hits);
+    Serial.print(", ");
+    Serial.print(memo.misses);
+    Serial.print(", ");
+    Serial.print(total ? (memo.hits * 100.0f) / total : 0.0f, 1);
+    Serial.println("%");
+  }
+}
+
+void memoResetStats() {
+  for (byte i = 0; i < memoCount; i++) {
+    memos[i]->hits = 0;
+    memos[i]->misses = 0;
+  }
+}